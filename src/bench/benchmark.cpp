@@ -0,0 +1,1800 @@
+#include "bench/benchmark.hpp"
+#include "core/algorithms.hpp"
+#include "core/csr.hpp"
+#include "core/distance_oracle.hpp"
+#include "core/contraction.hpp"
+#include "core/parallel.hpp"
+#include "core/statistics.hpp"
+#include "core/subgraph.hpp"
+#include "core/dfs.hpp"
+#include "core/query.hpp"
+#include "core/search.hpp"
+#include "core/incremental.hpp"
+#include "core/journal.hpp"
+#include "core/reorder.hpp"
+#include "core/dag.hpp"
+#include "io/loader.hpp"
+#include "io/exporter.hpp"
+#include "bench/memory.hpp"
+#include "visualization/layout.hpp"
+#include "visualization/sugiyama.hpp"
+#include "visualization/embedding.hpp"
+#include "visualization/layout_cache.hpp"
+#include <random>
+#include <iomanip>
+#include <functional>
+#include <cmath>
+#include <algorithm>
+#include <optional>
+#include <thread>
+#include <atomic>
+#include <sstream>
+#include <unordered_set>
+#include <queue>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <numeric>
+
+namespace graph {
+
+namespace {
+
+// Не даёт компилятору выбросить замеряемые вычисления
+volatile double sink = 0.0;
+
+// Граница размера графа для исходного O(V^2) Dijkstra
+constexpr int kLegacyDijkstraLimit = 5000;
+
+// Граница размера графа для точной центральности по посредничеству (O(VE))
+constexpr int kExactBetweennessLimit = 5000;
+
+// Сколько путей перечислять в замерах запросов
+constexpr size_t kQueryPathLimit = 1000;
+
+// Граница размера графа для полного force-directed (O(V^2) на итерацию)
+constexpr int kFullLayoutLimit = 2000;
+
+// Итераций force-directed в замере порядка вершин
+constexpr int kOrderingLayoutIterations = 5;
+
+// Длина пути для проверки глубокого DFS
+constexpr int kDeepPathLength = 10000000;
+
+// Вершина -> наименьшая вершина её компоненты: не зависит от номеров компонент
+std::unordered_map<int, int> canonicalComponents(const std::vector<std::vector<int>>& components) {
+    std::unordered_map<int, int> result;
+    for (const auto& component : components) {
+        int smallest = *std::min_element(component.begin(), component.end());
+        for (int v : component) result[v] = smallest;
+    }
+    return result;
+}
+
+// Эталонные обходы с состоянием в хеш-множествах по внешним ID (как до
+// плотной нумерации вершин)
+std::vector<int> hashedBFS(const Graph& g, int start) {
+    std::vector<int> order;
+    std::queue<int> queue;
+    std::unordered_set<int> visited{start};
+    queue.push(start);
+    while (!queue.empty()) {
+        int current = queue.front();
+        queue.pop();
+        order.push_back(current);
+        for (int neighbor : g.getNeighbors(current)) {
+            if (visited.insert(neighbor).second) queue.push(neighbor);
+        }
+    }
+    return order;
+}
+
+// Стек - копии списков соседей с позицией: рекурсия переполнилась бы на
+// длинных цепочках
+void hashedDFS(const Graph& g, int start, std::unordered_set<int>& visited, std::vector<int>& order) {
+    std::vector<std::pair<std::vector<int>, size_t>> stack;
+    visited.insert(start);
+    order.push_back(start);
+    stack.emplace_back(g.getNeighbors(start), 0);
+    while (!stack.empty()) {
+        auto& [neighbors, next] = stack.back();
+        if (next == neighbors.size()) {
+            stack.pop_back();
+            continue;
+        }
+        int v = neighbors[next++];
+        if (visited.insert(v).second) {
+            order.push_back(v);
+            stack.emplace_back(g.getNeighbors(v), 0);
+        }
+    }
+}
+
+bool matchesNode(const NodePattern& node, const Vertex& vertex) {
+    switch (node.kind) {
+        case NodePattern::Kind::Type: return vertex.type == node.value;
+        case NodePattern::Kind::Label: return vertex.label == node.value;
+        case NodePattern::Kind::Vertex: return vertex.id == node.id;
+        default: return true;
+    }
+}
+
+// Эталон без индекса: на каждом шаге шаблона перебираются все дуги графа;
+// возвращает число вершин, подходящих последнему узлу
+size_t scanAnswers(const Graph& g, const std::vector<Edge>& arcs, const PathPattern& pattern) {
+    std::unordered_set<int> frontier;
+    for (int id : g.getVertices()) {
+        if (matchesNode(pattern.nodes[0], *g.getVertex(id))) frontier.insert(id);
+    }
+    for (size_t i = 0; i < pattern.edges.size(); ++i) {
+        const EdgePattern& edge = pattern.edges[i];
+        std::unordered_set<int> next;
+        for (const auto& arc : arcs) {
+            int from = edge.reversed ? arc.to : arc.from;
+            int to = edge.reversed ? arc.from : arc.to;
+            if ((edge.label.empty() || arc.label == edge.label) && frontier.count(from)
+                && matchesNode(pattern.nodes[i + 1], *g.getVertex(to))) {
+                next.insert(to);
+            }
+        }
+        frontier.swap(next);
+    }
+    return frontier.size();
+}
+
+} // namespace
+
+int Benchmark::run(const std::string& filename, size_t queries, std::ostream& out,
+                   const std::string& section) {
+    std::unique_ptr<Graph> g;
+    MemoryUsage before = MemoryUsage::current();
+    double loadMs = measureMs([&] { g = GraphLoader::loadFromFile(filename, VertexOrdering::Original); });
+    if (!g) {
+        out << "Не удалось загрузить граф из " << filename << std::endl;
+        return 1;
+    }
+    MemoryUsage loaded = MemoryUsage::current();
+    
+    // Перенумерация - отдельно, чтобы раздел order сравнил её с порядком загрузки
+    std::vector<int> loadOrder = g->getVertices();
+    double orderMs = measureMs([&] { Reordering::apply(*g, GraphLoader::kDefaultOrdering); });
+    
+    out << "Граф: " << filename << ", вершин: " << g->getVertexCount()
+        << ", рёбер: " << g->getEdgeCount()
+        << ", загрузка: " << std::fixed << std::setprecision(2) << loadMs << " мс"
+        << ", перенумерация: " << orderMs << " мс" << std::endl;
+    out << "Память загрузки: ";
+    if (MemoryUsage::countsAllocations()) {
+        out << loaded.allocations - before.allocations << " выделений, "
+            << (loaded.bytes - before.bytes) / 1048576.0 << " МБ запрошено, ";
+    }
+    out << "RSS " << loaded.residentBytes / 1048576.0 << " МБ" << std::endl;
+    
+    auto selected = [&section](const char* name) { return section.empty() || section == name; };
+    if (selected("paths")) shortestPaths(*g, queries, out);
+    if (selected("traverse")) traversals(*g, queries, out);
+    if (selected("order")) vertexOrdering(*g, loadOrder, queries, out);
+    if (selected("sssp")) singleSource(*g, queries, out);
+    if (selected("pagerank")) pageRank(*g, out);
+    if (selected("betweenness")) betweenness(*g, out);
+    if (selected("communities")) communities(*g, out);
+    if (selected("triangles")) triangles(*g, out);
+    if (selected("cores")) cores(*g, out);
+    if (selected("dag")) directedStructure(*g, out);
+    if (selected("layout")) layoutQuality(*g, out);
+    if (selected("ego")) neighborhoods(*g, queries, out);
+    if (selected("oracle")) distanceOracle(*g, queries, out);
+    if (selected("query")) relationQueries(*g, queries, out);
+    if (selected("search")) nameSearch(*g, queries, out);
+    if (selected("memory")) memoryFootprint(*g, out);
+    if (selected("export")) exportThroughput(*g, out);
+    if (selected("journal")) operationJournal(*g, queries, out);
+    if (selected("versions")) versionedSnapshots(*g, queries, out);
+    if (selected("dynamic")) dynamicUpdates(*g, queries, out);
+    return 0;
+}
+
+int Benchmark::queryReport(const std::string& filename, const std::string& query, std::ostream& out) {
+    auto g = GraphLoader::loadFromFile(filename);
+    if (!g) {
+        out << "Не удалось загрузить граф из " << filename << std::endl;
+        return 1;
+    }
+    std::string error;
+    auto pattern = QueryEngine::parse(query, &error);
+    if (!pattern) {
+        out << "Ошибка в запросе: " << error << std::endl;
+        return 1;
+    }
+    
+    std::optional<QueryEngine> engine;
+    double buildMs = measureMs([&] { engine = QueryEngine::build(*g); });
+    QueryResult result;
+    double queryMs = measureMs([&] { result = engine->evaluate(*pattern, kQueryPathLimit); });
+    
+    auto name = [&g](int id) {
+        const Vertex* vertex = g->getVertex(id);
+        return vertex && !vertex->label.empty() ? std::to_string(id) + " (" + vertex->label + ")" : std::to_string(id);
+    };
+    out << std::fixed << std::setprecision(3);
+    out << "Индекс: " << engine->relationCounts().size() << " типов связей, " << engine->arcCount()
+        << " дуг, " << buildMs << " мс" << std::endl;
+    out << "Кандидаты по узлам:";
+    for (const auto& ids : result.bindings) out << " " << ids.size();
+    out << std::endl;
+    out << "Ответов: " << result.bindings.back().size() << ", путей: " << result.paths.size()
+        << (result.truncated ? "+" : "") << ", запрос: " << queryMs << " мс" << std::endl;
+    for (const auto& path : result.paths) {
+        out << " ";
+        for (size_t i = 0; i < path.size(); ++i) out << (i > 0 ? " -> " : " ") << name(path[i]);
+        out << std::endl;
+    }
+    return 0;
+}
+
+int Benchmark::statisticsReport(const std::string& filename, std::ostream& out) {
+    auto g = GraphLoader::loadFromFile(filename);
+    if (!g) {
+        out << "Не удалось загрузить граф из " << filename << std::endl;
+        return 1;
+    }
+    
+    CSRGraph csr = CSRGraph::fromGraph(*g);
+    GraphStatistics stats;
+    double ms = measureMs([&] { stats = Statistics::compute(csr, threadCount()); });
+    
+    out << "Граф: " << filename << (g->isDirected() ? " (ориентированный)" : "") << std::endl;
+    out << std::fixed << std::setprecision(4);
+    out << "Вершин: " << stats.vertices << ", рёбер без направления: " << stats.edges
+        << ", плотность: " << g->getDensity() << std::endl;
+    out << "Треугольников: " << stats.triangles << std::endl;
+    out << "Средний коэффициент кластеризации: " << stats.averageClustering << std::endl;
+    out << "Транзитивность: " << stats.transitivity << std::endl;
+    out << "Вырожденность (наибольшее k-ядро): " << stats.degeneracy << std::endl;
+    
+    // Размеры k-ядер: вершины с ядерным числом не меньше k
+    std::vector<size_t> atLeast(stats.degeneracy + 2, 0);
+    for (int core : stats.coreNumber) ++atLeast[core];
+    for (int k = stats.degeneracy; k > 0; --k) atLeast[k - 1] += atLeast[k];
+    out << "Размеры k-ядер:";
+    for (int k = 1; k <= stats.degeneracy; ++k) {
+        out << " " << k << ":" << atLeast[k];
+    }
+    out << std::endl;
+    out << "Время расчёта: " << std::setprecision(2) << ms << " мс" << std::endl;
+    return 0;
+}
+
+int Benchmark::searchReport(const std::string& filename, const std::string& text, std::ostream& out) {
+    auto g = GraphLoader::loadFromFile(filename);
+    if (!g) {
+        out << "Не удалось загрузить граф из " << filename << std::endl;
+        return 1;
+    }
+    auto index = g->getSearchIndex();
+    std::vector<SearchHit> hits;
+    double ms = measureMs([&] { hits = index->search(text); });
+    
+    out << std::fixed << std::setprecision(3);
+    out << "Найдено: " << hits.size() << " (" << ms * 1000.0 << " мкс)" << std::endl;
+    for (const auto& hit : hits) {
+        const Vertex* vertex = g->getVertex(hit.id);
+        out << "  " << hit.id;
+        if (vertex && !vertex->label.empty()) out << " (" << vertex->label << ")";
+        out << (hit.score < 1.0 ? ", сходство " : ", префикс ") << hit.score << std::endl;
+    }
+    return 0;
+}
+
+int Benchmark::exportReport(const std::string& filename, const std::string& output, std::ostream& out) {
+    auto format = GraphExporter::formatFor(output);
+    if (!format) {
+        out << "Неподдерживаемый формат файла: " << output << " (csv, json, graphml, dot, gv)" << std::endl;
+        return 1;
+    }
+    auto g = GraphLoader::loadFromFile(filename);
+    if (!g) {
+        out << "Не удалось загрузить граф из " << filename << std::endl;
+        return 1;
+    }
+    
+    Layout layout;
+    layout.setCache(std::make_shared<LayoutCache>(LayoutCache::defaultDirectory()));
+    double layoutMs = measureMs([&] { layout.applyLayout(*g, LayoutType::ForceDirected, 1200.0, 800.0); });
+    bool saved = false;
+    double saveMs = measureMs([&] { saved = GraphExporter::save(*g, output, *format); });
+    if (!saved) return 1;
+    
+    std::error_code error;
+    double megabytes = static_cast<double>(std::filesystem::file_size(output, error)) / 1048576.0;
+    out << std::fixed << std::setprecision(2);
+    out << "Граф записан в " << output << ": " << megabytes << " МБ, макет " << layoutMs << " мс, запись "
+        << saveMs << " мс (" << megabytes / (saveMs / 1000.0) << " МБ/с)" << std::endl;
+    return 0;
+}
+
+std::string Benchmark::column(const std::string& text, size_t width, bool alignLeft) {
+    size_t chars = 0;
+    for (unsigned char c : text) {
+        if ((c & 0xC0) != 0x80) ++chars;
+    }
+    std::string padding(chars < width ? width - chars : 0, ' ');
+    return alignLeft ? text + padding : padding + text;
+}
+
+std::vector<std::pair<int, int>> Benchmark::randomPairs(const Graph& g, size_t count) {
+    auto vertices = g.getVertices();
+    std::sort(vertices.begin(), vertices.end());
+    std::vector<std::pair<int, int>> pairs;
+    if (vertices.empty()) return pairs;
+    
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<size_t> pick(0, vertices.size() - 1);
+    for (size_t i = 0; i < count; ++i) {
+        pairs.emplace_back(vertices[pick(gen)], vertices[pick(gen)]);
+    }
+    return pairs;
+}
+
+size_t Benchmark::threadCount() {
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+void Benchmark::shortestPaths(Graph& g, size_t queries, std::ostream& out) {
+    auto pairs = randomPairs(g, queries);
+    if (pairs.empty()) return;
+    
+    ThreadPool pool(threadCount());
+    CSRGraph csr = CSRGraph::fromGraph(g);
+    CSRGraph reverse = csr.transposed();
+    std::optional<DistanceOracle> oracle;
+    double landmarkMs = measureMs([&] {
+        oracle = DistanceOracle::build(csr, 8, LandmarkStrategy::FarthestPoint, pool);
+    });
+    std::optional<ContractionHierarchy> hierarchy;
+    double hierarchyMs = measureMs([&] { hierarchy = ContractionHierarchy::build(csr); });
+    
+    // Эталонные расстояния - Dijkstra с кучей по CSR
+    std::vector<double> reference;
+    for (const auto& [s, t] : pairs) {
+        reference.push_back(Algorithms::shortestDistances(csr, csr.indexOf(s))[csr.indexOf(t)]);
+    }
+    
+    using Search = std::function<std::vector<int>(int, int, AlgorithmState&)>;
+    std::vector<std::pair<std::string, Search>> searches;
+    // Исходный Dijkstra квадратичен по числу вершин - на больших графах пропускается
+    if (csr.size() <= kLegacyDijkstraLimit) {
+        searches.push_back({"Dijkstra", [&](int s, int t, AlgorithmState& st) { return Algorithms::Dijkstra(g, s, t, st); }});
+    }
+    searches.insert(searches.end(), {
+        {"Bidirectional", [&](int s, int t, AlgorithmState& st) {
+            return Algorithms::BidirectionalDijkstra(csr, reverse, s, t, st);
+        }},
+        {"A* (ALT)", [&](int s, int t, AlgorithmState& st) {
+            int target = csr.indexOf(t);
+            return Algorithms::AStar(csr, s, t, st, [&](int v) { return oracle->lowerBound(v, target); });
+        }},
+        {"CH", [&](int s, int t, AlgorithmState& st) {
+            return Algorithms::HierarchyQuery(csr, *hierarchy, s, t, st);
+        }},
+    });
+    std::vector<double> xs, ys;
+    if (Algorithms::hasGeometricWeights(g)) {
+        for (int id : csr.ids) {
+            const Vertex* vertex = g.getVertex(id);
+            xs.push_back(vertex->x);
+            ys.push_back(vertex->y);
+        }
+        searches.push_back({"A* (Euclid)", [&](int s, int t, AlgorithmState& st) {
+            int target = csr.indexOf(t);
+            return Algorithms::AStar(csr, s, t, st, [&](int v) {
+                return std::hypot(xs[v] - xs[target], ys[v] - ys[target]);
+            });
+        }});
+    }
+    
+    out << "\n== Поиск кратчайшего пути: " << queries << " запросов ==" << std::endl;
+    out << "Ориентиры ALT: " << oracle->landmarks().size() << " шт., "
+        << std::fixed << std::setprecision(2) << landmarkMs << " мс" << std::endl;
+    out << "Иерархия сжатия: " << hierarchy->shortcutCount() << " шорткатов, "
+        << hierarchyMs << " мс" << std::endl;
+    out << column("алгоритм", 16, true) << column("просмотрено", 14)
+        << column("мс/запрос", 14) << column("расхождений", 14) << std::endl;
+    
+    for (const auto& [name, search] : searches) {
+        AlgorithmState state;
+        state.stepDelayMs = 0;
+        
+        double totalMs = 0.0;
+        size_t explored = 0;
+        size_t mismatches = 0;
+        for (size_t i = 0; i < pairs.size(); ++i) {
+            std::vector<int> path;
+            totalMs += measureMs([&] { path = search(pairs[i].first, pairs[i].second, state); });
+            explored += state.visited.size();
+            
+            double cost = Algorithms::pathCost(g, path);
+            if (std::abs(cost - reference[i]) > 1e-6 && !(std::isinf(cost) && std::isinf(reference[i]))) {
+                ++mismatches;
+            }
+        }
+        
+        out << column(name, 16, true)
+            << std::setw(14) << std::setprecision(1)
+            << static_cast<double>(explored) / pairs.size()
+            << std::setw(14) << std::setprecision(3) << totalMs / pairs.size()
+            << std::setw(14) << mismatches << std::endl;
+    }
+}
+
+void Benchmark::traversals(Graph& g, size_t queries, std::ostream& out) {
+    auto pairs = randomPairs(g, std::min<size_t>(queries, 20));
+    if (pairs.empty()) return;
+    
+    AlgorithmState state;
+    state.stepDelayMs = 0;
+    struct Row {
+        std::string name;
+        double ms;
+        std::optional<size_t> mismatches;
+    };
+    std::vector<Row> rows;
+    auto traverse = [&](const std::string& name, auto&& reference, auto&& dense) {
+        double referenceMs = 0.0, denseMs = 0.0;
+        size_t mismatches = 0;
+        for (const auto& [start, _] : pairs) {
+            std::vector<int> expected, actual;
+            referenceMs += measureMs([&] { expected = reference(start); });
+            denseMs += measureMs([&] { actual = dense(start); });
+            if (actual != expected) ++mismatches;
+        }
+        rows.push_back({name + ": хеш-множества", referenceMs / pairs.size(), std::nullopt});
+        rows.push_back({name + ": плотные индексы", denseMs / pairs.size(), mismatches});
+    };
+    
+    traverse("BFS", [&](int start) { return hashedBFS(g, start); },
+             [&](int start) { return Algorithms::BFS(g, start, state); });
+    traverse("DFS", [&](int start) {
+        std::unordered_set<int> visited;
+        std::vector<int> order;
+        hashedDFS(g, start, visited, order);
+        return order;
+    }, [&](int start) { return Algorithms::DFS(g, start, state); });
+    
+    // Компоненты: эталон - те же обходы из каждой непосещённой вершины
+    std::vector<std::vector<int>> expected, actual;
+    double referenceMs = measureMs([&] {
+        std::unordered_set<int> visited;
+        for (int id : g.getVertices()) {
+            if (visited.count(id)) continue;
+            expected.emplace_back();
+            hashedDFS(g, id, visited, expected.back());
+        }
+    });
+    double denseMs = measureMs([&] { actual = g.getConnectedComponents(); });
+    rows.push_back({"компоненты: хеш-множества", referenceMs, std::nullopt});
+    rows.push_back({"компоненты: плотные индексы", denseMs,
+                    canonicalComponents(actual) == canonicalComponents(expected) ? 0u : 1u});
+    
+    // Достижимость: явный стек DFS против потоков с отдачей работы;
+    // расхождение - другое множество или родитель без дуги к вершине
+    CSRGraph csr = CSRGraph::fromGraph(g);
+    std::vector<VertexMask> reachable;
+    double serialMs = 0.0;
+    DepthFirst dfs([&csr](int v) { return csr.neighbors(v); });
+    for (const auto& [start, _] : pairs) {
+        VertexMask visited(csr.size());
+        serialMs += measureMs([&] { dfs.run(csr.indexOf(start), visited, [](int) { return true; }); });
+        reachable.push_back(std::move(visited));
+    }
+    rows.push_back({"достижимость: DFS", serialMs / pairs.size(), std::nullopt});
+    for (size_t threads : {1, 2, 4, 8}) {
+        double ms = 0.0;
+        size_t mismatches = 0;
+        for (size_t i = 0; i < pairs.size(); ++i) {
+            std::vector<int> parent;
+            ms += measureMs([&] { parent = ParallelAlgorithms::reachabilityTree(csr, pairs[i].first, threads); });
+            bool valid = true;
+            for (int v = 0; v < csr.size() && valid; ++v) {
+                valid = (parent[v] != -1) == reachable[i].test(v);
+                if (valid && parent[v] != -1 && parent[v] != v) {
+                    auto neighbors = csr.neighbors(parent[v]);
+                    valid = std::find(neighbors.begin(), neighbors.end(), v) != neighbors.end();
+                }
+            }
+            if (!valid) ++mismatches;
+        }
+        rows.push_back({"достижимость: " + std::to_string(threads) + " потоков", ms / pairs.size(), mismatches});
+    }
+    
+    out << "\n== Обходы: " << pairs.size() << " стартов ==" << std::endl;
+    out << column("алгоритм", 30, true) << column("мс/обход", 12) << column("расхождений", 14) << std::endl;
+    for (const auto& row : rows) {
+        out << column(row.name, 30, true) << std::setw(12) << std::fixed << std::setprecision(3) << row.ms
+            << std::setw(14) << (row.mismatches ? std::to_string(*row.mismatches) : "-") << std::endl;
+    }
+    
+    // Путь 0 -> 1 -> ... : глубина стека обхода равна длине пути
+    CSRGraph path;
+    path.directed = true;
+    path.ids.resize(kDeepPathLength);
+    std::iota(path.ids.begin(), path.ids.end(), 0);
+    path.index[0] = 0;  // ID нужен только для старта
+    path.offsets.resize(kDeepPathLength + 1);
+    path.targets.resize(kDeepPathLength - 1);
+    for (int v = 0; v < kDeepPathLength; ++v) {
+        path.offsets[v + 1] = path.offsets[v] + (v + 1 < kDeepPathLength ? 1 : 0);
+        if (v + 1 < kDeepPathLength) path.targets[v] = v + 1;
+    }
+    size_t depth = 0, maxDepth = 0, finished = 0;
+    VertexMask visited(kDeepPathLength);
+    DepthFirst deep([&path](int v) { return path.neighbors(v); });
+    double deepMs = measureMs([&] {
+        deep.run(0, visited, [&](int) {
+            maxDepth = std::max(maxDepth, ++depth);
+            return true;
+        }, [&](int) {
+            --depth;
+            ++finished;
+        });
+    });
+    std::vector<int> parent;
+    double reachMs = measureMs([&] { parent = ParallelAlgorithms::reachabilityTree(path, 0, threadCount()); });
+    bool reachedAll = std::none_of(parent.begin(), parent.end(), [](int p) { return p == -1; });
+    out << "Путь из " << kDeepPathLength << " вершин: DFS " << std::setprecision(1) << deepMs
+        << " мс, глубина " << maxDepth << ", завершено " << finished << "; достижимость на "
+        << threadCount() << " потоках " << reachMs << " мс, " << (reachedAll ? "дошла до конца" : "НЕ дошла до конца")
+        << std::endl;
+}
+
+void Benchmark::vertexOrdering(Graph& g, const std::vector<int>& loadOrder, size_t queries, std::ostream& out) {
+    auto pairs = randomPairs(g, std::min<size_t>(queries, 20));
+    if (pairs.empty()) return;
+    
+    std::vector<int> current = g.getVertices();
+    g.setDenseOrder(loadOrder);
+    CSRGraph loaded = CSRGraph::fromGraph(g);
+    bool fullLayout = loaded.size() <= kFullLayoutLimit;
+    
+    AlgorithmState state;
+    state.stepDelayMs = 0;
+    
+    // BFS по массивам CSR: здесь порядок вершин виден сильнее всего
+    std::vector<int> queue;
+    std::vector<char> seen;
+    auto csrBFS = [&](const CSRGraph& csr, int start) {
+        seen.assign(csr.size(), 0);
+        queue.assign(1, start);
+        seen[start] = 1;
+        for (size_t head = 0; head < queue.size(); ++head) {
+            for (int u : csr.neighbors(queue[head])) {
+                if (!seen[u]) {
+                    seen[u] = 1;
+                    queue.push_back(u);
+                }
+            }
+        }
+        return queue.size();
+    };
+    
+    out << "\n== Порядок вершин: " << pairs.size() << " стартов BFS"
+        << (fullLayout ? "" : ", макет пропущен (O(V^2) на итерацию)") << " ==" << std::endl;
+    out << column("порядок", 12, true) << column("расчёт мс", 12) << column("разрыв", 12)
+        << column("BFS граф мс", 13) << column("BFS CSR мс", 12) << column("PageRank мс", 13)
+        << column("макет мс/итер", 15) << std::endl;
+    
+    const std::pair<const char*, VertexOrdering> orderings[] = {
+        {"загрузки", VertexOrdering::Original},
+        {"по степени", VertexOrdering::Degree},
+        {"RCM", VertexOrdering::ReverseCuthillMcKee},
+        {"Gorder", VertexOrdering::Gorder},
+    };
+    for (const auto& [name, ordering] : orderings) {
+        std::vector<int> order;
+        double computeMs = measureMs([&] { order = Reordering::compute(loaded, ordering); });
+        std::vector<int> ids;
+        ids.reserve(order.size());
+        for (int v : order) ids.push_back(loaded.ids[v]);
+        g.setDenseOrder(ids);
+        CSRGraph csr = CSRGraph::fromGraph(g);
+        
+        double graphMs = 0.0, csrMs = 0.0;
+        for (const auto& [start, _] : pairs) {
+            graphMs += measureMs([&] { sink = static_cast<double>(Algorithms::BFS(g, start, state).size()); });
+            int source = csr.indexOf(start);
+            csrMs += measureMs([&] { sink = static_cast<double>(csrBFS(csr, source)); });
+        }
+        double pageRankMs = std::numeric_limits<double>::infinity();
+        for (int run = 0; run < 3; ++run) {
+            pageRankMs = std::min(pageRankMs, measureMs([&] { sink = ParallelAlgorithms::pageRank(csr, 1).residual; }));
+        }
+        
+        out << column(name, 12, true) << std::setw(12) << std::fixed << std::setprecision(2) << computeMs
+            << std::setw(12) << std::setprecision(1) << Reordering::averageGap(csr)
+            << std::setw(13) << std::setprecision(3) << graphMs / pairs.size()
+            << std::setw(12) << csrMs / pairs.size()
+            << std::setw(13) << std::setprecision(2) << pageRankMs;
+        if (fullLayout) {
+            Layout layout;
+            double layoutMs = measureMs([&] { layout.forceDirected(g, 1200.0, 800.0, kOrderingLayoutIterations); });
+            out << std::setw(15) << std::setprecision(3) << layoutMs / kOrderingLayoutIterations;
+        } else {
+            out << std::setw(15) << "-";
+        }
+        out << std::endl;
+    }
+    g.setDenseOrder(current);
+}
+
+void Benchmark::singleSource(Graph& g, size_t queries, std::ostream& out) {
+    auto pairs = randomPairs(g, std::min<size_t>(queries, 20));
+    if (pairs.empty()) return;
+    
+    CSRGraph csr = CSRGraph::fromGraph(g);
+    std::vector<std::vector<double>> reference;
+    double referenceMs = measureMs([&] {
+        for (const auto& pair : pairs) {
+            reference.push_back(Algorithms::shortestDistances(csr, csr.indexOf(pair.first)));
+        }
+    });
+    
+    out << "\n== Кратчайшие расстояния от источника: " << pairs.size() << " источников ==" << std::endl;
+    out << column("алгоритм", 16, true) << column("потоков", 10)
+        << column("мс/источник", 14) << column("расхождений", 14) << std::endl;
+    out << column("Dijkstra", 16, true) << std::setw(10) << 1
+        << std::setw(14) << std::setprecision(3) << referenceMs / pairs.size()
+        << std::setw(14) << 0 << std::endl;
+    
+    for (size_t threads : {1, 2, 4, 8}) {
+        size_t mismatches = 0;
+        double totalMs = 0.0;
+        for (size_t i = 0; i < pairs.size(); ++i) {
+            ShortestPathTree tree;
+            totalMs += measureMs([&] { tree = ParallelAlgorithms::deltaStepping(csr, pairs[i].first, threads); });
+            for (int v = 0; v < csr.size(); ++v) {
+                double expected = reference[i][v];
+                if (std::abs(tree.distance[v] - expected) > 1e-6 && !(std::isinf(expected) && std::isinf(tree.distance[v]))) {
+                    ++mismatches;
+                }
+            }
+        }
+        out << column("delta-stepping", 16, true) << std::setw(10) << threads
+            << std::setw(14) << std::setprecision(3) << totalMs / pairs.size()
+            << std::setw(14) << mismatches << std::endl;
+    }
+}
+
+void Benchmark::pageRank(Graph& g, std::ostream& out) {
+    CSRGraph csr = CSRGraph::fromGraph(g);
+    if (csr.size() == 0) return;
+    
+    out << "\n== PageRank: " << csr.arcCount() << " дуг ==" << std::endl;
+    out << column("вариант", 16, true) << column("потоков", 10) << column("итераций", 10)
+        << column("мс", 12) << column("млн дуг/с", 12) << column("отклонение", 14) << std::endl;
+    
+    for (int personalizedFrom : {-1, csr.ids.front()}) {
+        std::vector<double> baseline;
+        for (size_t threads : {1, 2, 4, 8}) {
+            PageRankResult result;
+            double ms = measureMs([&] { result = ParallelAlgorithms::pageRank(csr, threads, personalizedFrom); });
+            if (baseline.empty()) baseline = result.score;
+            
+            // L1-расстояние до однопоточного результата
+            double deviation = 0.0;
+            for (size_t v = 0; v < baseline.size(); ++v) {
+                deviation += std::abs(result.score[v] - baseline[v]);
+            }
+            double throughput = ms > 0.0 ? csr.arcCount() * result.iterations / (ms * 1000.0) : 0.0;
+            
+            out << column(personalizedFrom == -1 ? "глобальный" : "персонализ.", 16, true)
+                << std::setw(10) << threads << std::setw(10) << result.iterations
+                << std::setw(12) << std::setprecision(2) << ms
+                << std::setw(12) << throughput
+                << std::setw(14) << std::scientific << std::setprecision(1) << deviation
+                << std::fixed << std::endl;
+        }
+    }
+}
+
+void Benchmark::betweenness(Graph& g, std::ostream& out) {
+    CSRGraph csr = CSRGraph::fromGraph(g);
+    int n = csr.size();
+    if (n < 3) return;
+    
+    // Точный расчёт - эталон; на больших графах сравниваются только выборки
+    std::optional<BetweennessResult> exact;
+    double exactMs = 0.0;
+    if (n <= kExactBetweennessLimit) {
+        exactMs = measureMs([&] { exact = ParallelAlgorithms::betweenness(csr, threadCount()); });
+    }
+    std::vector<int> exactTop;
+    if (exact) exactTop = ParallelAlgorithms::topVertices(csr, exact->score, 10);
+    double pairs = static_cast<double>(n) * (n - 1) * (csr.directed ? 1.0 : 0.5);
+    
+    out << "\n== Центральность по посредничеству: " << threadCount() << " потоков ==" << std::endl;
+    out << column("режим", 16, true) << column("источников", 12) << column("мс", 12)
+        << column("граница", 10) << column("ошибка", 10) << column("топ-10", 8) << std::endl;
+    if (exact) {
+        out << column("точно", 16, true) << std::setw(12) << exact->samples
+            << std::setw(12) << std::setprecision(2) << exactMs
+            << std::setw(10) << "0" << std::setw(10) << "0" << std::setw(8) << "10/10" << std::endl;
+    }
+    
+    for (double epsilon : {0.05, 0.02, 0.01}) {
+        BetweennessResult sampled;
+        double ms = measureMs([&] { sampled = ParallelAlgorithms::betweenness(csr, threadCount(), epsilon); });
+        
+        std::string error = "-";
+        std::string overlap = "-";
+        if (exact) {
+            // Наибольшая ошибка нормированной центральности и совпадение топ-10
+            double worst = 0.0;
+            for (int v = 0; v < n; ++v) {
+                worst = std::max(worst, std::abs(sampled.score[v] - exact->score[v]) / pairs);
+            }
+            std::ostringstream formatted;
+            formatted << std::fixed << std::setprecision(4) << worst;
+            error = formatted.str();
+            
+            auto top = ParallelAlgorithms::topVertices(csr, sampled.score, 10);
+            size_t common = 0;
+            for (int id : top) {
+                common += std::count(exactTop.begin(), exactTop.end(), id);
+            }
+            overlap = std::to_string(common) + "/" + std::to_string(exactTop.size());
+        }
+        
+        out << column("eps = " + std::to_string(epsilon).substr(0, 4), 16, true)
+            << std::setw(12) << sampled.samples
+            << std::setw(12) << std::setprecision(2) << ms
+            << std::setw(10) << std::setprecision(4) << sampled.errorBound
+            << std::setw(10) << error << std::setw(8) << overlap << std::endl;
+    }
+}
+
+void Benchmark::communities(Graph& g, std::ostream& out) {
+    CSRGraph csr = CSRGraph::fromGraph(g);
+    if (csr.size() == 0) return;
+    
+    out << "\n== Сообщества (Louvain) ==" << std::endl;
+    out << column("потоков", 10) << column("мс", 12) << column("сообществ", 12)
+        << column("уровней", 10) << column("модулярность", 14) << std::endl;
+    for (size_t threads : {1, 2, 4, 8}) {
+        CommunityResult result;
+        double ms = measureMs([&] { result = ParallelAlgorithms::louvain(csr, threads); });
+        out << std::setw(10) << threads << std::setw(12) << std::setprecision(2) << ms
+            << std::setw(12) << result.count << std::setw(10) << result.levels
+            << std::setw(14) << std::setprecision(4) << result.modularity << std::endl;
+    }
+}
+
+void Benchmark::triangles(Graph& g, std::ostream& out) {
+    CSRGraph simple = CSRGraph::fromGraph(g).simplified();
+    if (simple.size() == 0) return;
+    
+    out << "\n== Треугольники: " << simple.arcCount() / 2 << " рёбер ==" << std::endl;
+    out << column("пересечение", 14, true) << column("потоков", 10) << column("мс", 12)
+        << column("треугольников", 16) << std::endl;
+    for (bool simd : {false, true}) {
+        for (size_t threads : {1, 2, 4, 8}) {
+            uint64_t count = 0;
+            double ms = measureMs([&] { count = Statistics::countTriangles(simple, threads, nullptr, simd); });
+            out << column(simd ? "SIMD" : "скалярное", 14, true) << std::setw(10) << threads
+                << std::setw(12) << std::setprecision(2) << ms << std::setw(16) << count << std::endl;
+        }
+    }
+}
+
+void Benchmark::cores(Graph& g, std::ostream& out) {
+    auto simple = std::make_shared<const CSRGraph>(CSRGraph::fromGraph(g).simplified());
+    if (simple->size() == 0) return;
+    
+    std::vector<int> reference;
+    double referenceMs = measureMs([&] { reference = Statistics::coreNumbers(*simple); });
+    int degeneracy = *std::max_element(reference.begin(), reference.end());
+    
+    out << "\n== k-ядра: вырожденность " << degeneracy << " ==" << std::endl;
+    out << column("алгоритм", 16, true) << column("потоков", 10) << column("мс", 12)
+        << column("расхождений", 14) << std::endl;
+    out << column("корзины", 16, true) << std::setw(10) << 1
+        << std::setw(12) << std::setprecision(2) << referenceMs << std::setw(14) << 0 << std::endl;
+    for (size_t threads : {1, 2, 4, 8}) {
+        std::vector<int> core;
+        double ms = measureMs([&] { core = Statistics::coreNumbersParallel(*simple, threads); });
+        size_t mismatches = 0;
+        for (size_t v = 0; v < core.size(); ++v) {
+            mismatches += core[v] != reference[v];
+        }
+        out << column("параллельный", 16, true) << std::setw(10) << threads
+            << std::setw(12) << ms << std::setw(14) << mismatches << std::endl;
+    }
+    
+    // Представление k-ядра: маска строится за O(V), рёбра - только видимые
+    out << column("k", 6) << column("вершин", 10) << column("рёбер", 10)
+        << column("маска, мкс", 12) << column("рёбра, мкс", 12) << std::endl;
+    for (int k : {1, std::max(1, degeneracy / 2), degeneracy}) {
+        std::optional<SubgraphView> view;
+        double maskMs = measureMs([&] { view = SubgraphView::kCore(simple, reference, k); });
+        size_t edges = 0;
+        double edgesMs = measureMs([&] { edges = view->edges().size(); });
+        out << std::setw(6) << k << std::setw(10) << view->size() << std::setw(10) << edges
+            << std::setw(12) << std::setprecision(1) << maskMs * 1000.0
+            << std::setw(12) << edgesMs * 1000.0 << std::endl;
+    }
+}
+
+void Benchmark::directedStructure(Graph& g, std::ostream& out) {
+    CSRGraph csr = CSRGraph::fromGraph(g);
+    int n = csr.size();
+    if (n == 0) return;
+    
+    Condensation condensation;
+    double condenseMs = measureMs([&] { condensation = Dag::condense(csr); });
+    int largest = *std::max_element(condensation.sizes.begin(), condensation.sizes.end());
+    std::vector<int> cycle;
+    double cycleMs = measureMs([&] { cycle = Dag::findCycle(csr); });
+    bool cycleValid = true;
+    for (size_t i = 0; i < cycle.size(); ++i) {
+        auto neighbors = csr.neighbors(cycle[i]);
+        int next = cycle[(i + 1) % cycle.size()];
+        cycleValid = cycleValid && std::find(neighbors.begin(), neighbors.end(), next) != neighbors.end();
+    }
+    
+    out << "\n== Ориентированная структура: " << condensation.count() << " компонент сильной связности"
+        << " (наибольшая " << largest << "), сжатие " << std::setprecision(2) << condenseMs << " мс ==" << std::endl;
+    if (cycle.empty()) {
+        out << "Циклов нет (" << cycleMs << " мс)" << std::endl;
+    } else {
+        out << "Цикл-свидетель из " << cycle.size() << " вершин, " << cycleMs << " мс, "
+            << (cycleValid ? "дуги цикла есть в графе" : "ОШИБКА: дуги цикла нет в графе") << std::endl;
+    }
+    
+    out << column("топологическая сортировка", 28, true) << column("потоков", 10) << column("мс", 12)
+        << column("уровней", 10) << column("расхождений", 14) << std::endl;
+    TopologicalOrder baseline;
+    for (size_t threads : {1, 2, 4, 8}) {
+        TopologicalOrder order;
+        double ms = measureMs([&] { order = Dag::topologicalSort(csr, threads); });
+        if (threads == 1) baseline = order;
+        int levels = order.order.empty() ? 0 : order.level[order.order.back()] + 1;
+        out << column(order.acyclic ? "полная" : "частичная (есть циклы)", 28, true) << std::setw(10) << threads
+            << std::setw(12) << ms << std::setw(10) << levels
+            << std::setw(14) << (order.order == baseline.order ? 0 : 1) << std::endl;
+    }
+    
+    std::vector<std::pair<int, int>> reduction;
+    double reductionMs = measureMs([&] { reduction = Dag::transitiveReduction(csr, threadCount()); });
+    out << "Транзитивное сокращение: " << csr.arcCount() << " -> " << reduction.size() << " дуг, "
+        << reductionMs << " мс на " << threadCount() << " потоках" << std::endl;
+    
+    // Проверка: у сокращения то же замыкание
+    std::optional<TransitiveClosure> closure;
+    double closureMs = measureMs([&] { closure = TransitiveClosure::build(csr); });
+    if (!closure) {
+        out << "Замыкание пропущено: больше " << TransitiveClosure::kDefaultLimit << " компонент" << std::endl;
+    } else {
+        CSRGraph reduced;
+        reduced.directed = true;
+        reduced.ids = csr.ids;
+        std::vector<std::vector<int>> lists(n);
+        for (const auto& [u, v] : reduction) lists[u].push_back(v);
+        reduced.offsets.push_back(0);
+        for (const auto& list : lists) {
+            reduced.targets.insert(reduced.targets.end(), list.begin(), list.end());
+            reduced.offsets.push_back(reduced.targets.size());
+        }
+        auto reducedClosure = TransitiveClosure::build(reduced);
+        // Число достижимых пар не зависит от нумерации компонент
+        size_t mismatches = closure->reachablePairs() != reducedClosure->reachablePairs() ? 1 : 0;
+        std::mt19937 gen(42);
+        std::uniform_int_distribution<int> pick(0, n - 1);
+        for (int i = 0; i < 100000; ++i) {
+            int u = pick(gen), v = pick(gen);
+            if (closure->reaches(u, v) != reducedClosure->reaches(u, v)) ++mismatches;
+        }
+        out << "Замыкание: " << closure->reachablePairs() << " достижимых пар компонент, "
+            << closure->memoryBytes() / 1024.0 << " КБ, " << closureMs << " мс; расхождений с сокращением "
+            << mismatches << " на 100000 пар" << std::endl;
+    }
+    
+    // Иерархический макет по шагам Сугиямы
+    std::vector<int> layer;
+    LayeredGraph layered;
+    double layersMs = measureMs([&] { layer = Sugiyama::assignLayers(csr); });
+    double buildMs = measureMs([&] { layered = Sugiyama::build(csr, layer); });
+    size_t initial = Sugiyama::countCrossings(layered, 1);
+    out << "Иерархический макет: " << layered.layers() << " слоёв, " << layered.size() - layered.vertices
+        << " фиктивных вершин; слои " << layersMs << " мс, фиктивные вершины " << buildMs << " мс, "
+        << "пересечений в начальном порядке " << initial << std::endl;
+    out << column("порядок в слоях", 28, true) << column("потоков", 10) << column("мс", 12)
+        << column("пересечений", 14) << std::endl;
+    LayeredGraph ordered;
+    for (size_t threads : {1, 2, 4, 8}) {
+        ordered = layered;
+        size_t crossings = 0;
+        double ms = measureMs([&] { crossings = Sugiyama::orderLayers(ordered, threads); });
+        out << column("барицентры", 28, true) << std::setw(10) << threads << std::setw(12) << ms
+            << std::setw(14) << crossings << std::endl;
+    }
+    double coordinatesMs = measureMs([&] { Sugiyama::assignCoordinates(ordered); });
+    Layout layout;
+    double layoutMs = measureMs([&] { layout.layered(g, 1200.0, 800.0); });
+    out << "Координаты Брандеса-Кёпфа: " << coordinatesMs << " мс; макет целиком: " << layoutMs << " мс" << std::endl;
+}
+
+void Benchmark::layoutQuality(Graph& g, std::ostream& out) {
+    CSRGraph csr = CSRGraph::fromGraph(g);
+    int n = csr.size();
+    if (n < 3) return;
+    
+    // Стресс всех макетов - по одной модели (расстояния от 50 опорных)
+    StressModel model;
+    double modelMs = measureMs([&] { model = StressModel::build(csr, StressModel::kDefaultPivots, threadCount()); });
+    out << "\n== Макеты: стресс по расстояниям от " << model.pivots().size() << " опорных вершин, BFS от опорных "
+        << std::setprecision(2) << modelMs << " мс на " << threadCount() << " потоках ==" << std::endl;
+    out << column("макет", 28, true) << column("шагов", 8) << column("мс", 12) << column("стресс", 10) << std::endl;
+    auto row = [&](const std::string& name, int steps, double ms, double stress) {
+        out << column(name, 28, true) << std::setw(8) << steps << std::setw(12) << std::setprecision(2) << ms
+            << std::setw(10) << std::setprecision(4) << stress << std::endl;
+    };
+    
+    // Force-directed: O(n^2) на итерацию, поэтому только на небольших графах
+    constexpr int kForceDirectedLimit = 5000;
+    double target = -1.0, forceMs = 0.0;
+    if (n <= kForceDirectedLimit) {
+        Layout layout;
+        for (int iterations : {10, 50, 100}) {
+            double ms = measureMs([&] { layout.forceDirected(g, 1200.0, 800.0, iterations); });
+            Coordinates c;
+            for (int id : csr.ids) {
+                const Vertex* vertex = g.getVertex(id);
+                c.x.push_back(vertex->x);
+                c.y.push_back(vertex->y);
+            }
+            double stress = model.stress(c);
+            row("force-directed", iterations, ms, stress);
+            target = stress;
+            forceMs = ms;
+        }
+    } else {
+        out << "force-directed пропущен: больше " << kForceDirectedLimit << " вершин" << std::endl;
+    }
+    
+    // Majorization по шагу: время без расчёта стресса между шагами
+    Coordinates c;
+    double totalMs = measureMs([&] { c = model.pivotMDS(); });
+    row("pivot MDS", 0, totalMs, model.stress(c));
+    int reachedAt = -1;
+    double reachedMs = 0.0;
+    for (int step = 1; step <= StressModel::kDefaultIterations; ++step) {
+        totalMs += measureMs([&] { model.majorize(c, 1); });
+        double stress = model.stress(c);
+        if (reachedAt < 0 && stress <= target) {
+            reachedAt = step;
+            reachedMs = totalMs;
+        }
+        if (step == 1 || step == 5 || step == 10 || step == 25 || step == 50 || step == 100) {
+            row("MDS + majorization", step, totalMs, stress);
+        }
+    }
+    if (target >= 0.0) {
+        out << "Стресс force-directed за 100 итераций (" << std::setprecision(4) << target << "): ";
+        if (reachedAt > 0) {
+            out << "majorization за " << std::setprecision(2) << reachedMs << " мс (" << reachedAt << " шагов)";
+        } else {
+            out << "majorization не достиг за " << StressModel::kDefaultIterations << " шагов";
+        }
+        out << " против " << forceMs << " мс" << std::endl;
+    }
+    
+    for (int steps : {20, 40, 60, 100}) {
+        Coordinates spectral;
+        double ms = measureMs([&] { spectral = SpectralEmbedding::compute(csr, steps, threadCount()); });
+        row("спектральный (Ланцош)", steps, ms, model.stress(spectral));
+    }
+    
+    out << column("полный макет по стрессу", 28, true) << column("потоков", 8) << column("мс", 12)
+        << column("шагов", 10) << std::endl;
+    for (size_t threads : {1, 2, 4, 8}) {
+        int steps = 0;
+        double ms = measureMs([&] {
+            StressModel local = StressModel::build(csr, StressModel::kDefaultPivots, threads);
+            Coordinates start = local.pivotMDS();
+            steps = local.majorize(start);
+        });
+        out << column("", 28, true) << std::setw(8) << threads << std::setw(12) << std::setprecision(2) << ms
+            << std::setw(10) << steps << std::endl;
+    }
+    
+    // Макет по компонентам: одинаковые координаты при любом числе потоков
+    // и у нового объекта Layout с тем же зерном
+    auto positions = [&] {
+        std::vector<std::pair<double, double>> result;
+        for (int id : csr.ids) {
+            const Vertex* vertex = g.getVertex(id);
+            result.emplace_back(vertex->x, vertex->y);
+        }
+        return result;
+    };
+    out << "Компонент связности: " << g.getConnectedComponents().size() << std::endl;
+    out << column("макет по компонентам", 28, true) << column("потоков", 8) << column("мс", 12)
+        << column("расхождений", 14) << std::endl;
+    std::vector<std::pair<std::string, LayoutType>> types = {
+        {"случайный", LayoutType::Random}, {"по стрессу", LayoutType::Stress},
+        {"иерархический", LayoutType::Layered}, {"спектральный", LayoutType::Spectral}};
+    if (n <= kForceDirectedLimit) types.emplace_back("force-directed", LayoutType::ForceDirected);
+    for (const auto& [name, type] : types) {
+        std::vector<std::pair<double, double>> baseline;
+        for (size_t threads : {1, 2, 4, 8}) {
+            Layout layout;
+            layout.setThreadCount(threads);
+            double ms = measureMs([&] { layout.applyLayout(g, type, 1200.0, 800.0); });
+            auto current = positions();
+            if (threads == 1) baseline = current;
+            size_t mismatches = 0;
+            for (size_t i = 0; i < current.size(); ++i) {
+                if (current[i] != baseline[i]) ++mismatches;
+            }
+            out << column(name, 28, true) << std::setw(8) << threads << std::setw(12) << std::setprecision(2) << ms
+                << std::setw(14) << mismatches << std::endl;
+        }
+    }
+
+    // Кеш макетов: первый запуск считает и пишет файл, второй только читает его.
+    // Хеш содержимого не должен зависеть от нумерации вершин
+    std::vector<int> reversed(n);
+    std::iota(reversed.rbegin(), reversed.rend(), 0);
+    bool stableHash = Reordering::permute(csr, reversed).contentHash() == csr.contentHash();
+    auto cache = std::make_shared<LayoutCache>(
+        (std::filesystem::temp_directory_path() / "graph-visualizer-bench").string());
+    Layout cached;
+    cached.setCache(cache);
+    uint64_t key = 0;
+    double keyMs = measureMs([&] { key = cached.resultKey(csr, LayoutType::Stress, 1200.0, 800.0, 0); });
+    std::error_code error;
+    std::filesystem::remove(cache->path(key), error);
+    double computeMs = measureMs([&] { cached.applyLayout(g, LayoutType::Stress, 1200.0, 800.0); });
+    auto computed = positions();
+    for (int id : csr.ids) g.setVertexPosition(id, 0.0, 0.0);
+    double hitMs = measureMs([&] { cached.applyLayout(g, LayoutType::Stress, 1200.0, 800.0); });
+    auto loaded = positions();
+    double readMs = measureMs([&] { cache->load(key, csr, g); });
+    double deviation = 0.0;
+    for (size_t i = 0; i < loaded.size(); ++i) {
+        deviation = std::max({deviation, std::abs(loaded[i].first - computed[i].first),
+                              std::abs(loaded[i].second - computed[i].second)});
+    }
+    auto bytes = std::filesystem::file_size(cache->path(key), error);
+    out << "Кеш макетов (по стрессу): ключ " << std::setprecision(3) << keyMs << " мс, расчёт с записью "
+        << computeMs << " мс, из кеша " << hitMs << " мс (чтение файла " << readMs << " мс), файл "
+        << (error ? 0 : bytes) / 1024 << " КБ, отклонение " << deviation << " пикс., хеш не зависит от нумерации: "
+        << (stableHash ? "да" : "нет") << std::endl;
+    std::filesystem::remove(cache->path(key), error);
+}
+
+void Benchmark::neighborhoods(Graph& g, size_t queries, std::ostream& out) {
+    auto pairs = randomPairs(g, queries);
+    if (pairs.empty()) return;
+    
+    auto csr = std::make_shared<const CSRGraph>(CSRGraph::fromGraph(g));
+    CSRGraph reverse = csr->transposed();
+    
+    out << "\n== Окрестности: " << pairs.size() << " центров ==" << std::endl;
+    out << column("радиус", 8) << column("вершин", 12) << column("рёбер", 12)
+        << column("BFS, мкс", 12) << column("рёбра, мкс", 12) << std::endl;
+    for (int hops : {1, 2, 3}) {
+        double bfsMs = 0.0, edgesMs = 0.0;
+        size_t vertices = 0, edges = 0;
+        for (const auto& pair : pairs) {
+            std::optional<SubgraphView> view;
+            bfsMs += measureMs([&] { view = SubgraphView::neighborhood(csr, pair.first, hops, 0, &reverse); });
+            edgesMs += measureMs([&] { edges += view->edges().size(); });
+            vertices += view->size();
+        }
+        double count = static_cast<double>(pairs.size());
+        out << std::setw(8) << hops << std::setw(12) << std::setprecision(1) << vertices / count
+            << std::setw(12) << edges / count
+            << std::setw(12) << bfsMs * 1000.0 / count << std::setw(12) << edgesMs * 1000.0 / count << std::endl;
+    }
+}
+
+void Benchmark::distanceOracle(Graph& g, size_t queries, std::ostream& out) {
+    auto pairs = randomPairs(g, queries);
+    if (pairs.empty()) return;
+    
+    CSRGraph csr = CSRGraph::fromGraph(g);
+    std::vector<std::pair<int, int>> dense;
+    std::vector<double> exact;
+    for (const auto& [s, t] : pairs) {
+        int u = csr.indexOf(s);
+        int v = csr.indexOf(t);
+        double d = Algorithms::shortestDistances(csr, u)[v];
+        // Для точности учитываются только связные пары
+        if (std::isfinite(d)) {
+            dense.emplace_back(u, v);
+            exact.push_back(d);
+        }
+    }
+    if (dense.empty()) return;
+    
+    ThreadPool pool(threadCount());
+    
+    out << "\n== Оракул расстояний: " << dense.size() << " связных пар, "
+        << threadCount() << " потоков ==" << std::endl;
+    out << column("ориентиры", 18, true) << column("k", 4) << column("сборка мс", 12)
+        << column("память КБ", 12) << column("нс/оценка", 12) << column("покрыто %", 10)
+        << column("верх/точн", 12)
+        << column("точно %", 10) << column("низ/точн", 10) << column("путь/точн", 12) << std::endl;
+    
+    const std::pair<const char*, LandmarkStrategy> strategies[] = {
+        {"по степени", LandmarkStrategy::Degree},
+        {"дальняя точка", LandmarkStrategy::FarthestPoint},
+    };
+    for (const auto& [name, strategy] : strategies) {
+        for (size_t k : {4, 8, 16}) {
+            std::optional<DistanceOracle> oracle;
+            double buildMs = measureMs([&] { oracle = DistanceOracle::build(csr, k, strategy, pool); });
+            
+            // Задержка оценок: обе границы на каждую пару
+            double checksum = 0.0;
+            double boundsMs = measureMs([&] {
+                for (const auto& [u, v] : dense) {
+                    checksum += oracle->lowerBound(u, v) + oracle->upperBound(u, v);
+                }
+            });
+            
+            // Растяжение считается по парам, для которых оракул дал конечную оценку
+            double upperStretch = 0.0, lowerRatio = 0.0, pathStretch = 0.0;
+            size_t covered = 0, exactHits = 0;
+            for (size_t i = 0; i < dense.size(); ++i) {
+                auto [u, v] = dense[i];
+                double upper = oracle->upperBound(u, v);
+                double lower = oracle->lowerBound(u, v);
+                if (upper <= exact[i] * (1.0 + 1e-6)) ++exactHits;
+                if (!std::isfinite(upper)) continue;
+                
+                std::vector<int> path;
+                for (int x : oracle->approximatePath(u, v)) {
+                    path.push_back(csr.ids[x]);
+                }
+                double pathLength = Algorithms::pathCost(g, path);
+                double scale = exact[i] > 0.0 ? exact[i] : 1.0;
+                upperStretch += exact[i] > 0.0 ? upper / scale : 1.0;
+                lowerRatio += exact[i] > 0.0 ? lower / scale : 1.0;
+                pathStretch += exact[i] > 0.0 ? pathLength / scale : 1.0;
+                ++covered;
+            }
+            double count = static_cast<double>(dense.size());
+            double coveredCount = static_cast<double>(std::max<size_t>(covered, 1));
+            
+            out << column(name, 18, true) << std::setw(4) << oracle->landmarks().size()
+                << std::setw(12) << std::setprecision(2) << buildMs
+                << std::setw(12) << std::setprecision(1) << oracle->memoryBytes() / 1024.0
+                << std::setw(12) << std::setprecision(1) << boundsMs * 1e6 / count
+                << std::setw(10) << std::setprecision(1) << 100.0 * covered / count
+                << std::setw(12) << std::setprecision(3) << upperStretch / coveredCount
+                << std::setw(10) << std::setprecision(1) << 100.0 * exactHits / count
+                << std::setw(10) << std::setprecision(3) << lowerRatio / coveredCount
+                << std::setw(12) << std::setprecision(3) << pathStretch / coveredCount << std::endl;
+            sink = checksum;
+        }
+    }
+}
+
+void Benchmark::relationQueries(Graph& g, size_t queries, std::ostream& out) {
+    std::optional<QueryEngine> engine;
+    double buildMs = measureMs([&] { engine = QueryEngine::build(g); });
+    
+    // Граф без типов (CSV) получает синтетические типы, чтобы было что запрашивать
+    std::unique_ptr<Graph> typed;
+    Graph* source = &g;
+    if (engine->relationCounts().empty()) {
+        typed = std::make_unique<Graph>(g.isDirected());
+        const Graph& view = g;
+        for (int id : g.getVertices()) {
+            typed->addVertex(id, view.getVertex(id)->label);
+            typed->setVertexType(id, "type" + std::to_string(id % 4));
+        }
+        g.forEachAdjacency([&](int from, const EdgeList& edges) {
+            for (const auto& edge : edges) {
+                if (!g.isDirected() && edge.to < from) continue;
+                typed->addEdge(from, edge.to, edge.weight, "rel" + std::to_string((from * 31 + edge.to) % 8));
+            }
+        });
+        source = typed.get();
+        buildMs = measureMs([&] { engine = QueryEngine::build(*source); });
+        out << "\nВ графе нет типов связей: назначены синтетические rel0..rel7 и типы вершин type0..type3" << std::endl;
+    }
+    
+    // Имена с пробелами в шаблоне берутся в кавычки
+    auto quoted = [](const std::string& name) {
+        return name.find(' ') == std::string::npos ? name : "\"" + name + "\"";
+    };
+    auto relations = engine->relationCounts();
+    auto types = engine->typeCounts();
+    std::string r1 = quoted(relations[0].first);
+    std::string r2 = relations.size() > 1 ? quoted(relations[1].first) : r1;
+    std::string t1 = types.empty() ? "?" : quoted(types[0].first);
+    
+    std::vector<Edge> arcs;
+    source->forEachAdjacency([&arcs](int, const EdgeList& edges) {
+        arcs.insert(arcs.end(), edges.begin(), edges.end());
+    });
+    
+    out << "\n== Запросы по типам связей: " << relations.size() << " типов, " << engine->arcCount()
+        << " дуг, индекс " << std::fixed << std::setprecision(2) << buildMs << " мс ==" << std::endl;
+    out << column("шаблон", 44, true) << column("ответов", 10) << column("путей", 8)
+        << column("индекс мс", 12) << column("перебор мс", 12) << column("совпадает", 10) << std::endl;
+    
+    auto report = [&](const std::string& text, const std::vector<std::string>& instances) {
+        size_t answers = 0, paths = 0, matches = 0;
+        double indexMs = 0.0, scanMs = 0.0;
+        for (const auto& instance : instances) {
+            auto pattern = QueryEngine::parse(instance);
+            if (!pattern) return;
+            QueryResult result;
+            indexMs += measureMs([&] { result = engine->evaluate(*pattern, kQueryPathLimit); });
+            size_t expected = 0;
+            scanMs += measureMs([&] { expected = scanAnswers(*source, arcs, *pattern); });
+            answers += result.bindings.back().size();
+            paths += result.paths.size();
+            if (expected == result.bindings.back().size()) ++matches;
+        }
+        double count = static_cast<double>(instances.size());
+        out << column(text, 44, true) << std::setw(10) << std::setprecision(1) << answers / count
+            << std::setw(8) << paths / count << std::setw(12) << std::setprecision(3) << indexMs / count
+            << std::setw(12) << scanMs / count << column(matches == instances.size() ? "да" : "нет", 10) << std::endl;
+    };
+    
+    report("? -" + r1 + "-> ?", {"? -" + r1 + "-> ?"});
+    report(t1 + " -" + r1 + "-> ?", {t1 + " -" + r1 + "-> ?"});
+    report("? -" + r1 + "-> ? -" + r2 + "-> ?", {"? -" + r1 + "-> ? -" + r2 + "-> ?"});
+    report(t1 + " -" + r1 + "-> ? <-" + r2 + "- " + t1, {t1 + " -" + r1 + "-> ? <-" + r2 + "- " + t1});
+    
+    // Два шага от случайных вершин по любым связям
+    std::vector<std::string> instances;
+    for (const auto& pair : randomPairs(*source, std::min<size_t>(queries, 20))) {
+        instances.push_back(std::string("#").append(std::to_string(pair.first)).append(" -?-> ? -?-> ?"));
+    }
+    if (!instances.empty()) report("#ID -?-> ? -?-> ?", instances);
+}
+
+void Benchmark::nameSearch(Graph& g, size_t queries, std::ostream& out) {
+    std::optional<SearchIndex> index;
+    double buildMs = measureMs([&] { index = SearchIndex::build(g); });
+    auto pairs = randomPairs(g, queries);
+    if (pairs.empty()) return;
+    
+    // Имена выбранных вершин так, как их видит индекс
+    std::vector<std::pair<int, std::string>> names;
+    for (const auto& pair : pairs) {
+        const Vertex* vertex = g.getVertex(pair.first);
+        names.emplace_back(pair.first, SearchIndex::normalize(vertex->label.empty() ? std::to_string(pair.first) : vertex->label));
+    }
+    
+    out << "\n== Поиск по именам: " << index->size() << " вершин, индекс " << std::fixed << std::setprecision(2)
+        << buildMs << " мс, " << index->memoryBytes() / 1024.0 << " КБ ==" << std::endl;
+    out << column("запрос", 28, true) << column("мкс", 10) << column("найдено", 10)
+        << column("нужная в топ-20 %", 20) << std::endl;
+    
+    // Запрос строится из имени вершины; нужная вершина должна оказаться среди результатов
+    auto report = [&](const std::string& title, const std::function<std::string(const std::string&)>& makeQuery,
+                      bool fuzzyOnly) {
+        double ms = 0.0;
+        size_t found = 0, recalled = 0;
+        for (const auto& [id, name] : names) {
+            std::string query = makeQuery(name);
+            std::vector<int> ids;
+            ms += measureMs([&] {
+                if (fuzzyOnly) {
+                    for (const auto& hit : index->fuzzy(query)) ids.push_back(hit.id);
+                } else {
+                    ids = index->prefix(query);
+                }
+            });
+            found += ids.size();
+            if (std::find(ids.begin(), ids.end(), id) != ids.end()) ++recalled;
+        }
+        double count = static_cast<double>(names.size());
+        out << column(title, 28, true) << std::setw(10) << std::setprecision(1) << ms * 1000.0 / count
+            << std::setw(10) << found / count << std::setw(20) << 100.0 * recalled / count << std::endl;
+    };
+    
+    report("префикс 5 символов", [](const std::string& name) { return name.substr(0, 5); }, false);
+    report("полное имя", [](const std::string& name) { return name; }, false);
+    report("опечатка (перестановка)", [](const std::string& name) {
+        std::string typo = name;
+        if (typo.size() > 3) std::swap(typo[typo.size() / 2], typo[typo.size() / 2 + 1]);
+        return typo;
+    }, true);
+    report("опечатка (пропуск)", [](const std::string& name) {
+        std::string typo = name;
+        if (typo.size() > 3) typo.erase(typo.size() / 2, 1);
+        return typo;
+    }, true);
+}
+
+void Benchmark::memoryFootprint(Graph& g, std::ostream& out) {
+    // Исходные данные - копия вершин и дуг, чтобы обе сборки шли из одного
+    // источника и не трогали граф
+    std::vector<std::pair<int, std::string>> vertices;
+    const Graph& view = g;
+    for (int id : g.getVertices()) vertices.emplace_back(id, view.getVertex(id)->label);
+    std::vector<Edge> arcs;
+    g.forEachAdjacency([&](int from, const EdgeList& edges) {
+        for (const auto& edge : edges) {
+            if (g.isDirected() || from <= edge.to) arcs.push_back(edge);
+        }
+    });
+    
+    struct Row {
+        const char* name;
+        MemoryUsage used;
+        double buildMs;
+        double freeMs;
+    };
+    auto measure = [](const char* name, auto&& build) {
+        MemoryUsage::trim();
+        MemoryUsage before = MemoryUsage::current();
+        Row row{name, {}, 0.0, 0.0};
+        decltype(build()) built;
+        row.buildMs = measureMs([&] { built = build(); });
+        MemoryUsage after = MemoryUsage::current();
+        row.used.allocations = after.allocations - before.allocations;
+        row.used.bytes = after.bytes - before.bytes;
+        row.used.residentBytes = after.residentBytes > before.residentBytes ? after.residentBytes - before.residentBytes : 0;
+        row.freeMs = measureMs([&] { built.reset(); });
+        return row;
+    };
+    
+    // Прежнее хранение: отдельные хеш-таблицы вершин, списков смежности и
+    // обратного индекса, у каждой вершины свои векторы. Дуга добавляется,
+    // как в Graph, после проверки на повтор
+    struct Plain {
+        std::unordered_map<int, Vertex> vertices;
+        std::unordered_map<int, std::vector<Edge>> adjacency;
+        std::unordered_map<int, std::vector<int>> incoming;
+        
+        void addArc(int from, int to, double weight, bool directed, const std::string& label) {
+            auto& edges = adjacency[from];
+            if (std::any_of(edges.begin(), edges.end(), [to](const Edge& e) { return e.to == to; })) return;
+            edges.emplace_back(from, to, weight, directed, label);
+            if (directed) incoming[to].push_back(from);
+        }
+    };
+    bool directed = g.isDirected();
+    Row plain = measure("хеш-таблицы и векторы", [&] {
+        auto storage = std::make_unique<Plain>();
+        for (const auto& [id, label] : vertices) {
+            storage->vertices.emplace(id, Vertex(id, 0.0, 0.0, label));
+            storage->adjacency[id];
+        }
+        for (const auto& edge : arcs) {
+            storage->addArc(edge.from, edge.to, edge.weight, directed, edge.label);
+            if (!directed) storage->addArc(edge.to, edge.from, edge.weight, directed, edge.label);
+        }
+        return storage;
+    });
+    Row arena = measure("части с аренами", [&] {
+        auto storage = std::make_unique<Graph>(directed);
+        for (const auto& [id, label] : vertices) storage->addVertex(id, label);
+        for (const auto& edge : arcs) storage->addEdge(edge.from, edge.to, edge.weight, edge.label);
+        return storage;
+    });
+    
+    out << "\n== Память графа: " << vertices.size() << " вершин, " << arcs.size() << " рёбер ==" << std::endl;
+    out << column("хранение", 24, true) << column("выделений", 12) << column("МБ запрошено", 14)
+        << column("RSS МБ", 10) << column("сборка мс", 12) << column("освобождение мс", 17) << std::endl;
+    if (!MemoryUsage::countsAllocations()) {
+        out << "(выделения не считаются: сборка без -DGRAPH_COUNT_ALLOCATIONS=ON)" << std::endl;
+    }
+    for (const Row& row : {plain, arena}) {
+        out << column(row.name, 24, true) << std::setw(12) << row.used.allocations
+            << std::setw(14) << std::fixed << std::setprecision(1) << row.used.bytes / 1048576.0
+            << std::setw(10) << row.used.residentBytes / 1048576.0
+            << std::setw(12) << std::setprecision(2) << row.buildMs << std::setw(17) << row.freeMs << std::endl;
+    }
+}
+
+void Benchmark::exportThroughput(Graph& g, std::ostream& out) {
+    if (g.getVertexCount() == 0) return;
+    // Случайный макет: координаты - обычные дробные числа, как после раскладки
+    Layout().applyLayout(g, LayoutType::Random, 1200.0, 800.0);
+    std::filesystem::path directory = std::filesystem::temp_directory_path();
+    std::string path = (directory / "graph-visualizer-bench.export").string();
+    std::error_code error;
+    auto megabytes = [&] { return static_cast<double>(std::filesystem::file_size(path, error)) / 1048576.0; };
+    
+    out << "\n== Запись графа ==" << std::endl;
+    size_t edges = 0;
+    double edgesMs = measureMs([&] { edges = g.getEdges().size(); });
+    out << "getEdges: " << edges << " рёбер за " << std::fixed << std::setprecision(2) << edgesMs << " мс" << std::endl;
+    
+    // Прежняя запись: копия рёбер и ofstream << по одному ребру, без меток и координат
+    double streamMs = measureMs([&] {
+        std::ofstream file(path);
+        for (const auto& edge : g.getEdges()) file << edge.from << "," << edge.to << "," << edge.weight << "\n";
+    });
+    double streamMb = megabytes();
+    
+    out << column("формат", 10, true) << column("потоков", 8) << column("мс", 10) << column("МБ", 9)
+        << column("МБ/с", 9) << column("совпадает", 11) << std::endl;
+    out << column("CSV", 10, true) << column("ofstream", 8) << std::setw(10) << streamMs << std::setw(9)
+        << streamMb << std::setw(9) << std::setprecision(0) << streamMb / (streamMs / 1000.0)
+        << column("-", 11) << std::endl;
+    std::vector<std::pair<std::string, ExportFormat>> formats = {
+        {"CSV", ExportFormat::CSV}, {"JSON", ExportFormat::JSON},
+        {"GraphML", ExportFormat::GraphML}, {"DOT", ExportFormat::DOT}};
+    for (const auto& [name, format] : formats) {
+        // Текст не зависит от числа потоков: блоки пишутся по порядку
+        std::string baseline = GraphExporter::toString(g, format, 1);
+        for (size_t threads : {1, 2, 4, 8}) {
+            double ms = measureMs([&] { GraphExporter::save(g, path, format, threads); });
+            double mb = megabytes();
+            bool same = GraphExporter::toString(g, format, threads) == baseline;
+            out << column(name, 10, true) << std::setw(8) << threads << std::setw(10) << std::setprecision(2) << ms
+                << std::setw(9) << mb << std::setw(9) << std::setprecision(0) << mb / (ms / 1000.0)
+                << column(same ? "да" : "нет", 11) << std::endl;
+        }
+    }
+    
+    // Записанный CSV читается загрузчиком обратно: те же рёбра с весами и
+    // метками, вершины с метками, типами и координатами (с точностью записи;
+    // переводы строк в метках и запятые в типах экспорт заменяет пробелами)
+    GraphExporter::save(g, path, ExportFormat::CSV);
+    auto reloaded = GraphLoader::loadFromCSV(path, g.isDirected());
+    auto escaped = [](std::string text, bool field) {
+        for (char& c : text) {
+            if (c == '\n' || c == '\r' || (field && c == ',')) c = ' ';
+        }
+        return text;
+    };
+    const Graph& source = g;
+    size_t vertexMismatches = 0;
+    size_t edgeMismatches = 0;
+    if (reloaded) {
+        const Graph& copy = *reloaded;
+        for (int id : source.getVertices()) {
+            const Vertex* before = source.getVertex(id);
+            const Vertex* after = copy.getVertex(id);
+            if (!after || after->label != escaped(before->label, false) || after->type != escaped(before->type, true)
+                || std::abs(after->x - before->x) > 1e-3 || std::abs(after->y - before->y) > 1e-3) {
+                ++vertexMismatches;
+            }
+        }
+        for (const Edge& edge : source.getEdges()) {
+            Edge loaded = copy.getEdge(edge.from, edge.to);
+            if (!copy.hasEdge(edge.from, edge.to) || loaded.weight != edge.weight
+                || loaded.label != escaped(edge.label, false)) {
+                ++edgeMismatches;
+            }
+        }
+    }
+    out << "Повторная загрузка CSV: " << (reloaded ? reloaded->getEdgeCount() : 0) << " рёбер из "
+        << g.getEdgeCount() << ", " << (reloaded ? reloaded->getVertexCount() : 0) << " вершин из "
+        << g.getVertexCount() << "; расхождений в вершинах: " << vertexMismatches
+        << ", в рёбрах: " << edgeMismatches << std::endl;
+    std::filesystem::remove(path, error);
+}
+
+void Benchmark::versionedSnapshots(Graph& g, size_t queries, std::ostream& out) {
+    auto vertices = g.getVertices();
+    if (vertices.size() < 2) return;
+    std::sort(vertices.begin(), vertices.end());
+    std::mt19937 gen(7);
+    std::uniform_int_distribution<size_t> pick(0, vertices.size() - 1);
+    auto randomDelta = [&](size_t size) {
+        GraphDelta delta;
+        for (size_t i = 0; i < size; ++i) {
+            delta.addedEdges.emplace_back(vertices[pick(gen)], vertices[pick(gen)], 1.0, g.isDirected());
+        }
+        return delta;
+    };
+    
+    std::shared_ptr<const Graph> pinned;
+    double firstMs = measureMs([&] { pinned = g.snapshot(); });
+    double repeatMs = measureMs([&] {
+        for (size_t i = 0; i < queries; ++i) pinned = g.snapshot();
+    });
+    
+    out << "\n== Версии графа: снимок " << std::fixed << std::setprecision(1) << firstMs * 1000.0
+        << " мкс, повторный " << std::setprecision(3) << repeatMs * 1e6 / std::max<size_t>(queries, 1)
+        << " нс ==" << std::endl;
+    
+    // Первая запись в часть графа, которую держит снимок, копирует эту часть
+    out << column("пакет", 8) << column("без снимка мс", 15) << column("со снимком мс", 15) << std::endl;
+    for (size_t batch : {1, 100, 10000}) {
+        pinned.reset();
+        auto delta = randomDelta(batch);
+        double freeMs = measureMs([&] { g.applyDelta(delta); });
+        pinned = g.snapshot();
+        delta = randomDelta(batch);
+        double pinnedMs = measureMs([&] { g.applyDelta(delta); });
+        out << std::setw(8) << batch << std::setw(15) << std::setprecision(3) << freeMs
+            << std::setw(15) << pinnedMs << std::endl;
+    }
+    pinned.reset();
+    
+    // Читатель закрепляет версию и дважды считает её размер, пока писатель
+    // применяет пакеты: версия не должна меняться под ним
+    std::atomic<bool> done{false};
+    std::atomic<size_t> reads{0};
+    size_t unstable = 0;
+    std::thread reader([&] {
+        while (!done.load()) {
+            auto version = g.snapshot();
+            int vertexCount = version->getVertexCount();
+            int edgeCount = version->getEdgeCount();
+            if (version->getVertexCount() != vertexCount || version->getEdgeCount() != edgeCount) ++unstable;
+            ++reads;
+        }
+    });
+    size_t writes = std::max<size_t>(queries, 10);
+    double writeMs = measureMs([&] {
+        for (size_t i = 0; i < writes; ++i) {
+            g.applyDelta(randomDelta(10));
+            std::this_thread::yield();  // на одном ядре читатель иначе почти не получает времени
+        }
+    });
+    done.store(true);
+    reader.join();
+    out << "Чтение во время изменений: " << reads.load() << " снимков, " << writes << " пакетов по 10 рёбер за "
+        << std::setprecision(2) << writeMs << " мс, изменившихся снимков: " << unstable << std::endl;
+    
+    // Полная копия - последней: после освобождения большой копии первые
+    // выделения памяти заметно медленнее и исказили бы замеры выше
+    double copyMs = measureMs([&] { sink = static_cast<double>(CSRGraph::fromGraph(g).size()); });
+    out << "Полная копия (CSR) для сравнения: " << copyMs << " мс" << std::endl;
+}
+
+void Benchmark::operationJournal(Graph& g, size_t queries, std::ostream& out) {
+    auto vertices = g.getVertices();
+    if (vertices.size() < 2) return;
+    std::sort(vertices.begin(), vertices.end());
+    std::mt19937 gen(11);
+    std::uniform_int_distribution<size_t> pick(0, vertices.size() - 1);
+    
+    // Состояние графа с координатами в точности журнала
+    auto stateHash = [&g]() {
+        uint64_t hash = 0;
+        auto mix = [](uint64_t value) {
+            value ^= value >> 33;
+            value *= 0xff51afd7ed558ccdull;
+            value ^= value >> 33;
+            return value;
+        };
+        for (int id : g.getVertices()) {
+            const Vertex* vertex = g.getVertex(id);
+            hash += mix(static_cast<uint32_t>(id) ^ (static_cast<uint64_t>(std::llround(vertex->x * Journal::kPositionScale)) << 20)
+                        ^ (static_cast<uint64_t>(std::llround(vertex->y * Journal::kPositionScale)) << 40));
+        }
+        g.forEachAdjacency([&](int from, const EdgeList& edges) {
+            for (const auto& edge : edges) hash += mix((static_cast<uint64_t>(static_cast<uint32_t>(from)) << 32) | static_cast<uint32_t>(edge.to));
+        });
+        return hash;
+    };
+    
+    Layout layout;
+    bool fullLayout = g.getVertexCount() <= kFullLayoutLimit;
+    double forceMs = -1.0;
+    if (fullLayout) {
+        forceMs = measureMs([&] { layout.forceDirected(g, 1200.0, 800.0); });
+    } else {
+        layout.random(g, 1200.0, 800.0);
+    }
+    auto base = g.snapshot();
+    uint64_t baseHash = stateHash();
+    uint64_t fingerprint = CSRGraph::fromGraph(g).fingerprint();
+    Journal journal(g, fingerprint);
+    int listener = g.addChangeListener([&](const std::vector<GraphChange>& changes) { journal.record(g, changes); });
+    
+    out << "\n== Журнал операций: " << vertices.size() << " вершин ==" << std::endl;
+    out << column("операция", 22, true) << column("записей", 9) << column("байт/запись", 13)
+        << column("без сжатия", 12) << column("запись мс", 11) << column("отмена мс", 11)
+        << column("повтор мс", 11) << std::endl;
+    
+    // Несжатая запись: ID и две пары double на вершину, изменение - ID концов,
+    // вес и метка
+    auto row = [&](const std::string& name, size_t records, size_t bytes, size_t raw, double commitMs) {
+        double undoMs = 0.0, redoMs = 0.0;
+        for (size_t i = 0; i < records; ++i) undoMs += measureMs([&] { journal.undo(g); });
+        for (size_t i = 0; i < records; ++i) redoMs += measureMs([&] { journal.redo(g); });
+        out << column(name, 22, true) << std::setw(9) << records << std::setw(13) << bytes / std::max<size_t>(records, 1)
+            << std::setw(12) << raw / std::max<size_t>(records, 1) << std::fixed << std::setprecision(3)
+            << std::setw(11) << commitMs / records << std::setw(11) << undoMs / records
+            << std::setw(11) << redoMs / records << std::endl;
+    };
+    const size_t rawMove = sizeof(int) + 4 * sizeof(double);
+    const size_t rawChange = 2 * sizeof(int) + sizeof(double);
+    
+    size_t before = journal.bytes();
+    double commitMs = measureMs([&] {
+        journal.begin(g);
+        layout.circular(g, 1200.0, 800.0);
+        journal.commit(g);
+    });
+    row("смена макета", 1, journal.bytes() - before, vertices.size() * rawMove, commitMs);
+    
+    // Доводка: 1% вершин сдвигается на несколько пикселей
+    size_t moved = std::max<size_t>(1, vertices.size() / 100);
+    before = journal.bytes();
+    commitMs = measureMs([&] {
+        journal.begin(g);
+        for (size_t i = 0; i < moved; ++i) {
+            int id = vertices[pick(gen)];
+            const Vertex* vertex = g.getVertex(id);
+            g.setVertexPosition(id, vertex->x + static_cast<double>(gen() % 11) - 5.0,
+                                vertex->y + static_cast<double>(gen() % 11) - 5.0);
+        }
+        journal.commit(g);
+    });
+    row("доводка 1% вершин", 1, journal.bytes() - before, moved * rawMove, commitMs);
+    
+    // Пакеты по 10 изменений: половина удаляет ребро, половина добавляет
+    size_t batches = std::max<size_t>(queries, 2 * Journal::kCheckpointInterval);
+    size_t changeCount = 0;
+    before = journal.bytes();
+    commitMs = 0.0;
+    for (size_t b = 0; b < batches; ++b) {
+        GraphDelta delta;
+        for (size_t i = 0; i < 10; ++i) {
+            int u = vertices[pick(gen)];
+            if (i % 2 == 0) {
+                auto neighbors = g.getNeighbors(u);
+                if (!neighbors.empty()) delta.removedEdges.emplace_back(u, neighbors[gen() % neighbors.size()]);
+            } else {
+                delta.addedEdges.emplace_back(u, vertices[pick(gen)], 1.0, g.isDirected());
+            }
+        }
+        commitMs += measureMs([&] {
+            journal.begin(g);
+            changeCount += g.applyDelta(delta).size();
+            journal.commit(g);
+        });
+    }
+    row("пакет 10 рёбер", batches, journal.bytes() - before, changeCount * rawChange, commitMs);
+    if (forceMs >= 0.0) {
+        out << "Пересчёт force-directed вместо отмены: " << std::setprecision(2) << forceMs << " мс" << std::endl;
+    }
+    
+    // Переход к случайным версиям: от ближайшего снимка против повтора с начала
+    size_t total = journal.size();
+    uint64_t finalHash = stateHash();
+    double seekMs = 0.0, replayMs = 0.0;
+    const size_t seeks = 20;
+    for (size_t i = 0; i < seeks; ++i) {
+        size_t target = gen() % (total + 1);
+        journal.seek(g, total);
+        seekMs += measureMs([&] { journal.seek(g, target); });
+        journal.seek(g, 0);
+        replayMs += measureMs([&] {
+            while (journal.version() < target) journal.redo(g);
+        });
+    }
+    journal.seek(g, 0);
+    bool undoExact = stateHash() == baseHash;
+    journal.seek(g, total);
+    bool redoExact = stateHash() == finalHash;
+    out << "Переход к версии (" << total << " записей, снимок каждые " << Journal::kCheckpointInterval
+        << "): " << std::setprecision(3) << seekMs / seeks << " мс, повтор с начала " << replayMs / seeks
+        << " мс; отмена всего " << (undoExact ? "точна" : "НЕ ТОЧНА") << ", повтор всего "
+        << (redoExact ? "точен" : "НЕ ТОЧЕН") << std::endl;
+    g.removeChangeListener(listener);
+    
+    // Продолжение сеанса: сохранённый журнал применяется к исходному графу
+    auto path = (std::filesystem::temp_directory_path() / "kg_viewer_bench.journal").string();
+    double saveMs = measureMs([&] { journal.save(path); });
+    size_t fileBytes = static_cast<size_t>(std::filesystem::file_size(path));
+    g.restore(*base);
+    std::optional<Journal> resumed;
+    double loadMs = measureMs([&] { resumed = Journal::load(path, g, fingerprint); });
+    bool resumedExact = resumed && stateHash() == finalHash;
+    std::filesystem::remove(path);
+    out << "Сохранение: " << std::setprecision(2) << saveMs << " мс, " << fileBytes << " байт; продолжение сеанса: "
+        << loadMs << " мс, состояние " << (resumedExact ? "совпадает" : "НЕ СОВПАДАЕТ") << std::endl;
+}
+
+void Benchmark::dynamicUpdates(Graph& g, size_t queries, std::ostream& out) {
+    auto vertices = g.getVertices();
+    if (vertices.size() < 2) return;
+    std::sort(vertices.begin(), vertices.end());
+    std::mt19937 gen(42);
+    
+    // Удаление вершины: обратный индекс против прежнего обхода всех списков
+    size_t removals = std::min<size_t>(queries, vertices.size() / 10);
+    double scanMs = 0.0, removeMs = 0.0;
+    size_t removedArcs = 0;
+    for (size_t i = 0; i < removals; ++i) {
+        int id = vertices[std::uniform_int_distribution<size_t>(0, vertices.size() - 1)(gen)];
+        if (!g.hasVertex(id)) continue;
+        scanMs += measureMs([&] {
+            g.forEachAdjacency([&](int, const EdgeList& edges) {
+                removedArcs += std::count_if(edges.begin(), edges.end(), [id](const Edge& e) { return e.to == id; });
+            });
+        });
+        removeMs += measureMs([&] { g.removeVertex(id); });
+    }
+    sink = static_cast<double>(removedArcs);
+    vertices = g.getVertices();
+    std::sort(vertices.begin(), vertices.end());
+    if (removals > 0) {
+        out << "\n== Удаление вершины (" << removals << " раз): обход всех списков "
+            << std::fixed << std::setprecision(1) << scanMs * 1000.0 / removals << " мкс, обратный индекс "
+            << removeMs * 1000.0 / removals << " мкс ==" << std::endl;
+    }
+    
+    auto analysis = IncrementalAnalysis::build(g);
+    Layout layout;
+    bool fullLayout = g.getVertexCount() <= kFullLayoutLimit;
+    if (fullLayout) {
+        layout.forceDirected(g, 1200.0, 800.0);
+    } else {
+        layout.random(g, 1200.0, 800.0);
+    }
+    
+    out << "\n== Пакеты изменений: " << analysis.componentCount() << " компонент, наибольшая "
+        << analysis.largestComponentSize() << ", макс. степень " << analysis.maxDegree() << " ==" << std::endl;
+    out << column("пакет", 8) << column("применить мс", 14) << column("инкр. мс", 12) << column("просмотрено", 13)
+        << column("с нуля мс", 12) << column("расхождений", 13) << column("макет мс", 12)
+        << column("полный мс", 12) << std::endl;
+    
+    std::uniform_int_distribution<size_t> pick(0, vertices.size() - 1);
+    for (size_t batch : {1, 10, 100, 1000}) {
+        const int rounds = 5;
+        double applyMs = 0.0, incrementalMs = 0.0, scratchMs = 0.0, relaxMs = 0.0, fullMs = 0.0;
+        size_t visited = 0, mismatches = 0;
+        for (int round = 0; round < rounds; ++round) {
+            // Половина пакета - удаление существующих рёбер, половина - новые рёбра,
+            // одна вершина на сотню изменений удаляется целиком
+            GraphDelta delta;
+            for (size_t i = 0; i < batch; ++i) {
+                int u = vertices[pick(gen)];
+                if (i % 100 == 99) {
+                    delta.removedVertices.push_back(u);
+                } else if (i % 2 == 0) {
+                    auto neighbors = g.getNeighbors(u);
+                    if (!neighbors.empty()) delta.removedEdges.emplace_back(u, neighbors[gen() % neighbors.size()]);
+                } else {
+                    delta.addedEdges.emplace_back(u, vertices[pick(gen)], 1.0, g.isDirected());
+                }
+            }
+            
+            std::vector<GraphChange> changes;
+            applyMs += measureMs([&] { changes = g.applyDelta(delta); });
+            std::vector<int> touched;
+            incrementalMs += measureMs([&] { touched = analysis.apply(g, changes); });
+            visited += analysis.lastVisited();
+            
+            std::optional<IncrementalAnalysis> scratch;
+            scratchMs += measureMs([&] { scratch = IncrementalAnalysis::build(g); });
+            auto expected = canonicalComponents(scratch->components());
+            auto actual = canonicalComponents(analysis.components());
+            for (const auto& [v, root] : expected) {
+                auto it = actual.find(v);
+                if (it == actual.end() || it->second != root) ++mismatches;
+            }
+            if (actual.size() != expected.size() || analysis.maxDegree() != scratch->maxDegree()) ++mismatches;
+            
+            relaxMs += measureMs([&] { layout.relaxAround(g, touched, 1200.0, 800.0); });
+            if (fullLayout && round == 0) fullMs = measureMs([&] { layout.forceDirected(g, 1200.0, 800.0); });
+            
+            // Удалённые вершины больше не выбираются
+            if (!delta.removedVertices.empty()) {
+                vertices = g.getVertices();
+                std::sort(vertices.begin(), vertices.end());
+                pick = std::uniform_int_distribution<size_t>(0, vertices.size() - 1);
+            }
+        }
+        out << std::setw(8) << batch << std::setw(14) << std::setprecision(3) << applyMs / rounds
+            << std::setw(12) << incrementalMs / rounds << std::setw(13) << visited / rounds
+            << std::setw(12) << scratchMs / rounds << std::setw(13) << mismatches
+            << std::setw(12) << relaxMs / rounds;
+        if (fullLayout) {
+            out << std::setw(12) << fullMs << std::endl;
+        } else {
+            out << column("-", 12) << std::endl;
+        }
+    }
+}
+
+} // namespace graph
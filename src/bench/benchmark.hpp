@@ -0,0 +1,123 @@
+#pragma once
+
+#include "core/graph.hpp"
+#include <ostream>
+#include <string>
+#include <chrono>
+
+namespace graph {
+
+// Headless-замеры алгоритмов на загруженном графе (запуск: --bench <файл>)
+class Benchmark {
+public:
+    // Загрузить граф и выполнить замеры: все или один раздел
+    // (paths, traverse, order, sssp, pagerank, betweenness, communities, triangles, cores, dag, layout, ego, oracle, query, search, memory, export;
+    // journal, versions и dynamic изменяют граф и выполняются последними)
+    static int run(const std::string& filename, size_t queries, std::ostream& out,
+                   const std::string& section = "");
+    
+    // Структурные характеристики графа (запуск: --stats <файл>)
+    static int statisticsReport(const std::string& filename, std::ostream& out);
+    
+    // Запрос по типам связей с выводом найденных путей (запуск: --query <файл> <шаблон>)
+    static int queryReport(const std::string& filename, const std::string& query, std::ostream& out);
+    
+    // Поиск вершин по имени (запуск: --search <файл> <текст>)
+    static int searchReport(const std::string& filename, const std::string& text, std::ostream& out);
+    
+    // Запись графа в CSV, JSON, GraphML или DOT (по расширению) с макетом по
+    // умолчанию, как в окне; макет берётся из кеша, если граф уже открывался
+    // (запуск: --export <файл> <выходной файл>)
+    static int exportReport(const std::string& filename, const std::string& output, std::ostream& out);
+    
+    // Поиск пути между случайными парами: просмотренные вершины и задержка
+    static void shortestPaths(Graph& g, size_t queries, std::ostream& out);
+    
+    // Обходы BFS/DFS и компоненты связности: состояние по плотным индексам
+    // против хеш-множеств по внешним ID
+    static void traversals(Graph& g, size_t queries, std::ostream& out);
+    
+    // Порядок вершин: перенумерация от порядка загрузки (loadOrder) и её
+    // влияние на BFS, PageRank и итерацию макета; порядок графа возвращается
+    static void vertexOrdering(Graph& g, const std::vector<int>& loadOrder, size_t queries, std::ostream& out);
+    
+    // Кратчайшие расстояния от одного источника: delta-stepping по числу потоков
+    static void singleSource(Graph& g, size_t queries, std::ostream& out);
+    
+    // PageRank и персонализированный PageRank по числу потоков
+    static void pageRank(Graph& g, std::ostream& out);
+    
+    // Центральность по посредничеству: точный расчёт против выборки
+    static void betweenness(Graph& g, std::ostream& out);
+    
+    // Сообщества Louvain: модулярность и время по числу потоков
+    static void communities(Graph& g, std::ostream& out);
+    
+    // Подсчёт треугольников: SIMD против скалярного пересечения по числу потоков
+    static void triangles(Graph& g, std::ostream& out);
+    
+    // k-ядра: последовательный и параллельный расчёт, размеры представлений
+    static void cores(Graph& g, std::ostream& out);
+    
+    // Ориентированная структура: топологическая сортировка по числу потоков,
+    // компоненты сильной связности, цикл-свидетель, транзитивное сокращение
+    // и замыкание, иерархический макет
+    static void directedStructure(Graph& g, std::ostream& out);
+    
+    // Макеты по стрессу и спектральный против force-directed: время до
+    // стресса, которого force-directed достигает за 100 итераций;
+    // совпадение макетов по компонентам на разном числе потоков; кеш макетов
+    static void layoutQuality(Graph& g, std::ostream& out);
+    
+    // Окрестности вершин: задержка ограниченного BFS и размер представления
+    static void neighborhoods(Graph& g, size_t queries, std::ostream& out);
+    
+    // Запросы по типам связей: индекс против перебора всех дуг на каждом шаге
+    static void relationQueries(Graph& g, size_t queries, std::ostream& out);
+    
+    // Поиск по именам: префиксный и нечёткий (с опечаткой) поиск, память индекса
+    static void nameSearch(Graph& g, size_t queries, std::ostream& out);
+    
+    // Память графа: выделения, RSS, сборка и освобождение по частям с
+    // аренами против отдельных хеш-таблиц и векторов на каждую вершину
+    static void memoryFootprint(Graph& g, std::ostream& out);
+    
+    // Запись графа: параллельное форматирование блоков во всех форматах на
+    // 1/2/4/8 потоках против потока ofstream по одному ребру, совпадение
+    // текста между потоками и повторная загрузка записанного CSV
+    static void exportThroughput(Graph& g, std::ostream& out);
+    
+    // Журнал операций: размер сжатых записей, отмена и повтор, переход к
+    // версии через снимки и продолжение сеанса из файла (изменяет граф)
+    static void operationJournal(Graph& g, size_t queries, std::ostream& out);
+    
+    // Версии графа: стоимость снимка против полной копии, цена первой записи
+    // после снимка и согласованность чтения снимка во время изменений (изменяет граф)
+    static void versionedSnapshots(Graph& g, size_t queries, std::ostream& out);
+    
+    // Пакетные изменения: удаление вершины, инкрементальные компоненты, степени
+    // и локальный макет против пересчёта с нуля (изменяет граф)
+    static void dynamicUpdates(Graph& g, size_t queries, std::ostream& out);
+    
+    // Оракул расстояний: время построения, память, точность оценок и задержка
+    static void distanceOracle(Graph& g, size_t queries, std::ostream& out);
+    
+private:
+    // Выравнивание UTF-8 строки по ширине в символах (std::setw считает байты)
+    static std::string column(const std::string& text, size_t width, bool alignLeft = false);
+    
+    // Случайные пары вершин с фиксированным зерном, чтобы прогоны были сравнимы
+    static std::vector<std::pair<int, int>> randomPairs(const Graph& g, size_t count);
+    
+    static size_t threadCount();
+    
+    template<typename F>
+    static double measureMs(F&& f) {
+        auto begin = std::chrono::steady_clock::now();
+        f();
+        auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::milli>(end - begin).count();
+    }
+};
+
+} // namespace graph
@@ -0,0 +1,90 @@
+#include "bench/memory.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#if defined(_MSC_VER) || defined(__GLIBC__)
+#include <malloc.h>
+#endif
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
+#if defined(GRAPH_COUNT_ALLOCATIONS)
+namespace {
+
+std::atomic<size_t> allocationCount{0};
+std::atomic<size_t> allocatedBytes{0};
+
+void* countedAlloc(std::size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void* countedAlignedAlloc(std::size_t size, std::align_val_t alignment) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    std::size_t align = static_cast<std::size_t>(alignment);
+#if defined(_MSC_VER)
+    if (void* p = _aligned_malloc(size ? size : 1, align)) return p;
+#else
+    // aligned_alloc требует размер, кратный выравниванию
+    std::size_t rounded = (size + align - 1) / align * align;
+    if (void* p = std::aligned_alloc(align, rounded ? rounded : align)) return p;
+#endif
+    throw std::bad_alloc();
+}
+
+void alignedFree(void* p) {
+#if defined(_MSC_VER)
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+} // namespace
+
+// Варианты nothrow и sized delete по умолчанию сводятся к этим
+void* operator new(std::size_t size) { return countedAlloc(size); }
+void* operator new[](std::size_t size) { return countedAlloc(size); }
+void* operator new(std::size_t size, std::align_val_t alignment) { return countedAlignedAlloc(size, alignment); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return countedAlignedAlloc(size, alignment); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { alignedFree(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { alignedFree(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { alignedFree(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { alignedFree(p); }
+#endif
+
+namespace graph {
+
+MemoryUsage MemoryUsage::current() {
+    MemoryUsage usage;
+#if defined(GRAPH_COUNT_ALLOCATIONS)
+    usage.allocations = allocationCount.load(std::memory_order_relaxed);
+    usage.bytes = allocatedBytes.load(std::memory_order_relaxed);
+#endif
+#if defined(__linux__)
+    // Второе поле statm - резидентные страницы
+    std::ifstream statm("/proc/self/statm");
+    size_t total = 0, resident = 0;
+    if (statm >> total >> resident) {
+        usage.residentBytes = resident * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    }
+#endif
+    return usage;
+}
+
+void MemoryUsage::trim() {
+#if defined(__GLIBC__)
+    malloc_trim(0);
+#endif
+}
+
+} // namespace graph
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+
+namespace graph {
+
+// Счётчики выделений кучи и резидентная память процесса - для замеров
+// потребления памяти. Глобальный operator new заменяется счётчиком в
+// memory.cpp только при сборке с GRAPH_COUNT_ALLOCATIONS (опция CMake,
+// по умолчанию выключена); иначе allocations и bytes остаются нулями
+struct MemoryUsage {
+    size_t allocations = 0;  // вызовов operator new с начала работы
+    size_t bytes = 0;        // запрошено байт с начала работы
+    size_t residentBytes = 0;
+    
+    static MemoryUsage current();
+    
+    // Собраны ли счётчики выделений
+    static constexpr bool countsAllocations() {
+#if defined(GRAPH_COUNT_ALLOCATIONS)
+        return true;
+#else
+        return false;
+#endif
+    }
+    
+    // Вернуть освобождённую память системе, чтобы RSS отражал живые данные
+    // (только glibc; в остальных случаях ничего не делает)
+    static void trim();
+};
+
+} // namespace graph
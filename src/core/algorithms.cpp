@@ -1,9 +1,16 @@
 #include "core/algorithms.hpp"
-#include <unordered_set>
-#include <unordered_map>
+#include "core/distance_oracle.hpp"
+#include "core/contraction.hpp"
+#include "core/subgraph.hpp"
+#include "core/dfs.hpp"
+#include <algorithm>
+#include <numeric>
 #include <limits>
 #include <thread>
 #include <chrono>
+#include <cmath>
+#include <tuple>
+#include <optional>
 
 namespace graph {
 
@@ -16,151 +23,161 @@ void Algorithms::waitIfPaused(AlgorithmState& state) {
 void Algorithms::updateState(AlgorithmState& state, int vertex, bool visited) {
     std::lock_guard<std::mutex> lock(state.stateMutex);
     state.currentVertex = vertex;
-    if (visited && std::find(state.visited.begin(), state.visited.end(), vertex) == state.visited.end()) {
+    if (visited && state.visitedLookup.insert(vertex).second) {
         state.visited.push_back(vertex);
     }
 }
 
-std::vector<int> Algorithms::BFS(Graph& g, int start, AlgorithmState& state) {
+void Algorithms::markVisited(AlgorithmState& state, int vertex) {
+    std::lock_guard<std::mutex> lock(state.stateMutex);
+    state.currentVertex = vertex;
+    state.visited.push_back(vertex);
+}
+
+void Algorithms::stepDelay(const AlgorithmState& state) {
+    int delayMs = state.stepDelayMs;
+    if (delayMs > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(delayMs));
+    }
+}
+
+std::vector<int> Algorithms::BFS(const Graph& g, int start, AlgorithmState& state) {
     state.reset();
     state.isRunning = true;
     
     std::vector<int> result;
-    std::queue<int> queue;
-    std::unordered_set<int> visited;
-    
-    if (!g.hasVertex(start)) {
+    int s = g.denseIndex(start);
+    if (s == -1) {
         state.isRunning = false;
         return result;
     }
     
-    queue.push(start);
-    visited.insert(start);
-    updateState(state, start);
+    // Состояние - по плотным индексам графа, в ответ и анимацию идут ID
+    std::vector<int> ids = g.getVertices();
+    int n = static_cast<int>(ids.size());
+    VertexMask visited(n);
+    std::queue<int> queue;
+    std::vector<int> neighbors;
+    
+    queue.push(s);
+    visited.set(s);
+    markVisited(state, start);
     
     while (!queue.empty() && state.isRunning) {
         waitIfPaused(state);
         
         int current = queue.front();
         queue.pop();
-        result.push_back(current);
+        result.push_back(ids[current]);
         
-        updateState(state, current);
+        updateState(state, ids[current], false);
         
-        auto neighbors = g.getNeighbors(current);
+        g.getDenseNeighbors(current, neighbors);
         for (int neighbor : neighbors) {
-            if (visited.find(neighbor) == visited.end()) {
-                visited.insert(neighbor);
+            if (neighbor < n && !visited.test(neighbor)) {
+                visited.set(neighbor);
                 queue.push(neighbor);
-                updateState(state, neighbor);
+                markVisited(state, ids[neighbor]);
             }
         }
         
         // Небольшая задержка для визуализации
-        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        stepDelay(state);
     }
     
     state.isRunning = false;
     return result;
 }
 
-std::vector<int> Algorithms::DFS(Graph& g, int start, AlgorithmState& state) {
+std::vector<int> Algorithms::DFS(const Graph& g, int start, AlgorithmState& state) {
     state.reset();
     state.isRunning = true;
     
+    // Снимок CSR: стек обхода хранит позиции в массивах соседей, а не
+    // копии списков, и глубина не ограничена стеком потока
     std::vector<int> result;
-    std::unordered_set<int> visited;
-    
-    if (!g.hasVertex(start)) {
+    CSRGraph csr = CSRGraph::fromGraph(g);
+    int s = csr.indexOf(start);
+    if (s == -1) {
         state.isRunning = false;
         return result;
     }
     
-    std::function<void(int)> dfs_recursive = [&](int v) {
-        if (!state.isRunning || visited.find(v) != visited.end()) {
-            return;
-        }
-        
+    VertexMask visited(csr.size());
+    DepthFirst dfs([&csr](int v) { return csr.neighbors(v); });
+    dfs.run(s, visited, [&](int v) {
         waitIfPaused(state);
-        
-        visited.insert(v);
-        result.push_back(v);
-        updateState(state, v);
-        
-        auto neighbors = g.getNeighbors(v);
-        for (int neighbor : neighbors) {
-            if (visited.find(neighbor) == visited.end()) {
-                dfs_recursive(neighbor);
-            }
-        }
-        
-        std::this_thread::sleep_for(std::chrono::milliseconds(50));
-    };
-    
-    dfs_recursive(start);
+        if (!state.isRunning) return false;
+        result.push_back(csr.ids[v]);
+        markVisited(state, csr.ids[v]);
+        stepDelay(state);
+        return true;
+    });
     
     state.isRunning = false;
     return result;
 }
 
-std::vector<int> Algorithms::Dijkstra(Graph& g, int start, int end, AlgorithmState& state) {
+std::vector<int> Algorithms::Dijkstra(const Graph& g, int start, int end, AlgorithmState& state) {
     state.reset();
     state.isRunning = true;
     
     std::vector<int> path;
-    
-    if (!g.hasVertex(start) || !g.hasVertex(end)) {
+    int s = g.denseIndex(start);
+    int t = g.denseIndex(end);
+    if (s == -1 || t == -1) {
         state.isRunning = false;
         return path;
     }
     
-    std::unordered_map<int, double> distances;
-    std::unordered_map<int, int> previous;
-    std::unordered_set<int> unvisited;
-    
-    auto vertices = g.getVertices();
-    for (int v : vertices) {
-        distances[v] = std::numeric_limits<double>::infinity();
-        previous[v] = -1;
-        unvisited.insert(v);
-    }
-    distances[start] = 0.0;
+    std::vector<int> ids = g.getVertices();
+    int n = static_cast<int>(ids.size());
+    std::vector<double> distances(n, std::numeric_limits<double>::infinity());
+    std::vector<int> previous(n, -1);
+    VertexMask visited(n);
+    std::vector<int> unvisited(n);
+    std::iota(unvisited.begin(), unvisited.end(), 0);
+    distances[s] = 0.0;
     
+    std::vector<int> neighbors;
+    std::vector<double> weights;
     while (!unvisited.empty() && state.isRunning) {
         waitIfPaused(state);
         
         // Найти вершину с минимальным расстоянием
-        int current = -1;
+        size_t position = unvisited.size();
         double minDist = std::numeric_limits<double>::infinity();
-        for (int v : unvisited) {
-            if (distances[v] < minDist) {
-                minDist = distances[v];
-                current = v;
+        for (size_t i = 0; i < unvisited.size(); ++i) {
+            if (distances[unvisited[i]] < minDist) {
+                minDist = distances[unvisited[i]];
+                position = i;
             }
         }
         
-        if (current == -1 || minDist == std::numeric_limits<double>::infinity()) {
+        if (position == unvisited.size()) {
             break;
         }
         
-        unvisited.erase(current);
-        updateState(state, current);
+        int current = unvisited[position];
+        unvisited[position] = unvisited.back();
+        unvisited.pop_back();
+        visited.set(current);
+        markVisited(state, ids[current]);
         
-        if (current == end) {
+        if (current == t) {
             // Восстановить путь
-            int node = end;
-            while (node != -1) {
-                path.insert(path.begin(), node);
-                node = previous[node];
+            for (int node = t; node != -1; node = previous[node]) {
+                path.push_back(ids[node]);
             }
+            std::reverse(path.begin(), path.end());
             break;
         }
         
-        auto neighbors = g.getNeighbors(current);
-        for (int neighbor : neighbors) {
-            if (unvisited.find(neighbor) != unvisited.end()) {
-                auto edge = g.getEdge(current, neighbor);
-                double alt = distances[current] + edge.weight;
+        g.getDenseNeighbors(current, neighbors, &weights);
+        for (size_t i = 0; i < neighbors.size(); ++i) {
+            int neighbor = neighbors[i];
+            if (neighbor < n && !visited.test(neighbor)) {
+                double alt = distances[current] + weights[i];
                 if (alt < distances[neighbor]) {
                     distances[neighbor] = alt;
                     previous[neighbor] = current;
@@ -168,7 +185,266 @@ std::vector<int> Algorithms::Dijkstra(Graph& g, int start, int end, AlgorithmSta
             }
         }
         
-        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        stepDelay(state);
+    }
+    
+    state.path = path;
+    state.isRunning = false;
+    return path;
+}
+
+std::vector<int> Algorithms::BidirectionalDijkstra(const Graph& g, int start, int end, AlgorithmState& state) {
+    CSRGraph forward = CSRGraph::fromGraph(g);
+    if (!forward.directed) {
+        return BidirectionalDijkstra(forward, forward, start, end, state);
+    }
+    return BidirectionalDijkstra(forward, forward.transposed(), start, end, state);
+}
+
+std::vector<int> Algorithms::BidirectionalDijkstra(const CSRGraph& forward, const CSRGraph& backward,
+                                                   int start, int end, AlgorithmState& state) {
+    state.reset();
+    state.isRunning = true;
+    
+    std::vector<int> path;
+    int s = forward.indexOf(start);
+    int t = forward.indexOf(end);
+    if (s == -1 || t == -1) {
+        state.isRunning = false;
+        return path;
+    }
+    
+    // Прямой поиск идёт по исходным дугам, обратный - по обращённым
+    const CSRGraph* graphs[2] = {&forward, &backward};
+    
+    const double inf = std::numeric_limits<double>::infinity();
+    int n = forward.size();
+    
+    using Item = std::pair<double, int>;
+    using MinHeap = std::priority_queue<Item, std::vector<Item>, std::greater<Item>>;
+    std::vector<double> dist[2] = {std::vector<double>(n, inf), std::vector<double>(n, inf)};
+    std::vector<int> parent[2] = {std::vector<int>(n, -1), std::vector<int>(n, -1)};
+    MinHeap heap[2];
+    
+    dist[0][s] = 0.0;
+    dist[1][t] = 0.0;
+    heap[0].push({0.0, s});
+    heap[1].push({0.0, t});
+    
+    // Лучший найденный путь s -> meet -> t
+    double best = (s == t) ? 0.0 : inf;
+    int meet = (s == t) ? s : -1;
+    
+    while (state.isRunning && (!heap[0].empty() || !heap[1].empty())) {
+        waitIfPaused(state);
+        
+        // Остановка: сумма минимальных ключей не меньше найденного пути
+        double topForward = heap[0].empty() ? inf : heap[0].top().first;
+        double topBackward = heap[1].empty() ? inf : heap[1].top().first;
+        if (topForward + topBackward >= best) {
+            break;
+        }
+        
+        // Расширять сторону с меньшей очередью
+        int side = (!heap[0].empty() && (heap[1].empty() || heap[0].size() <= heap[1].size())) ? 0 : 1;
+        auto [d, u] = heap[side].top();
+        heap[side].pop();
+        if (d > dist[side][u]) {
+            continue;
+        }
+        
+        updateState(state, forward.ids[u]);
+        
+        auto neighbors = graphs[side]->neighbors(u);
+        auto weights = graphs[side]->neighborWeights(u);
+        for (size_t i = 0; i < neighbors.size(); ++i) {
+            int v = neighbors[i];
+            double alt = d + weights[i];
+            if (alt < dist[side][v]) {
+                dist[side][v] = alt;
+                parent[side][v] = u;
+                heap[side].push({alt, v});
+            }
+            double through = dist[side][v] + dist[1 - side][v];
+            if (through < best) {
+                best = through;
+                meet = v;
+            }
+        }
+        
+        stepDelay(state);
+    }
+    
+    if (meet != -1 && best < inf) {
+        // Восстановить путь: start -> meet по прямым предкам, meet -> end по обратным
+        for (int v = meet; v != -1; v = parent[0][v]) {
+            path.push_back(forward.ids[v]);
+        }
+        std::reverse(path.begin(), path.end());
+        for (int v = parent[1][meet]; v != -1; v = parent[1][v]) {
+            path.push_back(forward.ids[v]);
+        }
+    }
+    
+    state.path = path;
+    state.isRunning = false;
+    return path;
+}
+
+std::vector<int> Algorithms::AStar(const Graph& g, int start, int end, AlgorithmState& state,
+                                   HeuristicType heuristic, const DistanceOracle* oracle) {
+    CSRGraph csr = CSRGraph::fromGraph(g);
+    std::optional<EuclideanBound> geometry;
+    if (heuristic != HeuristicType::Landmarks || !oracle || !oracle->matches(csr)) {
+        geometry = EuclideanBound::build(csr, g);
+    }
+    return AStar(csr, start, end, state, heuristic, geometry ? &*geometry : nullptr, oracle);
+}
+
+std::vector<int> Algorithms::AStar(const CSRGraph& csr, int start, int end, AlgorithmState& state,
+                                   HeuristicType heuristic, const EuclideanBound* geometry,
+                                   const DistanceOracle* oracle) {
+    int t = csr.indexOf(end);
+    if (csr.indexOf(start) == -1 || t == -1) {
+        state.reset();
+        return {};
+    }
+    
+    // Без оракула для этого снимка ориентиров нет (строить их здесь - это
+    // несколько полных SSSP на каждый запрос): тогда евклидова оценка, если
+    // она допустима, иначе нулевая - поиск сводится к Dijkstra
+    bool hasOracle = oracle && oracle->matches(csr);
+    bool geometric = geometry && geometry->admissible && geometry->xs.size() == csr.ids.size();
+    if (heuristic == HeuristicType::Auto) {
+        heuristic = geometric ? HeuristicType::Euclidean : HeuristicType::Landmarks;
+    } else if (heuristic == HeuristicType::Landmarks && !hasOracle && geometric) {
+        heuristic = HeuristicType::Euclidean;
+    }
+    if ((heuristic == HeuristicType::Landmarks && !hasOracle)
+        || (heuristic == HeuristicType::Euclidean && !geometric)) {
+        return AStar(csr, start, end, state, [](int) { return 0.0; });
+    }
+    
+    if (heuristic == HeuristicType::Euclidean) {
+        const auto& xs = geometry->xs;
+        const auto& ys = geometry->ys;
+        return AStar(csr, start, end, state, [&](int v) { return std::hypot(xs[v] - xs[t], ys[v] - ys[t]); });
+    }
+    return AStar(csr, start, end, state, [&](int v) { return oracle->lowerBound(v, t); });
+}
+
+EuclideanBound EuclideanBound::build(const CSRGraph& csr, const Graph& g) {
+    EuclideanBound bound;
+    bound.version = g.version();
+    int n = csr.size();
+    bound.xs.resize(n);
+    bound.ys.resize(n);
+    for (int v = 0; v < n; ++v) {
+        const Vertex* vertex = g.getVertex(csr.ids[v]);
+        bound.xs[v] = vertex ? vertex->x : 0.0;
+        bound.ys[v] = vertex ? vertex->y : 0.0;
+    }
+    
+    // Те же условия, что в hasGeometricWeights, но по дугам снимка
+    bool hasLength = false;
+    for (int u = 0; u < n; ++u) {
+        auto neighbors = csr.neighbors(u);
+        auto weights = csr.neighborWeights(u);
+        for (size_t i = 0; i < neighbors.size(); ++i) {
+            int v = neighbors[i];
+            double length = std::hypot(bound.xs[v] - bound.xs[u], bound.ys[v] - bound.ys[u]);
+            if (weights[i] + 1e-9 < length) {
+                return bound;
+            }
+            hasLength = hasLength || length > 0.0;
+        }
+    }
+    bound.admissible = hasLength;
+    return bound;
+}
+
+std::vector<int> Algorithms::AStar(const CSRGraph& csr, int start, int end, AlgorithmState& state,
+                                   const std::function<double(int)>& estimate) {
+    state.reset();
+    state.isRunning = true;
+    
+    std::vector<int> path;
+    int n = csr.size();
+    int s = csr.indexOf(start);
+    int t = csr.indexOf(end);
+    if (s == -1 || t == -1) {
+        state.isRunning = false;
+        return path;
+    }
+    
+    const double inf = std::numeric_limits<double>::infinity();
+    std::vector<double> dist(n, inf);
+    std::vector<int> previous(n, -1);
+    
+    // (f = g + h, g, вершина); устаревшие записи отбрасываются по g
+    using Item = std::tuple<double, double, int>;
+    std::priority_queue<Item, std::vector<Item>, std::greater<Item>> open;
+    dist[s] = 0.0;
+    open.push({estimate(s), 0.0, s});
+    
+    while (!open.empty() && state.isRunning) {
+        waitIfPaused(state);
+        
+        auto [f, d, u] = open.top();
+        open.pop();
+        if (d > dist[u] || f == inf) {
+            continue;
+        }
+        
+        updateState(state, csr.ids[u]);
+        
+        if (u == t) {
+            for (int v = t; v != -1; v = previous[v]) {
+                path.push_back(csr.ids[v]);
+            }
+            std::reverse(path.begin(), path.end());
+            break;
+        }
+        
+        auto neighbors = csr.neighbors(u);
+        auto weights = csr.neighborWeights(u);
+        for (size_t i = 0; i < neighbors.size(); ++i) {
+            int v = neighbors[i];
+            double alt = d + weights[i];
+            if (alt < dist[v]) {
+                dist[v] = alt;
+                previous[v] = u;
+                open.push({alt + estimate(v), alt, v});
+            }
+        }
+        
+        stepDelay(state);
+    }
+    
+    state.path = path;
+    state.isRunning = false;
+    return path;
+}
+
+std::vector<int> Algorithms::HierarchyQuery(const CSRGraph& g, const ContractionHierarchy& ch,
+                                            int start, int end, AlgorithmState& state) {
+    state.reset();
+    state.isRunning = true;
+    
+    std::vector<int> path;
+    int s = g.indexOf(start);
+    int t = g.indexOf(end);
+    if (s == -1 || t == -1 || ch.vertexCount() != g.size()) {
+        state.isRunning = false;
+        return path;
+    }
+    
+    auto result = ch.query(s, t);
+    for (int v : result.settled) {
+        updateState(state, g.ids[v]);
+    }
+    for (int v : result.path) {
+        path.push_back(g.ids[v]);
     }
     
     state.path = path;
@@ -176,5 +452,70 @@ std::vector<int> Algorithms::Dijkstra(Graph& g, int start, int end, AlgorithmSta
     return path;
 }
 
+std::vector<double> Algorithms::shortestDistances(const CSRGraph& g, int source, std::vector<int>* parent) {
+    const double inf = std::numeric_limits<double>::infinity();
+    std::vector<double> dist(g.size(), inf);
+    if (parent) {
+        parent->assign(g.size(), -1);
+    }
+    if (source < 0 || source >= g.size()) {
+        return dist;
+    }
+    
+    using Item = std::pair<double, int>;
+    std::priority_queue<Item, std::vector<Item>, std::greater<Item>> heap;
+    dist[source] = 0.0;
+    heap.push({0.0, source});
+    
+    while (!heap.empty()) {
+        auto [d, u] = heap.top();
+        heap.pop();
+        if (d > dist[u]) continue;
+        
+        auto neighbors = g.neighbors(u);
+        auto weights = g.neighborWeights(u);
+        for (size_t i = 0; i < neighbors.size(); ++i) {
+            int v = neighbors[i];
+            double alt = d + weights[i];
+            if (alt < dist[v]) {
+                dist[v] = alt;
+                if (parent) (*parent)[v] = u;
+                heap.push({alt, v});
+            }
+        }
+    }
+    return dist;
+}
+
+bool Algorithms::hasGeometricWeights(const Graph& g) {
+    bool hasLength = false;
+    for (const auto& edge : g.getEdges()) {
+        const Vertex* v1 = g.getVertex(edge.from);
+        const Vertex* v2 = g.getVertex(edge.to);
+        if (!v1 || !v2) continue;
+        double length = std::hypot(v2->x - v1->x, v2->y - v1->y);
+        if (edge.weight + 1e-9 < length) {
+            return false;
+        }
+        hasLength = hasLength || length > 0.0;
+    }
+    // Без координат (все вершины в одной точке) эвристика бесполезна
+    return hasLength;
+}
+
+double Algorithms::pathCost(const Graph& g, const std::vector<int>& path) {
+    if (path.empty()) {
+        return std::numeric_limits<double>::infinity();
+    }
+    double cost = 0.0;
+    for (size_t i = 1; i < path.size(); ++i) {
+        if (!g.hasEdge(path[i - 1], path[i])) {
+            return std::numeric_limits<double>::infinity();
+        }
+        cost += g.getEdge(path[i - 1], path[i]).weight;
+    }
+    return cost;
+}
+
 } // namespace graph
 
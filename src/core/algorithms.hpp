@@ -1,10 +1,12 @@
 #pragma once
 
 #include "core/graph.hpp"
+#include "core/csr.hpp"
 #include <vector>
 #include <queue>
 #include <functional>
 #include <atomic>
+#include <unordered_set>
 
 namespace graph {
 
@@ -14,31 +16,100 @@ struct AlgorithmState {
     std::atomic<int> currentVertex{-1};
     std::vector<int> visited;
     std::vector<int> path;
+    std::unordered_set<int> visitedLookup;  // быстрая проверка принадлежности visited
     std::mutex stateMutex;
     
+    // Задержка между шагами для анимации (0 - без задержки, например в бенчмарке)
+    std::atomic<int> stepDelayMs{50};
+    
     void reset() {
         isRunning = false;
         isPaused = false;
         currentVertex = -1;
         visited.clear();
+        visitedLookup.clear();
         path.clear();
     }
 };
 
+// Эвристика для A*
+enum class HeuristicType {
+    Auto,       // евклидова, если веса геометрические, иначе ориентиры
+    Euclidean,  // расстояние между позициями макета
+    Landmarks   // ALT: неравенство треугольника через ориентиры
+};
+
+class DistanceOracle;
+class ContractionHierarchy;
+
+// Данные евклидовой оценки A* для одного снимка: координаты макета в
+// плотной нумерации CSR и допустимость оценки (ни одна дуга не короче
+// расстояния между концами). Строится за O(V + E) один раз на снимок,
+// запросы по нему не обходят граф заново
+struct EuclideanBound {
+    std::vector<double> xs, ys;
+    bool admissible = false;
+    uint64_t version = 0;  // Graph::version() графа, по которому построены координаты
+    
+    static EuclideanBound build(const CSRGraph& csr, const Graph& g);
+};
+
 class Algorithms {
 public:
     // BFS обход в ширину
-    static std::vector<int> BFS(Graph& g, int start, AlgorithmState& state);
+    static std::vector<int> BFS(const Graph& g, int start, AlgorithmState& state);
     
     // DFS обход в глубину
-    static std::vector<int> DFS(Graph& g, int start, AlgorithmState& state);
+    static std::vector<int> DFS(const Graph& g, int start, AlgorithmState& state);
     
     // Dijkstra поиск кратчайшего пути
-    static std::vector<int> Dijkstra(Graph& g, int start, int end, AlgorithmState& state);
+    static std::vector<int> Dijkstra(const Graph& g, int start, int end, AlgorithmState& state);
+    
+    // Двунаправленный Dijkstra: встречный поиск от start и от end
+    static std::vector<int> BidirectionalDijkstra(const Graph& g, int start, int end, AlgorithmState& state);
+    static std::vector<int> BidirectionalDijkstra(const CSRGraph& forward, const CSRGraph& backward,
+                                                  int start, int end, AlgorithmState& state);
+    
+    // A* с эвристикой по позициям макета или по ориентирам оракула расстояний
+    // (оракул строится один раз вызывающим; если его нет или он построен для
+    // другого графа - евклидова оценка при геометрических весах, иначе Dijkstra)
+    static std::vector<int> AStar(const Graph& g, int start, int end, AlgorithmState& state,
+                                  HeuristicType heuristic = HeuristicType::Auto,
+                                  const DistanceOracle* oracle = nullptr);
+    
+    // То же по готовому снимку и его евклидовой оценке (geometry == nullptr -
+    // без неё): до первого шага поиска граф не обходится
+    static std::vector<int> AStar(const CSRGraph& csr, int start, int end, AlgorithmState& state,
+                                  HeuristicType heuristic, const EuclideanBound* geometry,
+                                  const DistanceOracle* oracle);
+    
+    // A* по готовому снимку; estimate - нижняя оценка расстояния от вершины
+    // (плотный индекс) до цели
+    static std::vector<int> AStar(const CSRGraph& g, int start, int end, AlgorithmState& state,
+                                  const std::function<double(int)>& estimate);
+    
+    // Запрос к иерархии сжатия, построенной по снимку g: путь с развёрнутыми
+    // шорткатами, без анимации
+    static std::vector<int> HierarchyQuery(const CSRGraph& g, const ContractionHierarchy& ch,
+                                           int start, int end, AlgorithmState& state);
+    
+    // Кратчайшие расстояния от source по CSR (плотные индексы)
+    static std::vector<double> shortestDistances(const CSRGraph& g, int source,
+                                                 std::vector<int>* parent = nullptr);
+    
+    // Веса рёбер не меньше евклидовой длины, т.е. евклидова эвристика допустима
+    static bool hasGeometricWeights(const Graph& g);
+    
+    // Суммарный вес пути (infinity для пустого пути или отсутствующего ребра)
+    static double pathCost(const Graph& g, const std::vector<int>& path);
     
     // Вспомогательные функции
     static void waitIfPaused(AlgorithmState& state);
     static void updateState(AlgorithmState& state, int vertex, bool visited = true);
+    // Вершина посещена впервые: повтор уже исключён по маске алгоритма,
+    // поэтому visitedLookup не проверяется
+    static void markVisited(AlgorithmState& state, int vertex);
+    static void stepDelay(const AlgorithmState& state);
 };
 
 } // namespace graph
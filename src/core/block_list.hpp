@@ -0,0 +1,200 @@
+#pragma once
+
+#include <memory_resource>
+#include <iterator>
+#include <type_traits>
+#include <memory>
+#include <new>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+
+namespace graph {
+
+// Список в цепочке блоков из арены. Заполненный блок не копируется и не
+// освобождается: следующий блок (размером со всё, что уже накоплено)
+// цепляется в конец, поэтому рост не оставляет в арене освобождённых
+// старых массивов, а лишнее место - только хвост последнего блока.
+//
+// Сам список - один указатель: блоков в цепочке O(log size), и добавление
+// находит незаполненный блок проходом по ней. Все блоки до него заполнены,
+// после него - пусты (остаются после удалений и заполняются снова).
+//
+// Память блоков принадлежит арене и освобождается вместе с ней; деструктор
+// списка только разрушает элементы, release возвращает блоки арене. Порядок элементов - порядок добавления,
+// back/pop_back и запись через итератор позволяют удалять перестановкой
+// с последним
+template<typename T>
+class BlockList {
+    struct Block {
+        Block* next;
+        uint32_t used;
+        uint32_t capacity;
+
+        T* items() {
+            return reinterpret_cast<T*>(reinterpret_cast<char*>(this) + kHeaderSize);
+        }
+        const T* items() const {
+            return reinterpret_cast<const T*>(reinterpret_cast<const char*>(this) + kHeaderSize);
+        }
+    };
+
+    static constexpr size_t kAlign = std::max(alignof(Block), alignof(T));
+    static constexpr size_t kHeaderSize = (sizeof(Block) + alignof(T) - 1) / alignof(T) * alignof(T);
+    // Первый блок - около 16 байт данных: у большинства вершин графов
+    // знаний одна-две дуги
+    static constexpr uint32_t kFirstCapacity = std::max<uint32_t>(1, 16 / sizeof(T));
+
+public:
+    template<typename Value, typename BlockPtr>
+    class Iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::remove_const_t<Value>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = Value*;
+        using reference = Value&;
+
+        Iterator() = default;
+        Iterator(BlockPtr block, uint32_t index) : block_(block), index_(index) {}
+
+        reference operator*() const { return block_->items()[index_]; }
+        pointer operator->() const { return block_->items() + index_; }
+
+        Iterator& operator++() {
+            if (++index_ == block_->used) {
+                block_ = block_->next && block_->next->used > 0 ? block_->next : nullptr;
+                index_ = 0;
+            }
+            return *this;
+        }
+        Iterator operator++(int) {
+            Iterator old = *this;
+            ++*this;
+            return old;
+        }
+
+        bool operator==(const Iterator& other) const { return block_ == other.block_ && index_ == other.index_; }
+
+    private:
+        BlockPtr block_ = nullptr;
+        uint32_t index_ = 0;
+    };
+
+    using iterator = Iterator<T, Block*>;
+    using const_iterator = Iterator<const T, const Block*>;
+
+    BlockList() = default;
+    BlockList(const BlockList&) = delete;
+    BlockList& operator=(const BlockList&) = delete;
+
+    ~BlockList() {
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            for (Block* block = head_; block; block = block->next) {
+                std::destroy_n(block->items(), block->used);
+            }
+        }
+    }
+
+    size_t size() const {
+        size_t count = 0;
+        for (const Block* block = head_; block && block->used > 0; block = block->next) {
+            count += block->used;
+        }
+        return count;
+    }
+    bool empty() const { return !head_ || head_->used == 0; }
+
+    iterator begin() { return empty() ? end() : iterator(head_, 0); }
+    iterator end() { return iterator(); }
+    const_iterator begin() const { return empty() ? end() : const_iterator(head_, 0); }
+    const_iterator end() const { return const_iterator(); }
+
+    T& back() { return last()->items()[last()->used - 1]; }
+
+    // Первый элемент, для которого pred истинно, или nullptr (проход по
+    // блокам без итератора: так идёт проверка повтора при добавлении дуги)
+    template<typename Pred>
+    T* find_if(Pred pred) {
+        for (Block* block = head_; block && block->used > 0; block = block->next) {
+            T* items = block->items();
+            for (uint32_t i = 0; i < block->used; ++i) {
+                if (pred(items[i])) return items + i;
+            }
+        }
+        return nullptr;
+    }
+    template<typename Pred>
+    const T* find_if(Pred pred) const { return const_cast<BlockList*>(this)->find_if(pred); }
+
+    template<typename... Args>
+    T& emplace_back(std::pmr::memory_resource* arena, Args&&... args) {
+        Block* block = head_;
+        Block* tail = nullptr;
+        size_t count = 0;
+        while (block && block->used == block->capacity) {
+            count += block->used;
+            tail = block;
+            block = block->next;
+        }
+        if (!block) {
+            block = allocate(arena, std::max<uint32_t>(kFirstCapacity, static_cast<uint32_t>(count)));
+            if (tail) {
+                tail->next = block;
+            } else {
+                head_ = block;
+            }
+        }
+        T* slot = block->items() + block->used;
+        new (slot) T(std::forward<Args>(args)...);
+        ++block->used;
+        return *slot;
+    }
+
+    void pop_back() {
+        Block* block = last();
+        std::destroy_at(block->items() + block->used - 1);
+        --block->used;
+    }
+
+    // Разрушить элементы и вернуть блоки арене, из которой они взяты (для
+    // учёта освобождённой памяти); список становится пустым
+    void release(std::pmr::memory_resource* arena) {
+        Block* block = head_;
+        while (block) {
+            Block* next = block->next;
+            std::destroy_n(block->items(), block->used);
+            arena->deallocate(block, kHeaderSize + static_cast<size_t>(block->capacity) * sizeof(T), kAlign);
+            block = next;
+        }
+        head_ = nullptr;
+    }
+
+    // Копия из другого списка - одним блоком точного размера
+    void assign(const BlockList& other, std::pmr::memory_resource* arena) {
+        size_t count = other.size();
+        if (count == 0) return;
+        Block* block = allocate(arena, static_cast<uint32_t>(count));
+        T* target = block->items();
+        for (const T& value : other) new (target++) T(value);
+        block->used = static_cast<uint32_t>(count);
+        head_ = block;
+    }
+
+private:
+    Block* head_ = nullptr;
+
+    // Последний непустой блок (список не пуст)
+    Block* last() {
+        Block* block = head_;
+        while (block->next && block->next->used > 0) block = block->next;
+        return block;
+    }
+
+    static Block* allocate(std::pmr::memory_resource* arena, uint32_t capacity) {
+        void* memory = arena->allocate(kHeaderSize + static_cast<size_t>(capacity) * sizeof(T), kAlign);
+        return new (memory) Block{nullptr, 0, capacity};
+    }
+};
+
+} // namespace graph
@@ -0,0 +1,391 @@
+#include "core/contraction.hpp"
+#include <algorithm>
+#include <limits>
+#include <queue>
+#include <utility>
+
+namespace graph {
+
+namespace {
+
+constexpr double kInf = std::numeric_limits<double>::infinity();
+
+// Ограничение поиска свидетелей: больше шорткатов, но быстрая предобработка
+constexpr int kWitnessSettleLimit = 500;
+
+struct DynamicArc {
+    int to;
+    double weight;
+    int middle;
+};
+
+// Изменяемый граф на время сжатия
+struct DynamicGraph {
+    std::vector<std::vector<DynamicArc>> out;
+    std::vector<std::vector<DynamicArc>> in;
+    std::vector<char> contracted;
+    
+    // Добавить дугу или укоротить существующую
+    bool addArc(int from, int to, double weight, int middle) {
+        auto& arcs = out[from];
+        auto it = std::find_if(arcs.begin(), arcs.end(), [to](const DynamicArc& a) { return a.to == to; });
+        if (it != arcs.end()) {
+            if (it->weight <= weight) return false;
+            it->weight = weight;
+            it->middle = middle;
+            auto& back = in[to];
+            auto jt = std::find_if(back.begin(), back.end(), [from](const DynamicArc& a) { return a.to == from; });
+            jt->weight = weight;
+            jt->middle = middle;
+            return true;
+        }
+        arcs.push_back({to, weight, middle});
+        in[to].push_back({from, weight, middle});
+        return true;
+    }
+};
+
+// Dijkstra с ограничением для поиска путей-свидетелей в обход сжимаемой вершины
+class WitnessSearch {
+public:
+    explicit WitnessSearch(int n) : dist_(n, kInf) {}
+    
+    void run(const DynamicGraph& g, int source, int skip, double limit) {
+        for (int v : touched_) dist_[v] = kInf;
+        touched_.clear();
+        
+        using Item = std::pair<double, int>;
+        std::priority_queue<Item, std::vector<Item>, std::greater<Item>> heap;
+        dist_[source] = 0.0;
+        touched_.push_back(source);
+        heap.push({0.0, source});
+        
+        int settled = 0;
+        while (!heap.empty() && settled < kWitnessSettleLimit) {
+            auto [d, u] = heap.top();
+            heap.pop();
+            if (d > dist_[u]) continue;
+            if (d > limit) break;
+            ++settled;
+            for (const auto& arc : g.out[u]) {
+                if (arc.to == skip || g.contracted[arc.to]) continue;
+                double alt = d + arc.weight;
+                if (alt < dist_[arc.to]) {
+                    if (dist_[arc.to] == kInf) touched_.push_back(arc.to);
+                    dist_[arc.to] = alt;
+                    heap.push({alt, arc.to});
+                }
+            }
+        }
+    }
+    
+    double distance(int v) const { return dist_[v]; }
+    
+private:
+    std::vector<double> dist_;
+    std::vector<int> touched_;
+};
+
+struct Shortcut {
+    int from;
+    int to;
+    double weight;
+};
+
+// Шорткаты, необходимые при сжатии v
+std::vector<Shortcut> findShortcuts(const DynamicGraph& g, int v, WitnessSearch& search) {
+    std::vector<Shortcut> shortcuts;
+    double maxOut = 0.0;
+    for (const auto& arc : g.out[v]) {
+        maxOut = std::max(maxOut, arc.weight);
+    }
+    
+    for (const auto& inArc : g.in[v]) {
+        int u = inArc.to;
+        search.run(g, u, v, inArc.weight + maxOut);
+        for (const auto& outArc : g.out[v]) {
+            int w = outArc.to;
+            if (w == u) continue;
+            double viaV = inArc.weight + outArc.weight;
+            if (search.distance(w) > viaV) {
+                shortcuts.push_back({u, w, viaV});
+            }
+        }
+    }
+    return shortcuts;
+}
+
+} // namespace
+
+ContractionHierarchy ContractionHierarchy::build(const CSRGraph& g, const std::atomic<bool>* cancel) {
+    ContractionHierarchy ch;
+    int n = g.size();
+    ch.vertexCount_ = n;
+    ch.fingerprint_ = g.fingerprint();
+    ch.rank_.assign(n, -1);
+    
+    DynamicGraph dyn;
+    dyn.out.resize(n);
+    dyn.in.resize(n);
+    dyn.contracted.assign(n, 0);
+    for (int u = 0; u < n; ++u) {
+        auto neighbors = g.neighbors(u);
+        auto weights = g.neighborWeights(u);
+        for (size_t i = 0; i < neighbors.size(); ++i) {
+            if (neighbors[i] != u) {
+                dyn.addArc(u, neighbors[i], weights[i], -1);
+            }
+        }
+    }
+    
+    WitnessSearch search(n);
+    std::vector<int> deletedNeighbors(n, 0);
+    
+    // Приоритет: разность рёбер + число уже сжатых соседей (равномерность)
+    auto priority = [&](int v, const std::vector<Shortcut>& shortcuts) {
+        int removed = static_cast<int>(dyn.in[v].size() + dyn.out[v].size());
+        return static_cast<int>(shortcuts.size()) - removed + deletedNeighbors[v];
+    };
+    
+    auto cancelled = [cancel] { return cancel && cancel->load(std::memory_order_relaxed); };
+    
+    using Item = std::pair<int, int>;
+    std::priority_queue<Item, std::vector<Item>, std::greater<Item>> queue;
+    for (int v = 0; v < n; ++v) {
+        if ((v & 255) == 0 && cancelled()) return ch;
+        queue.push({priority(v, findShortcuts(dyn, v, search)), v});
+    }
+    
+    std::vector<std::vector<Arc>> up(n), down(n);
+    int order = 0;
+    while (!queue.empty()) {
+        if ((order & 255) == 0 && cancelled()) return ch;
+        int v = queue.top().second;
+        queue.pop();
+        if (dyn.contracted[v]) continue;
+        
+        // Ленивое обновление: если приоритет вырос, вернуть в очередь
+        auto shortcuts = findShortcuts(dyn, v, search);
+        int current = priority(v, shortcuts);
+        if (!queue.empty() && current > queue.top().first) {
+            queue.push({current, v});
+            continue;
+        }
+        
+        // Оставшиеся соседи старше v по рангу: зафиксировать дуги иерархии
+        for (const auto& arc : dyn.out[v]) {
+            up[v].push_back({arc.to, arc.weight, arc.middle});
+        }
+        for (const auto& arc : dyn.in[v]) {
+            down[v].push_back({arc.to, arc.weight, arc.middle});
+        }
+        
+        ch.rank_[v] = order++;
+        dyn.contracted[v] = 1;
+        
+        // Убрать v из списков соседей
+        for (const auto& arc : dyn.out[v]) {
+            auto& back = dyn.in[arc.to];
+            back.erase(std::remove_if(back.begin(), back.end(),
+                [v](const DynamicArc& a) { return a.to == v; }), back.end());
+            deletedNeighbors[arc.to]++;
+        }
+        for (const auto& arc : dyn.in[v]) {
+            auto& forward = dyn.out[arc.to];
+            forward.erase(std::remove_if(forward.begin(), forward.end(),
+                [v](const DynamicArc& a) { return a.to == v; }), forward.end());
+            deletedNeighbors[arc.to]++;
+        }
+        
+        for (const auto& shortcut : shortcuts) {
+            if (dyn.addArc(shortcut.from, shortcut.to, shortcut.weight, v)) {
+                ch.shortcutCount_++;
+            }
+        }
+
+    }
+    
+    // Упаковать в CSR
+    auto pack = [n](const std::vector<std::vector<Arc>>& lists, std::vector<size_t>& offsets, std::vector<Arc>& arcs) {
+        offsets.assign(n + 1, 0);
+        for (int v = 0; v < n; ++v) {
+            offsets[v + 1] = offsets[v] + lists[v].size();
+        }
+        arcs.reserve(offsets[n]);
+        for (const auto& list : lists) {
+            arcs.insert(arcs.end(), list.begin(), list.end());
+        }
+    };
+    pack(up, ch.upOffsets_, ch.upArcs_);
+    pack(down, ch.downOffsets_, ch.downArcs_);
+    
+    return ch;
+}
+
+ContractionHierarchy::Result ContractionHierarchy::query(int source, int target) const {
+    Result result{kInf, {}, {}};
+    if (source < 0 || target < 0 || source >= vertexCount_ || target >= vertexCount_) {
+        return result;
+    }
+    
+    // Рабочие массивы размера n переиспользуются между запросами потока;
+    // после запроса сбрасываются только затронутые вершины
+    struct Scratch {
+        std::vector<double> dist[2];
+        std::vector<int> parent[2];
+        std::vector<int> middle[2];
+        std::vector<int> touched;
+    };
+    thread_local Scratch scratch;
+    if (static_cast<int>(scratch.dist[0].size()) != vertexCount_) {
+        for (int s = 0; s < 2; ++s) {
+            scratch.dist[s].assign(vertexCount_, kInf);
+            scratch.parent[s].assign(vertexCount_, -1);
+            scratch.middle[s].assign(vertexCount_, -1);
+        }
+    }
+    auto& dist = scratch.dist;
+    auto& parent = scratch.parent;
+    auto& middle = scratch.middle;
+    auto& touched = scratch.touched;
+    
+    // Поиск только по дугам вверх: прямой - upArcs_, обратный - downArcs_.
+    // Дуги противоположного списка нужны для stall-on-demand: вершина не
+    // расширяется, если до неё есть более короткий путь через старшую вершину
+    const std::vector<size_t>* offsets[2] = {&upOffsets_, &downOffsets_};
+    const std::vector<Arc>* arcs[2] = {&upArcs_, &downArcs_};
+    
+    using Item = std::pair<double, int>;
+    std::priority_queue<Item, std::vector<Item>, std::greater<Item>> heap[2];
+    
+    dist[0][source] = 0.0;
+    dist[1][target] = 0.0;
+    touched.push_back(source);
+    touched.push_back(target);
+    heap[0].push({0.0, source});
+    heap[1].push({0.0, target});
+    
+    int meet = -1;
+    double best = kInf;
+    int side = 0;
+    while (!heap[0].empty() || !heap[1].empty()) {
+        // Направление прекращается, когда его минимум не меньше найденного пути
+        for (int s = 0; s < 2; ++s) {
+            if (!heap[s].empty() && heap[s].top().first >= best) {
+                heap[s] = {};
+            }
+        }
+        if (heap[side].empty()) {
+            side = 1 - side;
+            continue;
+        }
+        
+        auto [d, u] = heap[side].top();
+        heap[side].pop();
+        if (d > dist[side][u]) {
+            side = 1 - side;
+            continue;
+        }
+        result.settled.push_back(u);
+        
+        if (dist[1 - side][u] < kInf && d + dist[1 - side][u] < best) {
+            best = d + dist[1 - side][u];
+            meet = u;
+        }
+        
+        bool stalled = false;
+        const auto& opposite = *arcs[1 - side];
+        for (size_t e = (*offsets[1 - side])[u]; e < (*offsets[1 - side])[u + 1]; ++e) {
+            if (dist[side][opposite[e].to] + opposite[e].weight < d) {
+                stalled = true;
+                break;
+            }
+        }
+        
+        if (!stalled) {
+            for (size_t e = (*offsets[side])[u]; e < (*offsets[side])[u + 1]; ++e) {
+                const Arc& arc = (*arcs[side])[e];
+                double alt = d + arc.weight;
+                if (alt < dist[side][arc.to]) {
+                    if (dist[0][arc.to] == kInf && dist[1][arc.to] == kInf) {
+                        touched.push_back(arc.to);
+                    }
+                    dist[side][arc.to] = alt;
+                    parent[side][arc.to] = u;
+                    middle[side][arc.to] = arc.middle;
+                    heap[side].push({alt, arc.to});
+                }
+            }
+        }
+        side = 1 - side;
+    }
+    
+    // Цепочка дуг иерархии source -> meet -> target
+    struct HierarchyArc { int from; int to; int middle; };
+    std::vector<HierarchyArc> chain;
+    if (meet != -1) {
+        for (int v = meet; v != source; v = parent[0][v]) {
+            chain.push_back({parent[0][v], v, middle[0][v]});
+        }
+        std::reverse(chain.begin(), chain.end());
+        for (int v = meet; v != target; v = parent[1][v]) {
+            chain.push_back({v, parent[1][v], middle[1][v]});
+        }
+    }
+    
+    for (int v : touched) {
+        for (int s = 0; s < 2; ++s) {
+            dist[s][v] = kInf;
+            parent[s][v] = -1;
+            middle[s][v] = -1;
+        }
+    }
+    touched.clear();
+    
+    if (meet == -1) {
+        return result;
+    }
+    result.distance = best;
+    
+    result.path.push_back(source);
+    for (const auto& arc : chain) {
+        unpack(arc.from, arc.to, arc.middle, result.path);
+    }
+    return result;
+}
+
+const ContractionHierarchy::Arc* ContractionHierarchy::findUp(int from, int to) const {
+    for (size_t e = upOffsets_[from]; e < upOffsets_[from + 1]; ++e) {
+        if (upArcs_[e].to == to) return &upArcs_[e];
+    }
+    return nullptr;
+}
+
+const ContractionHierarchy::Arc* ContractionHierarchy::findDown(int at, int from) const {
+    for (size_t e = downOffsets_[at]; e < downOffsets_[at + 1]; ++e) {
+        if (downArcs_[e].to == from) return &downArcs_[e];
+    }
+    return nullptr;
+}
+
+void ContractionHierarchy::unpack(int from, int to, int middle, std::vector<int>& out) const {
+    // Шорткат from -> to через middle раскрывается в from -> middle (дуга вниз,
+    // хранится у middle) и middle -> to (дуга вверх от middle); явный стек
+    // вместо рекурсии, т.к. вложенность шорткатов может быть глубокой
+    struct Pending { int from; int to; int middle; };
+    std::vector<Pending> stack{{from, to, middle}};
+    while (!stack.empty()) {
+        Pending arc = stack.back();
+        stack.pop_back();
+        if (arc.middle == -1) {
+            out.push_back(arc.to);
+            continue;
+        }
+        const Arc* second = findUp(arc.middle, arc.to);
+        const Arc* first = findDown(arc.middle, arc.from);
+        stack.push_back({arc.middle, arc.to, second ? second->middle : -1});
+        stack.push_back({arc.from, arc.middle, first ? first->middle : -1});
+    }
+}
+
+} // namespace graph
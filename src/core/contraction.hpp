@@ -0,0 +1,64 @@
+#pragma once
+
+#include "core/csr.hpp"
+#include <atomic>
+#include <vector>
+#include <cstdint>
+
+namespace graph {
+
+// Иерархия сжатия (contraction hierarchies) для точных кратчайших путей
+// на статическом взвешенном графе. Вершины сжимаются в порядке разности
+// рёбер (edge difference); при сжатии добавляются шорткаты, сохраняющие
+// расстояния. Запрос - двунаправленный Dijkstra только "вверх" по рангу
+class ContractionHierarchy {
+public:
+    struct Result {
+        double distance;
+        std::vector<int> path;     // плотные индексы, шорткаты развёрнуты
+        std::vector<int> settled;  // вершины, извлечённые из очередей
+    };
+    
+    // Предобработка: порядок сжатия, шорткаты, восходящий/нисходящий CSR.
+    // Флаг cancel проверяется между этапами и по ходу сжатия; прерванная
+    // иерархия неполна и должна быть отброшена
+    static ContractionHierarchy build(const CSRGraph& g, const std::atomic<bool>* cancel = nullptr);
+    
+    // Запрос по плотным индексам (потокобезопасен: рабочие массивы у каждого потока свои)
+    Result query(int source, int target) const;
+    
+    bool matches(const CSRGraph& g) const {
+        return vertexCount_ == g.size() && fingerprint_ == g.fingerprint();
+    }
+    
+    int vertexCount() const { return vertexCount_; }
+    size_t shortcutCount() const { return shortcutCount_; }
+    int rankOf(int v) const { return rank_[v]; }
+    
+private:
+    // Дуга иерархии; middle - сжатая вершина шортката или -1 для исходного ребра
+    struct Arc {
+        int to;
+        double weight;
+        int middle;
+    };
+    
+    int vertexCount_ = 0;
+    uint64_t fingerprint_ = 0;
+    size_t shortcutCount_ = 0;
+    std::vector<int> rank_;
+    
+    // upArcs_: дуги v -> w с rank[w] > rank[v] (прямой поиск)
+    // downArcs_: дуги u -> v с rank[u] > rank[v], хранятся у v как (u, ...)
+    // (обратный поиск от цели идёт по ним вверх)
+    std::vector<size_t> upOffsets_;
+    std::vector<Arc> upArcs_;
+    std::vector<size_t> downOffsets_;
+    std::vector<Arc> downArcs_;
+    
+    const Arc* findUp(int from, int to) const;
+    const Arc* findDown(int at, int from) const;
+    void unpack(int from, int to, int middle, std::vector<int>& out) const;
+};
+
+} // namespace graph
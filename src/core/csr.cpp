@@ -0,0 +1,198 @@
+#include "core/csr.hpp"
+#include <algorithm>
+#include <cstring>
+#include <bit>
+
+namespace graph {
+
+namespace {
+
+constexpr uint64_t kPrime1 = 0x9e3779b185ebca87ull;
+constexpr uint64_t kPrime2 = 0xc2b2ae3d27d4eb4full;
+constexpr uint64_t kPrime3 = 0x165667b19e3779f9ull;
+constexpr uint64_t kPrime4 = 0x85ebca77c2b2ae63ull;
+constexpr uint64_t kPrime5 = 0x27d4eb2f165667c5ull;
+
+uint64_t hashRound(uint64_t acc, uint64_t input) {
+    acc += input * kPrime2;
+    acc = std::rotl(acc, 31);
+    return acc * kPrime1;
+}
+
+uint64_t hashMerge(uint64_t acc, uint64_t lane) {
+    acc ^= hashRound(0, lane);
+    return acc * kPrime1 + kPrime4;
+}
+
+// Слова читаются полосами по 4: каждая полоса - независимая цепочка
+// умножений, и процессор ведёт их параллельно
+uint64_t hashWords(const std::vector<uint64_t>& words) {
+    size_t count = words.size();
+    size_t i = 0;
+    uint64_t hash;
+    if (count >= 4) {
+        uint64_t lanes[4] = {kPrime1 + kPrime2, kPrime2, 0, 0 - kPrime1};
+        for (; i + 4 <= count; i += 4) {
+            for (int lane = 0; lane < 4; ++lane) lanes[lane] = hashRound(lanes[lane], words[i + lane]);
+        }
+        hash = std::rotl(lanes[0], 1) + std::rotl(lanes[1], 7) + std::rotl(lanes[2], 12) + std::rotl(lanes[3], 18);
+        for (uint64_t lane : lanes) hash = hashMerge(hash, lane);
+    } else {
+        hash = kPrime5;
+    }
+    hash += count * 8;
+    for (; i < count; ++i) {
+        hash ^= hashRound(0, words[i]);
+        hash = std::rotl(hash, 27) * kPrime1 + kPrime4;
+    }
+    hash ^= hash >> 33;
+    hash *= kPrime2;
+    hash ^= hash >> 29;
+    hash *= kPrime3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+} // namespace
+
+CSRGraph CSRGraph::fromGraph(const Graph& g) {
+    CSRGraph csr;
+    csr.directed = g.isDirected();
+    
+    // Под одной блокировкой графа, в его плотной нумерации: индексы концов
+    // дуг уже посчитаны графом
+    size_t n = g.getVertexCount();
+    csr.ids.reserve(n);
+    csr.index.reserve(n);
+    csr.offsets.reserve(n + 1);
+    csr.offsets.push_back(0);
+    g.forEachAdjacency([&](int id, const EdgeList& edges) {
+        csr.index[id] = static_cast<int>(csr.ids.size());
+        csr.ids.push_back(id);
+        for (const auto& edge : edges) {
+            csr.targets.push_back(edge.toIndex);
+            csr.weights.push_back(edge.weight);
+        }
+        csr.offsets.push_back(csr.targets.size());
+    });
+    
+    return csr;
+}
+
+CSRGraph CSRGraph::transposed() const {
+    if (!directed) {
+        return *this;
+    }
+    
+    CSRGraph t;
+    t.directed = true;
+    t.ids = ids;
+    t.index = index;
+    
+    int n = size();
+    t.offsets.assign(n + 1, 0);
+    for (int target : targets) {
+        t.offsets[target + 1]++;
+    }
+    for (int v = 0; v < n; ++v) {
+        t.offsets[v + 1] += t.offsets[v];
+    }
+    
+    t.targets.resize(targets.size());
+    t.weights.resize(weights.size());
+    std::vector<size_t> fill(t.offsets.begin(), t.offsets.end() - 1);
+    for (int u = 0; u < n; ++u) {
+        for (size_t e = offsets[u]; e < offsets[u + 1]; ++e) {
+            size_t pos = fill[targets[e]]++;
+            t.targets[pos] = u;
+            t.weights[pos] = weights[e];
+        }
+    }
+    return t;
+}
+
+int CSRGraph::indexOf(int id) const {
+    auto it = index.find(id);
+    return it != index.end() ? it->second : -1;
+}
+
+uint64_t CSRGraph::fingerprint() const {
+    // FNV-1a по 64-битным словам
+    uint64_t hash = 1469598103934665603ull;
+    auto mix = [&hash](uint64_t value) {
+        hash ^= value;
+        hash *= 1099511628211ull;
+    };
+    mix(static_cast<uint64_t>(size()));
+    mix(directed ? 1 : 0);
+    for (int id : ids) mix(static_cast<uint64_t>(static_cast<uint32_t>(id)));
+    for (size_t offset : offsets) mix(offset);
+    for (int target : targets) mix(static_cast<uint64_t>(target));
+    for (double weight : weights) {
+        uint64_t bits;
+        std::memcpy(&bits, &weight, sizeof(bits));
+        mix(bits);
+    }
+    return hash;
+}
+
+uint64_t CSRGraph::contentHash() const {
+    auto word = [](int id) { return static_cast<uint64_t>(static_cast<uint32_t>(id)); };
+    std::vector<uint64_t> words;
+    words.reserve(2 + ids.size() + 2 * targets.size());
+    words.push_back(static_cast<uint64_t>(size()));
+    words.push_back(directed ? 1 : 0);
+    size_t idsBegin = words.size();
+    for (int id : ids) words.push_back(word(id));
+    std::sort(words.begin() + idsBegin, words.end());
+    
+    std::vector<std::pair<uint64_t, uint64_t>> arcs;
+    arcs.reserve(targets.size());
+    for (int u = 0; u < size(); ++u) {
+        for (size_t e = offsets[u]; e < offsets[u + 1]; ++e) {
+            int from = ids[u], to = ids[targets[e]];
+            if (!directed && to < from) std::swap(from, to);
+            uint64_t bits;
+            std::memcpy(&bits, &weights[e], sizeof(bits));
+            arcs.emplace_back(word(from) << 32 | word(to), bits);
+        }
+    }
+    std::sort(arcs.begin(), arcs.end());
+    for (const auto& [ends, bits] : arcs) {
+        words.push_back(ends);
+        words.push_back(bits);
+    }
+    return hashWords(words);
+}
+
+CSRGraph CSRGraph::simplified() const {
+    int n = size();
+    std::vector<std::vector<std::pair<int, double>>> lists(n);
+    for (int u = 0; u < n; ++u) {
+        for (size_t e = offsets[u]; e < offsets[u + 1]; ++e) {
+            int v = targets[e];
+            if (u == v) continue;
+            lists[u].emplace_back(v, weights[e]);
+            if (directed) lists[v].emplace_back(u, weights[e]);
+        }
+    }
+    
+    CSRGraph s;
+    s.directed = false;
+    s.ids = ids;
+    s.index = index;
+    s.offsets.reserve(n + 1);
+    s.offsets.push_back(0);
+    for (auto& arcs : lists) {
+        std::sort(arcs.begin(), arcs.end());
+        for (size_t i = 0; i < arcs.size(); ++i) {
+            if (i > 0 && arcs[i].first == arcs[i - 1].first) continue;
+            s.targets.push_back(arcs[i].first);
+            s.weights.push_back(arcs[i].second);
+        }
+        s.offsets.push_back(s.targets.size());
+    }
+    return s;
+}
+
+} // namespace graph
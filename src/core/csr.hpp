@@ -0,0 +1,55 @@
+#pragma once
+
+#include "core/graph.hpp"
+#include <vector>
+#include <span>
+#include <unordered_map>
+#include <cstddef>
+#include <cstdint>
+
+namespace graph {
+
+// Компактное CSR-представление графа: вершины пронумерованы плотно 0..n-1,
+// соседи вершины v лежат в targets[offsets[v] .. offsets[v + 1])
+struct CSRGraph {
+    bool directed = false;
+    std::vector<int> ids;                // плотный индекс -> внешний ID
+    std::unordered_map<int, int> index;  // внешний ID -> плотный индекс
+    std::vector<size_t> offsets;
+    std::vector<int> targets;
+    std::vector<double> weights;
+    
+    // Построить снимок графа (вершины - в плотной нумерации графа)
+    static CSRGraph fromGraph(const Graph& g);
+    
+    // Граф с обращёнными дугами (для неориентированного графа совпадает с исходным)
+    CSRGraph transposed() const;
+    
+    // Простой неориентированный граф: без петель и кратных дуг, соседи
+    // отсортированы по возрастанию, вес кратных дуг - минимальный
+    CSRGraph simplified() const;
+    
+    int size() const { return static_cast<int>(ids.size()); }
+    size_t arcCount() const { return targets.size(); }
+    int indexOf(int id) const;
+    
+    // Отпечаток структуры: вершины, дуги и веса (для проверки предвычислений)
+    uint64_t fingerprint() const;
+    
+    // Отпечаток содержимого, не зависящий от плотной нумерации: ID вершин и
+    // дуги (ID, ID, вес) по возрастанию, у неориентированного графа - меньший
+    // ID первым. Хеш в духе XXH64 по 64-битным словам, четыре полосы
+    uint64_t contentHash() const;
+    
+    int degree(int v) const {
+        return static_cast<int>(offsets[v + 1] - offsets[v]);
+    }
+    std::span<const int> neighbors(int v) const {
+        return {targets.data() + offsets[v], targets.data() + offsets[v + 1]};
+    }
+    std::span<const double> neighborWeights(int v) const {
+        return {weights.data() + offsets[v], weights.data() + offsets[v + 1]};
+    }
+};
+
+} // namespace graph
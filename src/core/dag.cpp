@@ -0,0 +1,324 @@
+#include "core/dag.hpp"
+#include "core/parallel.hpp"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+
+namespace graph {
+
+namespace {
+
+// Уровень Кана меньше этого обрабатывается в текущем потоке
+constexpr size_t kParallelLevel = 1024;
+
+// Ширина блока столбцов при поиске лишних дуг: строка блока - 256 байт
+constexpr int kBlockBits = 2048;
+
+// Достижимость столбцов [lo, hi) из компонент 0..hi-1. Компоненты с
+// номером от hi не достигают этих столбцов (дуги идут к большим номерам),
+// а строки есть только у компонент, достигающих хотя бы одного столбца:
+// в разреженной иерархии таких немного, и блок стоит O(hi + E), а не
+// O(hi * words)
+void reachBlock(const Condensation& cd, int lo, int hi, ReachRows& reach) {
+    size_t words = (static_cast<size_t>(hi - lo) + 63) / 64;
+    reach.words = words;
+    reach.slot.assign(hi, -1);
+    reach.bits.clear();
+    for (int c = hi - 1; c >= 0; --c) {
+        for (int d : cd.successors(c)) {
+            if (d >= hi) break;
+            bool direct = d >= lo;
+            int sub = reach.slot[d];
+            if (!direct && sub < 0) continue;
+            if (reach.slot[c] < 0) {
+                reach.slot[c] = static_cast<int>(reach.bits.size() / words);
+                reach.bits.resize(reach.bits.size() + words, 0);
+            }
+            uint64_t* row = reach.bits.data() + reach.slot[c] * words;
+            if (sub >= 0) {
+                const uint64_t* from = reach.bits.data() + sub * words;
+                for (size_t w = 0; w < words; ++w) row[w] |= from[w];
+            }
+            if (direct) row[(d - lo) / 64] |= uint64_t{1} << ((d - lo) % 64);
+        }
+    }
+}
+
+} // namespace
+
+std::optional<TransitiveClosure> TransitiveClosure::build(const CSRGraph& g, int limit) {
+    TransitiveClosure closure;
+    closure.condensation_ = Dag::condense(g);
+    if (closure.condensation_.count() > limit) {
+        return std::nullopt;
+    }
+    reachBlock(closure.condensation_, 0, closure.condensation_.count(), closure.reach_);
+    return closure;
+}
+
+bool TransitiveClosure::reaches(int u, int v) const {
+    int cu = condensation_.component[u];
+    int cv = condensation_.component[v];
+    if (cu == cv) return true;
+    const uint64_t* row = reach_.row(cu);
+    return row && ((row[cv / 64] >> (cv % 64)) & 1u);
+}
+
+size_t TransitiveClosure::reachablePairs() const {
+    size_t pairs = 0;
+    for (uint64_t word : reach_.bits) pairs += std::popcount(word);
+    return pairs;
+}
+
+TopologicalOrder Dag::topologicalSort(const CSRGraph& g, size_t numThreads) {
+    int n = g.size();
+    TopologicalOrder result;
+    result.level.assign(n, -1);
+    result.order.reserve(n);
+
+    std::vector<std::atomic<int>> indegree(n);
+    for (int target : g.targets) {
+        indegree[target].fetch_add(1, std::memory_order_relaxed);
+    }
+    std::vector<int> frontier;
+    for (int v = 0; v < n; ++v) {
+        if (indegree[v].load(std::memory_order_relaxed) == 0) frontier.push_back(v);
+    }
+
+    numThreads = std::max<size_t>(1, numThreads);
+    std::optional<ThreadPool> pool;
+    if (numThreads > 1) pool.emplace(numThreads);
+    std::vector<std::vector<int>> next(numThreads);
+
+    // Вершину освобождает тот поток, который снял её последнюю входящую дугу
+    auto release = [&](size_t part, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            for (int u : g.neighbors(frontier[i])) {
+                if (indegree[u].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    next[part].push_back(u);
+                }
+            }
+        }
+    };
+
+    for (int level = 0; !frontier.empty(); ++level) {
+        for (int v : frontier) {
+            result.level[v] = level;
+            result.order.push_back(v);
+        }
+        if (pool && frontier.size() >= kParallelLevel) {
+            pool->parallelFor(frontier.size(), release);
+        } else {
+            release(0, 0, frontier.size());
+        }
+        frontier.clear();
+        for (auto& part : next) {
+            frontier.insert(frontier.end(), part.begin(), part.end());
+            part.clear();
+        }
+        std::sort(frontier.begin(), frontier.end());
+    }
+
+    result.acyclic = static_cast<int>(result.order.size()) == n;
+    return result;
+}
+
+Condensation Dag::condense(const CSRGraph& g) {
+    int n = g.size();
+    std::vector<int> index(n, -1), low(n, 0), found(n, -1);
+    std::vector<int> stack;
+    struct Frame {
+        int vertex;
+        size_t next;
+    };
+    std::vector<Frame> calls;
+    int counter = 0, components = 0;
+
+    for (int root = 0; root < n; ++root) {
+        if (index[root] != -1) continue;
+        index[root] = low[root] = counter++;
+        stack.push_back(root);
+        calls.push_back({root, g.offsets[root]});
+        while (!calls.empty()) {
+            Frame& frame = calls.back();
+            int v = frame.vertex;
+            if (frame.next < g.offsets[v + 1]) {
+                int u = g.targets[frame.next++];
+                if (index[u] == -1) {
+                    index[u] = low[u] = counter++;
+                    stack.push_back(u);
+                    calls.push_back({u, g.offsets[u]});
+                } else if (found[u] == -1) {
+                    low[v] = std::min(low[v], index[u]);
+                }
+                continue;
+            }
+            calls.pop_back();
+            if (!calls.empty()) {
+                int parent = calls.back().vertex;
+                low[parent] = std::min(low[parent], low[v]);
+            }
+            if (low[v] == index[v]) {
+                int u;
+                do {
+                    u = stack.back();
+                    stack.pop_back();
+                    found[u] = components;
+                } while (u != v);
+                ++components;
+            }
+        }
+    }
+
+    // Тарьян находит компоненты от стоков к истокам: обратить номера
+    Condensation cd;
+    cd.component.resize(n);
+    cd.sizes.assign(components, 0);
+    for (int v = 0; v < n; ++v) {
+        cd.component[v] = components - 1 - found[v];
+        ++cd.sizes[cd.component[v]];
+    }
+
+    // Вершины по компонентам (подсчётом), затем дуги без повторов
+    std::vector<size_t> start(components + 1, 0);
+    for (int v = 0; v < n; ++v) ++start[cd.component[v] + 1];
+    for (int c = 0; c < components; ++c) start[c + 1] += start[c];
+    std::vector<int> members(n);
+    std::vector<size_t> fill(start.begin(), start.end() - 1);
+    for (int v = 0; v < n; ++v) members[fill[cd.component[v]]++] = v;
+
+    std::vector<int> seen(components, -1);
+    std::vector<std::pair<int, std::pair<int, int>>> out;
+    cd.offsets.reserve(components + 1);
+    cd.offsets.push_back(0);
+    for (int c = 0; c < components; ++c) {
+        out.clear();
+        for (size_t i = start[c]; i < start[c + 1]; ++i) {
+            int u = members[i];
+            for (int v : g.neighbors(u)) {
+                int d = cd.component[v];
+                if (d != c && seen[d] != c) {
+                    seen[d] = c;
+                    out.push_back({d, {u, v}});
+                }
+            }
+        }
+        std::sort(out.begin(), out.end());
+        for (const auto& [d, arc] : out) {
+            cd.targets.push_back(d);
+            cd.arcs.push_back(arc);
+        }
+        cd.offsets.push_back(cd.targets.size());
+    }
+    return cd;
+}
+
+std::vector<int> Dag::longestPathLayers(const Condensation& cd) {
+    std::vector<int> layer(cd.count(), 0);
+    for (int c = 0; c < cd.count(); ++c) {
+        for (int d : cd.successors(c)) {
+            layer[d] = std::max(layer[d], layer[c] + 1);
+        }
+    }
+    return layer;
+}
+
+std::vector<int> Dag::findCycle(const CSRGraph& g) {
+    int n = g.size();
+    for (int v = 0; v < n; ++v) {
+        for (int u : g.neighbors(v)) {
+            if (u == v) return {v};
+        }
+    }
+
+    // В компоненте сильной связности из нескольких вершин у каждой есть
+    // преемник в той же компоненте: идти по ним до повтора
+    Condensation cd = condense(g);
+    for (int v = 0; v < n; ++v) {
+        int c = cd.component[v];
+        if (cd.sizes[c] < 2) continue;
+        std::vector<int> position(n, -1);
+        std::vector<int> path;
+        while (position[v] == -1) {
+            position[v] = static_cast<int>(path.size());
+            path.push_back(v);
+            for (int u : g.neighbors(v)) {
+                if (cd.component[u] == c) {
+                    v = u;
+                    break;
+                }
+            }
+        }
+        return std::vector<int>(path.begin() + position[v], path.end());
+    }
+    return {};
+}
+
+std::vector<std::pair<int, int>> Dag::transitiveReduction(const CSRGraph& g, size_t numThreads) {
+    Condensation cd = condense(g);
+    std::vector<std::pair<int, int>> result;
+    for (int u = 0; u < g.size(); ++u) {
+        for (int v : g.neighbors(u)) {
+            if (u != v && cd.component[u] == cd.component[v]) result.emplace_back(u, v);
+        }
+    }
+
+    // Дуга c -> d лишняя, если d достижима из другого преемника c; у
+    // компоненты с одним преемником лишних дуг нет. Столбец d лежит в одном
+    // блоке, поэтому блоки пишут разные флаги
+    int count = cd.count();
+    size_t blocks = (static_cast<size_t>(count) + kBlockBits - 1) / kBlockBits;
+    std::vector<std::vector<int>> sources(blocks);
+    for (int c = 0; c < count; ++c) {
+        if (cd.successors(c).size() < 2) continue;
+        size_t last = blocks;
+        for (int d : cd.successors(c)) {
+            size_t block = d / kBlockBits;
+            if (block != last) sources[block].push_back(c);
+            last = block;
+        }
+    }
+
+    std::vector<char> redundant(cd.targets.size(), 0);
+    auto scan = [&](size_t, size_t begin, size_t end) {
+        ReachRows reach;
+        std::vector<uint64_t> covered;
+        for (size_t block = begin; block < end; ++block) {
+            if (sources[block].empty()) continue;
+            int lo = static_cast<int>(block) * kBlockBits;
+            int hi = std::min(count, lo + kBlockBits);
+            reachBlock(cd, lo, hi, reach);
+            for (int c : sources[block]) {
+                covered.assign(reach.words, 0);
+                auto successors = cd.successors(c);
+                for (int d : successors) {
+                    if (d >= hi) break;
+                    if (const uint64_t* row = reach.row(d)) {
+                        for (size_t w = 0; w < reach.words; ++w) covered[w] |= row[w];
+                    }
+                }
+                for (size_t i = 0; i < successors.size(); ++i) {
+                    int column = successors[i] - lo;
+                    if (column < 0 || successors[i] >= hi) continue;
+                    if ((covered[column / 64] >> (column % 64)) & 1u) {
+                        redundant[cd.offsets[c] + i] = 1;
+                    }
+                }
+            }
+        }
+    };
+    numThreads = std::max<size_t>(1, numThreads);
+    if (numThreads > 1 && blocks > 1) {
+        ThreadPool pool(numThreads);
+        pool.parallelFor(blocks, scan);
+    } else {
+        scan(0, 0, blocks);
+    }
+
+    for (size_t e = 0; e < cd.targets.size(); ++e) {
+        if (!redundant[e]) result.push_back(cd.arcs[e]);
+    }
+    return result;
+}
+
+} // namespace graph
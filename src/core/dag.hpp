@@ -0,0 +1,92 @@
+#pragma once
+
+#include "core/csr.hpp"
+#include <vector>
+#include <span>
+#include <optional>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+
+namespace graph {
+
+// Топологический порядок по уровням алгоритма Кана
+struct TopologicalOrder {
+    std::vector<int> order;  // плотные индексы CSR; при цикле - без вершин на циклах и после них
+    std::vector<int> level;  // длина самого длинного пути в вершину, -1 - не упорядочена
+    bool acyclic = false;
+};
+
+// Граф компонент сильной связности. Компоненты пронумерованы в
+// топологическом порядке: дуги идут от меньшего номера к большему
+struct Condensation {
+    std::vector<int> component;      // плотный индекс -> компонента
+    std::vector<int> sizes;          // число вершин компоненты
+    std::vector<size_t> offsets;     // дуги между компонентами без повторов, как в CSR;
+    std::vector<int> targets;        // преемники отсортированы по возрастанию
+    std::vector<std::pair<int, int>> arcs;  // исходная дуга (u, v), давшая каждую из них
+
+    int count() const { return static_cast<int>(sizes.size()); }
+    std::span<const int> successors(int c) const {
+        return {targets.data() + offsets[c], targets.data() + offsets[c + 1]};
+    }
+};
+
+// Строки достижимости по битам: строки есть только у непустых
+struct ReachRows {
+    size_t words = 0;
+    std::vector<int> slot;        // компонента -> номер строки, -1 - пустая
+    std::vector<uint64_t> bits;
+
+    const uint64_t* row(int c) const { return slot[c] < 0 ? nullptr : bits.data() + slot[c] * words; }
+};
+
+// Транзитивное замыкание по сжатому графу: строка битов на компоненту
+// (бит d в строке c - из c достижима d). Память - до count^2 / 8 байт,
+// поэтому строится только до limit компонент
+class TransitiveClosure {
+public:
+    static constexpr int kDefaultLimit = 20000;
+
+    static std::optional<TransitiveClosure> build(const CSRGraph& g, int limit = kDefaultLimit);
+
+    // Достижима ли v из u (плотные индексы; вершина достижима из себя)
+    bool reaches(int u, int v) const;
+
+    const Condensation& condensation() const { return condensation_; }
+    size_t reachablePairs() const;  // пар компонент (c, d), c != d, d достижима из c
+    size_t memoryBytes() const { return reach_.bits.size() * sizeof(uint64_t); }
+
+private:
+    Condensation condensation_;
+    ReachRows reach_;
+};
+
+// Инструменты для ориентированных графов (иерархии графов знаний вроде
+// subtopic_of). Вершины - плотные индексы CSR; неориентированное ребро
+// считается двумя дугами, то есть циклом
+class Dag {
+public:
+    // Кан по уровням: вершины уровня обрабатываются параллельно, счётчики
+    // входящих дуг уменьшаются атомарно; уровень сортируется, поэтому порядок
+    // не зависит от числа потоков
+    static TopologicalOrder topologicalSort(const CSRGraph& g, size_t numThreads = 4);
+
+    // Компоненты сильной связности (Тарьян с явным стеком)
+    static Condensation condense(const CSRGraph& g);
+
+    // Слой каждой компоненты - длина самого длинного пути в неё
+    static std::vector<int> longestPathLayers(const Condensation& condensation);
+
+    // Цикл-свидетель v0 -> v1 -> ... -> vk -> v0 (петля - одна вершина);
+    // пусто, если граф ацикличен
+    static std::vector<int> findCycle(const CSRGraph& g);
+
+    // Транзитивное сокращение: дуги внутри компонент сильной связности
+    // (кроме петель) и дуги между компонентами, не выводимые через другие.
+    // Лишние дуги ищутся битовыми строками по блокам столбцов, блоки -
+    // параллельно, поэтому память - O(count) на поток
+    static std::vector<std::pair<int, int>> transitiveReduction(const CSRGraph& g, size_t numThreads = 4);
+};
+
+} // namespace graph
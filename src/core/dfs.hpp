@@ -0,0 +1,81 @@
+#pragma once
+
+#include "core/subgraph.hpp"
+#include <vector>
+#include <iterator>
+#include <utility>
+
+namespace graph {
+
+// Плотный индекс соседа из элемента списка смежности: CSR хранит индексы,
+// граф - дуги с посчитанным toIndex
+inline int adjacentIndex(int target) { return target; }
+inline int adjacentIndex(const Edge& edge) { return edge.toIndex; }
+
+// Обход в глубину с явным стеком. Кадр - вершина и позиция в её списке
+// соседей, поэтому глубина ограничена памятью, а не стеком потока: путь
+// в 10 млн вершин - 10 млн кадров по 16 байт. Хуки - параметры шаблона и
+// вызываются напрямую, без std::function на каждую вершину.
+//
+// neighbors(v) возвращает диапазон соседей вершины с плотным индексом v
+// (span CSR или список дуг графа); диапазон должен оставаться верным до
+// конца обхода. Стек переиспользуется между запусками (компоненты
+// связности - запуск от каждой непосещённой вершины)
+template<typename Neighbors>
+class DepthFirst {
+public:
+    explicit DepthFirst(Neighbors neighbors) : neighbors_(std::move(neighbors)) {}
+
+    // Обход из start по непосещённым вершинам, visited отмечается.
+    // enter(v) - при входе в вершину (прямой порядок), false прерывает обход;
+    // leave(v) - после всех её потомков (обратный порядок). Возвращает
+    // false, если обход прерван
+    template<typename Enter, typename Leave>
+    bool run(int start, VertexMask& visited, Enter&& enter, Leave&& leave) {
+        if (visited.test(start)) return true;
+        visited.set(start);
+        if (!enter(start)) return false;
+        stack_.clear();
+        stack_.push_back({start, std::begin(neighbors_(start))});
+        while (!stack_.empty()) {
+            Frame& frame = stack_.back();
+            auto end = std::end(neighbors_(frame.vertex));
+            int next = -1;
+            while (frame.next != end) {
+                int u = adjacentIndex(*frame.next);
+                ++frame.next;
+                if (!visited.test(u)) {
+                    next = u;
+                    break;
+                }
+            }
+            if (next == -1) {
+                int v = frame.vertex;
+                stack_.pop_back();
+                leave(v);
+                continue;
+            }
+            visited.set(next);
+            if (!enter(next)) return false;
+            stack_.push_back({next, std::begin(neighbors_(next))});
+        }
+        return true;
+    }
+
+    template<typename Enter>
+    bool run(int start, VertexMask& visited, Enter&& enter) {
+        return run(start, visited, std::forward<Enter>(enter), [](int) {});
+    }
+
+private:
+    using Iterator = decltype(std::begin(std::declval<Neighbors&>()(0)));
+    struct Frame {
+        int vertex;
+        Iterator next;
+    };
+
+    Neighbors neighbors_;
+    std::vector<Frame> stack_;
+};
+
+} // namespace graph
@@ -0,0 +1,402 @@
+#include "core/distance_oracle.hpp"
+#include "core/algorithms.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <thread>
+#include <unordered_map>
+
+namespace graph {
+
+namespace {
+
+// Относительная погрешность округления double -> float
+constexpr double kRoundingSlack = 1.2e-7;
+
+constexpr char kOracleMagic[4] = {'K', 'G', 'D', 'O'};
+constexpr uint32_t kOracleVersion = 1;
+
+template<typename T>
+void writeValue(std::ofstream& file, const T& value) {
+    file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template<typename T>
+void writeArray(std::ofstream& file, const std::vector<T>& values) {
+    file.write(reinterpret_cast<const char*>(values.data()), static_cast<std::streamsize>(values.size() * sizeof(T)));
+}
+
+template<typename T>
+bool readValue(std::ifstream& file, T& value) {
+    return static_cast<bool>(file.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+template<typename T>
+bool readArray(std::ifstream& file, std::vector<T>& values, size_t count) {
+    values.resize(count);
+    return static_cast<bool>(file.read(reinterpret_cast<char*>(values.data()), static_cast<std::streamsize>(count * sizeof(T))));
+}
+
+// Предки из файла: в [-1, n) и без циклов по каждому ориентиру, иначе
+// approximatePath читает за пределами массивов или не заканчивает обход
+bool validParents(const std::vector<int32_t>& parent, size_t k, int n) {
+    for (int32_t p : parent) {
+        if (p < -1 || p >= n) return false;
+    }
+    // 0 - не пройдена, 1 - на текущей цепочке, 2 - цепочка без цикла
+    std::vector<uint8_t> state(static_cast<size_t>(n));
+    std::vector<int> chain;
+    for (size_t i = 0; i < k; ++i) {
+        std::fill(state.begin(), state.end(), 0);
+        for (int v = 0; v < n; ++v) {
+            chain.clear();
+            int x = v;
+            while (x != -1 && state[x] == 0) {
+                state[x] = 1;
+                chain.push_back(x);
+                x = parent[static_cast<size_t>(x) * k + i];
+            }
+            if (x != -1 && state[x] == 1) return false;
+            for (int y : chain) state[y] = 2;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+DistanceOracle DistanceOracle::build(const CSRGraph& g, size_t k, LandmarkStrategy strategy, ThreadPool& pool,
+                                     const std::atomic<bool>* cancel) {
+    DistanceOracle oracle;
+    int n = g.size();
+    oracle.vertexCount_ = n;
+    oracle.directed_ = g.directed;
+    oracle.fingerprint_ = g.fingerprint();
+    k = std::min(k, static_cast<size_t>(n));
+    if (k == 0) return oracle;
+    auto cancelled = [cancel] { return cancel && cancel->load(std::memory_order_relaxed); };
+    // Прерванное построение: результат без ориентиров
+    auto abandon = [&oracle] {
+        oracle.landmarks_.clear();
+        return std::move(oracle);
+    };
+    
+    CSRGraph reverse;
+    if (g.directed) {
+        reverse = g.transposed();
+    }
+    
+    std::vector<std::vector<double>> fromDist(k), toDist(k);
+    std::vector<std::vector<int>> fromParent(k), toParent(k);
+    
+    // Запустить SSSP от ориентира i в обе стороны
+    auto enqueueLandmark = [&](size_t i, std::vector<std::future<void>>& futures) {
+        int landmark = oracle.landmarks_[i];
+        futures.push_back(pool.enqueue([&, i, landmark]() {
+            if (cancelled()) return;
+            fromDist[i] = Algorithms::shortestDistances(g, landmark, &fromParent[i]);
+        }));
+        if (g.directed) {
+            futures.push_back(pool.enqueue([&, i, landmark]() {
+                if (cancelled()) return;
+                toDist[i] = Algorithms::shortestDistances(reverse, landmark, &toParent[i]);
+            }));
+        }
+    };
+    
+    if (strategy == LandmarkStrategy::Degree) {
+        std::vector<int> order(n);
+        for (int v = 0; v < n; ++v) order[v] = v;
+        std::partial_sort(order.begin(), order.begin() + k, order.end(),
+            [&](int a, int b) { return g.degree(a) > g.degree(b); });
+        oracle.landmarks_.assign(order.begin(), order.begin() + k);
+        
+        // Все ориентиры независимы - считаются параллельно
+        std::vector<std::future<void>> futures;
+        for (size_t i = 0; i < k; ++i) {
+            enqueueLandmark(i, futures);
+        }
+        for (auto& future : futures) {
+            future.wait();
+        }
+        if (cancelled()) return abandon();
+    } else {
+        // Первый ориентир - вершина максимальной степени, далее самые удалённые
+        // от уже выбранных; недостижимые вершины выбираются в первую очередь,
+        // так что каждая компонента связности получает свой ориентир.
+        // Ориентиры выбираются пачками по числу потоков пула, и SSSP пачки
+        // считаются одновременно. Внутри пачки кандидаты берутся из разных
+        // областей Вороного (ближайший ориентир у каждого свой), иначе
+        // соседние дальние вершины дали бы почти одинаковые ориентиры; пачка
+        // поэтому растёт вместе с числом областей: 1, 1, 2, 4, ...
+        const double inf = std::numeric_limits<double>::infinity();
+        std::vector<double> closest(n, inf);
+        std::vector<int> owner(n, -1);  // ближайший ориентир, -1 - ни один не достижим
+        std::vector<char> chosen(n, 0);
+        int first = 0;
+        for (int v = 1; v < n; ++v) {
+            if (g.degree(v) > g.degree(first)) first = v;
+        }
+        oracle.landmarks_.push_back(first);
+        chosen[first] = 1;
+        
+        size_t batchLimit = std::max<size_t>(1, pool.size());
+        size_t done = 0;
+        std::vector<int> best;  // кандидат по каждой области (индекс - ориентир + 1)
+        while (true) {
+            std::vector<std::future<void>> futures;
+            for (size_t i = done; i < oracle.landmarks_.size(); ++i) {
+                enqueueLandmark(i, futures);
+            }
+            for (auto& future : futures) {
+                future.wait();
+            }
+            if (cancelled()) return abandon();
+            for (size_t i = done; i < oracle.landmarks_.size(); ++i) {
+                for (int v = 0; v < n; ++v) {
+                    if (fromDist[i][v] < closest[v]) {
+                        closest[v] = fromDist[i][v];
+                        owner[v] = static_cast<int>(i);
+                    }
+                }
+            }
+            done = oracle.landmarks_.size();
+            if (done == k) break;
+            
+            // Лучший кандидат каждой области: самый удалённый, при равенстве -
+            // большей степени и меньшего номера (с одним потоком выбор совпадает
+            // с поштучным); в пачку идут лучшие из этих кандидатов
+            auto better = [&](int a, int b) {
+                if (closest[a] != closest[b]) return closest[a] > closest[b];
+                if (g.degree(a) != g.degree(b)) return g.degree(a) > g.degree(b);
+                return a < b;
+            };
+            best.assign(done + 1, -1);
+            for (int v = 0; v < n; ++v) {
+                if (chosen[v]) continue;
+                int& slot = best[static_cast<size_t>(owner[v] + 1)];
+                if (slot == -1 || better(v, slot)) slot = v;
+            }
+            best.erase(std::remove(best.begin(), best.end(), -1), best.end());
+            size_t take = std::min({batchLimit, k - done, best.size()});
+            std::partial_sort(best.begin(), best.begin() + take, best.end(), better);
+            for (size_t i = 0; i < take; ++i) {
+                oracle.landmarks_.push_back(best[i]);
+                chosen[best[i]] = 1;
+            }
+            if (oracle.landmarks_.size() == done) break;
+        }
+    }
+    
+    // Переложить в компактный массив по вершинам: k значений подряд на вершину
+    size_t count = oracle.landmarks_.size();
+    oracle.fromLandmark_.resize(static_cast<size_t>(n) * count);
+    oracle.fromParent_.resize(static_cast<size_t>(n) * count);
+    if (g.directed) {
+        oracle.toLandmark_.resize(static_cast<size_t>(n) * count);
+        oracle.toParent_.resize(static_cast<size_t>(n) * count);
+    }
+    for (int v = 0; v < n; ++v) {
+        size_t row = static_cast<size_t>(v) * count;
+        for (size_t i = 0; i < count; ++i) {
+            oracle.fromLandmark_[row + i] = static_cast<float>(fromDist[i][v]);
+            oracle.fromParent_[row + i] = fromParent[i][v];
+            if (g.directed) {
+                oracle.toLandmark_[row + i] = static_cast<float>(toDist[i][v]);
+                oracle.toParent_[row + i] = toParent[i][v];
+            }
+        }
+    }
+    
+    return oracle;
+}
+
+double DistanceOracle::lowerBound(int u, int v) const {
+    double bound = 0.0;
+    for (size_t i = 0; i < k(); ++i) {
+        // d(u, v) >= d(L, v) - d(L, u)  и  d(u, v) >= d(u, L) - d(v, L);
+        // из разности вычитается погрешность округления, чтобы оценка
+        // оставалась допустимой для A*
+        double fu = from(u, i), fv = from(v, i);
+        double tu = to(u, i), tv = to(v, i);
+        double a = fv - fu;
+        double b = tu - tv;
+        if (std::isfinite(a)) a -= kRoundingSlack * (std::abs(fu) + std::abs(fv));
+        if (std::isfinite(b)) b -= kRoundingSlack * (std::abs(tu) + std::abs(tv));
+        if (!std::isnan(a)) bound = std::max(bound, a);
+        if (!std::isnan(b)) bound = std::max(bound, b);
+    }
+    return bound;
+}
+
+double DistanceOracle::upperBound(int u, int v) const {
+    if (u == v) return 0.0;
+    double best = std::numeric_limits<double>::infinity();
+    for (size_t i = 0; i < k(); ++i) {
+        best = std::min(best, static_cast<double>(to(u, i)) + static_cast<double>(from(v, i)));
+    }
+    return std::isfinite(best) ? best * (1.0 + kRoundingSlack) : best;
+}
+
+std::vector<int> DistanceOracle::approximatePath(int u, int v) const {
+    std::vector<int> path;
+    if (u < 0 || v < 0 || u >= vertexCount_ || v >= vertexCount_) return path;
+    if (u == v) return {u};
+    
+    // Ориентир с наименьшей суммой d(u, L) + d(L, v)
+    size_t bestLandmark = k();
+    double best = std::numeric_limits<double>::infinity();
+    for (size_t i = 0; i < k(); ++i) {
+        double through = static_cast<double>(to(u, i)) + static_cast<double>(from(v, i));
+        if (through < best) {
+            best = through;
+            bestLandmark = i;
+        }
+    }
+    if (bestLandmark == k()) return path;
+    
+    int landmark = landmarks_[bestLandmark];
+    for (int x = u; x != landmark; x = nextToward(x, bestLandmark)) {
+        if (x < 0) return {};
+        path.push_back(x);
+    }
+    std::vector<int> tail;
+    for (int x = v; x != landmark; x = fromParent_[static_cast<size_t>(x) * k() + bestLandmark]) {
+        if (x < 0) return {};
+        tail.push_back(x);
+    }
+    path.push_back(landmark);
+    path.insert(path.end(), tail.rbegin(), tail.rend());
+    
+    // Срезать петли: если вершина встречается повторно, участок между
+    // вхождениями лишний
+    std::vector<int> simple;
+    std::unordered_map<int, size_t> position;
+    for (int x : path) {
+        auto it = position.find(x);
+        if (it != position.end()) {
+            for (size_t i = it->second + 1; i < simple.size(); ++i) {
+                position.erase(simple[i]);
+            }
+            simple.resize(it->second + 1);
+            continue;
+        }
+        position[x] = simple.size();
+        simple.push_back(x);
+    }
+    return simple;
+}
+
+bool DistanceOracle::matches(const CSRGraph& g) const {
+    return vertexCount_ == g.size() && directed_ == g.directed && fingerprint_ == g.fingerprint();
+}
+
+size_t DistanceOracle::memoryBytes() const {
+    return fromLandmark_.size() * sizeof(float) + toLandmark_.size() * sizeof(float)
+        + fromParent_.size() * sizeof(int32_t) + toParent_.size() * sizeof(int32_t)
+        + landmarks_.size() * sizeof(int);
+}
+
+bool DistanceOracle::save(const std::string& filename) const {
+    // Запись во временный файл (свой у каждого потока) и переименование:
+    // читатель и параллельная запись никогда не видят файл наполовину
+    std::string temporary = filename + ".tmp" + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+    {
+        std::ofstream file(temporary, std::ios::binary);
+        if (!file.is_open()) {
+            return false;
+        }
+        
+        file.write(kOracleMagic, sizeof(kOracleMagic));
+        writeValue(file, kOracleVersion);
+        writeValue(file, static_cast<int32_t>(vertexCount_));
+        writeValue(file, static_cast<uint32_t>(landmarks_.size()));
+        writeValue(file, static_cast<uint8_t>(directed_ ? 1 : 0));
+        writeValue(file, fingerprint_);
+        writeArray(file, landmarks_);
+        writeArray(file, fromLandmark_);
+        writeArray(file, fromParent_);
+        if (directed_) {
+            writeArray(file, toLandmark_);
+            writeArray(file, toParent_);
+        }
+        if (!file) {
+            file.close();
+            std::error_code ignored;
+            std::filesystem::remove(temporary, ignored);
+            return false;
+        }
+    }
+    std::error_code error;
+    std::filesystem::rename(temporary, filename, error);
+    return !error;
+}
+
+std::optional<DistanceOracle> DistanceOracle::load(const std::string& filename, const CSRGraph& g) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        return std::nullopt;
+    }
+    
+    char magic[4];
+    uint32_t version = 0;
+    int32_t vertexCount = 0;
+    uint32_t count = 0;
+    uint8_t directed = 0;
+    uint64_t hash = 0;
+    if (!file.read(magic, sizeof(magic)) || std::memcmp(magic, kOracleMagic, sizeof(magic)) != 0
+        || !readValue(file, version) || version != kOracleVersion
+        || !readValue(file, vertexCount) || !readValue(file, count)
+        || !readValue(file, directed) || !readValue(file, hash)) {
+        return std::nullopt;
+    }
+    
+    // Файл от другой версии графа не используется
+    if (vertexCount != g.size() || (directed != 0) != g.directed || hash != g.fingerprint()) {
+        return std::nullopt;
+    }
+    
+    // Размер файла должен совпадать с заголовком: обрезанный или
+    // повреждённый файл не читается, и count не задаёт огромное выделение
+    if (count > static_cast<uint32_t>(vertexCount)) {
+        return std::nullopt;
+    }
+    size_t cells = static_cast<size_t>(vertexCount) * count;
+    size_t arrays = directed != 0 ? 2 : 1;
+    std::streamoff dataStart = file.tellg();
+    std::streamoff expected = dataStart
+        + static_cast<std::streamoff>(count * sizeof(int32_t) + arrays * cells * (sizeof(float) + sizeof(int32_t)));
+    file.seekg(0, std::ios::end);
+    if (file.tellg() != expected) {
+        return std::nullopt;
+    }
+    file.seekg(dataStart);
+    
+    DistanceOracle oracle;
+    oracle.vertexCount_ = vertexCount;
+    oracle.directed_ = directed != 0;
+    oracle.fingerprint_ = hash;
+    if (!readArray(file, oracle.landmarks_, count)
+        || !readArray(file, oracle.fromLandmark_, cells)
+        || !readArray(file, oracle.fromParent_, cells)) {
+        return std::nullopt;
+    }
+    if (oracle.directed_ && (!readArray(file, oracle.toLandmark_, cells) || !readArray(file, oracle.toParent_, cells))) {
+        return std::nullopt;
+    }
+    
+    for (int landmark : oracle.landmarks_) {
+        if (landmark < 0 || landmark >= vertexCount) return std::nullopt;
+    }
+    if (!validParents(oracle.fromParent_, count, vertexCount)
+        || (oracle.directed_ && !validParents(oracle.toParent_, count, vertexCount))) {
+        return std::nullopt;
+    }
+    return oracle;
+}
+
+} // namespace graph
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "core/csr.hpp"
+#include "core/parallel.hpp"
+#include <atomic>
+#include <vector>
+#include <string>
+#include <optional>
+#include <cstdint>
+
+namespace graph {
+
+// Стратегия выбора ориентиров
+enum class LandmarkStrategy {
+    Degree,        // вершины с наибольшей степенью
+    FarthestPoint  // следующие - самые удалённые от уже выбранных (пачками)
+};
+
+// Оракул расстояний по ориентирам: для каждой вершины хранится компактный
+// вектор расстояний до/от k ориентиров, что даёт нижние/верхние оценки
+// d(u, v) за O(k) и приближённый путь через лучший ориентир
+class DistanceOracle {
+public:
+    // Предвычисление: SSSP от каждого ориентира выполняется на пуле потоков.
+    // При взведённом cancel ещё не начатые SSSP пропускаются и возвращается
+    // оракул без ориентиров
+    static DistanceOracle build(const CSRGraph& g, size_t k, LandmarkStrategy strategy, ThreadPool& pool,
+                                const std::atomic<bool>* cancel = nullptr);
+    
+    // Оценки для плотных индексов CSR
+    double lowerBound(int u, int v) const;
+    double upperBound(int u, int v) const;
+    
+    // Приближённый путь u -> L -> v через ориентир с лучшей верхней оценкой
+    std::vector<int> approximatePath(int u, int v) const;
+    
+    // Построен ли оракул для этого графа (сверяется отпечаток структуры)
+    bool matches(const CSRGraph& g) const;
+    
+    int vertexCount() const { return vertexCount_; }
+    const std::vector<int>& landmarks() const { return landmarks_; }
+    size_t memoryBytes() const;
+    
+    // Сохранение рядом с графом (<граф>.oracle; файл заменяется целиком
+    // переименованием) и загрузка
+    bool save(const std::string& filename) const;
+    static std::optional<DistanceOracle> load(const std::string& filename, const CSRGraph& g);
+    
+private:
+    int vertexCount_ = 0;
+    bool directed_ = false;
+    uint64_t fingerprint_ = 0;
+    std::vector<int> landmarks_;
+    
+    // Хранение по вершинам: [v * k + i] относится к ориентиру i
+    std::vector<float> fromLandmark_;     // d(L_i, v)
+    std::vector<float> toLandmark_;       // d(v, L_i), пусто для неориентированного графа
+    std::vector<int32_t> fromParent_;     // предок v в дереве кратчайших путей из L_i
+    std::vector<int32_t> toParent_;       // следующая вершина на пути v -> L_i
+    
+    size_t k() const { return landmarks_.size(); }
+    float from(int v, size_t i) const { return fromLandmark_[static_cast<size_t>(v) * k() + i]; }
+    float to(int v, size_t i) const {
+        return directed_ ? toLandmark_[static_cast<size_t>(v) * k() + i] : from(v, i);
+    }
+    int32_t nextToward(int v, size_t i) const {
+        return directed_ ? toParent_[static_cast<size_t>(v) * k() + i] : fromParent_[static_cast<size_t>(v) * k() + i];
+    }
+};
+
+} // namespace graph
@@ -1,122 +1,370 @@
 #include "core/graph.hpp"
+#include "core/dfs.hpp"
 #include <algorithm>
 #include <cmath>
-#include <unordered_set>
 #include <functional>
 
 namespace graph {
 
-Graph::Graph(bool directed) : directed_(directed) {}
+Graph::Graph(bool directed) : directed_(directed) {
+    // Все части сначала разделяют одну пустую: своя создаётся при первой
+    // записи, поэтому малый граф не держит kChunkCount арен
+    chunks_.assign(kChunkCount, std::make_shared<Chunk>());
+    dense_ = std::make_shared<std::vector<Slot>>();
+}
 
-void Graph::addVertex(int id, const std::string& label) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    addVertexInternal(id, label);
+Graph::Chunk::Chunk(const Chunk& other) {
+    entries.reserve(other.entries.size());
+    for (const auto& [id, entry] : other.entries) {
+        Entry& copy = entries.try_emplace(id, entry.vertex, entry.index).first->second;
+        copy.out.assign(entry.out, &arena);
+        copy.in.assign(entry.in, &arena);
+    }
 }
 
-void Graph::addVertexInternal(int id, const std::string& label) {
-    if (vertices_.find(id) == vertices_.end()) {
-        vertices_[id] = std::make_unique<Vertex>(id, 0.0, 0.0, label);
-        adjacency_list_[id] = std::vector<Edge>();
+Graph::Chunk& Graph::writableChunk(int id) {
+    auto& chunk = chunks_[chunkIndex(id)];
+    // Часть, которую держит снимок, копируется; дальше запись идёт в копию
+    if (chunk.use_count() > 1) {
+        copyChunk(chunk);
     }
+    return *chunk;
 }
 
-void Graph::addEdge(int from, int to, double weight, const std::string& edgeLabel) {
+void Graph::copyChunk(std::shared_ptr<Chunk>& chunk) {
+    chunk = std::make_shared<Chunk>(*chunk);
+    std::vector<Slot>& dense = writableDense();
+    for (auto& [_, entry] : chunk->entries) {
+        dense[entry.index].entry = &entry;
+    }
+}
+
+std::vector<Graph::Slot>& Graph::writableDense() {
+    if (dense_.use_count() > 1) {
+        dense_ = std::make_shared<std::vector<Slot>>(*dense_);
+    }
+    return *dense_;
+}
+
+void Graph::touch() {
+    version_.fetch_add(1, std::memory_order_acq_rel);
+    if (hasPublished_) {
+        published_.store(nullptr);
+        hasPublished_ = false;
+    }
+}
+
+std::shared_ptr<const Graph> Graph::snapshot() const {
+    if (auto published = published_.load()) {
+        return published;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (auto published = published_.load()) {
+        return published;
+    }
+    std::shared_ptr<Graph> copy(new Graph(directed_, chunks_, dense_));
+    copy->searchIndex_ = searchIndex_;
+    copy->version_.store(version_.load());
+    std::shared_ptr<const Graph> result = std::move(copy);
+    published_.store(result);
+    hasPublished_ = true;
+    return result;
+}
+
+void Graph::restore(const Graph& version) {
+    if (&version == this) return;
     std::lock_guard<std::mutex> lock(mutex_);
-    if (vertices_.find(from) == vertices_.end()) {
-        addVertexInternal(from);
+    touch();
+    // Версия неизменяема, поэтому её поля читаются без её блокировки
+    chunks_ = version.chunks_;
+    dense_ = version.dense_;
+    searchIndex_ = version.searchIndex_;
+}
+
+void Graph::addVertex(int id, const std::string& label) {
+    std::vector<GraphChange> changes;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        addVertexInternal(id, label, changeSink(changes));
     }
-    if (vertices_.find(to) == vertices_.end()) {
-        addVertexInternal(to);
+    notify(changes);
+}
+
+void Graph::addVertexInternal(int id, const std::string& label, std::vector<GraphChange>* changes) {
+    if (entryOf(id)) return;
+    touch();
+    std::vector<Slot>& dense = writableDense();
+    Entry& entry = writableChunk(id).entries.try_emplace(id, Vertex(id, 0.0, 0.0, label), static_cast<int>(dense.size())).first->second;
+    dense.push_back({id, &entry});
+    if (changes) changes->push_back({GraphChange::Kind::VertexAdded, id, -1, 1.0, label});
+}
+
+void Graph::addEdge(int from, int to, double weight, const std::string& edgeLabel) {
+    std::vector<GraphChange> changes;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        insertEdgeInternal(from, to, weight, edgeLabel, changeSink(changes));
     }
-    addEdgeInternal(from, to, weight, edgeLabel);
+    notify(changes);
+}
+
+void Graph::insertEdgeInternal(int from, int to, double weight, const std::string& edgeLabel,
+                               std::vector<GraphChange>* changes) {
+    addVertexInternal(from, "", changes);
+    addVertexInternal(to, "", changes);
+    Edge previous(from, to);
+    bool added = addEdgeInternal(from, to, weight, edgeLabel, &previous);
     if (!directed_) {
         addEdgeInternal(to, from, weight, edgeLabel);
     }
+    if (!changes) return;
+    if (added) {
+        changes->push_back({GraphChange::Kind::EdgeAdded, from, to, weight, edgeLabel});
+    } else if (previous.weight != weight || previous.label != edgeLabel) {
+        GraphChange change{GraphChange::Kind::EdgeUpdated, from, to, weight, edgeLabel};
+        change.oldWeight = previous.weight;
+        change.oldLabel = previous.label;
+        changes->push_back(std::move(change));
+    }
+}
+
+bool Graph::addEdgeInternal(int from, int to, double weight, const std::string& edgeLabel, Edge* previous) {
+    touch();
+    Chunk& chunk = writableChunk(from);
+    auto& edges = chunk.find(from)->out;
+    Edge* it = edges.find_if([to](const Edge& e) { return e.to == to; });
+    if (!it) {
+        edges.emplace_back(&chunk.arena, from, to, weight, directed_, edgeLabel).toIndex = entryOf(to)->index;
+        if (directed_) {
+            Chunk& target = writableChunk(to);
+            target.find(to)->in.emplace_back(&target.arena, from);
+        }
+        return true;
+    }
+    if (previous) *previous = *it;
+    it->weight = weight;
+    it->label = edgeLabel;
+    return false;
 }
 
-void Graph::addEdgeInternal(int from, int to, double weight, const std::string& edgeLabel) {
-    Edge edge(from, to, weight, directed_, edgeLabel);
-    auto& edges = adjacency_list_[from];
-    auto it = std::find_if(edges.begin(), edges.end(),
-        [&](const Edge& e) { return e.to == to; });
-    if (it == edges.end()) {
-        edges.push_back(edge);
-    } else {
-        it->weight = weight;
-        it->label = edgeLabel;
+bool Graph::removeArcInternal(int from, int to, Edge* removed) {
+    const Entry* source = entryOf(from);
+    if (!source || std::none_of(source->out.begin(), source->out.end(), [to](const Edge& e) { return e.to == to; })) {
+        return false;
+    }
+
+    touch();
+    auto& edges = writableChunk(from).find(from)->out;
+    auto it = std::find_if(edges.begin(), edges.end(), [to](const Edge& e) { return e.to == to; });
+    if (removed) *removed = *it;
+    // Порядок дуг в списке не важен: последняя переносится на место удалённой
+    *it = std::move(edges.back());
+    edges.pop_back();
+
+    if (directed_) {
+        if (Entry* target = writableChunk(to).find(to)) {
+            auto& list = target->in;
+            auto pos = std::find(list.begin(), list.end(), from);
+            if (pos != list.end()) {
+                *pos = list.back();
+                list.pop_back();
+            }
+        }
+    }
+    return true;
+}
+
+void Graph::removeEdgeInternal(int from, int to, std::vector<GraphChange>* changes) {
+    Edge removed(from, to);
+    if (!removeArcInternal(from, to, &removed)) return;
+    if (!directed_) {
+        removeArcInternal(to, from);
+    }
+    if (changes) changes->push_back({GraphChange::Kind::EdgeRemoved, from, to, removed.weight, removed.label});
+}
+
+void Graph::removeVertexInternal(int id, std::vector<GraphChange>* changes) {
+    const Entry* own = entryOf(id);
+    if (!own) return;
+    touch();
+
+    // Обходятся только списки соседей: входящие дуги берутся из обратного
+    // индекса (или из симметричного списка), а не поиском по всему графу
+    std::vector<Edge> outgoing(own->out.begin(), own->out.end());
+    for (const auto& edge : outgoing) {
+        if (edge.to != id) {
+            if (directed_) {
+                if (Entry* target = writableChunk(edge.to).find(edge.to)) {
+                    auto& list = target->in;
+                    auto pos = std::find(list.begin(), list.end(), id);
+                    if (pos != list.end()) {
+                        *pos = list.back();
+                        list.pop_back();
+                    }
+                }
+            } else {
+                removeArcInternal(edge.to, id);
+            }
+        }
+        if (changes) changes->push_back({GraphChange::Kind::EdgeRemoved, id, edge.to, edge.weight, edge.label});
+    }
+    if (directed_) {
+        std::vector<int> sourceList(entryOf(id)->in.begin(), entryOf(id)->in.end());
+        for (int source : sourceList) {
+            if (source == id) continue;
+            Edge removed(source, id);
+            if (removeArcInternal(source, id, &removed) && changes) {
+                changes->push_back({GraphChange::Kind::EdgeRemoved, source, id, removed.weight, removed.label});
+            }
+        }
+    }
+
+    Chunk& chunk = writableChunk(id);
+    Entry& entry = *chunk.find(id);
+    if (changes) changes->push_back({GraphChange::Kind::VertexRemoved, id, -1, 1.0, entry.vertex.label, entry.vertex.type});
+    // Место в плотной нумерации занимает последняя вершина. Её запись
+    // меняется, поэтому берётся из части, открытой для записи (часть может
+    // быть общей со снимком), и до сдвига плотного массива: копия части
+    // переставляет указатели по прежним индексам
+    std::vector<Slot>& dense = writableDense();
+    int index = entry.index;
+    Slot last = dense.back();
+    Entry* movedEntry = last.id != id ? writableChunk(last.id).find(last.id) : nullptr;
+    entry.out.release(&chunk.arena);
+    entry.in.release(&chunk.arena);
+    chunk.entries.erase(id);
+    dense.pop_back();
+    if (movedEntry) {
+        dense[index] = {last.id, movedEntry};
+        Entry& moved = *movedEntry;
+        moved.index = index;
+        // Дуги в перенесённую вершину хранят её плотный индекс
+        std::vector<int> sources;
+        if (directed_) {
+            sources.assign(moved.in.begin(), moved.in.end());
+        } else {
+            for (const auto& edge : moved.out) sources.push_back(edge.to);
+        }
+        for (int source : sources) {
+            for (auto& edge : writableChunk(source).find(source)->out) {
+                if (edge.to == last.id) edge.toIndex = index;
+            }
+        }
+    }
+
+    // Арена не переиспользует память удалённых записей: когда её больше,
+    // чем живой, часть перекладывается в новую арену
+    auto& owner = chunks_[chunkIndex(id)];
+    if (owner->arena.releasedBytes > std::max(kCompactMinBytes, owner->arena.liveBytes())) {
+        copyChunk(owner);
     }
 }
 
 void Graph::removeVertex(int id) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    vertices_.erase(id);
-    adjacency_list_.erase(id);
-    for (auto& [vid, edges] : adjacency_list_) {
-        edges.erase(
-            std::remove_if(edges.begin(), edges.end(),
-                [id](const Edge& e) { return e.to == id; }),
-            edges.end());
+    std::vector<GraphChange> changes;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        removeVertexInternal(id, changeSink(changes));
     }
+    notify(changes);
 }
 
 void Graph::removeEdge(int from, int to) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    if (adjacency_list_.find(from) != adjacency_list_.end()) {
-        auto& edges = adjacency_list_[from];
-        edges.erase(
-            std::remove_if(edges.begin(), edges.end(),
-                [to](const Edge& e) { return e.to == to; }),
-            edges.end());
+    std::vector<GraphChange> changes;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        removeEdgeInternal(from, to, changeSink(changes));
     }
-    if (!directed_ && adjacency_list_.find(to) != adjacency_list_.end()) {
-        auto& edges = adjacency_list_[to];
-        edges.erase(
-            std::remove_if(edges.begin(), edges.end(),
-                [from](const Edge& e) { return e.to == from; }),
-            edges.end());
+    notify(changes);
+}
+
+std::vector<GraphChange> Graph::applyDelta(const GraphDelta& delta) {
+    std::vector<GraphChange> changes;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (int id : delta.removedVertices) {
+            removeVertexInternal(id, &changes);
+        }
+        for (const auto& [from, to] : delta.removedEdges) {
+            removeEdgeInternal(from, to, &changes);
+        }
+        for (const auto& [id, label] : delta.addedVertices) {
+            addVertexInternal(id, label, &changes);
+        }
+        for (const auto& edge : delta.addedEdges) {
+            insertEdgeInternal(edge.from, edge.to, edge.weight, edge.label, &changes);
+        }
     }
+    notify(changes);
+    return changes;
+}
+
+int Graph::addChangeListener(ChangeListener listener) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    int token = nextListener_++;
+    listeners_[token] = std::move(listener);
+    return token;
+}
+
+void Graph::removeChangeListener(int token) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    listeners_.erase(token);
+}
+
+void Graph::notify(const std::vector<GraphChange>& changes) const {
+    if (changes.empty()) return;
+    // Копия подписчиков: они вызываются без блокировки и могут читать граф
+    std::vector<ChangeListener> listeners;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& [_, listener] : listeners_) listeners.push_back(listener);
+    }
+    for (const auto& listener : listeners) listener(changes);
 }
 
 bool Graph::hasVertex(int id) const {
     std::lock_guard<std::mutex> lock(mutex_);
-    return vertices_.find(id) != vertices_.end();
+    return entryOf(id) != nullptr;
 }
 
 bool Graph::hasEdge(int from, int to) const {
     std::lock_guard<std::mutex> lock(mutex_);
-    if (adjacency_list_.find(from) == adjacency_list_.end()) {
+    const Entry* entry = entryOf(from);
+    if (!entry) {
         return false;
     }
-    const auto& edges = adjacency_list_.at(from);
-    return std::any_of(edges.begin(), edges.end(),
+    return std::any_of(entry->out.begin(), entry->out.end(),
         [to](const Edge& e) { return e.to == to; });
 }
 
 std::vector<int> Graph::getNeighbors(int id) const {
     std::lock_guard<std::mutex> lock(mutex_);
     std::vector<int> neighbors;
-    if (adjacency_list_.find(id) != adjacency_list_.end()) {
-        for (const auto& edge : adjacency_list_.at(id)) {
+    if (const Entry* entry = entryOf(id)) {
+        neighbors.reserve(entry->out.size());
+        for (const auto& edge : entry->out) {
             neighbors.push_back(edge.to);
         }
     }
     return neighbors;
 }
 
+std::vector<int> Graph::getIncoming(int id) const {
+    if (!directed_) return getNeighbors(id);
+    std::lock_guard<std::mutex> lock(mutex_);
+    const Entry* entry = entryOf(id);
+    return entry ? std::vector<int>(entry->in.begin(), entry->in.end()) : std::vector<int>();
+}
+
 std::vector<Edge> Graph::getEdges() const {
     std::lock_guard<std::mutex> lock(mutex_);
     std::vector<Edge> edges;
-    std::unordered_set<std::string> seen;
-    for (const auto& [from, edge_list] : adjacency_list_) {
-        for (const auto& edge : edge_list) {
-            std::string key = directed_ 
-                ? std::to_string(from) + "," + std::to_string(edge.to)
-                : (from < edge.to 
-                    ? std::to_string(from) + "," + std::to_string(edge.to)
-                    : std::to_string(edge.to) + "," + std::to_string(from));
-            if (seen.find(key) == seen.end()) {
-                edges.push_back(edge);
-                seen.insert(key);
+    edges.reserve(getEdgeCountInternal());
+    // Дуги списка уникальны; неориентированное ребро - из списка меньшего конца
+    for (const auto& chunk : chunks_) {
+        for (const auto& [from, entry] : chunk->entries) {
+            for (const auto& edge : entry.out) {
+                if (directed_ || from <= edge.to) edges.push_back(edge);
             }
         }
     }
@@ -126,19 +374,34 @@ std::vector<Edge> Graph::getEdges() const {
 std::vector<int> Graph::getVertices() const {
     std::lock_guard<std::mutex> lock(mutex_);
     std::vector<int> vertices;
-    for (const auto& [id, _] : vertices_) {
-        vertices.push_back(id);
+    vertices.reserve(dense_->size());
+    for (const Slot& slot : *dense_) {
+        vertices.push_back(slot.id);
     }
     return vertices;
 }
 
 int Graph::getVertexCount() const {
     std::lock_guard<std::mutex> lock(mutex_);
-    return static_cast<int>(vertices_.size());
+    return static_cast<int>(dense_->size());
 }
 
 int Graph::getEdgeCount() const {
-    return static_cast<int>(getEdges().size());
+    std::lock_guard<std::mutex> lock(mutex_);
+    return getEdgeCountInternal();
+}
+
+int Graph::getEdgeCountInternal() const {
+    // Неориентированное ребро хранится в обоих списках смежности - считать один раз
+    int count = 0;
+    for (const auto& chunk : chunks_) {
+        for (const auto& [from, entry] : chunk->entries) {
+            for (const auto& edge : entry.out) {
+                if (directed_ || from <= edge.to) ++count;
+            }
+        }
+    }
+    return count;
 }
 
 bool Graph::isDirected() const {
@@ -147,20 +410,21 @@ bool Graph::isDirected() const {
 
 Vertex* Graph::getVertex(int id) {
     std::lock_guard<std::mutex> lock(mutex_);
-    auto it = vertices_.find(id);
-    return (it != vertices_.end()) ? it->second.get() : nullptr;
+    if (!entryOf(id)) return nullptr;
+    touch();
+    return &writableChunk(id).find(id)->vertex;
 }
 
 const Vertex* Graph::getVertex(int id) const {
     std::lock_guard<std::mutex> lock(mutex_);
-    auto it = vertices_.find(id);
-    return (it != vertices_.end()) ? it->second.get() : nullptr;
+    const Entry* entry = entryOf(id);
+    return entry ? &entry->vertex : nullptr;
 }
 
 Edge Graph::getEdge(int from, int to) const {
     std::lock_guard<std::mutex> lock(mutex_);
-    if (adjacency_list_.find(from) != adjacency_list_.end()) {
-        for (const auto& edge : adjacency_list_.at(from)) {
+    if (const Entry* entry = entryOf(from)) {
+        for (const auto& edge : entry->out) {
             if (edge.to == to) {
                 return edge;
             }
@@ -171,56 +435,137 @@ Edge Graph::getEdge(int from, int to) const {
 
 void Graph::setVertexPosition(int id, double x, double y) {
     std::lock_guard<std::mutex> lock(mutex_);
-    if (vertices_.find(id) != vertices_.end()) {
-        vertices_[id]->x = x;
-        vertices_[id]->y = y;
+    if (entryOf(id)) {
+        touch();
+        Vertex& vertex = writableChunk(id).find(id)->vertex;
+        vertex.x = x;
+        vertex.y = y;
     }
 }
 
-int Graph::getDegree(int id) const {
+void Graph::setVertexType(int id, const std::string& type) {
     std::lock_guard<std::mutex> lock(mutex_);
-    if (adjacency_list_.find(id) == adjacency_list_.end()) {
-        return 0;
+    if (entryOf(id)) {
+        touch();
+        writableChunk(id).find(id)->vertex.type = type;
     }
-    return static_cast<int>(adjacency_list_.at(id).size());
+}
+
+void Graph::setSearchIndex(std::shared_ptr<const SearchIndex> index) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    touch();
+    searchIndex_ = std::move(index);
+}
+
+std::shared_ptr<const SearchIndex> Graph::getSearchIndex() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return searchIndex_;
+}
+
+int Graph::getDegree(int id) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const Entry* entry = entryOf(id);
+    return entry ? static_cast<int>(entry->out.size()) : 0;
 }
 
 double Graph::getDensity() const {
     std::lock_guard<std::mutex> lock(mutex_);
-    int n = static_cast<int>(vertices_.size());
+    size_t n = dense_->size();
     if (n < 2) return 0.0;
-    int m = getEdgeCount();
-    int max_edges = directed_ ? n * (n - 1) : n * (n - 1) / 2;
-    return max_edges > 0 ? static_cast<double>(m) / max_edges : 0.0;
+    int m = getEdgeCountInternal();
+    double max_edges = static_cast<double>(n) * (n - 1) / (directed_ ? 1.0 : 2.0);
+    return max_edges > 0 ? m / max_edges : 0.0;
 }
 
 std::vector<std::vector<int>> Graph::getConnectedComponents() const {
     std::lock_guard<std::mutex> lock(mutex_);
     std::vector<std::vector<int>> components;
-    std::unordered_set<int> visited;
-    
-    std::function<void(int, std::vector<int>&)> dfs = [&](int v, std::vector<int>& component) {
-        visited.insert(v);
-        component.push_back(v);
-        if (adjacency_list_.find(v) != adjacency_list_.end()) {
-            for (const auto& edge : adjacency_list_.at(v)) {
-                if (visited.find(edge.to) == visited.end()) {
-                    dfs(edge.to, component);
-                }
-            }
-        }
-    };
-    
-    for (const auto& [id, _] : vertices_) {
-        if (visited.find(id) == visited.end()) {
+    const std::vector<Slot>& dense = *dense_;
+    VertexMask visited(dense.size());
+    DepthFirst dfs([&dense](int v) -> const EdgeList& { return dense[v].entry->out; });
+
+    for (int v = 0; v < static_cast<int>(dense.size()); ++v) {
+        if (!visited.test(v)) {
             std::vector<int> component;
-            dfs(id, component);
-            components.push_back(component);
+            dfs.run(v, visited, [&](int u) {
+                component.push_back(dense[u].id);
+                return true;
+            });
+            components.push_back(std::move(component));
         }
     }
-    
+
     return components;
 }
 
-} // namespace graph
+int Graph::denseIndex(int id) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const Entry* entry = entryOf(id);
+    return entry ? entry->index : -1;
+}
 
+int Graph::externalId(int index) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return index >= 0 && index < static_cast<int>(dense_->size()) ? (*dense_)[index].id : -1;
+}
+
+void Graph::getDenseNeighbors(int index, std::vector<int>& neighbors, std::vector<double>* weights) const {
+    neighbors.clear();
+    if (weights) weights->clear();
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (index < 0 || index >= static_cast<int>(dense_->size())) return;
+    for (const auto& edge : (*dense_)[index].entry->out) {
+        neighbors.push_back(edge.toIndex);
+        if (weights) weights->push_back(edge.weight);
+    }
+}
+
+bool Graph::setDenseOrder(const std::vector<int>& order) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t n = dense_->size();
+    if (order.size() != n) return false;
+    std::vector<char> placed(n, 0);
+    for (int id : order) {
+        const Entry* entry = entryOf(id);
+        if (!entry || placed[entry->index]) return false;
+        placed[entry->index] = 1;
+    }
+    
+    // Индексы хранятся в записях и дугах: отделить все части от снимков
+    for (size_t c = 0; c < kChunkCount; ++c) {
+        if (!chunks_[c]->entries.empty()) writableChunk(static_cast<int>(c));
+    }
+    auto dense = std::make_shared<std::vector<Slot>>();
+    dense->reserve(n);
+    for (int id : order) {
+        Entry* entry = chunks_[chunkIndex(id)]->find(id);
+        entry->index = static_cast<int>(dense->size());
+        dense->push_back({id, entry});
+    }
+    for (Slot& slot : *dense) {
+        for (auto& edge : slot.entry->out) {
+            edge.toIndex = entryOf(edge.to)->index;
+        }
+    }
+    dense_ = std::move(dense);
+    touch();
+    return true;
+}
+
+void Graph::forEachAdjacency(const std::function<void(int, const EdgeList&)>& visitor) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const Slot& slot : *dense_) {
+        visitor(slot.id, slot.entry->out);
+    }
+}
+
+void Graph::forEachVertex(const std::function<void(const Vertex&, const EdgeList&)>& visitor) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& chunk : chunks_) {
+        for (const auto& [id, entry] : chunk->entries) {
+            visitor(entry.vertex, entry.out);
+        }
+    }
+}
+
+} // namespace graph
@@ -1,18 +1,27 @@
 #pragma once
 
 #include <vector>
+#include <string>
+#include <functional>
 #include <unordered_map>
 #include <unordered_set>
 #include <memory>
 #include <mutex>
 #include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <memory_resource>
+#include "core/block_list.hpp"
 
 namespace graph {
 
+class SearchIndex;
+
 struct Vertex {
     int id;
     double x, y;  // координаты для визуализации
     std::string label;
+    std::string type;  // Тип сущности (например, "person", "course"), если известен
     
     Vertex(int id = 0, double x = 0.0, double y = 0.0, const std::string& label = "")
         : id(id), x(x), y(y), label(label) {}
@@ -23,6 +32,7 @@ struct Edge {
     int to;
     double weight;
     bool directed;
+    int toIndex = -1;   // Плотный индекс конца (заполняет граф; в копии верен до изменения графа)
     std::string label;  // Тип связи (например, "lecturer_of", "subtopic_of")
     
     Edge(int from, int to, double weight = 1.0, bool directed = false, const std::string& label = "")
@@ -33,6 +43,48 @@ struct Edge {
     }
 };
 
+// Список исходящих дуг вершины (цепочка блоков, см. Graph::Chunk)
+using EdgeList = BlockList<Edge>;
+
+// Изменение графа. Для рёбер from/to - концы (неориентированное ребро -
+// одно изменение), для вершин from - ID, to = -1. Удалённые элементы хранят
+// вес, метку и тип, обновлённое ребро - прежние вес и метку, чтобы изменение
+// можно было обратить
+struct GraphChange {
+    enum class Kind {
+        VertexAdded,
+        VertexRemoved,
+        EdgeAdded,
+        EdgeRemoved,
+        EdgeUpdated   // повторное добавление ребра с другим весом или меткой
+    };
+    
+    Kind kind;
+    int from;
+    int to;
+    double weight = 1.0;
+    std::string label;  // метка ребра или вершины
+    std::string type = {};   // тип удалённой вершины
+    double oldWeight = 1.0;  // EdgeUpdated: вес и метка до изменения
+    std::string oldLabel = {};
+};
+
+// Пакет изменений. Применяется под одной блокировкой в порядке: удаление
+// вершин, удаление рёбер, добавление вершин, добавление рёбер
+struct GraphDelta {
+    std::vector<std::pair<int, std::string>> addedVertices;
+    std::vector<Edge> addedEdges;
+    std::vector<std::pair<int, int>> removedEdges;
+    std::vector<int> removedVertices;
+    
+    bool empty() const {
+        return addedVertices.empty() && addedEdges.empty() && removedEdges.empty() && removedVertices.empty();
+    }
+};
+
+// Подписчик получает фактические изменения после снятия блокировки графа
+using ChangeListener = std::function<void(const std::vector<GraphChange>&)>;
+
 class Graph {
 public:
     Graph(bool directed = false);
@@ -43,17 +95,28 @@ public:
     void removeVertex(int id);
     void removeEdge(int from, int to);
     
+    // Пакетное изменение; возвращает то, что действительно изменилось
+    // (повторное добавление ребра обновляет вес и метку - EdgeUpdated)
+    std::vector<GraphChange> applyDelta(const GraphDelta& delta);
+    
+    // Подписка на изменения; возвращает номер для отписки
+    int addChangeListener(ChangeListener listener);
+    void removeChangeListener(int token);
+    
     // Получение информации
     bool hasVertex(int id) const;
     bool hasEdge(int from, int to) const;
     std::vector<int> getNeighbors(int id) const;
+    std::vector<int> getIncoming(int id) const;  // источники дуг в вершину
     std::vector<Edge> getEdges() const;
-    std::vector<int> getVertices() const;
+    std::vector<int> getVertices() const;  // в порядке плотных индексов
     int getVertexCount() const;
     int getEdgeCount() const;
     bool isDirected() const;
     
-    // Получение вершин и рёбер
+    // Получение вершин и рёбер. Неконстантный указатель - для записи: часть
+    // графа с вершиной отделяется от снимков, указатель нельзя хранить
+    // дольше следующего снимка
     Vertex* getVertex(int id);
     const Vertex* getVertex(int id) const;
     Edge getEdge(int from, int to) const;
@@ -61,22 +124,174 @@ public:
     // Установка координат
     void setVertexPosition(int id, double x, double y);
     
+    // Установка типа сущности
+    void setVertexType(int id, const std::string& type);
+    
     // Вычисление характеристик
     int getDegree(int id) const;
     double getDensity() const;
     std::vector<std::vector<int>> getConnectedComponents() const;
     
+    // Плотная нумерация вершин 0..n-1 в порядке добавления. Поддерживается
+    // при изменениях: удалённую вершину заменяет последняя. Алгоритмы держат
+    // состояние в массивах по плотному индексу и переводят ответ в ID;
+    // индексы верны, пока граф не меняется (для долгих расчётов - снимок)
+    int denseIndex(int id) const;     // -1, если вершины нет
+    int externalId(int index) const;  // -1 вне диапазона
+    
+    // Соседи вершины с плотным индексом index - тоже плотными индексами
+    // (и веса дуг, если weights задан); списки очищаются
+    void getDenseNeighbors(int index, std::vector<int>& neighbors, std::vector<double>* weights = nullptr) const;
+    
+    // Перенумеровать вершины: order - все ID в новом плотном порядке
+    // (см. Reordering). Граф не меняется, но версия растёт: плотные индексы
+    // и CSR прежней версии недействительны. false, если order - не
+    // перестановка вершин графа
+    bool setDenseOrder(const std::vector<int>& order);
+    
+    // Поисковый индекс по именам вершин (строится загрузчиком; после
+    // изменения меток его нужно построить заново)
+    void setSearchIndex(std::shared_ptr<const SearchIndex> index);
+    std::shared_ptr<const SearchIndex> getSearchIndex() const;
+    
+    // Обход списков смежности под одной блокировкой в порядке плотной
+    // нумерации (для построения CSR; у дуг верен toIndex)
+    void forEachAdjacency(const std::function<void(int, const EdgeList&)>& visitor) const;
+    
+    // Обход вершин (метка, тип, координаты) со списками дуг в порядке
+    // хранения - по частям графа: записи лежат подряд в аренах, и обход
+    // вдвое быстрее, чем в порядке плотной нумерации. Ссылки живут, пока
+    // жива версия: у снимка (snapshot) их можно собрать и читать из
+    // нескольких потоков без блокировки
+    void forEachVertex(const std::function<void(const Vertex&, const EdgeList&)>& visitor) const;
+    
+    // Неизменяемая версия графа для долгих расчётов: части графа не
+    // копируются, а разделяются, и копируются только при записи в живой
+    // граф. Повторный вызов без изменений возвращает ту же версию без
+    // блокировки; версия публикуется атомарно
+    std::shared_ptr<const Graph> snapshot() const;
+    
+    // Вернуться к версии, полученной от snapshot(): части снова разделяются
+    // с ней. Подписчики не уведомляются - зависимые данные строятся заново
+    void restore(const Graph& version);
+    
+    // Номер версии: растёт при каждом изменении
+    uint64_t version() const { return version_.load(std::memory_order_acquire); }
+    
     // Потокобезопасный доступ
     std::mutex& getMutex() const { return mutex_; }
     
 private:
+    // Часть графа: вершины, у которых ID по модулю kChunkCount равен номеру
+    // части, вместе со списками смежности и обратным индексом. Части
+    // разделяются между версиями (copy-on-write).
+    //
+    // Вся память части - одна монотонная арена: узлы хеш-таблицы и блоки
+    // списков дуг (BlockList растёт цепочкой блоков без перевыделения).
+    // Арена берёт у кучи всё более крупные куски и отдаёт их целиком вместе
+    // с частью. Память удалённых вершин и старых массивов корзин арена не
+    // переиспользует, а только учитывает; когда такой памяти в части больше,
+    // чем живой, часть перекладывается копией в новую арену (как при
+    // отделении от снимка). Метки остаются std::string: короткие хранятся
+    // внутри строки
+    // Списки - первыми: они в той же кэш-линии, что и ключ узла таблицы
+    struct Entry {
+        EdgeList out;
+        // Источники входящих дуг (только у ориентированного графа: у
+        // неориентированного списки смежности симметричны)
+        BlockList<int> in;
+        int index;  // плотный индекс
+        Vertex vertex;
+        
+        Entry(const Vertex& vertex, int index) : index(index), vertex(vertex) {}
+    };
+    // Монотонная арена со счётчиками выданных и возвращённых байт
+    struct Arena : std::pmr::monotonic_buffer_resource {
+        using std::pmr::monotonic_buffer_resource::monotonic_buffer_resource;
+        
+        size_t allocatedBytes = 0;
+        size_t releasedBytes = 0;
+        size_t liveBytes() const { return allocatedBytes - releasedBytes; }
+        
+    protected:
+        void* do_allocate(size_t bytes, size_t alignment) override {
+            allocatedBytes += bytes;
+            return monotonic_buffer_resource::do_allocate(bytes, alignment);
+        }
+        void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+            releasedBytes += bytes;
+            monotonic_buffer_resource::do_deallocate(p, bytes, alignment);
+        }
+    };
+    struct Chunk {
+        // В малом графе в части несколько вершин: первый кусок арены мал
+        Arena arena{kArenaInitialBytes};
+        std::pmr::unordered_map<int, Entry> entries{&arena};
+        
+        Chunk() = default;
+        // Копия укладывает каждый список в один блок своей арены
+        Chunk(const Chunk& other);
+        
+        const Entry* find(int id) const {
+            auto it = entries.find(id);
+            return it != entries.end() ? &it->second : nullptr;
+        }
+        Entry* find(int id) {
+            auto it = entries.find(id);
+            return it != entries.end() ? &it->second : nullptr;
+        }
+    };
+    static constexpr size_t kChunkCount = 1024;
+    static constexpr size_t kArenaInitialBytes = 256;
+    // Меньше этого мёртвой памяти часть не перекладывается: копия малой
+    // части стоит дороже, чем сэкономит
+    static constexpr size_t kCompactMinBytes = 4096;
+    
     bool directed_;
-    std::unordered_map<int, std::unique_ptr<Vertex>> vertices_;
-    std::unordered_map<int, std::vector<Edge>> adjacency_list_;
+    std::vector<std::shared_ptr<Chunk>> chunks_;
+    // Плотный индекс -> ID и запись вершины (узлы таблицы не переезжают при
+    // её росте; при копировании части указатели обновляются). Разделяется
+    // со снимками и копируется при записи, как части
+    struct Slot {
+        int id;
+        Entry* entry;
+    };
+    std::shared_ptr<std::vector<Slot>> dense_;
+    std::shared_ptr<const SearchIndex> searchIndex_;
+    std::unordered_map<int, ChangeListener> listeners_;
+    int nextListener_ = 0;
+    std::atomic<uint64_t> version_{0};
+    // Последняя опубликованная версия; сбрасывается при изменении, чтобы
+    // не удерживать части, которые живой граф уже переписал
+    mutable std::atomic<std::shared_ptr<const Graph>> published_;
+    mutable bool hasPublished_ = false;  // под mutex_
     mutable std::mutex mutex_;
     
-    void addEdgeInternal(int from, int to, double weight, const std::string& edgeLabel = "");
-    void addVertexInternal(int id, const std::string& label = "");  // Без блокировки
+    // Версия из готовых частей (для snapshot)
+    Graph(bool directed, const std::vector<std::shared_ptr<Chunk>>& chunks, const std::shared_ptr<std::vector<Slot>>& dense)
+        : directed_(directed), chunks_(chunks), dense_(dense) {}
+    
+    static size_t chunkIndex(int id) { return static_cast<uint32_t>(id) % kChunkCount; }
+    const Chunk& chunkOf(int id) const { return *chunks_[chunkIndex(id)]; }
+    const Entry* entryOf(int id) const { return chunkOf(id).find(id); }
+    Chunk& writableChunk(int id);  // Без блокировки; копирует разделяемую часть
+    void copyChunk(std::shared_ptr<Chunk>& chunk);  // Без блокировки; часть - в новую арену
+    std::vector<Slot>& writableDense();  // Без блокировки; то же для нумерации
+    void touch();                  // Без блокировки; отметить изменение
+    
+    // Без блокировки; changes == nullptr - изменения не записываются
+    // false - дуга уже была (её вес и метка обновлены, прежние - в previous)
+    bool addEdgeInternal(int from, int to, double weight, const std::string& edgeLabel = "", Edge* previous = nullptr);
+    void addVertexInternal(int id, const std::string& label = "", std::vector<GraphChange>* changes = nullptr);
+    void insertEdgeInternal(int from, int to, double weight, const std::string& edgeLabel, std::vector<GraphChange>* changes);
+    bool removeArcInternal(int from, int to, Edge* removed = nullptr);
+    void removeEdgeInternal(int from, int to, std::vector<GraphChange>* changes);
+    void removeVertexInternal(int id, std::vector<GraphChange>* changes);
+    std::vector<GraphChange>* changeSink(std::vector<GraphChange>& changes) {
+        return listeners_.empty() ? nullptr : &changes;
+    }
+    void notify(const std::vector<GraphChange>& changes) const;
+    int getEdgeCountInternal() const;  // Без блокировки
 };
 
 } // namespace graph
@@ -0,0 +1,268 @@
+#include "core/incremental.hpp"
+#include <algorithm>
+#include <numeric>
+
+namespace graph {
+
+IncrementalAnalysis IncrementalAnalysis::build(const Graph& g) {
+    IncrementalAnalysis analysis;
+    analysis.directed_ = g.isDirected();
+    for (int id : g.getVertices()) {
+        analysis.addVertex(id);
+    }
+    g.forEachAdjacency([&analysis](int id, const EdgeList& edges) {
+        analysis.changeDegree(id, static_cast<int>(edges.size()));
+        for (const auto& edge : edges) {
+            analysis.merge(id, edge.to);
+        }
+    });
+    return analysis;
+}
+
+void IncrementalAnalysis::addVertex(int id) {
+    if (slot_.count(id)) return;
+    int component = nextComponent_++;
+    members_[component].push_back(id);
+    slot_[id] = {component, 0};
+    degree_[id] = 0;
+    if (degreeCount_.empty()) degreeCount_.resize(1, 0);
+    ++degreeCount_[0];
+}
+
+void IncrementalAnalysis::moveVertex(int id, int component) {
+    Slot& slot = slot_[id];
+    auto& list = members_[slot.component];
+    int last = list.back();
+    list[slot.position] = last;
+    slot_[last].position = slot.position;
+    list.pop_back();
+    if (list.empty()) members_.erase(slot.component);
+
+    if (component < 0) return;
+    auto& target = members_[component];
+    slot = {component, target.size()};
+    target.push_back(id);
+}
+
+void IncrementalAnalysis::removeVertex(int id) {
+    if (!slot_.count(id)) return;
+    moveVertex(id, -1);
+    slot_.erase(id);
+    changeDegree(id, -degree_[id]);
+    --degreeCount_[0];
+    degree_.erase(id);
+}
+
+void IncrementalAnalysis::merge(int u, int v) {
+    auto a = slot_.find(u);
+    auto b = slot_.find(v);
+    if (a == slot_.end() || b == slot_.end()) return;
+    int into = a->second.component;
+    int from = b->second.component;
+    if (into == from) return;
+    if (members_[into].size() < members_[from].size()) std::swap(into, from);
+
+    auto moved = std::move(members_[from]);
+    members_.erase(from);
+    auto& target = members_[into];
+    for (int x : moved) {
+        slot_[x] = {into, target.size()};
+        target.push_back(x);
+    }
+}
+
+void IncrementalAnalysis::changeDegree(int id, int delta) {
+    auto it = degree_.find(id);
+    if (it == degree_.end() || delta == 0) return;
+    --degreeCount_[it->second];
+    it->second = std::max(0, it->second + delta);
+    if (static_cast<size_t>(it->second) >= degreeCount_.size()) degreeCount_.resize(it->second + 1, 0);
+    ++degreeCount_[it->second];
+    maxDegree_ = std::max(maxDegree_, it->second);
+    while (maxDegree_ > 0 && degreeCount_[maxDegree_] == 0) --maxDegree_;
+}
+
+std::vector<int> IncrementalAnalysis::apply(const Graph& g, const std::vector<GraphChange>& changes) {
+    lastVisited_ = 0;
+    std::vector<int> touched;
+    std::vector<std::pair<int, int>> removed;
+
+    // Добавления сливают компоненты сразу, удаления проверяются по итоговому графу
+    for (const auto& change : changes) {
+        switch (change.kind) {
+            case GraphChange::Kind::VertexAdded:
+                addVertex(change.from);
+                touched.push_back(change.from);
+                break;
+            case GraphChange::Kind::VertexRemoved:
+                removeVertex(change.from);
+                break;
+            case GraphChange::Kind::EdgeAdded:
+                changeDegree(change.from, 1);
+                if (!directed_ && change.from != change.to) changeDegree(change.to, 1);
+                merge(change.from, change.to);
+                touched.push_back(change.from);
+                touched.push_back(change.to);
+                break;
+            case GraphChange::Kind::EdgeRemoved:
+                changeDegree(change.from, -1);
+                if (!directed_ && change.from != change.to) changeDegree(change.to, -1);
+                removed.emplace_back(change.from, change.to);
+                break;
+            case GraphChange::Kind::EdgeUpdated:
+                // Вес и метка не влияют на компоненты и степени
+                break;
+        }
+    }
+
+    // Компонента без уцелевших концов удалённых рёбер не могла распасться:
+    // любая отколовшаяся часть касается удалённого ребра или вершины
+    std::unordered_map<int, std::vector<int>> seeds;
+    for (const auto& [u, v] : removed) {
+        for (int x : {u, v}) {
+            auto it = slot_.find(x);
+            if (it == slot_.end()) continue;
+            seeds[it->second.component].push_back(x);
+            touched.push_back(x);
+        }
+    }
+    for (auto& [_, list] : seeds) {
+        std::sort(list.begin(), list.end());
+        list.erase(std::unique(list.begin(), list.end()), list.end());
+        if (list.size() > 1) split(g, list);
+    }
+
+    std::sort(touched.begin(), touched.end());
+    touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+    touched.erase(std::remove_if(touched.begin(), touched.end(), [this](int id) { return !slot_.count(id); }),
+                  touched.end());
+    return touched;
+}
+
+void IncrementalAnalysis::split(const Graph& g, const std::vector<int>& seeds) {
+    size_t k = seeds.size();
+    std::vector<size_t> parent(k);
+    std::iota(parent.begin(), parent.end(), 0);
+    auto find = [&parent](size_t x) {
+        while (parent[x] != x) {
+            parent[x] = parent[parent[x]];
+            x = parent[x];
+        }
+        return x;
+    };
+
+    // Обход i: найденные вершины и очередь (голова - head[i])
+    std::vector<std::vector<int>> found(k);
+    std::vector<size_t> head(k, 0);
+    std::unordered_map<int, size_t> owner;
+    for (size_t i = 0; i < k; ++i) {
+        owner[seeds[i]] = i;
+        found[i].push_back(seeds[i]);
+    }
+
+    auto unfinishedGroups = [&]() {
+        std::vector<size_t> roots;
+        for (size_t i = 0; i < k; ++i) {
+            if (head[i] < found[i].size()) roots.push_back(find(i));
+        }
+        std::sort(roots.begin(), roots.end());
+        return static_cast<size_t>(std::unique(roots.begin(), roots.end()) - roots.begin());
+    };
+
+    // По одной вершине на обход за раунд, пока не останется одна незаконченная группа
+    while (unfinishedGroups() > 1) {
+        for (size_t i = 0; i < k; ++i) {
+            if (head[i] == found[i].size()) continue;
+            int v = found[i][head[i]++];
+            ++lastVisited_;
+            auto neighbors = g.getNeighbors(v);
+            if (directed_) {
+                auto incoming = g.getIncoming(v);
+                neighbors.insert(neighbors.end(), incoming.begin(), incoming.end());
+            }
+            for (int w : neighbors) {
+                auto it = owner.find(w);
+                if (it == owner.end()) {
+                    owner[w] = i;
+                    found[i].push_back(w);
+                } else {
+                    size_t a = find(i);
+                    size_t b = find(it->second);
+                    if (a != b) parent[b] = a;
+                }
+            }
+        }
+    }
+
+    // Группы обходов; законченная группа - целая компонента итогового графа
+    std::unordered_map<size_t, std::vector<size_t>> groups;
+    for (size_t i = 0; i < k; ++i) {
+        groups[find(i)].push_back(i);
+    }
+    if (groups.size() < 2) return;
+
+    auto finished = [&](const std::vector<size_t>& group) {
+        return std::all_of(group.begin(), group.end(), [&](size_t i) { return head[i] == found[i].size(); });
+    };
+    auto groupSize = [&](const std::vector<size_t>& group) {
+        size_t size = 0;
+        for (size_t i : group) size += found[i].size();
+        return size;
+    };
+
+    // Старый номер остаётся у незаконченной группы, а если закончились все -
+    // у самой большой: так переносится меньше вершин
+    size_t keep = groups.begin()->first;
+    bool keepUnfinished = false;
+    for (const auto& [root, group] : groups) {
+        if (!finished(group)) {
+            keep = root;
+            keepUnfinished = true;
+            break;
+        }
+    }
+    if (!keepUnfinished) {
+        for (const auto& [root, group] : groups) {
+            if (groupSize(group) > groupSize(groups[keep])) keep = root;
+        }
+    }
+
+    for (const auto& [root, group] : groups) {
+        if (root == keep) continue;
+        int fresh = nextComponent_++;
+        for (size_t i : group) {
+            for (int v : found[i]) {
+                if (slot_.count(v) && slot_[v].component != fresh) moveVertex(v, fresh);
+            }
+        }
+    }
+}
+
+int IncrementalAnalysis::componentOf(int id) const {
+    auto it = slot_.find(id);
+    return it != slot_.end() ? it->second.component : -1;
+}
+
+size_t IncrementalAnalysis::largestComponentSize() const {
+    size_t largest = 0;
+    for (const auto& [_, list] : members_) {
+        largest = std::max(largest, list.size());
+    }
+    return largest;
+}
+
+std::vector<std::vector<int>> IncrementalAnalysis::components() const {
+    std::vector<std::vector<int>> result;
+    result.reserve(members_.size());
+    for (const auto& [_, list] : members_) {
+        result.push_back(list);
+    }
+    return result;
+}
+
+int IncrementalAnalysis::degree(int id) const {
+    auto it = degree_.find(id);
+    return it != degree_.end() ? it->second : 0;
+}
+
+} // namespace graph
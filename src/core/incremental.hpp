@@ -0,0 +1,69 @@
+#pragma once
+
+#include "core/graph.hpp"
+#include <vector>
+#include <unordered_map>
+#include <cstddef>
+
+namespace graph {
+
+// Связные компоненты (без учёта направления дуг) и степени вершин, которые
+// обновляются по событиям изменения графа, а не пересчитываются заново.
+//
+// Добавление ребра сливает компоненты: меньшая переносится в большую, так что
+// каждая вершина переезжает O(log n) раз. Удаление рёбер и вершин проверяется
+// одновременными обходами из уцелевших концов: обходы, которые встретились,
+// объединяются, а закончившийся обход - это целая отколовшаяся компонента.
+// Обход останавливается, когда незаконченной остаётся одна группа, поэтому
+// стоимость определяется меньшими частями, а не всей компонентой
+class IncrementalAnalysis {
+public:
+    static IncrementalAnalysis build(const Graph& g);
+
+    // Учесть изменения; граф уже находится в состоянии после них.
+    // Возвращает затронутые вершины, которые остались в графе
+    std::vector<int> apply(const Graph& g, const std::vector<GraphChange>& changes);
+
+    // Номер компоненты вершины (-1, если вершины нет); номера устойчивы,
+    // пока компонента не сливается и не распадается
+    int componentOf(int id) const;
+    size_t componentCount() const { return members_.size(); }
+    size_t largestComponentSize() const;
+    std::vector<std::vector<int>> components() const;
+
+    // Степень - размер списка смежности вершины, как в Graph::getDegree
+    int degree(int id) const;
+    int maxDegree() const { return maxDegree_; }
+    const std::vector<size_t>& degreeHistogram() const { return degreeCount_; }  // степень -> число вершин
+
+    // Сколько вершин просмотрено при проверке распада компонент (для замеров)
+    size_t lastVisited() const { return lastVisited_; }
+
+private:
+    struct Slot {
+        int component;
+        size_t position;  // место в members_[component]
+    };
+
+    std::unordered_map<int, Slot> slot_;
+    std::unordered_map<int, std::vector<int>> members_;
+    int nextComponent_ = 0;
+    bool directed_ = false;
+
+    std::unordered_map<int, int> degree_;
+    std::vector<size_t> degreeCount_;
+    int maxDegree_ = 0;
+    size_t lastVisited_ = 0;
+
+    void addVertex(int id);
+    void removeVertex(int id);
+    void moveVertex(int id, int component);
+    void merge(int u, int v);
+    void changeDegree(int id, int delta);
+
+    // Разделить компоненту, если удаления её разорвали; seeds - уцелевшие
+    // концы удалённых рёбер, лежащие в одной компоненте
+    void split(const Graph& g, const std::vector<int>& seeds);
+};
+
+} // namespace graph
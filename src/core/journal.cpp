@@ -0,0 +1,442 @@
+#include "core/journal.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+namespace graph {
+
+namespace {
+
+constexpr char kJournalMagic[4] = {'K', 'G', 'J', 'L'};
+constexpr uint32_t kJournalVersion = 1;
+
+// Флаги байта изменения: младшие три бита - вид изменения
+constexpr uint8_t kKindMask = 7;
+constexpr uint8_t kHasWeight = 8;
+constexpr uint8_t kHasLabel = 16;
+constexpr uint8_t kHasType = 32;        // тип удалённой вершины
+constexpr uint8_t kHasOldWeight = 64;   // EdgeUpdated: прежние вес и метка
+constexpr uint8_t kHasOldLabel = 128;
+
+template<typename T>
+void writeValue(std::ofstream& file, const T& value) {
+    file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template<typename T>
+bool readValue(std::ifstream& file, T& value) {
+    return static_cast<bool>(file.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+uint64_t zigzag(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+int64_t unzigzag(uint64_t value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+void putVarint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out += static_cast<char>((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    out += static_cast<char>(value);
+}
+
+void putSigned(std::string& out, int64_t value) {
+    putVarint(out, zigzag(value));
+}
+
+void putDouble(std::string& out, double value) {
+    char raw[sizeof(double)];
+    std::memcpy(raw, &value, sizeof(double));
+    out.append(raw, sizeof(double));
+}
+
+void putString(std::string& out, const std::string& value) {
+    putVarint(out, value.size());
+    out += value;
+}
+
+bool isVertexChange(const GraphChange& change) {
+    return change.kind == GraphChange::Kind::VertexAdded || change.kind == GraphChange::Kind::VertexRemoved;
+}
+
+int64_t toFixed(double coordinate) {
+    return std::llround(coordinate * Journal::kPositionScale);
+}
+
+double fromFixed(int64_t value) {
+    return static_cast<double>(value) / Journal::kPositionScale;
+}
+
+// Чтение записи с проверкой границ: после ошибки ok = false
+struct RecordReader {
+    const std::string& data;
+    size_t pos = 0;
+    bool ok = true;
+
+    uint64_t varint() {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (pos >= data.size()) break;
+            uint8_t byte = static_cast<uint8_t>(data[pos++]);
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) return value;
+        }
+        ok = false;
+        return 0;
+    }
+
+    int64_t signedVarint() { return unzigzag(varint()); }
+
+    double real() {
+        double value = 1.0;
+        std::string raw = bytes(sizeof(double));
+        if (ok) std::memcpy(&value, raw.data(), sizeof(double));
+        return value;
+    }
+
+    std::string string() { return bytes(varint()); }
+
+    uint8_t byte() {
+        if (pos >= data.size()) {
+            ok = false;
+            return 0;
+        }
+        return static_cast<uint8_t>(data[pos++]);
+    }
+
+    std::string bytes(size_t count) {
+        if (count > data.size() - pos) {
+            ok = false;
+            return {};
+        }
+        std::string result = data.substr(pos, count);
+        pos += count;
+        return result;
+    }
+};
+
+} // namespace
+
+Journal::Journal(const Graph& g, uint64_t fingerprint) : fingerprint_(fingerprint) {
+    checkpoints_.push_back({0, g.snapshot()});
+}
+
+std::vector<Journal::Position> Journal::positions(const Graph& g) {
+    auto vertices = g.getVertices();
+    std::sort(vertices.begin(), vertices.end());
+    std::vector<Position> result;
+    result.reserve(vertices.size());
+    for (int id : vertices) {
+        const Vertex* vertex = g.getVertex(id);
+        if (vertex) result.push_back({id, toFixed(vertex->x), toFixed(vertex->y)});
+    }
+    return result;
+}
+
+void Journal::begin(const Graph& g) {
+    if (replaying_) return;
+    open_ = true;
+    before_ = positions(g);
+    pending_.clear();
+}
+
+void Journal::record(const Graph& g, const std::vector<GraphChange>& changes) {
+    if (replaying_ || changes.empty()) return;
+    if (open_) {
+        pending_.insert(pending_.end(), changes.begin(), changes.end());
+        return;
+    }
+    append(encode(changes, {}), g);
+}
+
+bool Journal::commit(const Graph& g) {
+    if (!open_) return false;
+    open_ = false;
+
+    // Слияние двух списков по ID. Удалённые и добавленные вершины тоже
+    // попадают в запись: после отмены удаления вершине нужны координаты
+    auto after = positions(g);
+    std::vector<Move> moves;
+    size_t i = 0, j = 0;
+    while (i < before_.size() || j < after.size()) {
+        if (j == after.size() || (i < before_.size() && before_[i].id < after[j].id)) {
+            const Position& old = before_[i++];
+            moves.push_back({old.id, old.x, old.y, old.x, old.y});
+        } else if (i == before_.size() || after[j].id < before_[i].id) {
+            const Position& now = after[j++];
+            moves.push_back({now.id, now.x, now.y, now.x, now.y});
+        } else {
+            const Position& old = before_[i++];
+            const Position& now = after[j++];
+            if (old.x != now.x || old.y != now.y) moves.push_back({old.id, old.x, old.y, now.x, now.y});
+        }
+    }
+    before_.clear();
+    before_.shrink_to_fit();
+
+    bool changed = !pending_.empty() || !moves.empty();
+    if (changed) append(encode(pending_, moves), g);
+    pending_.clear();
+    return changed;
+}
+
+std::string Journal::encode(const std::vector<GraphChange>& changes, const std::vector<Move>& moves) {
+    std::string out;
+    putVarint(out, changes.size());
+    int64_t previous = 0;
+    for (const auto& change : changes) {
+        bool vertex = isVertexChange(change);
+        bool updated = change.kind == GraphChange::Kind::EdgeUpdated;
+        uint8_t tag = static_cast<uint8_t>(change.kind);
+        if (!vertex && change.weight != 1.0) tag |= kHasWeight;
+        if (!change.label.empty()) tag |= kHasLabel;
+        if (vertex && !change.type.empty()) tag |= kHasType;
+        if (updated && change.oldWeight != 1.0) tag |= kHasOldWeight;
+        if (updated && !change.oldLabel.empty()) tag |= kHasOldLabel;
+        out += static_cast<char>(tag);
+        putSigned(out, static_cast<int64_t>(change.from) - previous);
+        previous = change.from;
+        if (!vertex) putSigned(out, static_cast<int64_t>(change.to) - change.from);
+        if (tag & kHasWeight) putDouble(out, change.weight);
+        if (tag & kHasLabel) putString(out, change.label);
+        if (tag & kHasType) putString(out, change.type);
+        if (tag & kHasOldWeight) putDouble(out, change.oldWeight);
+        if (tag & kHasOldLabel) putString(out, change.oldLabel);
+    }
+
+    // ID по возрастанию; старая координата - разностью с предыдущей вершиной
+    // (соседние ID часто лежат рядом), новая - разностью со старой
+    putVarint(out, moves.size());
+    int64_t previousId = 0, previousX = 0, previousY = 0;
+    for (const auto& move : moves) {
+        putSigned(out, move.id - previousId);
+        putSigned(out, move.oldX - previousX);
+        putSigned(out, move.oldY - previousY);
+        putSigned(out, move.newX - move.oldX);
+        putSigned(out, move.newY - move.oldY);
+        previousId = move.id;
+        previousX = move.oldX;
+        previousY = move.oldY;
+    }
+    return out;
+}
+
+bool Journal::decode(const std::string& record, std::vector<GraphChange>& changes, std::vector<Move>& moves) {
+    RecordReader reader{record};
+    uint64_t count = reader.varint();
+    if (!reader.ok || count > record.size()) return false;
+    changes.clear();
+    changes.reserve(count);
+    int64_t previous = 0;
+    for (uint64_t i = 0; i < count && reader.ok; ++i) {
+        uint8_t tag = reader.byte();
+        if ((tag & kKindMask) > static_cast<uint8_t>(GraphChange::Kind::EdgeUpdated)) return false;
+        GraphChange change{static_cast<GraphChange::Kind>(tag & kKindMask), 0, -1, 1.0, ""};
+        bool vertex = isVertexChange(change);
+        previous += reader.signedVarint();
+        change.from = static_cast<int>(previous);
+        if (!vertex) change.to = static_cast<int>(change.from + reader.signedVarint());
+        if (tag & kHasWeight) change.weight = reader.real();
+        if (tag & kHasLabel) change.label = reader.string();
+        if (tag & kHasType) change.type = reader.string();
+        if (tag & kHasOldWeight) change.oldWeight = reader.real();
+        if (tag & kHasOldLabel) change.oldLabel = reader.string();
+        changes.push_back(std::move(change));
+    }
+
+    count = reader.varint();
+    if (!reader.ok || count > record.size()) return false;
+    moves.clear();
+    moves.reserve(count);
+    int64_t previousId = 0, previousX = 0, previousY = 0;
+    for (uint64_t i = 0; i < count && reader.ok; ++i) {
+        Move move;
+        previousId += reader.signedVarint();
+        previousX += reader.signedVarint();
+        previousY += reader.signedVarint();
+        move.id = static_cast<int>(previousId);
+        move.oldX = previousX;
+        move.oldY = previousY;
+        move.newX = previousX + reader.signedVarint();
+        move.newY = previousY + reader.signedVarint();
+        moves.push_back(move);
+    }
+    return reader.ok && reader.pos == record.size();
+}
+
+void Journal::play(Graph& g, size_t index, bool forward) {
+    std::vector<GraphChange> changes;
+    std::vector<Move> moves;
+    if (!decode(records_[index], changes, moves)) return;
+
+    // Пакет применяется в порядке applyDelta (удаления, затем добавления),
+    // поэтому обратная операция - тот же пакет с переставленными ролями.
+    // Обновлённое ребро добавляется заново с новыми или прежними весом и меткой
+    GraphDelta delta;
+    std::vector<std::pair<int, std::string>> types;
+    for (const auto& change : changes) {
+        bool added = change.kind == GraphChange::Kind::VertexAdded || change.kind == GraphChange::Kind::EdgeAdded;
+        bool insert = added == forward;
+        if (change.kind == GraphChange::Kind::EdgeUpdated) {
+            delta.addedEdges.emplace_back(change.from, change.to, forward ? change.weight : change.oldWeight,
+                                          g.isDirected(), forward ? change.label : change.oldLabel);
+        } else if (isVertexChange(change)) {
+            if (insert) {
+                delta.addedVertices.emplace_back(change.from, change.label);
+                if (!change.type.empty()) types.emplace_back(change.from, change.type);
+            } else {
+                delta.removedVertices.push_back(change.from);
+            }
+        } else if (insert) {
+            delta.addedEdges.emplace_back(change.from, change.to, change.weight, g.isDirected(), change.label);
+        } else {
+            delta.removedEdges.emplace_back(change.from, change.to);
+        }
+    }
+
+    replaying_ = true;
+    if (!delta.empty()) g.applyDelta(delta);
+    for (const auto& [id, type] : types) g.setVertexType(id, type);
+    for (const auto& move : moves) {
+        g.setVertexPosition(move.id, fromFixed(forward ? move.newX : move.oldX),
+                            fromFixed(forward ? move.newY : move.oldY));
+    }
+    replaying_ = false;
+}
+
+void Journal::append(std::string record, const Graph& g) {
+    // Новая операция после отмены отбрасывает отменённые записи
+    records_.resize(cursor_);
+    while (!checkpoints_.empty() && checkpoints_.back().version > cursor_) checkpoints_.pop_back();
+    records_.push_back(std::move(record));
+    ++cursor_;
+    checkpoint(g);
+}
+
+void Journal::checkpoint(const Graph& g) {
+    if (cursor_ % kCheckpointInterval != 0) return;
+    if (!checkpoints_.empty() && checkpoints_.back().version >= cursor_) return;
+    checkpoints_.push_back({cursor_, g.snapshot()});
+
+    // Прореживание от новых к старым: снимок убирается, если промежуток
+    // между его соседями не длиннее возраста более нового соседа. Промежутки
+    // растут примерно вдвое, снимков остаётся O(log) от числа записей, а
+    // переход на версию возраста a повторяет не больше max(интервал, a) записей.
+    // Начальный снимок (версия 0) остаётся всегда
+    std::vector<Checkpoint> kept;
+    kept.push_back(std::move(checkpoints_.back()));
+    for (size_t i = checkpoints_.size() - 1; i-- > 0;) {
+        if (i > 0) {
+            size_t newer = kept.back().version;
+            size_t gap = newer - checkpoints_[i - 1].version;
+            if (gap <= std::max(kCheckpointInterval, cursor_ - newer)) continue;
+        }
+        kept.push_back(std::move(checkpoints_[i]));
+    }
+    std::reverse(kept.begin(), kept.end());
+    checkpoints_ = std::move(kept);
+}
+
+bool Journal::undo(Graph& g) {
+    if (cursor_ == 0) return false;
+    play(g, cursor_ - 1, false);
+    --cursor_;
+    return true;
+}
+
+bool Journal::redo(Graph& g) {
+    if (cursor_ == records_.size()) return false;
+    play(g, cursor_, true);
+    ++cursor_;
+    checkpoint(g);
+    return true;
+}
+
+bool Journal::seek(Graph& g, size_t version) {
+    version = std::min(version, records_.size());
+    if (version == cursor_ || checkpoints_.empty()) {
+        while (cursor_ < version && redo(g)) {}
+        while (cursor_ > version && undo(g)) {}
+        return false;
+    }
+
+    // Ближайший снимок не позже цели; с него идти дешевле, если он ближе
+    // текущей версии
+    auto nearest = std::upper_bound(checkpoints_.begin(), checkpoints_.end(), version,
+                                    [](size_t v, const Checkpoint& c) { return v < c.version; });
+    const Checkpoint& base = *std::prev(nearest);
+    size_t direct = version > cursor_ ? version - cursor_ : cursor_ - version;
+    bool restored = version - base.version < direct;
+    if (restored) {
+        g.restore(*base.graph);
+        cursor_ = base.version;
+    }
+    while (cursor_ < version && redo(g)) {}
+    while (cursor_ > version && undo(g)) {}
+    return restored;
+}
+
+size_t Journal::bytes() const {
+    size_t total = 0;
+    for (const auto& record : records_) total += record.size();
+    return total;
+}
+
+bool Journal::save(const std::string& filename) const {
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    file.write(kJournalMagic, sizeof(kJournalMagic));
+    writeValue(file, kJournalVersion);
+    writeValue(file, fingerprint_);
+    writeValue(file, static_cast<uint64_t>(records_.size()));
+    writeValue(file, static_cast<uint64_t>(cursor_));
+    for (const auto& record : records_) {
+        writeValue(file, static_cast<uint32_t>(record.size()));
+        file.write(record.data(), static_cast<std::streamsize>(record.size()));
+    }
+    return static_cast<bool>(file);
+}
+
+std::optional<Journal> Journal::load(const std::string& filename, Graph& g, uint64_t fingerprint) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        return std::nullopt;
+    }
+
+    char magic[4];
+    uint32_t version = 0;
+    uint64_t hash = 0, count = 0, cursor = 0;
+    if (!file.read(magic, sizeof(magic)) || std::memcmp(magic, kJournalMagic, sizeof(magic)) != 0
+        || !readValue(file, version) || version != kJournalVersion
+        || !readValue(file, hash) || !readValue(file, count) || !readValue(file, cursor)) {
+        return std::nullopt;
+    }
+
+    // Журнал другого графа не применяется
+    if (hash != fingerprint || cursor > count) {
+        return std::nullopt;
+    }
+
+    Journal journal(g, fingerprint);
+    std::vector<GraphChange> changes;
+    std::vector<Move> moves;
+    for (uint64_t i = 0; i < count; ++i) {
+        uint32_t size = 0;
+        if (!readValue(file, size)) return std::nullopt;
+        std::string record(size, '\0');
+        if (!file.read(record.data(), size) || !decode(record, changes, moves)) return std::nullopt;
+        journal.records_.push_back(std::move(record));
+    }
+    journal.seek(g, cursor);
+    return journal;
+}
+
+} // namespace graph
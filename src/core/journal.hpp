@@ -0,0 +1,97 @@
+#pragma once
+
+#include "core/graph.hpp"
+#include <vector>
+#include <string>
+#include <memory>
+#include <optional>
+#include <cstdint>
+#include <cstddef>
+
+namespace graph {
+
+// Журнал операций для отмены и повтора: изменения графа и перемещения
+// вершин (смена макета, локальная доводка). Запись хранится в сжатом
+// двоичном виде: ID идут по возрастанию и кодируются разностями, числа -
+// varint с zigzag, координаты - фиксированной точкой с шагом 1/kPositionScale
+// пикселя, новая координата - разностью со старой.
+//
+// Отмена и повтор обращаются только к одной записи. Каждые
+// kCheckpointInterval записей снимается снимок графа (copy-on-write); старые
+// снимки прореживаются с примерно логарифмическим шагом, поэтому переход к
+// версии возраста a повторяет не больше max(kCheckpointInterval, a) записей
+class Journal {
+public:
+    static constexpr int kPositionScale = 64;
+    static constexpr size_t kCheckpointInterval = 32;
+
+    Journal() = default;
+
+    // Журнал для графа в текущем состоянии; fingerprint - отпечаток этого
+    // состояния (CSRGraph::fingerprint), по нему проверяется сохранённый журнал
+    Journal(const Graph& g, uint64_t fingerprint);
+
+    // Операция: begin запоминает координаты, record добавляет изменения
+    // графа (от подписчика), commit записывает всё, что изменилось, и
+    // возвращает false, если ничего не изменилось. Изменения вне
+    // begin/commit записываются сразу отдельной операцией
+    void begin(const Graph& g);
+    void record(const Graph& g, const std::vector<GraphChange>& changes);
+    bool commit(const Graph& g);
+
+    bool undo(Graph& g);
+    bool redo(Graph& g);
+
+    // Перейти к версии (числу применённых записей): отменой/повтором или от
+    // ближайшего снимка. true - граф восстановлен из снимка, подписчики не
+    // получили изменений
+    bool seek(Graph& g, size_t version);
+
+    // Идёт отмена/повтор: изменения графа не записываются
+    bool replaying() const { return replaying_; }
+
+    size_t version() const { return cursor_; }
+    size_t size() const { return records_.size(); }
+    size_t bytes() const;
+
+    // Сохранение рядом с графом (<граф>.journal); при загрузке журнал
+    // применяется к графу до сохранённой версии, если отпечаток совпал
+    bool save(const std::string& filename) const;
+    static std::optional<Journal> load(const std::string& filename, Graph& g, uint64_t fingerprint);
+
+private:
+    struct Move {
+        int id;
+        int64_t oldX, oldY, newX, newY;  // фиксированная точка
+    };
+    struct Position {
+        int id;
+        int64_t x, y;
+    };
+    struct Checkpoint {
+        size_t version;
+        std::shared_ptr<const Graph> graph;
+    };
+
+    uint64_t fingerprint_ = 0;
+    std::vector<std::string> records_;
+    size_t cursor_ = 0;
+    std::vector<Checkpoint> checkpoints_;  // по возрастанию версии
+
+    // Открытая операция
+    bool open_ = false;
+    std::vector<Position> before_;
+    std::vector<GraphChange> pending_;
+    bool replaying_ = false;
+
+    static std::vector<Position> positions(const Graph& g);
+    static std::string encode(const std::vector<GraphChange>& changes, const std::vector<Move>& moves);
+    static bool decode(const std::string& record, std::vector<GraphChange>& changes, std::vector<Move>& moves);
+
+    // Применить запись вперёд или обратно
+    void play(Graph& g, size_t index, bool forward);
+    void append(std::string record, const Graph& g);
+    void checkpoint(const Graph& g);
+};
+
+} // namespace graph
@@ -2,9 +2,285 @@
 #include <algorithm>
 #include <unordered_set>
 #include <unordered_map>
+#include <limits>
+#include <cmath>
+#include <iostream>
+#include <queue>
+#include <random>
 
 namespace graph {
 
+namespace {
+
+// Рабочие массивы одного потока для проходов Брандеса
+struct BrandesScratch {
+    std::vector<double> distance;
+    std::vector<double> sigma;   // число кратчайших путей от источника
+    std::vector<double> delta;   // зависимость источника от вершины
+    std::vector<int> order;      // вершины в порядке неубывания расстояния
+    
+    explicit BrandesScratch(int n)
+        : distance(n, std::numeric_limits<double>::infinity()), sigma(n, 0.0), delta(n, 0.0) {}
+};
+
+// Один проход Брандеса от source: поиск кратчайших путей (BFS при одинаковых весах,
+// иначе Dijkstra) и обратное накопление зависимостей по исходящим дугам.
+// visit(v, delta) вызывается для каждой достижимой вершины, кроме источника
+template<typename Visit>
+void brandesPass(const CSRGraph& g, int source, bool uniform, BrandesScratch& s, Visit&& visit) {
+    auto& dist = s.distance;
+    auto& sigma = s.sigma;
+    dist[source] = 0.0;
+    sigma[source] = 1.0;
+    
+    auto length = [uniform](double weight) { return uniform ? 1.0 : weight; };
+    
+    if (uniform) {
+        s.order.push_back(source);
+        for (size_t head = 0; head < s.order.size(); ++head) {
+            int u = s.order[head];
+            for (int v : g.neighbors(u)) {
+                if (dist[v] == std::numeric_limits<double>::infinity()) {
+                    dist[v] = dist[u] + 1.0;
+                    s.order.push_back(v);
+                }
+                if (dist[v] == dist[u] + 1.0) sigma[v] += sigma[u];
+            }
+        }
+    } else {
+        using Item = std::pair<double, int>;
+        std::priority_queue<Item, std::vector<Item>, std::greater<Item>> heap;
+        heap.push({0.0, source});
+        while (!heap.empty()) {
+            auto [d, u] = heap.top();
+            heap.pop();
+            if (d > dist[u]) continue;
+            s.order.push_back(u);
+            
+            auto neighbors = g.neighbors(u);
+            auto weights = g.neighborWeights(u);
+            for (size_t i = 0; i < neighbors.size(); ++i) {
+                int v = neighbors[i];
+                double alt = d + weights[i];
+                if (alt < dist[v]) {
+                    dist[v] = alt;
+                    sigma[v] = sigma[u];
+                    heap.push({alt, v});
+                } else if (alt == dist[v]) {
+                    sigma[v] += sigma[u];
+                }
+            }
+        }
+    }
+    
+    // Обратный проход: последователи вершины лежат дальше неё в order
+    for (size_t i = s.order.size(); i-- > 0;) {
+        int u = s.order[i];
+        auto neighbors = g.neighbors(u);
+        auto weights = g.neighborWeights(u);
+        for (size_t j = 0; j < neighbors.size(); ++j) {
+            int v = neighbors[j];
+            if (dist[v] == dist[u] + length(weights[j])) {
+                s.delta[u] += sigma[u] / sigma[v] * (1.0 + s.delta[v]);
+            }
+        }
+        if (u != source) visit(u, s.delta[u]);
+    }
+    
+    for (int v : s.order) {
+        dist[v] = std::numeric_limits<double>::infinity();
+        sigma[v] = 0.0;
+        s.delta[v] = 0.0;
+    }
+    s.order.clear();
+}
+
+// Взвешенный неориентированный граф уровня Louvain; петли хранят вес рёбер
+// внутри агрегированной вершины (каждое ребро учтено с двух сторон)
+struct CommunityGraph {
+    std::vector<size_t> offsets;
+    std::vector<int> targets;
+    std::vector<double> weights;
+    std::vector<double> selfLoops;
+    
+    int size() const { return static_cast<int>(selfLoops.size()); }
+    double degree(int v) const {
+        double sum = selfLoops[v];
+        for (size_t e = offsets[v]; e < offsets[v + 1]; ++e) sum += weights[e];
+        return sum;
+    }
+};
+
+CommunityGraph symmetrize(const CSRGraph& g) {
+    CSRGraph simple = g.simplified();
+    CommunityGraph result;
+    result.offsets = std::move(simple.offsets);
+    result.targets = std::move(simple.targets);
+    result.weights.assign(result.targets.size(), 1.0);
+    result.selfLoops.assign(simple.size(), 0.0);
+    return result;
+}
+
+double modularity(const CommunityGraph& g, const std::vector<int>& community, double totalWeight,
+                  double resolution, ThreadPool& pool) {
+    std::vector<double> inside(pool.size(), 0.0);
+    pool.parallelFor(g.size(), [&](size_t part, size_t begin, size_t end) {
+        double sum = 0.0;
+        for (size_t u = begin; u < end; ++u) {
+            sum += g.selfLoops[u];
+            for (size_t e = g.offsets[u]; e < g.offsets[u + 1]; ++e) {
+                if (community[g.targets[e]] == community[u]) sum += g.weights[e];
+            }
+        }
+        inside[part] = sum;
+    });
+    
+    std::unordered_map<int, double> totals;
+    for (int v = 0; v < g.size(); ++v) {
+        totals[community[v]] += g.degree(v);
+    }
+    double quality = 0.0;
+    for (double value : inside) quality += value / totalWeight;
+    for (const auto& [_, total] : totals) {
+        quality -= resolution * (total / totalWeight) * (total / totalWeight);
+    }
+    return quality;
+}
+
+// Фаза локальных перемещений; возвращает true, если разбиение изменилось.
+// Чтобы синхронные ходы не зацикливались, две одиночные вершины не меняются
+// местами: одиночка переходит только к одиночке с меньшим номером
+bool moveVertices(const CommunityGraph& g, std::vector<int>& community, double totalWeight,
+                  double resolution, ThreadPool& pool) {
+    int n = g.size();
+    std::vector<double> degree(n), total(n);
+    std::vector<int> size(n, 0);
+    for (int v = 0; v < n; ++v) {
+        community[v] = v;
+        degree[v] = g.degree(v);
+    }
+    auto recount = [&]() {
+        std::fill(total.begin(), total.end(), 0.0);
+        std::fill(size.begin(), size.end(), 0);
+        for (int v = 0; v < n; ++v) {
+            total[community[v]] += degree[v];
+            ++size[community[v]];
+        }
+    };
+    recount();
+    
+    std::vector<std::vector<double>> links(pool.size(), std::vector<double>(n, 0.0));
+    std::vector<int> target(n);
+    double quality = modularity(g, community, totalWeight, resolution, pool);
+    bool changed = false;
+    
+    for (int iteration = 0; iteration < 32; ++iteration) {
+        pool.parallelFor(n, [&](size_t part, size_t begin, size_t end) {
+            auto& weightTo = links[part];
+            std::vector<int> touched;
+            for (size_t v = begin; v < end; ++v) {
+                int own = community[v];
+                weightTo[own] = 0.0;
+                touched.assign(1, own);
+                for (size_t e = g.offsets[v]; e < g.offsets[v + 1]; ++e) {
+                    int c = community[g.targets[e]];
+                    if (weightTo[c] == 0.0 && c != own) touched.push_back(c);
+                    weightTo[c] += g.weights[e];
+                }
+                
+                // Прирост модулярности с точностью до общего множителя
+                double scale = resolution * degree[v] / totalWeight;
+                int best = own;
+                double bestGain = weightTo[own] - scale * (total[own] - degree[v]);
+                for (int c : touched) {
+                    if (c == own) continue;
+                    double gain = weightTo[c] - scale * total[c];
+                    if (gain > bestGain + 1e-12 || (best != own && gain > bestGain - 1e-12 && c < best)) {
+                        best = c;
+                        bestGain = gain;
+                    }
+                }
+                target[v] = best;
+                for (int c : touched) weightTo[c] = 0.0;
+            }
+        });
+        
+        std::vector<int> previous = community;
+        size_t moves = 0;
+        for (int v = 0; v < n; ++v) {
+            int from = community[v];
+            int to = target[v];
+            if (to == from || (size[from] == 1 && size[to] == 1 && to > from)) continue;
+            total[from] -= degree[v];
+            --size[from];
+            total[to] += degree[v];
+            ++size[to];
+            community[v] = to;
+            ++moves;
+        }
+        if (moves == 0) break;
+        
+        double updated = modularity(g, community, totalWeight, resolution, pool);
+        if (updated < quality) {
+            community = previous;
+            recount();
+            break;
+        }
+        changed = true;
+        bool converged = updated - quality < 1e-6;
+        quality = updated;
+        if (converged) break;
+    }
+    return changed;
+}
+
+// Перенумеровать сообщества в 0..count-1, вернуть count
+int renumber(std::vector<int>& community) {
+    std::unordered_map<int, int> dense;
+    for (int& c : community) {
+        auto [it, _] = dense.emplace(c, static_cast<int>(dense.size()));
+        c = it->second;
+    }
+    return static_cast<int>(dense.size());
+}
+
+CommunityGraph aggregate(const CommunityGraph& g, const std::vector<int>& community, int count) {
+    std::vector<std::vector<int>> members(count);
+    for (int v = 0; v < g.size(); ++v) {
+        members[community[v]].push_back(v);
+    }
+    
+    CommunityGraph result;
+    result.selfLoops.assign(count, 0.0);
+    result.offsets.push_back(0);
+    std::vector<double> weightTo(count, 0.0);
+    std::vector<int> touched;
+    for (int c = 0; c < count; ++c) {
+        for (int u : members[c]) {
+            result.selfLoops[c] += g.selfLoops[u];
+            for (size_t e = g.offsets[u]; e < g.offsets[u + 1]; ++e) {
+                int other = community[g.targets[e]];
+                if (other == c) {
+                    result.selfLoops[c] += g.weights[e];
+                    continue;
+                }
+                if (weightTo[other] == 0.0) touched.push_back(other);
+                weightTo[other] += g.weights[e];
+            }
+        }
+        for (int other : touched) {
+            result.targets.push_back(other);
+            result.weights.push_back(weightTo[other]);
+            weightTo[other] = 0.0;
+        }
+        touched.clear();
+        result.offsets.push_back(result.targets.size());
+    }
+    return result;
+}
+
+} // namespace
+
 ThreadPool::ThreadPool(size_t numThreads) {
     for (size_t i = 0; i < numThreads; ++i) {
         workers_.emplace_back([this] {
@@ -42,7 +318,7 @@ void ThreadPool::shutdown() {
     }
 }
 
-std::vector<int> ParallelAlgorithms::parallelBFS(Graph& g, int start, AlgorithmState& state, size_t numThreads) {
+std::vector<int> ParallelAlgorithms::parallelBFS(const Graph& g, int start, AlgorithmState& state, size_t numThreads) {
     state.reset();
     state.isRunning = true;
     
@@ -104,19 +380,117 @@ std::vector<int> ParallelAlgorithms::parallelBFS(Graph& g, int start, AlgorithmS
         }
         
         currentLevel = std::move(nextLevel);
-        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        Algorithms::stepDelay(state);
+    }
+    
+    state.isRunning = false;
+    return result;
+}
+
+std::vector<int> ParallelAlgorithms::parallelDFS(const Graph& g, int start, AlgorithmState& state, size_t numThreads) {
+    state.reset();
+    state.isRunning = true;
+    
+    CSRGraph csr = CSRGraph::fromGraph(g);
+    std::vector<int> parent = reachabilityTree(csr, start, numThreads);
+    std::vector<int> result;
+    for (int v = 0; v < csr.size(); ++v) {
+        if (parent[v] != -1) {
+            result.push_back(csr.ids[v]);
+            Algorithms::markVisited(state, csr.ids[v]);
+        }
     }
     
     state.isRunning = false;
     return result;
 }
 
-std::vector<int> ParallelAlgorithms::parallelDFS(Graph& g, int start, AlgorithmState& state, size_t /* numThreads */) {
-    // Для DFS параллелизация сложнее, используем простую версию
-    return Algorithms::DFS(g, start, state);
+std::vector<int> ParallelAlgorithms::reachabilityTree(const CSRGraph& g, int start, size_t numThreads) {
+    int n = g.size();
+    int source = g.indexOf(start);
+    if (source == -1) {
+        return std::vector<int>(n, -1);
+    }
+    numThreads = std::max<size_t>(1, numThreads);
+    
+    std::vector<std::atomic<int>> parent(n);
+    for (auto& p : parent) p.store(-1, std::memory_order_relaxed);
+    parent[source].store(source, std::memory_order_relaxed);
+    
+    // Свой стек поток ведёт без блокировки; отданная часть лежит в shared
+    struct Worker {
+        std::vector<int> stack;
+        std::mutex mutex;
+        std::vector<int> shared;
+    };
+    std::vector<Worker> workers(numThreads);
+    workers[0].stack.push_back(source);
+    std::atomic<size_t> idle{0};
+    
+    // Забрать отданную часть у любого потока (и у себя)
+    auto steal = [&](size_t self) {
+        for (size_t k = 1; k <= numThreads; ++k) {
+            Worker& victim = workers[(self + k) % numThreads];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.shared.empty()) {
+                workers[self].stack.swap(victim.shared);
+                return true;
+            }
+        }
+        return false;
+    };
+    
+    auto work = [&](size_t self) {
+        Worker& own = workers[self];
+        while (true) {
+            while (!own.stack.empty()) {
+                int v = own.stack.back();
+                own.stack.pop_back();
+                for (int u : g.neighbors(v)) {
+                    int expected = -1;
+                    if (parent[u].load(std::memory_order_relaxed) == -1 &&
+                        parent[u].compare_exchange_strong(expected, v, std::memory_order_relaxed)) {
+                        own.stack.push_back(u);
+                    }
+                }
+                if (own.stack.size() > 1 && idle.load(std::memory_order_relaxed) > 0) {
+                    std::lock_guard<std::mutex> lock(own.mutex);
+                    if (own.shared.empty()) {
+                        size_t half = own.stack.size() / 2;
+                        own.shared.assign(own.stack.begin(), own.stack.begin() + half);
+                        own.stack.erase(own.stack.begin(), own.stack.begin() + half);
+                    }
+                }
+            }
+            
+            // Работы нет. Отдают только работающие потоки, поэтому если все
+            // простаивали до просмотра очередей и в них пусто - обход закончен
+            idle.fetch_add(1);
+            while (true) {
+                bool allIdle = idle.load() == numThreads;
+                if (steal(self)) break;
+                if (allIdle) return;
+                std::this_thread::yield();
+            }
+            idle.fetch_sub(1);
+        }
+    };
+    
+    if (numThreads == 1) {
+        work(0);
+    } else {
+        ThreadPool pool(numThreads);
+        pool.parallelFor(numThreads, [&work](size_t part, size_t, size_t) { work(part); });
+    }
+    
+    std::vector<int> result(n);
+    for (int v = 0; v < n; ++v) {
+        result[v] = parent[v].load(std::memory_order_relaxed);
+    }
+    return result;
 }
 
-std::unordered_map<int, int> ParallelAlgorithms::parallelComputeDegrees(Graph& g, size_t numThreads) {
+std::unordered_map<int, int> ParallelAlgorithms::parallelComputeDegrees(const Graph& g, size_t numThreads) {
     std::unordered_map<int, int> degrees;
     std::mutex degreesMutex;
     
@@ -147,10 +521,358 @@ std::unordered_map<int, int> ParallelAlgorithms::parallelComputeDegrees(Graph& g
     return degrees;
 }
 
-std::vector<std::vector<int>> ParallelAlgorithms::parallelConnectedComponents(Graph& g, size_t /* numThreads */) {
+std::vector<std::vector<int>> ParallelAlgorithms::parallelConnectedComponents(const Graph& g, size_t /* numThreads */) {
     // Упрощенная версия, полная параллелизация сложна для компонент связности
     return g.getConnectedComponents();
 }
 
+ShortestPathTree ParallelAlgorithms::deltaStepping(const CSRGraph& g, int start, size_t numThreads, double delta) {
+    const double inf = std::numeric_limits<double>::infinity();
+    int n = g.size();
+    ShortestPathTree tree{std::vector<double>(n, inf), std::vector<int>(n, -1)};
+    int source = g.indexOf(start);
+    if (source == -1) {
+        return tree;
+    }
+    
+    if (delta <= 0.0) {
+        double total = 0.0;
+        for (double w : g.weights) total += w;
+        delta = g.weights.empty() ? 1.0 : std::max(total / g.weights.size(), 1e-9);
+    }
+    
+    numThreads = std::max<size_t>(1, numThreads);
+    ThreadPool pool(numThreads);
+    
+    // Запрос на релаксацию; применяет поток-владелец вершины (v % numThreads),
+    // поэтому запись dist/parent идёт без гонок и без атомарных операций
+    struct Request {
+        int vertex;
+        int parent;
+        double distance;
+    };
+    std::vector<std::vector<std::vector<Request>>> requests(
+        numThreads, std::vector<std::vector<Request>>(numThreads));
+    std::vector<std::vector<int>> reinserted(numThreads);
+    
+    std::vector<std::vector<int>> buckets(1);
+    auto bucketOf = [delta](double d) { return static_cast<size_t>(d / delta); };
+    
+    auto& dist = tree.distance;
+    auto& parent = tree.parent;
+    dist[source] = 0.0;
+    buckets[0].push_back(source);
+    
+    // Маленькие фазы выгоднее выполнить в текущем потоке, чем раздавать пулу
+    auto forParts = [&](size_t count, bool parallel, const auto& body) {
+        if (parallel) {
+            pool.parallelFor(count, body);
+            return;
+        }
+        size_t chunkSize = (count + numThreads - 1) / numThreads;
+        for (size_t part = 0; part < numThreads; ++part) {
+            size_t begin = std::min(count, part * chunkSize);
+            body(part, begin, std::min(count, begin + chunkSize));
+        }
+    };
+    
+    // Релаксация рёбер frontier: лёгких или тяжёлых
+    auto relax = [&](const std::vector<int>& frontier, bool light) {
+        bool parallel = numThreads > 1 && frontier.size() >= 256;
+        forParts(frontier.size(), parallel, [&](size_t part, size_t begin, size_t end) {
+            auto& outgoing = requests[part];
+            for (size_t i = begin; i < end; ++i) {
+                int u = frontier[i];
+                auto neighbors = g.neighbors(u);
+                auto weights = g.neighborWeights(u);
+                for (size_t e = 0; e < neighbors.size(); ++e) {
+                    if ((weights[e] <= delta) != light) continue;
+                    double alt = dist[u] + weights[e];
+                    int v = neighbors[e];
+                    if (alt < dist[v]) {
+                        outgoing[v % numThreads].push_back({v, u, alt});
+                    }
+                }
+            }
+        });
+        forParts(numThreads, parallel, [&](size_t, size_t begin, size_t end) {
+            for (size_t owner = begin; owner < end; ++owner) {
+                for (size_t producer = 0; producer < numThreads; ++producer) {
+                    auto& incoming = requests[producer][owner];
+                    for (const auto& request : incoming) {
+                        if (request.distance < dist[request.vertex]) {
+                            dist[request.vertex] = request.distance;
+                            parent[request.vertex] = request.parent;
+                            reinserted[owner].push_back(request.vertex);
+                        }
+                    }
+                    incoming.clear();
+                }
+            }
+        });
+        // Разложить обновлённые вершины по корзинам
+        for (auto& list : reinserted) {
+            for (int v : list) {
+                size_t bucket = bucketOf(dist[v]);
+                if (bucket >= buckets.size()) buckets.resize(bucket + 1);
+                buckets[bucket].push_back(v);
+            }
+            list.clear();
+        }
+    };
+    
+    std::vector<char> inFrontier(n, 0), removed(n, 0);
+    for (size_t current = 0; current < buckets.size(); ++current) {
+        std::vector<int> settled;
+        while (!buckets[current].empty()) {
+            // Актуальные вершины корзины без повторов
+            std::vector<int> frontier;
+            for (int v : buckets[current]) {
+                if (!inFrontier[v] && bucketOf(dist[v]) == current) {
+                    inFrontier[v] = 1;
+                    frontier.push_back(v);
+                }
+            }
+            buckets[current].clear();
+            for (int v : frontier) {
+                inFrontier[v] = 0;
+                if (!removed[v]) {
+                    removed[v] = 1;
+                    settled.push_back(v);
+                }
+            }
+            relax(frontier, true);
+        }
+        
+        // Тяжёлые рёбра не могут вернуть вершину в текущую корзину
+        relax(settled, false);
+        for (int v : settled) {
+            removed[v] = 0;
+        }
+    }
+    
+    return tree;
+}
+
+PageRankResult ParallelAlgorithms::pageRank(const CSRGraph& g, size_t numThreads, int personalizedFrom,
+                                            double damping, double tolerance, size_t maxIterations) {
+    PageRankResult result;
+    int n = g.size();
+    if (n == 0) {
+        return result;
+    }
+    
+    int seed = personalizedFrom == -1 ? -1 : g.indexOf(personalizedFrom);
+    if (personalizedFrom != -1 && seed == -1) {
+        std::cerr << "Вершина " << personalizedFrom << " не найдена" << std::endl;
+        return result;
+    }
+    
+    CSRGraph incoming = g.transposed();
+    std::vector<double> inverseDegree(n);
+    for (int u = 0; u < n; ++u) {
+        size_t degree = g.degree(u);
+        inverseDegree[u] = degree == 0 ? 0.0 : 1.0 / static_cast<double>(degree);
+    }
+    
+    // Вероятность телепортации в вершину v
+    auto teleport = [seed, n](int v) {
+        if (seed == -1) return 1.0 / n;
+        return v == seed ? 1.0 : 0.0;
+    };
+    
+    std::vector<double> rank(n), next(n), contribution(n);
+    for (int v = 0; v < n; ++v) {
+        rank[v] = teleport(v);
+    }
+    
+    numThreads = std::max<size_t>(1, numThreads);
+    ThreadPool pool(numThreads);
+    std::vector<double> partial(numThreads);
+    
+    auto sumPartial = [&partial]() {
+        double total = 0.0;
+        for (double& value : partial) {
+            total += value;
+            value = 0.0;
+        }
+        return total;
+    };
+    
+    while (result.iterations < maxIterations) {
+        ++result.iterations;
+        
+        // Вклад каждой вершины в соседей; масса висячих вершин распределяется
+        // по вектору телепортации
+        pool.parallelFor(n, [&](size_t part, size_t begin, size_t end) {
+            double dangling = 0.0;
+            for (size_t u = begin; u < end; ++u) {
+                contribution[u] = rank[u] * inverseDegree[u];
+                if (inverseDegree[u] == 0.0) dangling += rank[u];
+            }
+            partial[part] = dangling;
+        });
+        double base = (1.0 - damping) + damping * sumPartial();
+        
+        pool.parallelFor(n, [&](size_t part, size_t begin, size_t end) {
+            double change = 0.0;
+            for (size_t v = begin; v < end; ++v) {
+                double sum = 0.0;
+                for (int u : incoming.neighbors(static_cast<int>(v))) {
+                    sum += contribution[u];
+                }
+                next[v] = base * teleport(static_cast<int>(v)) + damping * sum;
+                change += std::abs(next[v] - rank[v]);
+            }
+            partial[part] = change;
+        });
+        result.residual = sumPartial();
+        rank.swap(next);
+        
+        if (result.residual < tolerance) {
+            break;
+        }
+    }
+    
+    result.score = std::move(rank);
+    return result;
+}
+
+BetweennessResult ParallelAlgorithms::betweenness(const CSRGraph& g, size_t numThreads, double epsilon,
+                                                  double failureProbability, uint32_t seed) {
+    BetweennessResult result;
+    int n = g.size();
+    result.score.assign(n, 0.0);
+    if (n < 3) {
+        return result;
+    }
+    
+    bool uniform = std::all_of(g.weights.begin(), g.weights.end(),
+        [&g](double w) { return w == g.weights.front(); });
+    
+    bool exact = epsilon <= 0.0;
+    std::vector<int> sources(n);
+    for (int v = 0; v < n; ++v) sources[v] = v;
+    if (!exact) {
+        std::mt19937 gen(seed);
+        std::shuffle(sources.begin(), sources.end(), gen);
+    }
+    
+    numThreads = std::max<size_t>(1, numThreads);
+    ThreadPool pool(numThreads);
+    
+    // Накопители каждого потока сливаются только при проверке границы ошибки
+    std::vector<BrandesScratch> scratch;
+    std::vector<std::vector<double>> sum(numThreads, std::vector<double>(n, 0.0));
+    std::vector<std::vector<double>> sumSquares(exact ? 0 : numThreads, std::vector<double>(n, 0.0));
+    for (size_t t = 0; t < numThreads; ++t) scratch.emplace_back(n);
+    
+    // Граница Бернштейна с эмпирической дисперсией и поправкой на n вершин:
+    // eps = sqrt(2 * Var * L / k) + 3 * L / k, L = ln(3n / failureProbability).
+    // Зависимость источника нормируется на n - 1, чтобы лежать в [0, 1]
+    double logTerm = std::log(3.0 * n / std::clamp(failureProbability, 1e-12, 1.0));
+    size_t batch = exact ? n : std::max<size_t>(numThreads, static_cast<size_t>(std::ceil(3.0 * logTerm / epsilon)));
+    
+    std::vector<double> total(n), totalSquares(n);
+    size_t done = 0;
+    while (done < static_cast<size_t>(n)) {
+        size_t count = std::min(batch, n - done);
+        pool.parallelFor(count, [&](size_t part, size_t begin, size_t end) {
+            auto& local = sum[part];
+            for (size_t i = begin; i < end; ++i) {
+                brandesPass(g, sources[done + i], uniform, scratch[part], [&](int v, double dependency) {
+                    local[v] += dependency;
+                    if (!exact) sumSquares[part][v] += dependency * dependency;
+                });
+            }
+        });
+        done += count;
+        if (exact || done == static_cast<size_t>(n)) break;
+        
+        std::fill(total.begin(), total.end(), 0.0);
+        std::fill(totalSquares.begin(), totalSquares.end(), 0.0);
+        for (size_t t = 0; t < numThreads; ++t) {
+            for (int v = 0; v < n; ++v) {
+                total[v] += sum[t][v];
+                totalSquares[v] += sumSquares[t][v];
+            }
+        }
+        
+        double k = static_cast<double>(done);
+        double scale = 1.0 / (n - 1);
+        double worst = 0.0;
+        for (int v = 0; v < n; ++v) {
+            double mean = total[v] * scale / k;
+            double variance = std::max(0.0, totalSquares[v] * scale * scale / k - mean * mean);
+            worst = std::max(worst, std::sqrt(2.0 * variance * logTerm / k) + 3.0 * logTerm / k);
+        }
+        result.errorBound = worst;
+        if (worst <= epsilon) break;
+        batch = std::max<size_t>(batch / 2, done / 2);
+    }
+    
+    result.samples = done;
+    bool complete = done == static_cast<size_t>(n);
+    if (complete) result.errorBound = 0.0;
+    
+    // Оценка по выборке масштабируется на все источники; в неориентированном
+    // графе каждая пара учтена дважды
+    double factor = (complete ? 1.0 : static_cast<double>(n) / done) * (g.directed ? 1.0 : 0.5);
+    for (size_t t = 0; t < numThreads; ++t) {
+        for (int v = 0; v < n; ++v) {
+            result.score[v] += sum[t][v];
+        }
+    }
+    for (double& value : result.score) value *= factor;
+    return result;
+}
+
+CommunityResult ParallelAlgorithms::louvain(const CSRGraph& g, size_t numThreads, double resolution) {
+    CommunityResult result;
+    int n = g.size();
+    result.community.resize(n);
+    for (int v = 0; v < n; ++v) result.community[v] = v;
+    result.count = n;
+    if (n == 0) {
+        return result;
+    }
+    
+    CommunityGraph base = symmetrize(g);
+    double totalWeight = 0.0;
+    for (int v = 0; v < n; ++v) totalWeight += base.degree(v);
+    if (totalWeight == 0.0) {
+        return result;
+    }
+    
+    ThreadPool pool(std::max<size_t>(1, numThreads));
+    CommunityGraph level = base;
+    while (result.levels < 20) {
+        std::vector<int> community(level.size());
+        bool changed = moveVertices(level, community, totalWeight, resolution, pool);
+        int count = renumber(community);
+        for (int& c : result.community) c = community[c];
+        result.count = count;
+        ++result.levels;
+        
+        if (!changed || count == level.size()) break;
+        level = aggregate(level, community, count);
+    }
+    
+    result.modularity = modularity(base, result.community, totalWeight, resolution, pool);
+    return result;
+}
+
+std::vector<int> ParallelAlgorithms::topVertices(const CSRGraph& g, const std::vector<double>& score, size_t k) {
+    std::vector<int> order(score.size());
+    for (size_t v = 0; v < order.size(); ++v) order[v] = static_cast<int>(v);
+    k = std::min(k, order.size());
+    std::partial_sort(order.begin(), order.begin() + k, order.end(),
+        [&](int a, int b) { return score[a] != score[b] ? score[a] > score[b] : a < b; });
+    
+    std::vector<int> ids;
+    for (size_t i = 0; i < k; ++i) ids.push_back(g.ids[order[i]]);
+    return ids;
+}
+
 } // namespace graph
 
@@ -2,6 +2,7 @@
 
 #include "core/graph.hpp"
 #include "core/algorithms.hpp"
+#include "core/csr.hpp"
 #include <thread>
 #include <vector>
 #include <queue>
@@ -12,6 +13,8 @@
 #include <future>
 #include <type_traits>
 #include <stdexcept>
+#include <algorithm>
+#include <cstdint>
 
 namespace graph {
 
@@ -25,6 +28,14 @@ public:
     
     void shutdown();
     
+    size_t size() const { return workers_.size(); }
+    
+    // Разбить [0, count) на части по числу потоков и выполнить
+    // body(номер части, begin, end) параллельно; возвращает управление после
+    // завершения всех частей. Нельзя вызывать из задачи этого же пула
+    template<typename F>
+    void parallelFor(size_t count, F&& body);
+    
 private:
     std::vector<std::thread> workers_;
     std::queue<std::function<void()>> tasks_;
@@ -53,19 +64,97 @@ auto ThreadPool::enqueue(F&& f, Args&&... args) -> std::future<typename std::inv
     return result;
 }
 
+template<typename F>
+void ThreadPool::parallelFor(size_t count, F&& body) {
+    size_t parts = std::max<size_t>(1, workers_.size());
+    size_t chunkSize = (count + parts - 1) / parts;
+    std::vector<std::future<void>> futures;
+    for (size_t part = 0; part < parts; ++part) {
+        size_t begin = std::min(count, part * chunkSize);
+        size_t end = std::min(count, begin + chunkSize);
+        futures.push_back(enqueue([&body, part, begin, end]() { body(part, begin, end); }));
+    }
+    for (auto& future : futures) {
+        future.get();
+    }
+}
+
+// Дерево кратчайших путей по плотным индексам CSR
+struct ShortestPathTree {
+    std::vector<double> distance;  // infinity для недостижимых вершин
+    std::vector<int> parent;       // -1 для источника и недостижимых
+};
+
+struct PageRankResult {
+    std::vector<double> score;  // по плотным индексам CSR, сумма равна 1
+    size_t iterations = 0;
+    double residual = 0.0;      // L1-норма изменения на последней итерации
+};
+
+struct BetweennessResult {
+    std::vector<double> score;  // по плотным индексам CSR; в выборочном режиме - оценка
+    size_t samples = 0;         // обработано источников
+    double errorBound = 0.0;    // граница ошибки нормированной центральности, 0 - точно
+};
+
+struct CommunityResult {
+    std::vector<int> community;  // по плотным индексам CSR, номера 0..count-1
+    int count = 0;
+    double modularity = 0.0;
+    size_t levels = 0;           // уровней агрегации Louvain
+};
+
 class ParallelAlgorithms {
 public:
     // Параллельный BFS с разделением уровней
-    static std::vector<int> parallelBFS(Graph& g, int start, AlgorithmState& state, size_t numThreads = 4);
+    static std::vector<int> parallelBFS(const Graph& g, int start, AlgorithmState& state, size_t numThreads = 4);
+    
+    // Параллельный обход из start: вершины, достижимые из неё (по
+    // возрастанию плотного индекса; порядок DFS не соблюдается - ветви
+    // обходят разные потоки, см. reachabilityTree)
+    static std::vector<int> parallelDFS(const Graph& g, int start, AlgorithmState& state, size_t numThreads = 4);
     
-    // Параллельный DFS с разделением ветвей
-    static std::vector<int> parallelDFS(Graph& g, int start, AlgorithmState& state, size_t numThreads = 4);
+    // Дерево достижимости от start без требования порядка DFS: у каждого
+    // потока свой стек, и поток с работой отдаёт нижнюю половину стека
+    // (корни самых больших необойдённых ветвей), когда другие простаивают.
+    // Вершину забирает поток, первым записавший ей родителя.
+    // parent[v] - вершина, из которой достигнута v (у start - сама start),
+    // -1 - недостижима; индексы плотные
+    static std::vector<int> reachabilityTree(const CSRGraph& g, int start, size_t numThreads = 4);
     
     // Параллельное вычисление степеней вершин
-    static std::unordered_map<int, int> parallelComputeDegrees(Graph& g, size_t numThreads = 4);
+    static std::unordered_map<int, int> parallelComputeDegrees(const Graph& g, size_t numThreads = 4);
     
     // Параллельное вычисление компонент связности
-    static std::vector<std::vector<int>> parallelConnectedComponents(Graph& g, size_t numThreads = 4);
+    static std::vector<std::vector<int>> parallelConnectedComponents(const Graph& g, size_t numThreads = 4);
+    
+    // Delta-stepping SSSP: вершины раскладываются по корзинам ширины delta,
+    // лёгкие (w <= delta) и тяжёлые рёбра корзины релаксируются параллельно.
+    // delta = 0 - выбрать по среднему весу ребра
+    static ShortestPathTree deltaStepping(const CSRGraph& g, int start, size_t numThreads = 4, double delta = 0.0);
+    
+    // PageRank: pull-итерации по входящим дугам с двумя буферами до сходимости
+    // по L1-норме. personalizedFrom != -1 - персонализированный PageRank,
+    // телепортация всегда в эту вершину (внешний id)
+    static PageRankResult pageRank(const CSRGraph& g, size_t numThreads = 4, int personalizedFrom = -1,
+                                   double damping = 0.85, double tolerance = 1e-6, size_t maxIterations = 100);
+    
+    // Центральность по посредничеству (Брандес): проходы от источников выполняются
+    // на пуле с локальными для потока накопителями. epsilon = 0 - точный расчёт по всем
+    // источникам; иначе источники выбираются случайно, пока эмпирическая граница
+    // Бернштейна для нормированной центральности (доля пар) не станет <= epsilon
+    // с вероятностью 1 - failureProbability
+    static BetweennessResult betweenness(const CSRGraph& g, size_t numThreads = 4, double epsilon = 0.0,
+                                         double failureProbability = 0.1, uint32_t seed = 42);
+    
+    // Сообщества методом Louvain: выбор лучшего сообщества для всех вершин
+    // считается параллельно по снимку назначений, затем ходы применяются
+    // и граф сообществ агрегируется. Граф рассматривается как неориентированный
+    // и невзвешенный: веса рёбер в проекте - длины, а не сила связи
+    static CommunityResult louvain(const CSRGraph& g, size_t numThreads = 4, double resolution = 1.0);
+    
+    // k вершин с наибольшей оценкой (внешние ID, по убыванию)
+    static std::vector<int> topVertices(const CSRGraph& g, const std::vector<double>& score, size_t k);
 };
 
 } // namespace graph
@@ -0,0 +1,438 @@
+#include "core/query.hpp"
+#include <algorithm>
+#include <functional>
+#include <cctype>
+#include <tuple>
+#include <limits>
+
+namespace graph {
+
+namespace {
+
+// Символы имени типа вершины или связи (UTF-8 байты тоже допустимы)
+bool isNameChar(char c) {
+    unsigned char u = static_cast<unsigned char>(c);
+    return std::isalnum(u) || u >= 0x80 || c == '_' || c == '.' || c == ':';
+}
+
+void skipSpaces(const std::string& text, size_t& pos) {
+    while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos]))) ++pos;
+}
+
+std::string readName(const std::string& text, size_t& pos) {
+    size_t begin = pos;
+    while (pos < text.size() && isNameChar(text[pos])) ++pos;
+    return text.substr(begin, pos - begin);
+}
+
+} // namespace
+
+QueryEngine::LabelAdjacency QueryEngine::LabelAdjacency::fromSorted(std::span<const std::pair<int, int>> arcs) {
+    LabelAdjacency adjacency;
+    adjacency.targets.reserve(arcs.size());
+    for (const auto& [from, to] : arcs) {
+        if (adjacency.sources.empty() || adjacency.sources.back() != from) {
+            if (!adjacency.sources.empty()) adjacency.offsets.push_back(adjacency.targets.size());
+            adjacency.sources.push_back(from);
+        }
+        adjacency.targets.push_back(to);
+    }
+    if (!adjacency.sources.empty()) adjacency.offsets.push_back(adjacency.targets.size());
+    return adjacency;
+}
+
+std::span<const int> QueryEngine::LabelAdjacency::neighbors(int v) const {
+    auto it = std::lower_bound(sources.begin(), sources.end(), v);
+    if (it == sources.end() || *it != v) return {};
+    size_t i = static_cast<size_t>(it - sources.begin());
+    return {targets.data() + offsets[i], targets.data() + offsets[i + 1]};
+}
+
+QueryEngine QueryEngine::build(const Graph& g, const std::atomic<bool>* cancel) {
+    QueryEngine engine;
+    auto cancelled = [cancel] { return cancel && cancel->load(std::memory_order_relaxed); };
+    engine.ids_ = g.getVertices();
+    std::sort(engine.ids_.begin(), engine.ids_.end());
+    for (int v = 0; v < engine.size(); ++v) {
+        engine.index_[engine.ids_[v]] = v;
+        if (const Vertex* vertex = g.getVertex(engine.ids_[v])) {
+            if (!vertex->type.empty()) engine.byType_[vertex->type].push_back(v);
+            if (!vertex->label.empty()) engine.byLabel_[vertex->label].push_back(v);
+        }
+    }
+
+    // Дуги (тип, источник, цель); дуги без типа попадают только в общий индекс
+    struct Arc {
+        int relation, from, to;
+        bool operator<(const Arc& other) const {
+            return std::tie(relation, from, to) < std::tie(other.relation, other.from, other.to);
+        }
+        bool operator==(const Arc& other) const = default;
+    };
+    std::vector<Arc> arcs;
+    g.forEachAdjacency([&](int from, const EdgeList& edges) {
+        for (const auto& edge : edges) {
+            int relation = -1;
+            if (!edge.label.empty()) {
+                auto [it, inserted] = engine.relationIndex_.try_emplace(edge.label, static_cast<int>(engine.relations_.size()));
+                if (inserted) engine.relations_.push_back(edge.label);
+                relation = it->second;
+            }
+            arcs.push_back({relation, engine.index_.at(from), engine.index_.at(edge.to)});
+        }
+    });
+    if (cancelled()) return engine;
+
+    auto buildIndex = [&arcs](int relations, bool reverse, std::vector<LabelAdjacency>& byRelation, LabelAdjacency& any) {
+        std::vector<Arc> oriented = arcs;
+        if (reverse) {
+            for (auto& arc : oriented) std::swap(arc.from, arc.to);
+        }
+        std::sort(oriented.begin(), oriented.end());
+        oriented.erase(std::unique(oriented.begin(), oriented.end()), oriented.end());
+
+        std::vector<std::pair<int, int>> pairs;
+        pairs.reserve(oriented.size());
+        byRelation.resize(relations);
+        size_t i = 0;
+        while (i < oriented.size()) {
+            int relation = oriented[i].relation;
+            pairs.clear();
+            for (; i < oriented.size() && oriented[i].relation == relation; ++i) {
+                pairs.emplace_back(oriented[i].from, oriented[i].to);
+            }
+            if (relation >= 0) byRelation[relation] = LabelAdjacency::fromSorted(pairs);
+        }
+
+        pairs.clear();
+        for (const auto& arc : oriented) pairs.emplace_back(arc.from, arc.to);
+        std::sort(pairs.begin(), pairs.end());
+        pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+        any = LabelAdjacency::fromSorted(pairs);
+    };
+    int relations = static_cast<int>(engine.relations_.size());
+    buildIndex(relations, false, engine.forward_, engine.any_);
+    if (cancelled()) return engine;
+    buildIndex(relations, true, engine.backward_, engine.anyBackward_);
+    return engine;
+}
+
+std::optional<PathPattern> QueryEngine::parse(const std::string& text, std::string* error) {
+    auto fail = [error](const std::string& message, size_t pos) -> std::optional<PathPattern> {
+        if (error) *error = message + " (позиция " + std::to_string(pos + 1) + ")";
+        return std::nullopt;
+    };
+
+    PathPattern pattern;
+    size_t pos = 0;
+    while (true) {
+        skipSpaces(text, pos);
+        if (pos >= text.size()) {
+            return fail(pattern.nodes.empty() ? "Пустой запрос" : "Ожидался узел после связи", pos);
+        }
+
+        NodePattern node;
+        char c = text[pos];
+        if (c == '?' || c == '*') {
+            ++pos;
+        } else if (c == '#') {
+            size_t begin = ++pos;
+            while (pos < text.size() && (std::isdigit(static_cast<unsigned char>(text[pos])) || (pos == begin && text[pos] == '-'))) ++pos;
+            if (pos == begin || text.compare(begin, pos - begin, "-") == 0 || pos - begin > 10) {
+                return fail("Ожидался ID вершины после #", begin);
+            }
+            node.kind = NodePattern::Kind::Vertex;
+            node.id = std::stoi(text.substr(begin, pos - begin));
+        } else if (c == '"') {
+            size_t end = text.find('"', pos + 1);
+            if (end == std::string::npos) return fail("Незакрытая кавычка", pos);
+            node.kind = NodePattern::Kind::Label;
+            node.value = text.substr(pos + 1, end - pos - 1);
+            pos = end + 1;
+        } else if (isNameChar(c)) {
+            node.kind = NodePattern::Kind::Type;
+            node.value = readName(text, pos);
+        } else {
+            return fail("Ожидался узел: ?, тип, #ID или \"метка\"", pos);
+        }
+        pattern.nodes.push_back(std::move(node));
+
+        skipSpaces(text, pos);
+        if (pos >= text.size()) break;
+
+        // Связь: -rel-> или <-rel-, вместо rel можно ? или ничего
+        EdgePattern edge;
+        if (text.compare(pos, 2, "<-") == 0) {
+            pos += 2;
+            edge.reversed = true;
+        } else if (text[pos] == '-') {
+            ++pos;
+        } else {
+            return fail("Ожидалась связь -тип-> или <-тип-", pos);
+        }
+        skipSpaces(text, pos);
+        if (pos < text.size() && (text[pos] == '?' || text[pos] == '*')) {
+            ++pos;
+        } else if (pos < text.size() && text[pos] == '"') {
+            // Тип связи с пробелами: -"related to"->
+            size_t end = text.find('"', pos + 1);
+            if (end == std::string::npos) return fail("Незакрытая кавычка", pos);
+            edge.label = text.substr(pos + 1, end - pos - 1);
+            pos = end + 1;
+        } else {
+            edge.label = readName(text, pos);
+        }
+        skipSpaces(text, pos);
+        if (edge.reversed ? text.compare(pos, 1, "-") != 0 : text.compare(pos, 2, "->") != 0) {
+            return fail(edge.reversed ? "Ожидался - после типа связи" : "Ожидалось -> после типа связи", pos);
+        }
+        pos += edge.reversed ? 1 : 2;
+        pattern.edges.push_back(std::move(edge));
+    }
+    return pattern;
+}
+
+const QueryEngine::LabelAdjacency* QueryEngine::adjacency(const EdgePattern& edge, bool forward) const {
+    bool alongArcs = forward != edge.reversed;
+    if (edge.label.empty()) {
+        return alongArcs ? &any_ : &anyBackward_;
+    }
+    auto it = relationIndex_.find(edge.label);
+    if (it == relationIndex_.end()) return nullptr;
+    return alongArcs ? &forward_[it->second] : &backward_[it->second];
+}
+
+QueryEngine::Candidates QueryEngine::initial(const PathPattern& pattern, size_t node) const {
+    Candidates candidates;
+    const NodePattern& spec = pattern.nodes[node];
+
+    // Узел ? не ограничен: список появится из первого полуджойна в него
+    if (spec.kind == NodePattern::Kind::Any) {
+        if (pattern.edges.empty()) materialize(pattern, node, candidates);
+        return candidates;
+    }
+
+    auto fromMap = [](const std::unordered_map<std::string, std::vector<int>>& map, const std::string& key) {
+        auto it = map.find(key);
+        return it == map.end() ? std::vector<int>{} : it->second;
+    };
+    if (spec.kind == NodePattern::Kind::Type) {
+        candidates.list = fromMap(byType_, spec.value);
+    } else if (spec.kind == NodePattern::Kind::Label) {
+        candidates.list = fromMap(byLabel_, spec.value);
+    } else if (auto it = index_.find(spec.id); it != index_.end()) {
+        candidates.list.push_back(it->second);
+    }
+    candidates.bounded = true;
+    candidates.mask = VertexMask(ids_.size());
+    for (int v : candidates.list) candidates.mask.set(v);
+    return candidates;
+}
+
+void QueryEngine::materialize(const PathPattern& pattern, size_t node, Candidates& candidates) const {
+    // Вершины, у которых есть дуги нужного типа со всех сторон узла
+    bool first = true;
+    auto restrict = [&](const LabelAdjacency* adj) {
+        std::vector<int> sources = adj ? adj->sources : std::vector<int>{};
+        if (first) {
+            candidates.list = std::move(sources);
+            first = false;
+            return;
+        }
+        std::vector<int> both;
+        std::set_intersection(candidates.list.begin(), candidates.list.end(),
+                              sources.begin(), sources.end(), std::back_inserter(both));
+        candidates.list.swap(both);
+    };
+    if (node > 0) restrict(adjacency(pattern.edges[node - 1], false));
+    if (node < pattern.edges.size()) restrict(adjacency(pattern.edges[node], true));
+    if (first) {
+        candidates.list.resize(ids_.size());
+        for (int v = 0; v < size(); ++v) candidates.list[v] = v;
+    }
+
+    candidates.bounded = true;
+    candidates.mask = VertexMask(ids_.size());
+    for (int v : candidates.list) candidates.mask.set(v);
+}
+
+bool QueryEngine::semijoin(const Candidates& from, Candidates& to, const EdgePattern& edge, bool forward) const {
+    const LabelAdjacency* out = adjacency(edge, forward);
+    const LabelAdjacency* in = adjacency(edge, !forward);
+    size_t before = to.list.size();
+    bool wasBounded = to.bounded;
+
+    // Неограниченный узел получает ровно соседей from
+    if (!to.bounded) {
+        to.bounded = true;
+        to.mask = VertexMask(ids_.size());
+        if (!out) return true;
+        for (int u : from.list) {
+            for (int w : out->neighbors(u)) {
+                if (to.mask.test(w)) continue;
+                to.mask.set(w);
+                to.list.push_back(w);
+            }
+        }
+        return true;
+    }
+
+    // Прямо: отметить соседей from; обратно: проверить входящие дуги to.
+    // Выбирается направление с меньшим ожидаемым числом просмотренных дуг
+    if (!out || !in) {
+        to.list.clear();
+    } else if (from.list.size() * out->averageDegree() <= to.list.size() * in->averageDegree()) {
+        VertexMask reached(ids_.size());
+        for (int u : from.list) {
+            for (int w : out->neighbors(u)) reached.set(w);
+        }
+        std::erase_if(to.list, [&reached](int v) { return !reached.test(v); });
+    } else {
+        std::erase_if(to.list, [&](int v) {
+            auto sources = in->neighbors(v);
+            return std::none_of(sources.begin(), sources.end(), [&from](int u) { return from.mask.test(u); });
+        });
+    }
+
+    if (to.list.size() == before) return !wasBounded;
+    VertexMask mask(ids_.size());
+    for (int v : to.list) mask.set(v);
+    to.mask = std::move(mask);
+    return true;
+}
+
+QueryResult QueryEngine::evaluate(const PathPattern& pattern, size_t limit) const {
+    QueryResult result;
+    size_t nodes = pattern.nodes.size();
+    if (nodes == 0 || pattern.edges.size() + 1 != nodes) return result;
+
+    std::vector<Candidates> candidates;
+    candidates.reserve(nodes);
+    for (size_t i = 0; i < nodes; ++i) candidates.push_back(initial(pattern, i));
+
+    // Работа - полуджойн по ребру edge в сторону forward (из узла edge в edge + 1
+    // или обратно). Следующей берётся работа с самым маленьким множеством-источником
+    struct Work {
+        size_t edge;
+        bool forward;
+        size_t source() const { return forward ? edge : edge + 1; }
+        size_t target() const { return forward ? edge + 1 : edge; }
+    };
+    std::vector<Work> worklist;
+    std::vector<char> pending(2 * pattern.edges.size(), 1);
+    for (size_t e = 0; e < pattern.edges.size(); ++e) {
+        worklist.push_back({e, true});
+        worklist.push_back({e, false});
+    }
+    auto schedule = [&](size_t node) {
+        if (node > 0 && !pending[2 * (node - 1) + 1]) {
+            pending[2 * (node - 1) + 1] = 1;
+            worklist.push_back({node - 1, false});
+        }
+        if (node < pattern.edges.size() && !pending[2 * node]) {
+            pending[2 * node] = 1;
+            worklist.push_back({node, true});
+        }
+    };
+
+    // Неограниченный узел считается самым большим; если ограниченных
+    // источников не осталось, он заполняется по индексу типов связей
+    auto estimate = [&candidates](size_t node) {
+        return candidates[node].bounded ? candidates[node].list.size() : std::numeric_limits<size_t>::max();
+    };
+    bool empty = std::any_of(candidates.begin(), candidates.end(),
+                             [](const Candidates& c) { return c.bounded && c.list.empty(); });
+    while (!worklist.empty() && !empty) {
+        auto next = std::min_element(worklist.begin(), worklist.end(), [&](const Work& a, const Work& b) {
+            return estimate(a.source()) < estimate(b.source());
+        });
+        Work work = *next;
+        worklist.erase(next);
+        pending[2 * work.edge + (work.forward ? 0 : 1)] = 0;
+        if (!candidates[work.source()].bounded) {
+            materialize(pattern, work.source(), candidates[work.source()]);
+            if (candidates[work.source()].list.empty()) {
+                empty = true;
+                break;
+            }
+        }
+        
+        // Неограниченную цель дешевле заполнить по индексу, если вершин с
+        // дугами этого типа меньше, чем дуг из источника
+        if (!candidates[work.target()].bounded) {
+            const LabelAdjacency* out = adjacency(pattern.edges[work.edge], work.forward);
+            const LabelAdjacency* in = adjacency(pattern.edges[work.edge], !work.forward);
+            if (out && in && in->sources.size() < candidates[work.source()].list.size() * out->averageDegree()) {
+                materialize(pattern, work.target(), candidates[work.target()]);
+            }
+        }
+
+        if (semijoin(candidates[work.source()], candidates[work.target()], pattern.edges[work.edge], work.forward)) {
+            empty = candidates[work.target()].list.empty();
+            schedule(work.target());
+        }
+    }
+
+    if (empty) {
+        result.bindings.assign(nodes, {});
+        return result;
+    }
+    for (const auto& c : candidates) {
+        std::vector<int> ids;
+        ids.reserve(c.list.size());
+        for (int v : c.list) ids.push_back(ids_[v]);
+        std::sort(ids.begin(), ids.end());
+        result.bindings.push_back(std::move(ids));
+    }
+
+    // Перечисление путей: после сужения каждый шаг продолжается хотя бы одним соседом
+    std::vector<int> path(nodes);
+    std::function<bool(size_t)> extend = [&](size_t i) {
+        if (i + 1 == nodes) {
+            if (result.paths.size() >= limit) {
+                result.truncated = true;
+                return false;
+            }
+            std::vector<int> ids;
+            ids.reserve(nodes);
+            for (int v : path) ids.push_back(ids_[v]);
+            result.paths.push_back(std::move(ids));
+            return true;
+        }
+        for (int w : adjacency(pattern.edges[i], true)->neighbors(path[i])) {
+            if (!candidates[i + 1].mask.test(w)) continue;
+            path[i + 1] = w;
+            if (!extend(i + 1)) return false;
+        }
+        return true;
+    };
+    for (int v : candidates[0].list) {
+        path[0] = v;
+        if (!extend(0)) break;
+    }
+    return result;
+}
+
+std::vector<std::pair<std::string, size_t>> QueryEngine::relationCounts() const {
+    std::vector<std::pair<std::string, size_t>> counts;
+    for (size_t r = 0; r < relations_.size(); ++r) {
+        counts.emplace_back(relations_[r], forward_[r].targets.size());
+    }
+    std::sort(counts.begin(), counts.end(), [](const auto& a, const auto& b) {
+        return a.second != b.second ? a.second > b.second : a.first < b.first;
+    });
+    return counts;
+}
+
+std::vector<std::pair<std::string, size_t>> QueryEngine::typeCounts() const {
+    std::vector<std::pair<std::string, size_t>> counts;
+    for (const auto& [type, vertices] : byType_) {
+        counts.emplace_back(type, vertices.size());
+    }
+    std::sort(counts.begin(), counts.end(), [](const auto& a, const auto& b) {
+        return a.second != b.second ? a.second > b.second : a.first < b.first;
+    });
+    return counts;
+}
+
+} // namespace graph
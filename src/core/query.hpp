@@ -0,0 +1,116 @@
+#pragma once
+
+#include "core/graph.hpp"
+#include "core/subgraph.hpp"
+#include <atomic>
+#include <vector>
+#include <string>
+#include <span>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <cstddef>
+
+namespace graph {
+
+// Узел шаблона пути: любая вершина (? или *), вершина типа (person),
+// конкретная вершина (#12) или вершина с меткой ("10-725: Optimization")
+struct NodePattern {
+    enum class Kind { Any, Type, Vertex, Label };
+    Kind kind = Kind::Any;
+    std::string value;
+    int id = -1;
+};
+
+// Ребро шаблона: -rel-> (по направлению), <-rel- (против), -?-> или --> (любой тип);
+// тип с пробелами берётся в кавычки: -"related to"->
+struct EdgePattern {
+    std::string label;  // пусто - любой тип связи
+    bool reversed = false;
+};
+
+// Шаблон пути: nodes.size() == edges.size() + 1
+struct PathPattern {
+    std::vector<NodePattern> nodes;
+    std::vector<EdgePattern> edges;
+};
+
+struct QueryResult {
+    std::vector<std::vector<int>> bindings;  // внешние ID, подходящие каждому узлу шаблона
+    std::vector<std::vector<int>> paths;     // найденные пути (внешние ID), не больше limit
+    bool truncated = false;                  // путей больше limit
+};
+
+// Запросы по типизированным связям графа знаний. Индекс - отдельный CSR на
+// каждый тип связи (только вершины, у которых есть дуги этого типа) в обе
+// стороны. Шаблон вычисляется полуджойнами по списку работ: сначала от самого
+// избирательного узла, каждый полуджойн идёт по более дешёвому направлению,
+// пока множества кандидатов не перестанут сужаться. После этого каждый
+// кандидат лежит хотя бы на одном пути, и пути перечисляются без тупиков
+class QueryEngine {
+public:
+    // cancel проверяется между этапами построения; прерванный индекс
+    // неполон и должен быть отброшен
+    static QueryEngine build(const Graph& g, const std::atomic<bool>* cancel = nullptr);
+
+    // Разбор шаблона; при ошибке - nullopt и описание в error
+    static std::optional<PathPattern> parse(const std::string& text, std::string* error = nullptr);
+
+    QueryResult evaluate(const PathPattern& pattern, size_t limit = 1000) const;
+
+    int size() const { return static_cast<int>(ids_.size()); }
+    size_t arcCount() const { return any_.targets.size(); }
+
+    // Типы связей по убыванию числа дуг
+    std::vector<std::pair<std::string, size_t>> relationCounts() const;
+
+    // Типы вершин по убыванию числа вершин
+    std::vector<std::pair<std::string, size_t>> typeCounts() const;
+
+private:
+    // CSR одного типа связи: sources отсортированы, дуги sources[i] лежат
+    // в targets[offsets[i] .. offsets[i + 1])
+    struct LabelAdjacency {
+        std::vector<int> sources;
+        std::vector<size_t> offsets{0};
+        std::vector<int> targets;
+
+        // arcs - пары (источник, цель), отсортированы и без повторов
+        static LabelAdjacency fromSorted(std::span<const std::pair<int, int>> arcs);
+        std::span<const int> neighbors(int v) const;
+        double averageDegree() const {
+            return sources.empty() ? 0.0 : static_cast<double>(targets.size()) / sources.size();
+        }
+    };
+
+    std::vector<int> ids_;                   // плотный индекс -> внешний ID
+    std::unordered_map<int, int> index_;
+    std::vector<std::string> relations_;
+    std::unordered_map<std::string, int> relationIndex_;
+    std::vector<LabelAdjacency> forward_;    // по номеру типа связи
+    std::vector<LabelAdjacency> backward_;
+    LabelAdjacency any_;                     // все типы вместе, без кратных дуг
+    LabelAdjacency anyBackward_;
+    std::unordered_map<std::string, std::vector<int>> byType_;
+    std::unordered_map<std::string, std::vector<int>> byLabel_;
+
+    // Множество кандидатов узла: маска для проверки и список для обхода;
+    // неограниченный (bounded == false) узел ? ещё не заполнен
+    struct Candidates {
+        bool bounded = false;
+        VertexMask mask;
+        std::vector<int> list;
+    };
+
+    // Дуги ребра шаблона в направлении обхода (forward - вдоль шаблона);
+    // nullptr, если такого типа связи в графе нет
+    const LabelAdjacency* adjacency(const EdgePattern& edge, bool forward) const;
+    Candidates initial(const PathPattern& pattern, size_t node) const;
+    void materialize(const PathPattern& pattern, size_t node, Candidates& candidates) const;
+
+    // Оставить в to только вершины, смежные с from по ребру edge
+    // (forward - из from в to вдоль шаблона); true, если to сузилось
+    bool semijoin(const Candidates& from, Candidates& to, const EdgePattern& edge, bool forward) const;
+};
+
+} // namespace graph
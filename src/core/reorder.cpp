@@ -0,0 +1,240 @@
+#include "core/reorder.hpp"
+#include <algorithm>
+#include <numeric>
+#include <cmath>
+#include <cstdlib>
+
+namespace graph {
+
+std::vector<int> Reordering::compute(const CSRGraph& g, VertexOrdering ordering) {
+    if (ordering == VertexOrdering::Original) {
+        std::vector<int> order(g.size());
+        std::iota(order.begin(), order.end(), 0);
+        return order;
+    }
+
+    // Простой неориентированный граф: соседство без учёта направления и повторов
+    CSRGraph simple = g.simplified();
+    switch (ordering) {
+        case VertexOrdering::Degree:
+            return degreeOrder(simple);
+        case VertexOrdering::ReverseCuthillMcKee:
+            return reverseCuthillMcKee(simple);
+        case VertexOrdering::Gorder:
+            return gorder(simple);
+        case VertexOrdering::Original:
+            break;
+    }
+    return {};
+}
+
+void Reordering::apply(Graph& g, VertexOrdering ordering) {
+    if (ordering == VertexOrdering::Original) return;
+    CSRGraph csr = CSRGraph::fromGraph(g);
+    std::vector<int> ids;
+    ids.reserve(csr.size());
+    for (int v : compute(csr, ordering)) {
+        ids.push_back(csr.ids[v]);
+    }
+    g.setDenseOrder(ids);
+}
+
+CSRGraph Reordering::permute(const CSRGraph& g, const std::vector<int>& order) {
+    int n = g.size();
+    std::vector<int> position(n);
+    for (int i = 0; i < n; ++i) {
+        position[order[i]] = i;
+    }
+
+    CSRGraph p;
+    p.directed = g.directed;
+    p.ids.reserve(n);
+    p.index.reserve(n);
+    p.offsets.reserve(n + 1);
+    p.targets.reserve(g.arcCount());
+    p.weights.reserve(g.arcCount());
+    p.offsets.push_back(0);
+    std::vector<std::pair<int, double>> arcs;
+    for (int old : order) {
+        p.index[g.ids[old]] = static_cast<int>(p.ids.size());
+        p.ids.push_back(g.ids[old]);
+        arcs.clear();
+        auto neighbors = g.neighbors(old);
+        auto weights = g.neighborWeights(old);
+        for (size_t i = 0; i < neighbors.size(); ++i) {
+            arcs.emplace_back(position[neighbors[i]], weights[i]);
+        }
+        std::sort(arcs.begin(), arcs.end());
+        for (const auto& [target, weight] : arcs) {
+            p.targets.push_back(target);
+            p.weights.push_back(weight);
+        }
+        p.offsets.push_back(p.targets.size());
+    }
+    return p;
+}
+
+double Reordering::averageGap(const CSRGraph& g) {
+    if (g.arcCount() == 0) return 0.0;
+    double total = 0.0;
+    for (int v = 0; v < g.size(); ++v) {
+        for (int u : g.neighbors(v)) {
+            total += std::abs(u - v);
+        }
+    }
+    return total / g.arcCount();
+}
+
+std::vector<int> Reordering::degreeOrder(const CSRGraph& g) {
+    std::vector<int> order(g.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+        [&g](int a, int b) { return g.degree(a) > g.degree(b); });
+    return order;
+}
+
+std::vector<int> Reordering::reverseCuthillMcKee(const CSRGraph& g) {
+    int n = g.size();
+    std::vector<int> order;
+    order.reserve(n);
+    std::vector<char> placed(n, 0);
+
+    // Псевдопериферийная вершина (Джордж-Лю): BFS от вершины, переход к
+    // вершине наименьшей степени на последнем уровне, пока растёт
+    // эксцентриситет. Старт с края компоненты даёт больше уровней и
+    // более узкую ленту
+    std::vector<int> stamp(n, -1), queue;
+    int round = 0;
+    auto farthest = [&](int start, int& eccentricity) {
+        ++round;
+        queue.assign(1, start);
+        stamp[start] = round;
+        size_t levelBegin = 0;
+        eccentricity = 0;
+        while (true) {
+            size_t levelEnd = queue.size();
+            for (size_t i = levelBegin; i < levelEnd; ++i) {
+                for (int u : g.neighbors(queue[i])) {
+                    if (stamp[u] != round) {
+                        stamp[u] = round;
+                        queue.push_back(u);
+                    }
+                }
+            }
+            if (queue.size() == levelEnd) {
+                return *std::min_element(queue.begin() + levelBegin, queue.end(),
+                    [&g](int a, int b) { return g.degree(a) < g.degree(b); });
+            }
+            levelBegin = levelEnd;
+            ++eccentricity;
+        }
+    };
+
+    std::vector<int> byDegree(n);
+    std::iota(byDegree.begin(), byDegree.end(), 0);
+    std::stable_sort(byDegree.begin(), byDegree.end(),
+        [&g](int a, int b) { return g.degree(a) < g.degree(b); });
+
+    std::vector<int> level;
+    for (int seed : byDegree) {
+        if (placed[seed]) continue;
+        int start = seed;
+        int eccentricity = 0;
+        int candidate = farthest(start, eccentricity);
+        for (int attempt = 0; attempt < 4; ++attempt) {
+            int candidateEccentricity = 0;
+            int next = farthest(candidate, candidateEccentricity);
+            if (candidateEccentricity <= eccentricity) break;
+            start = candidate;
+            eccentricity = candidateEccentricity;
+            candidate = next;
+        }
+
+        // Cuthill-McKee: BFS, непоставленные соседи - по возрастанию степени
+        size_t head = order.size();
+        order.push_back(start);
+        placed[start] = 1;
+        while (head < order.size()) {
+            int v = order[head++];
+            level.clear();
+            for (int u : g.neighbors(v)) {
+                if (!placed[u]) {
+                    placed[u] = 1;
+                    level.push_back(u);
+                }
+            }
+            std::stable_sort(level.begin(), level.end(),
+                [&g](int a, int b) { return g.degree(a) < g.degree(b); });
+            order.insert(order.end(), level.begin(), level.end());
+        }
+    }
+    std::reverse(order.begin(), order.end());
+    return order;
+}
+
+std::vector<int> Reordering::gorder(const CSRGraph& g) {
+    int n = g.size();
+    std::vector<int> order;
+    order.reserve(n);
+    if (n == 0) return order;
+
+    // Очередь по оценке - корзины со связными списками: оценка меняется
+    // на единицу, и перенос вершины между корзинами стоит O(1)
+    std::vector<int> score(n, 0), next(n, -1), prev(n, -1);
+    std::vector<int> head(1, -1);
+    int top = 0;
+    auto unlink = [&](int v) {
+        if (prev[v] >= 0) next[prev[v]] = next[v]; else head[score[v]] = next[v];
+        if (next[v] >= 0) prev[next[v]] = prev[v];
+    };
+    auto link = [&](int v) {
+        if (score[v] >= static_cast<int>(head.size())) head.resize(score[v] + 1, -1);
+        prev[v] = -1;
+        next[v] = head[score[v]];
+        if (next[v] >= 0) prev[next[v]] = v;
+        head[score[v]] = v;
+        top = std::max(top, score[v]);
+    };
+
+    // Первой (и первой в каждой новой компоненте при равных нулях)
+    // берётся вершина с большей степенью
+    std::vector<int> byDegree(n);
+    std::iota(byDegree.begin(), byDegree.end(), 0);
+    std::stable_sort(byDegree.begin(), byDegree.end(),
+        [&g](int a, int b) { return g.degree(a) < g.degree(b); });
+    for (int v : byDegree) link(v);
+
+    // Вершина в окне добавляет единицу соседям (ребро) и соседям соседей
+    // (общий сосед). Через концентраторы общие соседи не считаются, как в
+    // исходном Gorder: иначе обход стоит O(d²) и все оценки равны
+    std::vector<char> placed(n, 0);
+    int hubDegree = std::max(16, static_cast<int>(std::sqrt(static_cast<double>(n))));
+    auto change = [&](int v, int delta) {
+        if (placed[v]) return;
+        unlink(v);
+        score[v] += delta;
+        link(v);
+    };
+    auto spread = [&](int v, int delta) {
+        for (int u : g.neighbors(v)) {
+            change(u, delta);
+            if (g.degree(u) > hubDegree) continue;
+            for (int w : g.neighbors(u)) {
+                if (w != v) change(w, delta);
+            }
+        }
+    };
+
+    for (int i = 0; i < n; ++i) {
+        while (head[top] < 0) --top;
+        int v = head[top];
+        unlink(v);
+        placed[v] = 1;
+        order.push_back(v);
+        spread(v, 1);
+        if (i >= kGorderWindow) spread(order[i - kGorderWindow], -1);
+    }
+    return order;
+}
+
+} // namespace graph
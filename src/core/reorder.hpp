@@ -0,0 +1,46 @@
+#pragma once
+
+#include "core/csr.hpp"
+#include <vector>
+#include <cstddef>
+
+namespace graph {
+
+// Порядок вершин в памяти. Загрузчик нумерует вершины в порядке появления
+// в файле, и соседи вершины разбросаны по массивам; перенумерация
+// сближает соседей, чтобы обходы реже промахивались мимо кэша
+enum class VertexOrdering {
+    Original,            // как загружены
+    Degree,              // по убыванию степени: концентраторы вместе в начале
+    ReverseCuthillMcKee, // обратный Катхилл-Макки: BFS по уровням, узкая лента
+    Gorder               // жадно: следующая - вершина с наибольшим числом общих
+                         // соседей и рёбер с последними w поставленными
+};
+
+class Reordering {
+public:
+    // Новый порядок: order[новый индекс] = плотный индекс в g. Направление
+    // дуг не учитывается
+    static std::vector<int> compute(const CSRGraph& g, VertexOrdering ordering);
+
+    // Перенумеровать граф (один раз после загрузки: плотные индексы и CSR,
+    // построенные раньше, становятся недействительны)
+    static void apply(Graph& g, VertexOrdering ordering);
+
+    // Копия CSR в порядке order (соседи каждой вершины - по возрастанию)
+    static CSRGraph permute(const CSRGraph& g, const std::vector<int>& order);
+
+    // Средний разрыв |u - v| между индексами концов дуги: чем меньше,
+    // тем ближе в памяти данные соседей
+    static double averageGap(const CSRGraph& g);
+
+private:
+    // Окно Gorder: столько последних вершин учитывается в оценке
+    static constexpr int kGorderWindow = 5;
+
+    static std::vector<int> degreeOrder(const CSRGraph& g);
+    static std::vector<int> reverseCuthillMcKee(const CSRGraph& g);
+    static std::vector<int> gorder(const CSRGraph& g);
+};
+
+} // namespace graph
@@ -0,0 +1,244 @@
+#include "core/search.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace graph {
+
+namespace {
+
+// Нечёткий поиск по слишком коротким запросам находит почти всё подряд
+constexpr size_t kFuzzyMinLength = 3;
+
+// Длинные запросы обрезаются: счётчики общих триграмм однобайтные
+constexpr size_t kFuzzyMaxLength = 200;
+
+bool isWordChar(unsigned char c) {
+    return c >= 0x80 || (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z');
+}
+
+} // namespace
+
+std::string SearchIndex::normalize(const std::string& text) {
+    std::string result;
+    result.reserve(text.size());
+    for (size_t i = 0; i < text.size(); ++i) {
+        unsigned char c = static_cast<unsigned char>(text[i]);
+        if (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+            if (!result.empty() && result.back() != ' ') result += ' ';
+            continue;
+        }
+        if (c >= 'A' && c <= 'Z') {
+            result += static_cast<char>(c - 'A' + 'a');
+            continue;
+        }
+
+        // Кириллица в UTF-8: А-П -> а-п (D0 90..9F -> D0 B0..BF),
+        // Р-Я -> р-я (D0 A0..AF -> D1 80..8F), Ё -> ё
+        if (c == 0xD0 && i + 1 < text.size()) {
+            unsigned char next = static_cast<unsigned char>(text[i + 1]);
+            if (next >= 0x90 && next <= 0x9F) {
+                result += static_cast<char>(0xD0);
+                result += static_cast<char>(next + 0x20);
+                ++i;
+                continue;
+            }
+            if (next >= 0xA0 && next <= 0xAF) {
+                result += static_cast<char>(0xD1);
+                result += static_cast<char>(next - 0x20);
+                ++i;
+                continue;
+            }
+            if (next == 0x81) {
+                result += static_cast<char>(0xD1);
+                result += static_cast<char>(0x91);
+                ++i;
+                continue;
+            }
+        }
+        result += static_cast<char>(c);
+    }
+    if (!result.empty() && result.back() == ' ') result.pop_back();
+    return result;
+}
+
+std::vector<uint32_t> SearchIndex::trigramsOf(std::string_view name) {
+    // Два пробела в начале и один в конце: короткие слова тоже дают триграммы,
+    // а совпадение начала имени весит больше
+    std::string padded = "  ";
+    padded += name;
+    padded += ' ';
+    std::vector<uint32_t> codes;
+    codes.reserve(padded.size());
+    for (size_t i = 0; i + 3 <= padded.size(); ++i) {
+        codes.push_back((static_cast<uint32_t>(static_cast<unsigned char>(padded[i])) << 16)
+                        | (static_cast<uint32_t>(static_cast<unsigned char>(padded[i + 1])) << 8)
+                        | static_cast<uint32_t>(static_cast<unsigned char>(padded[i + 2])));
+    }
+    std::sort(codes.begin(), codes.end());
+    codes.erase(std::unique(codes.begin(), codes.end()), codes.end());
+    return codes;
+}
+
+SearchIndex SearchIndex::build(const Graph& g) {
+    SearchIndex index;
+    index.vertexIds_ = g.getVertices();
+    std::sort(index.vertexIds_.begin(), index.vertexIds_.end());
+    uint32_t n = static_cast<uint32_t>(index.vertexIds_.size());
+
+    index.nameOffsets_.reserve(n + 1);
+    index.nameOffsets_.push_back(0);
+    for (int id : index.vertexIds_) {
+        const Vertex* vertex = g.getVertex(id);
+        index.names_ += normalize(vertex && !vertex->label.empty() ? vertex->label : std::to_string(id));
+        index.nameOffsets_.push_back(static_cast<uint32_t>(index.names_.size()));
+    }
+
+    // Начала слов: начало имени и позиции после разделителя
+    for (uint32_t v = 0; v < n; ++v) {
+        std::string_view text = index.name(v);
+        for (size_t i = 0; i < text.size(); ++i) {
+            bool start = i == 0 || (!isWordChar(static_cast<unsigned char>(text[i - 1]))
+                                    && isWordChar(static_cast<unsigned char>(text[i])));
+            if (start) index.words_.push_back({v, static_cast<uint32_t>(i)});
+        }
+    }
+    std::sort(index.words_.begin(), index.words_.end(), [&index](const WordStart& a, const WordStart& b) {
+        int order = index.key(a).compare(index.key(b));
+        return order != 0 ? order < 0 : a.vertex < b.vertex;
+    });
+
+    index.lcp_.assign(index.words_.size(), 0);
+    for (size_t i = 1; i < index.words_.size(); ++i) {
+        std::string_view a = index.key(index.words_[i - 1]);
+        std::string_view b = index.key(index.words_[i]);
+        size_t common = 0;
+        size_t limit = std::min({a.size(), b.size(), size_t{std::numeric_limits<uint16_t>::max()}});
+        while (common < limit && a[common] == b[common]) ++common;
+        index.lcp_[i] = static_cast<uint16_t>(common);
+    }
+
+    // Инвертированный индекс триграмм: пары (триграмма, вершина) -> CSR
+    std::vector<std::pair<uint32_t, uint32_t>> pairs;
+    index.trigramCount_.resize(n);
+    for (uint32_t v = 0; v < n; ++v) {
+        auto codes = trigramsOf(index.name(v));
+        index.trigramCount_[v] = static_cast<uint16_t>(std::min<size_t>(codes.size(), std::numeric_limits<uint16_t>::max()));
+        for (uint32_t code : codes) pairs.emplace_back(code, v);
+    }
+    std::sort(pairs.begin(), pairs.end());
+    index.postings_.reserve(pairs.size());
+    for (const auto& [code, v] : pairs) {
+        if (index.trigrams_.empty() || index.trigrams_.back() != code) {
+            index.trigrams_.push_back(code);
+            index.trigramOffsets_.push_back(static_cast<uint32_t>(index.postings_.size()));
+        }
+        index.postings_.push_back(v);
+    }
+    index.trigramOffsets_.push_back(static_cast<uint32_t>(index.postings_.size()));
+    return index;
+}
+
+std::vector<int> SearchIndex::prefix(const std::string& text, size_t limit) const {
+    std::vector<int> result;
+    std::string query = normalize(text);
+    if (query.empty() || limit == 0) return result;
+
+    auto first = std::lower_bound(words_.begin(), words_.end(), query, [this](const WordStart& word, const std::string& value) {
+        return key(word) < std::string_view(value);
+    });
+    if (first == words_.end() || !key(*first).starts_with(query)) return result;
+
+    // Следующие элементы совпадают, пока общий префикс с предыдущим не короче запроса
+    size_t need = std::min<size_t>(query.size(), std::numeric_limits<uint16_t>::max());
+    for (size_t i = first - words_.begin(); i < words_.size(); ++i) {
+        if (i != static_cast<size_t>(first - words_.begin()) && lcp_[i] < need) break;
+        int id = vertexIds_[words_[i].vertex];
+        if (std::find(result.begin(), result.end(), id) != result.end()) continue;
+        result.push_back(id);
+        if (result.size() == limit) break;
+    }
+    return result;
+}
+
+std::vector<SearchHit> SearchIndex::fuzzy(const std::string& text, size_t limit, double threshold) const {
+    std::vector<SearchHit> hits;
+    auto query = trigramsOf(normalize(text).substr(0, kFuzzyMaxLength));
+    if (query.empty() || limit == 0) return hits;
+
+    // Списки вершин для триграмм запроса, от самого короткого
+    struct Posting {
+        const uint32_t* begin;
+        const uint32_t* end;
+        size_t size() const { return static_cast<size_t>(end - begin); }
+    };
+    std::vector<Posting> lists;
+    for (uint32_t code : query) {
+        auto it = std::lower_bound(trigrams_.begin(), trigrams_.end(), code);
+        if (it == trigrams_.end() || *it != code) {
+            lists.push_back({nullptr, nullptr});
+            continue;
+        }
+        size_t t = it - trigrams_.begin();
+        lists.push_back({postings_.data() + trigramOffsets_[t], postings_.data() + trigramOffsets_[t + 1]});
+    }
+    std::sort(lists.begin(), lists.end(), [](const Posting& a, const Posting& b) { return a.size() < b.size(); });
+
+    // Сходство Жаккара c / (|q| + |name| - c) не больше c / |q| и |name| / |q|,
+    // поэтому у подходящей вершины не меньше minOverlap общих триграмм, она
+    // есть хотя бы в одном из |q| - minOverlap + 1 самых коротких списков
+    // (их вхождения считаются подряд), а длины имени и запроса близки
+    size_t q = query.size();
+    size_t minOverlap = std::max<size_t>(1, static_cast<size_t>(std::ceil(threshold * q - 1e-9)));
+    size_t generators = q >= minOverlap ? q - minOverlap + 1 : 0;
+    std::vector<uint8_t> counts(vertexIds_.size(), 0);
+    std::vector<uint32_t> candidates;
+    for (size_t i = 0; i < generators; ++i) {
+        for (const uint32_t* it = lists[i].begin; it != lists[i].end; ++it) {
+            if (counts[*it]++ == 0) candidates.push_back(*it);
+        }
+    }
+
+    // Остальные списки проверяются двоичным поиском; кандидат отбрасывается,
+    // как только даже все оставшиеся списки не дадут minOverlap
+    for (uint32_t v : candidates) {
+        size_t names = trigramCount_[v];
+        if (names * threshold > q || q * threshold > names) continue;
+        size_t common = counts[v];
+        for (size_t i = generators; i < q && common + (q - i) >= minOverlap; ++i) {
+            if (std::binary_search(lists[i].begin, lists[i].end, v)) ++common;
+        }
+        if (common < minOverlap) continue;
+        double score = static_cast<double>(common) / (q + names - common);
+        if (score >= threshold) hits.push_back({vertexIds_[v], score});
+    }
+
+    std::sort(hits.begin(), hits.end(), [](const SearchHit& a, const SearchHit& b) {
+        return a.score != b.score ? a.score > b.score : a.id < b.id;
+    });
+    if (hits.size() > limit) hits.resize(limit);
+    return hits;
+}
+
+std::vector<SearchHit> SearchIndex::search(const std::string& text, size_t limit) const {
+    std::vector<SearchHit> hits;
+    for (int id : prefix(text, limit)) hits.push_back({id, 1.0});
+    if (hits.size() >= limit || normalize(text).size() < kFuzzyMinLength) return hits;
+
+    for (const auto& hit : fuzzy(text, limit)) {
+        bool known = std::any_of(hits.begin(), hits.end(), [&hit](const SearchHit& h) { return h.id == hit.id; });
+        if (!known) hits.push_back(hit);
+        if (hits.size() >= limit) break;
+    }
+    return hits;
+}
+
+size_t SearchIndex::memoryBytes() const {
+    return vertexIds_.capacity() * sizeof(int) + names_.capacity()
+        + nameOffsets_.capacity() * sizeof(uint32_t) + words_.capacity() * sizeof(WordStart)
+        + lcp_.capacity() * sizeof(uint16_t) + trigrams_.capacity() * sizeof(uint32_t)
+        + trigramOffsets_.capacity() * sizeof(uint32_t) + postings_.capacity() * sizeof(uint32_t)
+        + trigramCount_.capacity() * sizeof(uint16_t);
+}
+
+} // namespace graph
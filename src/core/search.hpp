@@ -0,0 +1,71 @@
+#pragma once
+
+#include "core/graph.hpp"
+#include <vector>
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <cstddef>
+
+namespace graph {
+
+struct SearchHit {
+    int id;        // внешний ID вершины
+    double score;  // 1 - совпадение по префиксу, иначе сходство по триграммам
+};
+
+// Поиск вершин по имени (метке; у вершин без метки - по ID). Имена
+// приводятся к нижнему регистру (латиница и кириллица).
+//
+// Префиксный индекс - отсортированный массив начал слов имён (суффиксный
+// массив по границам слов) и массив LCP соседних элементов: двоичный поиск
+// находит первое совпадение, остальные идут подряд, пока LCP не меньше длины
+// префикса, без сравнения строк. Нечёткий поиск - инвертированный индекс
+// триграмм: кандидаты берутся из самых редких списков запроса, сходство
+// (Жаккар по множествам триграмм) проверяется по спискам двоичным поиском
+class SearchIndex {
+public:
+    static SearchIndex build(const Graph& g);
+
+    // Вершины, у которых одно из слов имени начинается с prefix
+    std::vector<int> prefix(const std::string& text, size_t limit = 20) const;
+
+    // Вершины с похожим именем, по убыванию сходства
+    std::vector<SearchHit> fuzzy(const std::string& text, size_t limit = 20, double threshold = 0.3) const;
+
+    // Сначала совпадения по префиксу, затем (если их мало) нечёткие
+    std::vector<SearchHit> search(const std::string& text, size_t limit = 20) const;
+
+    size_t size() const { return vertexIds_.size(); }
+    size_t memoryBytes() const;
+
+    // Нижний регистр, пробельные символы схлопнуты в один пробел
+    static std::string normalize(const std::string& text);
+
+private:
+    // Начало слова: вершина (плотный индекс) и смещение в её имени
+    struct WordStart {
+        uint32_t vertex;
+        uint32_t offset;
+    };
+
+    std::vector<int> vertexIds_;           // плотный индекс -> внешний ID
+    std::string names_;                    // нормализованные имена подряд
+    std::vector<uint32_t> nameOffsets_;    // имя v - names_[nameOffsets_[v] .. nameOffsets_[v + 1])
+    std::vector<WordStart> words_;         // отсортированы по суффиксу имени
+    std::vector<uint16_t> lcp_;            // общий префикс с предыдущим (с насыщением)
+
+    std::vector<uint32_t> trigrams_;       // отсортированные коды триграмм
+    std::vector<uint32_t> trigramOffsets_;
+    std::vector<uint32_t> postings_;       // вершины по триграммам, по возрастанию
+    std::vector<uint16_t> trigramCount_;   // число разных триграмм имени вершины
+
+    std::string_view name(uint32_t v) const {
+        return std::string_view(names_).substr(nameOffsets_[v], nameOffsets_[v + 1] - nameOffsets_[v]);
+    }
+    std::string_view key(const WordStart& word) const { return name(word.vertex).substr(word.offset); }
+
+    static std::vector<uint32_t> trigramsOf(std::string_view name);
+};
+
+} // namespace graph
@@ -0,0 +1,330 @@
+#include "core/statistics.hpp"
+#include "core/parallel.hpp"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace graph {
+
+namespace {
+
+// Размер блока вершин, который поток забирает за раз
+constexpr size_t kTriangleChunk = 64;
+
+// Пересечение отсортированных списков; emit(x) вызывается для каждого
+// общего элемента, если Collect. Блоки по 4 элемента сравниваются
+// "все со всеми" за 4 сравнения с циклическим сдвигом второго блока
+template<bool Collect, typename Emit>
+size_t intersect(std::span<const int> a, std::span<const int> b, Emit&& emit) {
+    size_t i = 0, j = 0, count = 0;
+
+#if defined(__SSE2__)
+    while (i + 4 <= a.size() && j + 4 <= b.size()) {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a.data() + i));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b.data() + j));
+        __m128i match = _mm_cmpeq_epi32(va, vb);
+        for (int shift = 0; shift < 3; ++shift) {
+            vb = _mm_shuffle_epi32(vb, _MM_SHUFFLE(0, 3, 2, 1));
+            match = _mm_or_si128(match, _mm_cmpeq_epi32(va, vb));
+        }
+        unsigned mask = static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(match)));
+        count += std::popcount(mask);
+        if constexpr (Collect) {
+            for (; mask != 0; mask &= mask - 1) {
+                emit(a[i + std::countr_zero(mask)]);
+            }
+        }
+        
+        int lastA = a[i + 3];
+        int lastB = b[j + 3];
+        if (lastA <= lastB) i += 4;
+        if (lastB <= lastA) j += 4;
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    while (i + 4 <= a.size() && j + 4 <= b.size()) {
+        int32x4_t va = vld1q_s32(a.data() + i);
+        int32x4_t vb = vld1q_s32(b.data() + j);
+        uint32x4_t match = vceqq_s32(va, vb);
+        for (int shift = 0; shift < 3; ++shift) {
+            vb = vextq_s32(vb, vb, 1);
+            match = vorrq_u32(match, vceqq_s32(va, vb));
+        }
+        count += static_cast<size_t>(-vaddvq_s32(vreinterpretq_s32_u32(match)));
+        if constexpr (Collect) {
+            uint32_t lanes[4];
+            vst1q_u32(lanes, match);
+            for (int lane = 0; lane < 4; ++lane) {
+                if (lanes[lane]) emit(a[i + lane]);
+            }
+        }
+        
+        int lastA = a[i + 3];
+        int lastB = b[j + 3];
+        if (lastA <= lastB) i += 4;
+        if (lastB <= lastA) j += 4;
+    }
+#endif
+
+    while (i < a.size() && j < b.size()) {
+        if (a[i] < b[j]) {
+            ++i;
+        } else if (b[j] < a[i]) {
+            ++j;
+        } else {
+            if constexpr (Collect) emit(a[i]);
+            ++count;
+            ++i;
+            ++j;
+        }
+    }
+    return count;
+}
+
+} // namespace
+
+size_t Statistics::intersectionSize(std::span<const int> a, std::span<const int> b) {
+    return intersect<false>(a, b, [](int) {});
+}
+
+size_t Statistics::intersectionSizeScalar(std::span<const int> a, std::span<const int> b) {
+    size_t i = 0, j = 0, count = 0;
+    while (i < a.size() && j < b.size()) {
+        if (a[i] < b[j]) {
+            ++i;
+        } else if (b[j] < a[i]) {
+            ++j;
+        } else {
+            ++count;
+            ++i;
+            ++j;
+        }
+    }
+    return count;
+}
+
+uint64_t Statistics::countTriangles(const CSRGraph& g, size_t numThreads,
+                                    std::vector<uint64_t>* perVertex, bool simd) {
+    int n = g.size();
+    if (perVertex) perVertex->assign(n, 0);
+    if (n == 0) {
+        return 0;
+    }
+    
+    // Ранг вершины - позиция в порядке (степень, индекс); у каждой вершины
+    // остаются только соседи старшего ранга, поэтому списки короткие даже у хабов
+    std::vector<int> order(n);
+    for (int v = 0; v < n; ++v) order[v] = v;
+    std::sort(order.begin(), order.end(), [&g](int a, int b) {
+        return g.degree(a) != g.degree(b) ? g.degree(a) < g.degree(b) : a < b;
+    });
+    std::vector<int> rank(n);
+    for (int r = 0; r < n; ++r) rank[order[r]] = r;
+    
+    // Старшие соседи в терминах рангов, отсортированы по возрастанию
+    std::vector<size_t> offsets(n + 1, 0);
+    for (int u = 0; u < n; ++u) {
+        for (int v : g.neighbors(u)) {
+            if (rank[v] > rank[u]) ++offsets[rank[u] + 1];
+        }
+    }
+    for (int r = 0; r < n; ++r) offsets[r + 1] += offsets[r];
+    std::vector<int> higher(offsets[n]);
+    for (int u = 0; u < n; ++u) {
+        size_t pos = offsets[rank[u]];
+        for (int v : g.neighbors(u)) {
+            if (rank[v] > rank[u]) higher[pos++] = rank[v];
+        }
+        std::sort(higher.begin() + offsets[rank[u]], higher.begin() + pos);
+    }
+    auto higherOf = [&](int r) {
+        return std::span<const int>(higher.data() + offsets[r], higher.data() + offsets[r + 1]);
+    };
+    
+    numThreads = std::max<size_t>(1, numThreads);
+    ThreadPool pool(numThreads);
+    std::atomic<size_t> nextChunk{0};
+    std::vector<uint64_t> partial(numThreads, 0);
+    
+    pool.parallelFor(numThreads, [&](size_t part, size_t, size_t) {
+        uint64_t local = 0;
+        auto count = [&](int r, int s) {
+            return simd ? intersectionSize(higherOf(r), higherOf(s))
+                        : intersectionSizeScalar(higherOf(r), higherOf(s));
+        };
+        
+        while (true) {
+            size_t begin = nextChunk.fetch_add(kTriangleChunk);
+            if (begin >= static_cast<size_t>(n)) break;
+            size_t end = std::min<size_t>(n, begin + kTriangleChunk);
+            
+            for (size_t r = begin; r < end; ++r) {
+                for (int s : higherOf(static_cast<int>(r))) {
+                    if (!perVertex) {
+                        local += count(static_cast<int>(r), s);
+                        continue;
+                    }
+                    
+                    // Вершины треугольника r < s < t получают по единице
+                    auto& counts = *perVertex;
+                    size_t found = intersect<true>(higherOf(static_cast<int>(r)), higherOf(s), [&](int t) {
+                        std::atomic_ref<uint64_t>(counts[order[t]]).fetch_add(1, std::memory_order_relaxed);
+                    });
+                    if (found > 0) {
+                        std::atomic_ref<uint64_t>(counts[order[r]]).fetch_add(found, std::memory_order_relaxed);
+                        std::atomic_ref<uint64_t>(counts[order[s]]).fetch_add(found, std::memory_order_relaxed);
+                    }
+                    local += found;
+                }
+            }
+        }
+        partial[part] = local;
+    });
+    
+    uint64_t total = 0;
+    for (uint64_t value : partial) total += value;
+    return total;
+}
+
+std::vector<int> Statistics::coreNumbers(const CSRGraph& g) {
+    int n = g.size();
+    std::vector<int> degree(n);
+    int maxDegree = 0;
+    for (int v = 0; v < n; ++v) {
+        degree[v] = g.degree(v);
+        maxDegree = std::max(maxDegree, degree[v]);
+    }
+    
+    // Вершины отсортированы подсчётом по текущей степени; bin[d] - начало
+    // группы степени d, position[v] - место вершины в порядке
+    std::vector<int> bin(maxDegree + 1, 0);
+    for (int d : degree) ++bin[d];
+    for (int d = 0, start = 0; d <= maxDegree; ++d) {
+        int size = bin[d];
+        bin[d] = start;
+        start += size;
+    }
+    std::vector<int> vertices(n), position(n);
+    for (int v = 0; v < n; ++v) {
+        position[v] = bin[degree[v]]++;
+        vertices[position[v]] = v;
+    }
+    for (int d = maxDegree; d > 0; --d) bin[d] = bin[d - 1];
+    bin[0] = 0;
+    
+    for (int i = 0; i < n; ++i) {
+        int v = vertices[i];
+        for (int u : g.neighbors(v)) {
+            if (degree[u] <= degree[v]) continue;
+            
+            // Переместить u в начало его группы и уменьшить степень
+            int du = degree[u];
+            int pu = position[u];
+            int pw = bin[du];
+            int w = vertices[pw];
+            if (u != w) {
+                position[u] = pw;
+                vertices[pu] = w;
+                position[w] = pu;
+                vertices[pw] = u;
+            }
+            ++bin[du];
+            --degree[u];
+        }
+    }
+    return degree;
+}
+
+std::vector<int> Statistics::coreNumbersParallel(const CSRGraph& g, size_t numThreads) {
+    int n = g.size();
+    std::vector<int> degree(n), core(n, 0);
+    std::vector<int> remaining(n);
+    for (int v = 0; v < n; ++v) {
+        degree[v] = g.degree(v);
+        remaining[v] = v;
+    }
+    
+    numThreads = std::max<size_t>(1, numThreads);
+    ThreadPool pool(numThreads);
+    std::vector<std::vector<int>> found(numThreads);
+    std::vector<char> removed(n, 0);
+    
+    for (int k = 0; !remaining.empty(); ++k) {
+        // Вершины, чья степень уже опустилась до k
+        std::vector<int> frontier;
+        std::vector<int> rest;
+        for (int v : remaining) {
+            (degree[v] <= k ? frontier : rest).push_back(v);
+        }
+        remaining.swap(rest);
+        
+        while (!frontier.empty()) {
+            for (int v : frontier) {
+                removed[v] = 1;
+                core[v] = k;
+            }
+            pool.parallelFor(frontier.size(), [&](size_t part, size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    for (int u : g.neighbors(frontier[i])) {
+                        if (removed[u]) continue;
+                        std::atomic_ref<int> du(degree[u]);
+                        int before = du.fetch_sub(1, std::memory_order_relaxed);
+                        if (before <= k) {
+                            // Уже на уровне k - вернуть и не опускать ниже
+                            du.fetch_add(1, std::memory_order_relaxed);
+                        } else if (before == k + 1) {
+                            found[part].push_back(u);
+                        }
+                    }
+                }
+            });
+            
+            frontier.clear();
+            for (auto& list : found) {
+                frontier.insert(frontier.end(), list.begin(), list.end());
+                list.clear();
+            }
+        }
+        
+        // Удалённые на этом уровне вершины убрать из остатка
+        std::erase_if(remaining, [&removed](int v) { return removed[v] != 0; });
+    }
+    return core;
+}
+
+GraphStatistics Statistics::compute(const CSRGraph& g, size_t numThreads) {
+    CSRGraph simple = g.simplified();
+    GraphStatistics stats;
+    int n = simple.size();
+    stats.vertices = n;
+    stats.edges = simple.arcCount() / 2;
+    stats.triangles = countTriangles(simple, numThreads, &stats.vertexTriangles);
+    
+    stats.clustering.assign(n, 0.0);
+    double wedges = 0.0;
+    double clusteringSum = 0.0;
+    for (int v = 0; v < n; ++v) {
+        double d = simple.degree(v);
+        double pairs = d * (d - 1.0) / 2.0;
+        wedges += pairs;
+        if (pairs > 0.0) {
+            stats.clustering[v] = stats.vertexTriangles[v] / pairs;
+            clusteringSum += stats.clustering[v];
+        }
+    }
+    stats.averageClustering = n > 0 ? clusteringSum / n : 0.0;
+    stats.transitivity = wedges > 0.0 ? 3.0 * stats.triangles / wedges : 0.0;
+    
+    stats.coreNumber = coreNumbers(simple);
+    for (int core : stats.coreNumber) {
+        stats.degeneracy = std::max(stats.degeneracy, core);
+    }
+    return stats;
+}
+
+} // namespace graph
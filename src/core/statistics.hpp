@@ -0,0 +1,52 @@
+#pragma once
+
+#include "core/csr.hpp"
+#include <vector>
+#include <span>
+#include <cstdint>
+#include <cstddef>
+
+namespace graph {
+
+// Структурные характеристики графа (рассматривается как простой неориентированный)
+struct GraphStatistics {
+    size_t vertices = 0;
+    size_t edges = 0;
+    uint64_t triangles = 0;
+    double averageClustering = 0.0;      // среднее локальных коэффициентов
+    double transitivity = 0.0;           // 3 * треугольники / связные тройки
+    int degeneracy = 0;                  // наибольшее ядерное число
+    std::vector<uint64_t> vertexTriangles;  // по плотным индексам CSR
+    std::vector<double> clustering;
+    std::vector<int> coreNumber;
+};
+
+class Statistics {
+public:
+    // Все характеристики сразу: треугольники, коэффициенты кластеризации, k-ядра
+    static GraphStatistics compute(const CSRGraph& g, size_t numThreads = 4);
+    
+    // Дальше g - простой неориентированный граф (CSRGraph::simplified)
+    
+    // Подсчёт треугольников с упорядочиванием по степени: каждое ребро
+    // направлено к вершине старшего ранга, треугольник находится один раз
+    // как пересечение списков старших соседей. Вершины раздаются потокам
+    // блоками по мере освобождения. perVertex (если задан) получает число
+    // треугольников каждой вершины
+    static uint64_t countTriangles(const CSRGraph& g, size_t numThreads = 4,
+                                   std::vector<uint64_t>* perVertex = nullptr, bool simd = true);
+    
+    // Ядерные числа (k-ядра) алгоритмом Батагеля-Заверсника за O(V + E)
+    static std::vector<int> coreNumbers(const CSRGraph& g);
+    
+    // Параллельное снятие слоёв: на уровне k все вершины степени k удаляются
+    // одновременно, степени соседей уменьшаются атомарно (для больших графов)
+    static std::vector<int> coreNumbersParallel(const CSRGraph& g, size_t numThreads = 4);
+    
+    // Размер пересечения отсортированных списков без повторов:
+    // SSE2/NEON сравнивает блоки по 4 элемента, хвост - скалярным слиянием
+    static size_t intersectionSize(std::span<const int> a, std::span<const int> b);
+    static size_t intersectionSizeScalar(std::span<const int> a, std::span<const int> b);
+};
+
+} // namespace graph
@@ -0,0 +1,98 @@
+#include "core/subgraph.hpp"
+#include <bit>
+
+namespace graph {
+
+size_t VertexMask::count() const {
+    size_t total = 0;
+    for (uint64_t word : words_) total += std::popcount(word);
+    return total;
+}
+
+void VertexMask::buildRank() {
+    prefix_.resize(words_.size());
+    uint32_t total = 0;
+    for (size_t w = 0; w < words_.size(); ++w) {
+        prefix_[w] = total;
+        total += static_cast<uint32_t>(std::popcount(words_[w]));
+    }
+}
+
+size_t VertexMask::rank(size_t i) const {
+    uint64_t below = words_[i / 64] & ((uint64_t{1} << (i % 64)) - 1);
+    return prefix_[i / 64] + std::popcount(below);
+}
+
+SubgraphView::SubgraphView(std::shared_ptr<const CSRGraph> parent, VertexMask mask)
+    : parent_(std::move(parent)), mask_(std::move(mask)) {
+    mask_.buildRank();
+    visible_ = mask_.count();
+}
+
+SubgraphView SubgraphView::kCore(std::shared_ptr<const CSRGraph> parent, const std::vector<int>& coreNumber, int k) {
+    VertexMask mask(parent->size());
+    for (size_t v = 0; v < coreNumber.size(); ++v) {
+        if (coreNumber[v] >= k) mask.set(v);
+    }
+    return SubgraphView(std::move(parent), std::move(mask));
+}
+
+SubgraphView SubgraphView::neighborhood(std::shared_ptr<const CSRGraph> parent, int center, int hops,
+                                        size_t limit, const CSRGraph* reverse) {
+    VertexMask mask(parent->size());
+    int start = parent->indexOf(center);
+    if (start == -1) {
+        return SubgraphView(std::move(parent), std::move(mask));
+    }
+    
+    // Посещённые вершины хранятся прямо в маске; работа пропорциональна окрестности
+    const CSRGraph& g = *parent;
+    size_t visited = 1;
+    mask.set(start);
+    std::vector<int> frontier{start}, next;
+    for (int depth = 0; depth < hops && !frontier.empty(); ++depth) {
+        for (int u : frontier) {
+            auto visit = [&](std::span<const int> neighbors) {
+                for (int v : neighbors) {
+                    if (limit != 0 && visited >= limit) return;
+                    if (mask.test(v)) continue;
+                    mask.set(v);
+                    ++visited;
+                    next.push_back(v);
+                }
+            };
+            visit(g.neighbors(u));
+            if (reverse && g.directed) visit(reverse->neighbors(u));
+        }
+        frontier.swap(next);
+        next.clear();
+    }
+    return SubgraphView(std::move(parent), std::move(mask));
+}
+
+bool SubgraphView::contains(int id) const {
+    int v = parent_->indexOf(id);
+    return v != -1 && mask_.test(v);
+}
+
+std::vector<int> SubgraphView::vertices() const {
+    std::vector<int> ids;
+    ids.reserve(visible_);
+    mask_.forEach([&](size_t v) { ids.push_back(parent_->ids[v]); });
+    return ids;
+}
+
+std::vector<std::pair<int, int>> SubgraphView::edges() const {
+    std::vector<std::pair<int, int>> result;
+    const CSRGraph& g = *parent_;
+    mask_.forEach([&](size_t v) {
+        for (int u : g.neighbors(static_cast<int>(v))) {
+            if (!mask_.test(u)) continue;
+            if (!g.directed && u < static_cast<int>(v)) continue;
+            result.emplace_back(g.ids[v], g.ids[u]);
+        }
+    });
+    return result;
+}
+
+} // namespace graph
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "core/csr.hpp"
+#include <vector>
+#include <memory>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+#include <bit>
+
+namespace graph {
+
+// Битовая маска по плотным индексам CSR: V бит и V/64 счётчиков для rank
+class VertexMask {
+public:
+    VertexMask() = default;
+    explicit VertexMask(size_t size) : words_((size + 63) / 64, 0), size_(size) {}
+    
+    size_t size() const { return size_; }
+    bool test(size_t i) const { return (words_[i / 64] >> (i % 64)) & 1u; }
+    void set(size_t i) { words_[i / 64] |= uint64_t{1} << (i % 64); }
+    void reset(size_t i) { words_[i / 64] &= ~(uint64_t{1} << (i % 64)); }
+    size_t count() const;
+    
+    // Число установленных битов перед позицией i (после buildRank)
+    void buildRank();
+    size_t rank(size_t i) const;
+    
+    template<typename F>
+    void forEach(F&& visit) const {
+        for (size_t w = 0; w < words_.size(); ++w) {
+            for (uint64_t bits = words_[w]; bits != 0; bits &= bits - 1) {
+                visit(w * 64 + static_cast<size_t>(std::countr_zero(bits)));
+            }
+        }
+    }
+    
+private:
+    std::vector<uint64_t> words_;
+    std::vector<uint32_t> prefix_;
+    size_t size_ = 0;
+};
+
+// Подграф поверх снимка CSR без копирования рёбер и меток: маска вершин и
+// плотная перенумерация видимых вершин (rank по маске)
+class SubgraphView {
+public:
+    SubgraphView(std::shared_ptr<const CSRGraph> parent, VertexMask mask);
+    
+    // k-ядро: вершины с ядерным числом не меньше k
+    static SubgraphView kCore(std::shared_ptr<const CSRGraph> parent, const std::vector<int>& coreNumber, int k);
+    
+    // Окрестность вершины center (внешний ID) радиуса hops: BFS с ограничением
+    // глубины и числа вершин limit (0 - без ограничения). reverse - обращённый
+    // снимок для ориентированного графа, чтобы учитывать и входящие дуги
+    static SubgraphView neighborhood(std::shared_ptr<const CSRGraph> parent, int center, int hops,
+                                     size_t limit = 0, const CSRGraph* reverse = nullptr);
+    
+    const CSRGraph& parent() const { return *parent_; }
+    const VertexMask& mask() const { return mask_; }
+    size_t size() const { return visible_; }
+    
+    bool contains(int id) const;
+    bool containsIndex(int v) const { return mask_.test(v); }
+    
+    // Индекс вершины родителя внутри подграфа (0..size-1) или -1
+    int localIndex(int v) const { return mask_.test(v) ? static_cast<int>(mask_.rank(v)) : -1; }
+    
+    // Внешние ID видимых вершин и рёбер между ними (неориентированные - один раз)
+    std::vector<int> vertices() const;
+    std::vector<std::pair<int, int>> edges() const;
+    
+private:
+    std::shared_ptr<const CSRGraph> parent_;
+    VertexMask mask_;
+    size_t visible_ = 0;
+};
+
+} // namespace graph
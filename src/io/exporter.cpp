@@ -0,0 +1,514 @@
+#include "io/exporter.hpp"
+#include "core/parallel.hpp"
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <string_view>
+#include <vector>
+#if defined(_WIN32)
+#include <fstream>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+namespace graph {
+
+namespace {
+
+// Буфер текста блока. Под число место резервируется заранее, и
+// std::to_chars пишет прямо в буфер; память переиспользуется между окнами
+class TextBuffer {
+public:
+    void append(std::string_view text) {
+        std::memcpy(grow(text.size()), text.data(), text.size());
+        size_ += text.size();
+    }
+    void append(char c) {
+        *grow(1) = c;
+        ++size_;
+    }
+    template<typename T>
+    void number(T value) {
+        char* out = grow(kNumberChars);
+        size_ = static_cast<size_t>(std::to_chars(out, out + kNumberChars, value).ptr - data_.get());
+    }
+    // Вес: целый - как целое число (частый случай, без поиска кратчайшего
+    // представления double), иначе кратчайшее точное представление
+    void weight(double value) {
+        if (value == std::trunc(value) && std::abs(value) < 1e15) {
+            number(static_cast<int64_t>(value));
+        } else {
+            number(value);
+        }
+    }
+    // Координата: три знака после точки (точность 1/1000 пикселя) целочисленной
+    // записью; нули в конце дробной части отбрасываются
+    void coordinate(double value) {
+        if (!std::isfinite(value) || std::abs(value) >= 1e12) {
+            number(value);
+            return;
+        }
+        int64_t scaled = std::llround(value * 1000.0);
+        if (scaled < 0) {
+            append('-');
+            scaled = -scaled;
+        }
+        number(scaled / 1000);
+        int fraction = static_cast<int>(scaled % 1000);
+        if (fraction == 0) return;
+        char digits[4] = {'.', static_cast<char>('0' + fraction / 100), static_cast<char>('0' + fraction / 10 % 10),
+                          static_cast<char>('0' + fraction % 10)};
+        size_t length = 4;
+        while (digits[length - 1] == '0') --length;
+        append(std::string_view(digits, length));
+    }
+    void clear() { size_ = 0; }
+    std::string_view view() const { return {data_.get(), size_}; }
+
+private:
+    // Самое длинное кратчайшее представление double - 24 символа
+    static constexpr size_t kNumberChars = 32;
+
+    char* grow(size_t count) {
+        if (size_ + count > capacity_) {
+            size_t capacity = std::max(size_ + count, capacity_ * 2);
+            auto data = std::make_unique<char[]>(capacity);
+            if (size_) std::memcpy(data.get(), data_.get(), size_);
+            data_ = std::move(data);
+            capacity_ = capacity;
+        }
+        return data_.get() + size_;
+    }
+
+    std::unique_ptr<char[]> data_;
+    size_t size_ = 0;
+    size_t capacity_ = 0;
+};
+
+// Правила экранирования строк: CsvTail - последнее поле строки CSV (запятые
+// можно оставить), CsvField - поле в середине строки
+enum class Escape { CsvTail, CsvField, Json, Xml, Dot };
+
+bool needsEscape(unsigned char c, Escape rule) {
+    switch (rule) {
+        case Escape::CsvTail: return c == '\n' || c == '\r';
+        case Escape::CsvField: return c == '\n' || c == '\r' || c == ',';
+        case Escape::Json: return c < 0x20 || c == '"' || c == '\\';
+        case Escape::Xml: return c < 0x20 || c == '&' || c == '<' || c == '>' || c == '"';
+        case Escape::Dot: return c == '\n' || c == '\r' || c == '"' || c == '\\';
+    }
+    return false;
+}
+
+void appendEscaped(TextBuffer& out, std::string_view text, Escape rule) {
+    size_t start = 0;
+    for (size_t i = 0; i < text.size(); ++i) {
+        unsigned char c = static_cast<unsigned char>(text[i]);
+        if (!needsEscape(c, rule)) continue;
+        out.append(text.substr(start, i - start));
+        start = i + 1;
+        switch (rule) {
+            case Escape::CsvTail:
+            case Escape::CsvField:
+                out.append(' ');
+                break;
+            case Escape::Json:
+                if (c == '"' || c == '\\') {
+                    out.append('\\');
+                    out.append(static_cast<char>(c));
+                } else if (c == '\n') {
+                    out.append("\\n");
+                } else if (c == '\t') {
+                    out.append("\\t");
+                } else {
+                    static constexpr char kHex[] = "0123456789abcdef";
+                    out.append("\\u00");
+                    out.append(kHex[c >> 4]);
+                    out.append(kHex[c & 0xF]);
+                }
+                break;
+            case Escape::Xml:
+                if (c == '&') out.append("&amp;");
+                else if (c == '<') out.append("&lt;");
+                else if (c == '>') out.append("&gt;");
+                else if (c == '"') out.append("&quot;");
+                else if (c == '\t' || c == '\n' || c == '\r') out.append(static_cast<char>(c));
+                // Прочие управляющие символы в XML 1.0 недопустимы - пропускаются
+                break;
+            case Escape::Dot:
+                if (c == '\n') out.append("\\n");
+                else if (c != '\r') {
+                    out.append('\\');
+                    out.append(static_cast<char>(c));
+                }
+                break;
+        }
+    }
+    out.append(text.substr(start));
+}
+
+struct Item {
+    const Vertex* vertex;
+    const EdgeList* edges;
+};
+
+// Текст вокруг блоков: заголовок, переход от вершин к рёбрам, окончание и
+// разделитель элементов (в JSON - запятая перед каждым элементом, кроме
+// первого в массиве)
+struct Frame {
+    std::string header, middle, footer;
+    std::string_view separator;
+};
+
+Frame frameFor(ExportFormat format, bool directed) {
+    switch (format) {
+        case ExportFormat::CSV:
+            return {"# v,id,x,y,type,label\n# from,to,weight,label\n", "", "", ""};
+        case ExportFormat::JSON:
+            return {std::string("{\n  \"directed\": ") + (directed ? "true" : "false") + ",\n  \"vertices\": [\n",
+                    "\n  ],\n  \"edges\": [\n", "\n  ]\n}\n", ",\n"};
+        case ExportFormat::GraphML:
+            return {std::string("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                                "<graphml xmlns=\"http://graphml.graphdrawing.org/xmlns\">\n"
+                                "  <key id=\"label\" for=\"node\" attr.name=\"label\" attr.type=\"string\"/>\n"
+                                "  <key id=\"type\" for=\"node\" attr.name=\"type\" attr.type=\"string\"/>\n"
+                                "  <key id=\"x\" for=\"node\" attr.name=\"x\" attr.type=\"double\"/>\n"
+                                "  <key id=\"y\" for=\"node\" attr.name=\"y\" attr.type=\"double\"/>\n"
+                                "  <key id=\"weight\" for=\"edge\" attr.name=\"weight\" attr.type=\"double\"/>\n"
+                                "  <key id=\"relation\" for=\"edge\" attr.name=\"label\" attr.type=\"string\"/>\n"
+                                "  <graph id=\"G\" edgedefault=\"")
+                        + (directed ? "directed" : "undirected") + "\">\n",
+                    "", "  </graph>\n</graphml>\n", ""};
+        case ExportFormat::DOT:
+            return {directed ? "digraph G {\n" : "graph G {\n", "", "}\n", ""};
+    }
+    return {};
+}
+
+void formatVertex(TextBuffer& out, const Vertex& v, ExportFormat format) {
+    switch (format) {
+        case ExportFormat::CSV:
+            out.append("# v,");
+            out.number(v.id);
+            out.append(',');
+            out.coordinate(v.x);
+            out.append(',');
+            out.coordinate(v.y);
+            out.append(',');
+            appendEscaped(out, v.type, Escape::CsvField);
+            out.append(',');
+            appendEscaped(out, v.label, Escape::CsvTail);
+            out.append('\n');
+            break;
+        case ExportFormat::JSON:
+            out.append(",\n    { \"id\": ");
+            out.number(v.id);
+            out.append(", \"label\": \"");
+            appendEscaped(out, v.label, Escape::Json);
+            if (!v.type.empty()) {
+                out.append("\", \"type\": \"");
+                appendEscaped(out, v.type, Escape::Json);
+            }
+            out.append("\", \"x\": ");
+            out.coordinate(v.x);
+            out.append(", \"y\": ");
+            out.coordinate(v.y);
+            out.append(" }");
+            break;
+        case ExportFormat::GraphML:
+            out.append("    <node id=\"n");
+            out.number(v.id);
+            out.append("\">");
+            if (!v.label.empty()) {
+                out.append("<data key=\"label\">");
+                appendEscaped(out, v.label, Escape::Xml);
+                out.append("</data>");
+            }
+            if (!v.type.empty()) {
+                out.append("<data key=\"type\">");
+                appendEscaped(out, v.type, Escape::Xml);
+                out.append("</data>");
+            }
+            out.append("<data key=\"x\">");
+            out.coordinate(v.x);
+            out.append("</data><data key=\"y\">");
+            out.coordinate(v.y);
+            out.append("</data></node>\n");
+            break;
+        case ExportFormat::DOT:
+            out.append("  ");
+            out.number(v.id);
+            out.append(" [label=\"");
+            appendEscaped(out, v.label, Escape::Dot);
+            if (!v.type.empty()) {
+                out.append("\", type=\"");
+                appendEscaped(out, v.type, Escape::Dot);
+            }
+            out.append("\", pos=\"");
+            out.coordinate(v.x);
+            out.append(',');
+            out.coordinate(v.y);
+            out.append("\"];\n");
+            break;
+    }
+}
+
+void formatEdge(TextBuffer& out, int from, const Edge& e, bool directed, ExportFormat format) {
+    switch (format) {
+        case ExportFormat::CSV:
+            out.number(from);
+            out.append(',');
+            out.number(e.to);
+            out.append(',');
+            out.weight(e.weight);
+            if (!e.label.empty()) {
+                out.append(',');
+                appendEscaped(out, e.label, Escape::CsvTail);
+            }
+            out.append('\n');
+            break;
+        case ExportFormat::JSON:
+            out.append(",\n    { \"from\": ");
+            out.number(from);
+            out.append(", \"to\": ");
+            out.number(e.to);
+            out.append(", \"weight\": ");
+            out.weight(e.weight);
+            if (!e.label.empty()) {
+                out.append(", \"label\": \"");
+                appendEscaped(out, e.label, Escape::Json);
+                out.append('"');
+            }
+            out.append(" }");
+            break;
+        case ExportFormat::GraphML:
+            out.append("    <edge source=\"n");
+            out.number(from);
+            out.append("\" target=\"n");
+            out.number(e.to);
+            out.append("\"><data key=\"weight\">");
+            out.weight(e.weight);
+            out.append("</data>");
+            if (!e.label.empty()) {
+                out.append("<data key=\"relation\">");
+                appendEscaped(out, e.label, Escape::Xml);
+                out.append("</data>");
+            }
+            out.append("</edge>\n");
+            break;
+        case ExportFormat::DOT:
+            out.append("  ");
+            out.number(from);
+            out.append(directed ? " -> " : " -- ");
+            out.number(e.to);
+            out.append(" [weight=");
+            out.weight(e.weight);
+            if (!e.label.empty()) {
+                out.append(", label=\"");
+                appendEscaped(out, e.label, Escape::Dot);
+                out.append('"');
+            }
+            out.append("];\n");
+            break;
+    }
+}
+
+// Куда уходят готовые куски текста (по порядку); false - ошибка записи
+using Sink = std::function<bool(const std::vector<std::string_view>&)>;
+
+bool exportGraph(const Graph& g, ExportFormat format, size_t numThreads, const Sink& sink) {
+    // Снимок не меняется, поэтому ссылки на вершины и списки дуг можно
+    // читать из потоков без блокировки
+    auto snapshot = g.snapshot();
+    bool directed = snapshot->isDirected();
+    std::vector<Item> items;
+    items.reserve(snapshot->getVertexCount());
+    snapshot->forEachVertex([&items](const Vertex& vertex, const EdgeList& edges) {
+        items.push_back({&vertex, &edges});
+    });
+
+    // Блоки вершин с примерно kBlockArcs дугами; задача t < blocks пишет
+    // вершины блока t, задача blocks + t - его рёбра
+    std::vector<size_t> bounds = {0};
+    size_t work = 0;
+    for (size_t i = 0; i < items.size(); ++i) {
+        work += 1 + items[i].edges->size();
+        if (work >= GraphExporter::kBlockArcs) {
+            bounds.push_back(i + 1);
+            work = 0;
+        }
+    }
+    if (bounds.back() != items.size()) bounds.push_back(items.size());
+    size_t blocks = bounds.size() - 1;
+    size_t tasks = 2 * blocks;
+
+    Frame frame = frameFor(format, directed);
+    auto formatTask = [&](size_t task, TextBuffer& out) {
+        out.clear();
+        bool edges = task >= blocks;
+        size_t block = edges ? task - blocks : task;
+        for (size_t i = bounds[block]; i < bounds[block + 1]; ++i) {
+            const Vertex& vertex = *items[i].vertex;
+            if (!edges) {
+                formatVertex(out, vertex, format);
+                continue;
+            }
+            // Неориентированное ребро хранится в обоих списках - из списка меньшего конца
+            for (const Edge& edge : *items[i].edges) {
+                if (directed || vertex.id <= edge.to) formatEdge(out, vertex.id, edge, directed, format);
+            }
+        }
+    };
+
+    ThreadPool pool(std::max<size_t>(1, numThreads));
+    size_t window = pool.size() * GraphExporter::kWindowBlocksPerThread;
+    // Два набора буферов: пока один пишется на диск, второй заполняется
+    std::vector<TextBuffer> buffers[2] = {std::vector<TextBuffer>(window), std::vector<TextBuffer>(window)};
+    std::vector<std::string_view> pieces[2];
+    std::future<bool> pending;
+    bool sectionStarted = false;
+
+    if (tasks == 0) {
+        pieces[0] = {frame.header, frame.middle, frame.footer};
+        return sink(pieces[0]);
+    }
+    for (size_t first = 0, turn = 0; first < tasks; first += window, turn ^= 1) {
+        size_t count = std::min(window, tasks - first);
+        std::vector<TextBuffer>& buffer = buffers[turn];
+        std::atomic<size_t> next{0};
+        pool.parallelFor(count, [&](size_t, size_t, size_t) {
+            for (size_t i = next.fetch_add(1); i < count; i = next.fetch_add(1)) {
+                formatTask(first + i, buffer[i]);
+            }
+        });
+        // Окна пишутся по порядку; буферы предыдущего заполнит следующее окно
+        if (pending.valid() && !pending.get()) return false;
+
+        std::vector<std::string_view>& list = pieces[turn];
+        list.clear();
+        for (size_t i = 0; i < count; ++i) {
+            size_t task = first + i;
+            if (task == 0) list.push_back(frame.header);
+            if (task == blocks) {
+                list.push_back(frame.middle);
+                sectionStarted = false;
+            }
+            std::string_view text = buffer[i].view();
+            if (!text.empty() && !sectionStarted) {
+                text.remove_prefix(frame.separator.size());
+                sectionStarted = true;
+            }
+            if (!text.empty()) list.push_back(text);
+        }
+        if (first + count == tasks) list.push_back(frame.footer);
+        pending = std::async(std::launch::async, [&sink, &list] { return sink(list); });
+    }
+    return pending.get();
+}
+
+#if !defined(_WIN32)
+// Все куски одним системным вызовом writev (по IOV_MAX за раз), с
+// дозаписью при частичной записи
+bool writeAll(int fd, const std::vector<std::string_view>& pieces) {
+    constexpr size_t kMaxVectors = 1024;
+    std::vector<iovec> vectors;
+    vectors.reserve(std::min(pieces.size(), kMaxVectors));
+    size_t index = 0;
+    while (index < pieces.size()) {
+        vectors.clear();
+        for (size_t i = index; i < pieces.size() && vectors.size() < kMaxVectors; ++i) {
+            vectors.push_back({const_cast<char*>(pieces[i].data()), pieces[i].size()});
+        }
+        ssize_t written = ::writev(fd, vectors.data(), static_cast<int>(vectors.size()));
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        // Целиком записанные куски пропускаются, остаток куска - дописывается
+        size_t left = static_cast<size_t>(written);
+        size_t i = 0;
+        while (i < vectors.size() && left >= vectors[i].iov_len) left -= vectors[i++].iov_len;
+        index += i;
+        if (i < vectors.size() && left > 0) {
+            const char* rest = pieces[index].data() + left;
+            size_t size = pieces[index].size() - left;
+            while (size > 0) {
+                ssize_t part = ::write(fd, rest, size);
+                if (part < 0) {
+                    if (errno == EINTR) continue;
+                    return false;
+                }
+                rest += part;
+                size -= static_cast<size_t>(part);
+            }
+            ++index;
+        }
+    }
+    return true;
+}
+#endif
+
+} // namespace
+
+std::optional<ExportFormat> GraphExporter::formatFor(const std::string& filename) {
+    auto endsWith = [&filename](std::string_view suffix) {
+        return filename.size() >= suffix.size()
+            && filename.compare(filename.size() - suffix.size(), suffix.size(), suffix) == 0;
+    };
+    if (endsWith(".csv")) return ExportFormat::CSV;
+    if (endsWith(".json")) return ExportFormat::JSON;
+    if (endsWith(".graphml")) return ExportFormat::GraphML;
+    if (endsWith(".dot") || endsWith(".gv")) return ExportFormat::DOT;
+    return std::nullopt;
+}
+
+bool GraphExporter::save(const Graph& g, const std::string& filename, ExportFormat format, size_t numThreads) {
+#if defined(_WIN32)
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Ошибка: не удалось создать файл " << filename << std::endl;
+        return false;
+    }
+    bool ok = exportGraph(g, format, numThreads, [&file](const std::vector<std::string_view>& pieces) {
+        for (std::string_view piece : pieces) file.write(piece.data(), static_cast<std::streamsize>(piece.size()));
+        return static_cast<bool>(file);
+    });
+    file.close();
+    ok = ok && !file.fail();
+#else
+    int fd = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        std::cerr << "Ошибка: не удалось создать файл " << filename << std::endl;
+        return false;
+    }
+    bool ok = exportGraph(g, format, numThreads, [fd](const std::vector<std::string_view>& pieces) {
+        return writeAll(fd, pieces);
+    });
+    ok = (::close(fd) == 0) && ok;
+#endif
+    if (!ok) {
+        std::cerr << "Ошибка записи в файл " << filename << std::endl;
+    }
+    return ok;
+}
+
+std::string GraphExporter::toString(const Graph& g, ExportFormat format, size_t numThreads) {
+    std::string text;
+    exportGraph(g, format, numThreads, [&text](const std::vector<std::string_view>& pieces) {
+        for (std::string_view piece : pieces) text.append(piece);
+        return true;
+    });
+    return text;
+}
+
+} // namespace graph
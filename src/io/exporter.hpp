@@ -0,0 +1,42 @@
+#pragma once
+
+#include "core/graph.hpp"
+#include <string>
+#include <optional>
+#include <thread>
+#include <cstddef>
+
+namespace graph {
+
+enum class ExportFormat {
+    CSV,      // from,to,weight,метка; вершины - строками-комментариями "# v,..."
+    JSON,     // {"directed", "vertices": [...], "edges": [...]}
+    GraphML,  // ключи label, type, x, y у вершин и weight, label у рёбер
+    DOT       // Graphviz: label, pos="x,y" у вершин; weight, label у рёбер
+};
+
+// Запись графа целиком: метки, типы и координаты вершин (3 знака после
+// точки), веса и метки рёбер. Пишется снимок графа (snapshot), поэтому граф
+// можно менять во время записи. Вершины идут в порядке хранения
+// (Graph::forEachVertex) и делятся на блоки с примерно равным числом дуг;
+// блоки форматируются параллельно (числа - std::to_chars) в свои буферы,
+// и окно готовых блоков уходит на диск одной записью (writev), пока
+// форматируется следующее окно
+class GraphExporter {
+public:
+    // Формат по расширению: .csv, .json, .graphml, .dot или .gv
+    static std::optional<ExportFormat> formatFor(const std::string& filename);
+
+    static bool save(const Graph& g, const std::string& filename, ExportFormat format,
+                     size_t numThreads = std::thread::hardware_concurrency());
+
+    // Тот же текст в строку (для замеров и проверки записи)
+    static std::string toString(const Graph& g, ExportFormat format,
+                                size_t numThreads = std::thread::hardware_concurrency());
+
+    // Примерное число дуг в блоке форматирования и блоков в окне записи на поток
+    static constexpr size_t kBlockArcs = 1 << 14;
+    static constexpr size_t kWindowBlocksPerThread = 4;
+};
+
+} // namespace graph
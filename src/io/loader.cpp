@@ -1,4 +1,6 @@
 #include "io/loader.hpp"
+#include "io/exporter.hpp"
+#include "core/search.hpp"
 #include <fstream>
 #include <sstream>
 #include <iostream>
@@ -25,17 +27,46 @@ std::unique_ptr<Graph> GraphLoader::loadFromCSV(const std::string& filename, boo
         return nullptr;
     }
     
+    // Начало остатка строки после count запятых (метки - последнее поле,
+    // в них могут быть запятые)
+    auto tail = [](const std::string& line, int count) {
+        size_t pos = 0;
+        for (int i = 0; i < count; ++i) {
+            pos = line.find(',', pos);
+            if (pos == std::string::npos) return std::string();
+            ++pos;
+        }
+        return line.substr(pos);
+    };
+    
     std::string line;
     while (std::getline(file, line)) {
-        if (line.empty() || line[0] == '#') continue;
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        
+        // Вершина из экспорта: "# v,id,x,y,тип,метка"; прочие комментарии
+        // и заголовок экспорта пропускаются
+        bool vertexLine = line.compare(0, 4, "# v,") == 0;
+        if (line.empty() || (line[0] == '#' && !vertexLine)) continue;
         
         auto tokens = split(line, ',');
-        if (tokens.size() >= 2) {
+        if (vertexLine) {
+            if (tokens.size() < 4 || tokens[1] == "id") continue;
+            try {
+                int id = std::stoi(tokens[1]);
+                double x = std::stod(tokens[2]);
+                double y = std::stod(tokens[3]);
+                graph->addVertex(id, tail(line, 5));
+                graph->setVertexPosition(id, x, y);
+                if (tokens.size() >= 5 && !tokens[4].empty()) graph->setVertexType(id, tokens[4]);
+            } catch (const std::exception& e) {
+                std::cerr << "Ошибка при парсинге строки: " << line << std::endl;
+            }
+        } else if (tokens.size() >= 2) {
             try {
                 int from = std::stoi(tokens[0]);
                 int to = std::stoi(tokens[1]);
                 double weight = tokens.size() >= 3 ? std::stod(tokens[2]) : 1.0;
-                graph->addEdge(from, to, weight);
+                graph->addEdge(from, to, weight, tail(line, 3));
             } catch (const std::exception& e) {
                 std::cerr << "Ошибка при парсинге строки: " << line << std::endl;
             }
@@ -43,6 +74,7 @@ std::unique_ptr<Graph> GraphLoader::loadFromCSV(const std::string& filename, boo
     }
     
     file.close();
+    attachSearchIndex(*graph);
     return graph;
 }
 
@@ -111,53 +143,79 @@ std::unique_ptr<Graph> GraphLoader::loadFromJSON(const std::string& filename, bo
         pos = objEnd + 1;
     }
     
+    attachSearchIndex(*graph);
     return graph;
 }
 
-bool GraphLoader::saveToCSV(const Graph& g, const std::string& filename) {
-    std::ofstream file(filename);
-    if (!file.is_open()) {
-        std::cerr << "Ошибка: не удалось создать файл " << filename << std::endl;
-        return false;
+std::unique_ptr<Graph> GraphLoader::loadFromFile(const std::string& filename, VertexOrdering ordering) {
+    std::unique_ptr<Graph> graph;
+    if (filename.find(".csv") != std::string::npos) {
+        graph = loadFromCSV(filename, false);
+    } else if (filename.find("kg.json") != std::string::npos || filename.find("knowledge") != std::string::npos) {
+        // Загрузка графа знаний
+        graph = loadFromKnowledgeGraph(filename, true);
+    } else if (filename.find(".json") != std::string::npos) {
+        graph = loadFromJSON(filename, false);
+    } else {
+        std::cout << "Неподдерживаемый формат файла: " << filename << std::endl;
+        return nullptr;
     }
-    
-    auto edges = g.getEdges();
-    for (const auto& edge : edges) {
-        file << edge.from << "," << edge.to << "," << edge.weight << "\n";
+    if (graph) {
+        Reordering::apply(*graph, ordering);
     }
-    
-    file.close();
-    return true;
+    return graph;
 }
 
-bool GraphLoader::saveToJSON(const Graph& g, const std::string& filename) {
-    std::ofstream file(filename);
+std::optional<GraphDelta> GraphLoader::loadDelta(const std::string& filename) {
+    std::ifstream file(filename);
     if (!file.is_open()) {
-        std::cerr << "Ошибка: не удалось создать файл " << filename << std::endl;
-        return false;
+        std::cerr << "Ошибка: не удалось открыть файл " << filename << std::endl;
+        return std::nullopt;
     }
     
-    file << "{\n";
-    file << "  \"directed\": " << (g.isDirected() ? "true" : "false") << ",\n";
-    file << "  \"edges\": [\n";
-    
-    auto edges = g.getEdges();
-    for (size_t i = 0; i < edges.size(); ++i) {
-        const auto& edge = edges[i];
-        file << "    { \"from\": " << edge.from 
-             << ", \"to\": " << edge.to 
-             << ", \"weight\": " << edge.weight << " }";
-        if (i < edges.size() - 1) {
-            file << ",";
+    GraphDelta delta;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty() || line[0] == '#') continue;
+        
+        // Метка - остаток строки, в ней могут быть запятые
+        auto tokens = split(line, ',');
+        try {
+            const std::string& op = tokens[0];
+            if (op == "+v" && tokens.size() >= 2) {
+                size_t labelStart = line.find(',', line.find(',') + 1);
+                std::string label = labelStart == std::string::npos ? "" : line.substr(labelStart + 1);
+                delta.addedVertices.emplace_back(std::stoi(tokens[1]), label);
+            } else if (op == "-v" && tokens.size() >= 2) {
+                delta.removedVertices.push_back(std::stoi(tokens[1]));
+            } else if (op == "+e" && tokens.size() >= 3) {
+                double weight = tokens.size() >= 4 ? std::stod(tokens[3]) : 1.0;
+                size_t labelStart = std::string::npos;
+                if (tokens.size() >= 5) {
+                    labelStart = 0;
+                    for (int i = 0; i < 4; ++i) labelStart = line.find(',', labelStart) + 1;
+                }
+                std::string label = labelStart == std::string::npos ? "" : line.substr(labelStart);
+                delta.addedEdges.emplace_back(std::stoi(tokens[1]), std::stoi(tokens[2]), weight, false, label);
+            } else if (op == "-e" && tokens.size() >= 3) {
+                delta.removedEdges.emplace_back(std::stoi(tokens[1]), std::stoi(tokens[2]));
+            } else {
+                std::cerr << "Неизвестное изменение: " << line << std::endl;
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Ошибка при парсинге строки: " << line << std::endl;
         }
-        file << "\n";
     }
-    
-    file << "  ]\n";
-    file << "}\n";
-    
-    file.close();
-    return true;
+    return delta;
+}
+
+bool GraphLoader::saveToCSV(const Graph& g, const std::string& filename) {
+    return GraphExporter::save(g, filename, ExportFormat::CSV);
+}
+
+bool GraphLoader::saveToJSON(const Graph& g, const std::string& filename) {
+    return GraphExporter::save(g, filename, ExportFormat::JSON);
 }
 
 // Вспомогательная функция для извлечения строкового значения из JSON
@@ -177,6 +235,34 @@ static std::string extractStringValue(const std::string& json, const std::string
     return json.substr(valueStart + 1, valueEnd - valueStart - 1);
 }
 
+// Строковое значение ключа верхнего уровня объекта: вложенные объекты
+// (например, "attributes" с собственным "type") пропускаются
+static std::string extractTopLevelStringValue(const std::string& obj, const std::string& key) {
+    int depth = 0;
+    for (size_t i = 0; i < obj.size(); ++i) {
+        char c = obj[i];
+        if (c == '{' || c == '[') {
+            ++depth;
+        } else if (c == '}' || c == ']') {
+            --depth;
+        } else if (c == '"') {
+            size_t end = i + 1;
+            while (end < obj.size() && obj[end] != '"') {
+                if (obj[end] == '\\') ++end;
+                ++end;
+            }
+            if (depth == 1 && obj.compare(i + 1, end - i - 1, key) == 0) {
+                size_t colon = obj.find_first_not_of(" \t\r\n", end + 1);
+                if (colon != std::string::npos && obj[colon] == ':') {
+                    return extractStringValue(obj, key, i);
+                }
+            }
+            i = end;
+        }
+    }
+    return "";
+}
+
 std::unique_ptr<Graph> GraphLoader::loadFromKnowledgeGraph(const std::string& filename, bool directed) {
     auto graph = std::make_unique<Graph>(directed);
     std::ifstream file(filename);
@@ -241,6 +327,12 @@ std::unique_ptr<Graph> GraphLoader::loadFromKnowledgeGraph(const std::string& fi
                         graph->addVertex(numericId, entityId);
                     }
                     
+                    // Тип сущности - на верхнем уровне, после вложенных attributes
+                    std::string entityType = extractTopLevelStringValue(obj, "type");
+                    if (!entityType.empty()) {
+                        graph->setVertexType(numericId, entityType);
+                    }
+                    
                     numericId++;
                 }
                 
@@ -297,8 +389,13 @@ std::unique_ptr<Graph> GraphLoader::loadFromKnowledgeGraph(const std::string& fi
     std::cout << "Загружено сущностей: " << entityIdMap.size() 
               << ", связей: " << graph->getEdgeCount() << std::endl;
     
+    attachSearchIndex(*graph);
     return graph;
 }
 
+void GraphLoader::attachSearchIndex(Graph& g) {
+    g.setSearchIndex(std::make_shared<const SearchIndex>(SearchIndex::build(g)));
+}
+
 } // namespace graph
 
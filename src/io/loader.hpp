@@ -1,14 +1,17 @@
 #pragma once
 
 #include "core/graph.hpp"
+#include "core/reorder.hpp"
 #include <string>
 #include <memory>
+#include <optional>
 
 namespace graph {
 
 class GraphLoader {
 public:
-    // Загрузка из CSV формата: from,to,weight
+    // Загрузка из CSV формата: from,to[,weight[,метка]]; строки вершин
+    // экспорта "# v,id,x,y,тип,метка" задают метки, типы и координаты
     static std::unique_ptr<Graph> loadFromCSV(const std::string& filename, bool directed = false);
     
     // Загрузка из JSON формата
@@ -17,14 +20,27 @@ public:
     // Загрузка из формата графа знаний (kg.json)
     static std::unique_ptr<Graph> loadFromKnowledgeGraph(const std::string& filename, bool directed = true);
     
-    // Сохранение в CSV
-    static bool saveToCSV(const Graph& g, const std::string& filename);
+    // Порядок вершин после загрузки по умолчанию
+    static constexpr VertexOrdering kDefaultOrdering = VertexOrdering::ReverseCuthillMcKee;
+    
+    // Загрузка с выбором формата по имени файла; затем вершины один раз
+    // перенумеровываются в порядке ordering
+    static std::unique_ptr<Graph> loadFromFile(const std::string& filename,
+                                               VertexOrdering ordering = kDefaultOrdering);
+    
+    // Пакет изменений, по строке на изменение:
+    //   +v,id[,метка]   -v,id   +e,from,to[,вес[,метка]]   -e,from,to
+    static std::optional<GraphDelta> loadDelta(const std::string& filename);
     
-    // Сохранение в JSON
+    // Сохранение в CSV и JSON с метками и координатами (см. GraphExporter)
+    static bool saveToCSV(const Graph& g, const std::string& filename);
     static bool saveToJSON(const Graph& g, const std::string& filename);
     
 private:
     static std::vector<std::string> split(const std::string& s, char delimiter);
+    
+    // Построить поисковый индекс по именам вершин загруженного графа
+    static void attachSearchIndex(Graph& g);
 };
 
 } // namespace graph
@@ -2,19 +2,36 @@
 #include <iostream>
 #include <memory>
 #include <thread>
+#include <atomic>
+#include <mutex>
 #include <future>
+#include <functional>
 #include <string>
 #include <variant>
 #include <type_traits>
 #include <optional>
+#include <unordered_map>
+#include <limits>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <SFML/Window/Event.hpp>
 
 #include "core/graph.hpp"
 #include "core/algorithms.hpp"
 #include "core/parallel.hpp"
+#include "core/distance_oracle.hpp"
+#include "core/contraction.hpp"
+#include "core/statistics.hpp"
+#include "core/subgraph.hpp"
+#include "core/query.hpp"
+#include "core/search.hpp"
+#include "core/incremental.hpp"
+#include "core/journal.hpp"
 #include "io/loader.hpp"
 #include "visualization/layout.hpp"
 #include "visualization/renderer.hpp"
+#include "bench/benchmark.hpp"
 
 using namespace graph;
 
@@ -23,7 +40,57 @@ enum class AlgorithmType {
     BFS,
     DFS,
     Dijkstra,
-    ParallelBFS
+    ParallelBFS,
+    BidirectionalDijkstra,
+    AStar,
+    OracleQuery,
+    Hierarchy,
+    DistanceMap,
+    PageRank,
+    PersonalizedPageRank,
+    Betweenness,
+    Communities,
+    Statistics
+};
+
+// Результат фонового анализа, который накладывается на отрисовку
+struct VertexOverlay {
+    std::unordered_map<int, sf::Color> colors;
+    std::unordered_map<int, float> scales;
+    std::vector<int> highlighted;
+    std::unordered_map<int, int> clusters;  // подсказки кластеров для макета
+};
+
+// Алгоритмы, которым нужны начальная и конечная вершины
+static bool isPointToPoint(AlgorithmType type) {
+    return type == AlgorithmType::Dijkstra || type == AlgorithmType::BidirectionalDijkstra
+        || type == AlgorithmType::AStar || type == AlgorithmType::OracleQuery
+        || type == AlgorithmType::Hierarchy;
+}
+
+// Размер графа (дуг), с которого k-ядра считаются параллельно
+constexpr size_t kParallelCoreArcs = 1'000'000;
+
+// Наибольший размер окрестности: force-directed квадратичен по числу вершин
+constexpr size_t kEgoVertexLimit = 2000;
+
+// Сколько путей запроса перечислять и сколько из них печатать
+constexpr size_t kQueryPathLimit = 1000;
+constexpr size_t kQueryPrintedPaths = 10;
+
+// Сколько найденных по имени вершин подсвечивать и во сколько раз приближать первую
+constexpr size_t kSearchLimit = 20;
+constexpr float kSearchZoom = 2.5f;
+
+// Пауза в правках, после которой перестраиваются снимок и индексы: серия
+// правок (пакет, отмена подряд) обходится одной перестройкой
+constexpr std::chrono::milliseconds kRebuildDelay{500};
+
+// Строка ввода: запрос по типам связей (Q) или поиск по имени (/)
+enum class InputMode {
+    None,
+    Query,
+    Search
 };
 
 class GraphVisualizerApp {
@@ -85,7 +152,10 @@ public:
         std::cout << "Окно создано. Размер: " << window_.getSize().x << "x" << window_.getSize().y << std::endl;
         std::cout.flush();
         
-        // Загрузить граф из файла, если указан
+        // Готовые макеты читаются из кеша на диске, а не пересчитываются
+        layout_.setCache(std::make_shared<LayoutCache>(LayoutCache::defaultDirectory()));
+        
+        // Загрузить граф из файла, если указан (макет применяет loadGraphFromFile)
         if (!graphFile.empty()) {
             std::cout << "[DEBUG] Загрузка графа из файла: " << graphFile << std::endl;
             std::cout.flush();
@@ -98,6 +168,10 @@ public:
             std::cout.flush();
             try {
                 createTestGraph();
+                watchGraph();
+                preparePrecomputations();
+                startJournal();
+                applyLayout(currentLayout_);
             } catch (const std::exception& e) {
                 std::cerr << "[ERROR] Исключение при создании тестового графа: " << e.what() << std::endl;
                 std::cerr.flush();
@@ -107,17 +181,6 @@ public:
         std::cout << "[DEBUG] После createTestGraph(), graph_ = " << (graph_ ? "существует" : "null") << std::endl;
         std::cout.flush();
         
-        std::cout << "[DEBUG] Применение layout" << std::endl;
-        std::cout.flush();
-        try {
-            applyLayout(LayoutType::ForceDirected);
-            std::cout << "[DEBUG] Layout применён" << std::endl;
-            std::cout.flush();
-        } catch (const std::exception& e) {
-            std::cerr << "[ERROR] Исключение при применении layout: " << e.what() << std::endl;
-            std::cerr.flush();
-        }
-        
         // Отладочный вывод
         std::cout << "[DEBUG] graph_ " << (graph_ ? "существует" : "null") << std::endl;
         std::cout.flush();
@@ -131,7 +194,8 @@ public:
                     std::cout << id << " ";
                 }
                 std::cout << std::endl;
-                auto* v = graph_->getVertex(vertices[0]);
+                const Graph& view = *graph_;
+                const Vertex* v = view.getVertex(vertices[0]);
                 if (v) {
                     std::cout << "[DEBUG] Координаты первой вершины (" << vertices[0] << "): (" 
                              << v->x << ", " << v->y << ")" << std::endl;
@@ -160,13 +224,14 @@ public:
             update();
             render();
         }
+        saveJournal();
         std::cout << "[DEBUG] Главный цикл завершён" << std::endl;
         std::cout.flush();
     }
     
 private:
     sf::RenderWindow window_;
-    std::unique_ptr<Graph> graph_;
+    std::shared_ptr<Graph> graph_;
     std::unique_ptr<GraphRenderer> renderer_;
     Layout layout_;
     AlgorithmState algorithmState_;
@@ -176,8 +241,77 @@ private:
     int selectedEndVertex_;
     float animationSpeed_;
     LayoutType currentLayout_ = LayoutType::ForceDirected;
+    std::string currentGraphFile_;
+    
+    // Предвычисления по снимку графа: оракул расстояний (на пуле потоков,
+    // сохраняется рядом с графом) и иерархия сжатия; строятся в фоне
+    ThreadPool workers_{std::max(1u, std::thread::hardware_concurrency())};
+    std::mutex oracleFileMutex_;  // объявлен до задач, которые его берут
+    std::shared_ptr<const CSRGraph> graphSnapshot_;
+    std::shared_ptr<const DistanceOracle> oracle_;
+    std::future<std::shared_ptr<const DistanceOracle>> oracleFuture_;
+    std::shared_ptr<const CSRGraph> oracleSource_;  // снимок, для которого строится oracleFuture_
+    std::shared_ptr<std::atomic<bool>> precomputeStale_;  // взводится, когда задачи снимка устарели; прерывает их
+    std::shared_ptr<const ContractionHierarchy> hierarchy_;
+    std::future<std::shared_ptr<const ContractionHierarchy>> hierarchyFuture_;
+    
+    // После правки снимок строится по первому требованию, индексы - когда
+    // правки стихнут на kRebuildDelay; до тех пор пути ищутся без индексов
+    bool snapshotPending_ = false;
+    bool indicesPending_ = false;
+    std::chrono::steady_clock::time_point lastEdit_;
     
     std::future<std::vector<int>> algorithmFuture_;
+    std::atomic<std::shared_ptr<const EuclideanBound>> geometry_;  // оценка A* для последней версии графа
+    std::future<VertexOverlay> overlayFuture_;
+    std::shared_ptr<const CSRGraph> overlaySource_;  // снимок, по которому считается overlayFuture_
+    
+    // Фильтр k-ядра: ядерные числа снимка и текущее значение k (0 - весь граф)
+    std::shared_ptr<const std::vector<int>> coreNumbers_;
+    int coreLevel_ = 0;
+    int degeneracy_ = 0;
+    
+    // Окрестность выбранной вершины: центр и радиус в рёбрах (0 - выключено)
+    std::shared_ptr<const CSRGraph> reverseSnapshot_;
+    int egoCenter_ = -1;
+    int egoHops_ = 0;
+    
+    // Запросы по типам связей: индекс строится в фоне
+    std::shared_ptr<const QueryEngine> queryEngine_;
+    std::future<std::shared_ptr<const QueryEngine>> queryEngineFuture_;
+    
+    // Строка ввода: символ клавиши, открывшей ввод, приходит следом как TextEntered
+    InputMode inputMode_ = InputMode::None;
+    char32_t skipInputChar_ = 0;
+    std::string inputText_;
+    
+    // Фоновые задачи прежнего графа: деструктор future из std::async ждёт
+    // конца задачи, поэтому они доживают здесь и удаляются в update(), когда
+    // готовы (объявлены после workers_ - освобождаются раньше пула)
+    std::vector<std::function<bool()>> retired_;
+    
+    template<typename T>
+    void retire(std::future<T>& future) {
+        if (!future.valid()) return;
+        auto pending = std::make_shared<std::future<T>>(std::move(future));
+        retired_.push_back([pending] {
+            return pending->wait_for(std::chrono::milliseconds(0)) == std::future_status::ready;
+        });
+    }
+    
+    // Результаты поиска по имени; Tab переходит к следующему
+    std::vector<SearchHit> searchHits_;
+    size_t searchCursor_ = 0;
+    
+    // Компоненты и степени, обновляемые по событиям изменения графа
+    IncrementalAnalysis dynamics_;
+    
+    // Журнал операций для отмены (Ctrl+Z) и повтора (Ctrl+Y); сохраняется
+    // рядом с графом при выходе. Пока журнал применяется при загрузке,
+    // события изменения графа не обрабатываются
+    Journal journal_;
+    bool restoringJournal_ = false;
+    bool sessionResumed_ = false;
     bool isAlgorithmRunning_ = false;
     bool isDragging_ = false;
     sf::Vector2i lastMousePos_;
@@ -192,8 +326,18 @@ private:
             else if (const auto* mouseWheel = event->getIf<sf::Event::MouseWheelScrolled>()) {
                 if (renderer_) renderer_->handleMouseWheel(mouseWheel->delta);
             }
+            else if (const auto* textEntered = event->getIf<sf::Event::TextEntered>()) {
+                if (inputMode_ != InputMode::None) handleInputText(textEntered->unicode);
+            }
             else if (const auto* keyPressed = event->getIf<sf::Event::KeyPressed>()) {
-                handleKeyPress(keyPressed->code);
+                // Во время ввода текста обычные клавиши не работают
+                if (inputMode_ != InputMode::None) {
+                    handleInputKey(keyPressed->code);
+                } else if (keyPressed->control) {
+                    handleControlKey(keyPressed->code, keyPressed->shift);
+                } else {
+                    handleKeyPress(keyPressed->code);
+                }
             }
             else if (const auto* mouseButton = event->getIf<sf::Event::MouseButtonPressed>()) {
                 handleMouseClick(*mouseButton);
@@ -240,6 +384,63 @@ private:
             case sf::Keyboard::Key::P:
                 startAlgorithm(AlgorithmType::ParallelBFS);
                 break;
+            case sf::Keyboard::Key::J:  // Двунаправленный Dijkstra
+                startAlgorithm(AlgorithmType::BidirectionalDijkstra);
+                break;
+            case sf::Keyboard::Key::A:
+                startAlgorithm(AlgorithmType::AStar);
+                break;
+            case sf::Keyboard::Key::O:  // Оценка расстояния оракулом
+                startAlgorithm(AlgorithmType::OracleQuery);
+                break;
+            case sf::Keyboard::Key::H:  // Иерархия сжатия
+                startAlgorithm(AlgorithmType::Hierarchy);
+                break;
+            case sf::Keyboard::Key::G:  // Карта расстояний (delta-stepping)
+                startAlgorithm(AlgorithmType::DistanceMap);
+                break;
+            case sf::Keyboard::Key::E:  // PageRank
+                startAlgorithm(AlgorithmType::PageRank);
+                break;
+            case sf::Keyboard::Key::U:  // Персонализированный PageRank от выбранной вершины
+                startAlgorithm(AlgorithmType::PersonalizedPageRank);
+                break;
+            case sf::Keyboard::Key::T:  // Центральность по посредничеству
+                startAlgorithm(AlgorithmType::Betweenness);
+                break;
+            case sf::Keyboard::Key::M:  // Сообщества (Louvain)
+                startAlgorithm(AlgorithmType::Communities);
+                break;
+            case sf::Keyboard::Key::X:  // Структурные характеристики
+                startAlgorithm(AlgorithmType::Statistics);
+                break;
+            case sf::Keyboard::Key::K:  // Показать только k-ядро / весь граф
+                toggleCoreFilter();
+                break;
+            case sf::Keyboard::Key::LBracket:
+                setCoreLevel(coreLevel_ - 1);
+                break;
+            case sf::Keyboard::Key::RBracket:
+                setCoreLevel(coreLevel_ + 1);
+                break;
+            case sf::Keyboard::Key::V:  // Расширить окрестность выбранной вершины
+                setEgoHops(selectedStartVertex_ == egoCenter_ ? egoHops_ + 1 : 1);
+                break;
+            case sf::Keyboard::Key::Z:  // Сузить окрестность (0 - весь граф)
+                setEgoHops(egoHops_ - 1);
+                break;
+            case sf::Keyboard::Key::Q:  // Ввод запроса по типам связей
+                startTextInput(InputMode::Query, U'q');
+                break;
+            case sf::Keyboard::Key::Slash:  // Поиск вершины по имени
+                startTextInput(InputMode::Search, U'/');
+                break;
+            case sf::Keyboard::Key::Tab:  // Следующий результат поиска
+                focusNextSearchHit();
+                break;
+            case sf::Keyboard::Key::W:  // Применить пакет изменений <файл графа>.delta
+                applyDeltaFile();
+                break;
             case sf::Keyboard::Key::Space:
                 pauseResumeAlgorithm();
                 break;
@@ -255,6 +456,15 @@ private:
             case sf::Keyboard::Key::N:  // Random
                 applyLayout(LayoutType::Random);
                 break;
+            case sf::Keyboard::Key::Num1:  // Иерархический макет
+                applyLayout(LayoutType::Layered);
+                break;
+            case sf::Keyboard::Key::Num2:  // Макет по стрессу
+                applyLayout(LayoutType::Stress);
+                break;
+            case sf::Keyboard::Key::Num3:  // Спектральный макет
+                applyLayout(LayoutType::Spectral);
+                break;
             case sf::Keyboard::Key::Escape:
                 window_.close();
                 break;
@@ -263,6 +473,19 @@ private:
         }
     }
     
+    void handleControlKey(sf::Keyboard::Key key, bool shift) {
+        switch (key) {
+            case sf::Keyboard::Key::Z:  // Отмена, Ctrl+Shift+Z - повтор
+                stepJournal(shift);
+                break;
+            case sf::Keyboard::Key::Y:  // Повтор
+                stepJournal(true);
+                break;
+            default:
+                break;
+        }
+    }
+    
     void handleMouseClick(const sf::Event::MouseButtonPressed& mouseEvent) {
         if (mouseEvent.button == sf::Mouse::Button::Left) {
             // Преобразовать координаты экрана в координаты мира (SFML 3)
@@ -273,10 +496,10 @@ private:
                 if (selectedStartVertex_ == -1) {
                     selectedStartVertex_ = vertexId;
                     std::cout << "Выбрана начальная вершина: " << vertexId << std::endl;
-                } else if (selectedEndVertex_ == -1 && algorithmType_ == AlgorithmType::Dijkstra) {
+                } else if (selectedEndVertex_ == -1 && isPointToPoint(algorithmType_)) {
                     selectedEndVertex_ = vertexId;
                     std::cout << "Выбрана конечная вершина: " << vertexId << std::endl;
-                    startAlgorithm(AlgorithmType::Dijkstra);
+                    startAlgorithm(algorithmType_);
                 } else {
                     selectedStartVertex_ = vertexId;
                     selectedEndVertex_ = -1;
@@ -304,36 +527,763 @@ private:
         algorithmType_ = type;
         isAlgorithmRunning_ = true;
         
+        if (isPointToPoint(type) && selectedEndVertex_ == -1) {
+            std::cout << "Для поиска пути нужна конечная вершина. Кликните на вершину." << std::endl;
+            isAlgorithmRunning_ = false;
+            return;
+        }
+        
+        // Оракул, иерархия и снимок A* описывают граф до правок, которые ещё
+        // идут: путь ищется встречным Dijkstra по текущей версии
+        if (indicesPending_ && (type == AlgorithmType::AStar || type == AlgorithmType::OracleQuery
+                                || type == AlgorithmType::Hierarchy)) {
+            std::cout << "Индексы перестраиваются после правок, путь ищется двунаправленным Dijkstra" << std::endl;
+            type = AlgorithmType::BidirectionalDijkstra;
+        }
+        
+        if (type == AlgorithmType::OracleQuery) {
+            isAlgorithmRunning_ = false;
+            queryOracle();
+            return;
+        }
+        
+        if (type == AlgorithmType::Hierarchy) {
+            isAlgorithmRunning_ = false;
+            queryHierarchy();
+            return;
+        }
+        
+        if (type == AlgorithmType::DistanceMap) {
+            isAlgorithmRunning_ = false;
+            computeDistanceMap();
+            return;
+        }
+        
+        if (type == AlgorithmType::PageRank || type == AlgorithmType::PersonalizedPageRank) {
+            isAlgorithmRunning_ = false;
+            computePageRank(type == AlgorithmType::PersonalizedPageRank ? selectedStartVertex_ : -1);
+            return;
+        }
+        
+        if (type == AlgorithmType::Betweenness) {
+            isAlgorithmRunning_ = false;
+            computeBetweenness();
+            return;
+        }
+        
+        if (type == AlgorithmType::Communities) {
+            isAlgorithmRunning_ = false;
+            computeCommunities();
+            return;
+        }
+        
+        if (type == AlgorithmType::Statistics) {
+            isAlgorithmRunning_ = false;
+            computeStatistics();
+            return;
+        }
+        
+        // Фоновый алгоритм работает со своей версией графа: изменения, новый
+        // макет и загрузка другого графа его не затрагивают
+        auto graph = graph_->snapshot();
+        int start = selectedStartVertex_;
+        int end = selectedEndVertex_;
         if (type == AlgorithmType::Dijkstra) {
-            if (selectedEndVertex_ == -1) {
-                std::cout << "Для Dijkstra нужна конечная вершина. Кликните на вершину." << std::endl;
-                isAlgorithmRunning_ = false;
-                return;
-            }
             algorithmFuture_ = std::async(std::launch::async, 
-                [this]() {
-                    return Algorithms::Dijkstra(*graph_, selectedStartVertex_, 
-                                               selectedEndVertex_, algorithmState_);
+                [this, graph, start, end]() {
+                    return Algorithms::Dijkstra(*graph, start, end, algorithmState_);
+                });
+        } else if (type == AlgorithmType::BidirectionalDijkstra) {
+            algorithmFuture_ = std::async(std::launch::async,
+                [this, graph, start, end]() {
+                    return Algorithms::BidirectionalDijkstra(*graph, start, end, algorithmState_);
+                });
+        } else if (type == AlgorithmType::AStar) {
+            // Снимок CSR уже есть; евклидова оценка строится раз на версию графа
+            algorithmFuture_ = std::async(std::launch::async,
+                [this, graph, csr = graphSnapshot_, start, end, oracle = oracle_]() {
+                    auto geometry = geometryFor(*csr, *graph);
+                    return Algorithms::AStar(*csr, start, end, algorithmState_, HeuristicType::Auto,
+                                             geometry.get(), oracle.get());
                 });
         } else if (type == AlgorithmType::BFS) {
             algorithmFuture_ = std::async(std::launch::async,
-                [this]() {
-                    return Algorithms::BFS(*graph_, selectedStartVertex_, algorithmState_);
+                [this, graph, start]() {
+                    return Algorithms::BFS(*graph, start, algorithmState_);
                 });
         } else if (type == AlgorithmType::DFS) {
             algorithmFuture_ = std::async(std::launch::async,
-                [this]() {
-                    return Algorithms::DFS(*graph_, selectedStartVertex_, algorithmState_);
+                [this, graph, start]() {
+                    return Algorithms::DFS(*graph, start, algorithmState_);
                 });
         } else if (type == AlgorithmType::ParallelBFS) {
             algorithmFuture_ = std::async(std::launch::async,
-                [this]() {
-                    return ParallelAlgorithms::parallelBFS(*graph_, selectedStartVertex_, 
+                [this, graph, start]() {
+                    return ParallelAlgorithms::parallelBFS(*graph, start, 
                                                           algorithmState_, 4);
                 });
         }
     }
     
+    std::shared_ptr<const EuclideanBound> geometryFor(const CSRGraph& csr, const Graph& graph) {
+        auto cached = geometry_.load();
+        if (cached && cached->version == graph.version() && cached->xs.size() == csr.ids.size()) {
+            return cached;
+        }
+        auto built = std::make_shared<const EuclideanBound>(EuclideanBound::build(csr, graph));
+        geometry_.store(built);
+        return built;
+    }
+    
+    void queryOracle() {
+        if (!oracle_ || !graphSnapshot_) {
+            std::cout << "Оракул расстояний ещё строится" << std::endl;
+            return;
+        }
+        
+        int u = graphSnapshot_->indexOf(selectedStartVertex_);
+        int v = graphSnapshot_->indexOf(selectedEndVertex_);
+        if (u == -1 || v == -1) return;
+        
+        auto begin = std::chrono::steady_clock::now();
+        double lower = oracle_->lowerBound(u, v);
+        double upper = oracle_->upperBound(u, v);
+        std::vector<int> path;
+        for (int x : oracle_->approximatePath(u, v)) {
+            path.push_back(graphSnapshot_->ids[x]);
+        }
+        auto elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin);
+        
+        algorithmState_.reset();
+        algorithmState_.path = path;
+        std::cout << "Оракул: " << lower << " <= d <= " << upper
+                  << ", приближённый путь из " << path.size() << " вершин ("
+                  << elapsed.count() << " мкс)" << std::endl;
+    }
+    
+    void queryHierarchy() {
+        if (!hierarchy_ || !graphSnapshot_) {
+            std::cout << "Иерархия сжатия ещё строится" << std::endl;
+            return;
+        }
+        
+        auto begin = std::chrono::steady_clock::now();
+        auto path = Algorithms::HierarchyQuery(*graphSnapshot_, *hierarchy_,
+                                               selectedStartVertex_, selectedEndVertex_, algorithmState_);
+        auto elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin);
+        
+        std::cout << "Иерархия сжатия: путь из " << path.size() << " вершин, длина "
+                  << Algorithms::pathCost(*graph_, path) << " (" << elapsed.count() << " мкс)" << std::endl;
+    }
+    
+    void computeDistanceMap() {
+        if (!currentSnapshot() || overlayFuture_.valid()) return;
+        
+        auto csr = graphSnapshot_;
+        int start = selectedStartVertex_;
+        overlaySource_ = csr;
+        overlayFuture_ = std::async(std::launch::async, [csr, start]() {
+            auto begin = std::chrono::steady_clock::now();
+            auto tree = ParallelAlgorithms::deltaStepping(*csr, start,
+                                                         std::max(1u, std::thread::hardware_concurrency()));
+            auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin);
+            
+            double farthest = 0.0;
+            for (double d : tree.distance) {
+                if (d != std::numeric_limits<double>::infinity()) farthest = std::max(farthest, d);
+            }
+            
+            // Недостижимые вершины остаются стандартного цвета
+            VertexOverlay overlay;
+            for (int v = 0; v < csr->size(); ++v) {
+                if (tree.distance[v] == std::numeric_limits<double>::infinity()) continue;
+                float t = farthest > 0.0 ? static_cast<float>(tree.distance[v] / farthest) : 0.0f;
+                overlay.colors[csr->ids[v]] = GraphRenderer::gradientColor(t);
+            }
+            std::cout << "Карта расстояний: достижимо " << overlay.colors.size() << " вершин, максимум "
+                      << farthest << " (" << elapsed.count() << " мс)" << std::endl;
+            return overlay;
+        });
+    }
+    
+    void computePageRank(int personalizedFrom) {
+        if (!currentSnapshot() || overlayFuture_.valid()) return;
+        
+        auto csr = graphSnapshot_;
+        overlaySource_ = csr;
+        overlayFuture_ = std::async(std::launch::async, [csr, personalizedFrom]() {
+            auto begin = std::chrono::steady_clock::now();
+            auto result = ParallelAlgorithms::pageRank(*csr, std::max(1u, std::thread::hardware_concurrency()),
+                                                       personalizedFrom);
+            auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin);
+            
+            VertexOverlay overlay;
+            if (result.score.empty()) return overlay;
+            
+            // Площадь круга пропорциональна оценке: радиус от 0.6 до 2.5 базового
+            double best = *std::max_element(result.score.begin(), result.score.end());
+            for (int v = 0; v < csr->size(); ++v) {
+                double t = best > 0.0 ? std::sqrt(result.score[v] / best) : 0.0;
+                overlay.scales[csr->ids[v]] = static_cast<float>(0.6 + 1.9 * t);
+                overlay.colors[csr->ids[v]] = GraphRenderer::gradientColor(static_cast<float>(1.0 - t));
+            }
+            overlay.highlighted = ParallelAlgorithms::topVertices(*csr, result.score, 5);
+            
+            std::cout << (personalizedFrom == -1 ? "PageRank" : "Персонализированный PageRank")
+                      << ": " << result.iterations << " итераций, невязка " << result.residual
+                      << " (" << elapsed.count() << " мс)" << std::endl;
+            printRanking(*csr, result.score, overlay.highlighted);
+            return overlay;
+        });
+    }
+    
+    void computeBetweenness() {
+        if (!currentSnapshot() || overlayFuture_.valid()) return;
+        
+        // Точный расчёт квадратичен по числу вершин - на больших графах выборка
+        auto csr = graphSnapshot_;
+        double epsilon = csr->size() <= 2000 ? 0.0 : 0.01;
+        overlaySource_ = csr;
+        overlayFuture_ = std::async(std::launch::async, [csr, epsilon]() {
+            auto begin = std::chrono::steady_clock::now();
+            auto result = ParallelAlgorithms::betweenness(*csr, std::max(1u, std::thread::hardware_concurrency()),
+                                                          epsilon);
+            auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin);
+            
+            VertexOverlay overlay;
+            if (result.score.empty()) return overlay;
+            
+            double best = *std::max_element(result.score.begin(), result.score.end());
+            for (int v = 0; v < csr->size(); ++v) {
+                double t = best > 0.0 ? result.score[v] / best : 0.0;
+                overlay.colors[csr->ids[v]] = GraphRenderer::gradientColor(static_cast<float>(1.0 - t));
+            }
+            overlay.highlighted = ParallelAlgorithms::topVertices(*csr, result.score, 10);
+            
+            std::cout << "Центральность по посредничеству: " << result.samples << " источников";
+            if (result.errorBound > 0.0) {
+                std::cout << ", ошибка нормированной оценки <= " << result.errorBound;
+            }
+            std::cout << " (" << elapsed.count() << " мс)" << std::endl;
+            printRanking(*csr, result.score, overlay.highlighted);
+            return overlay;
+        });
+    }
+    
+    void computeCommunities() {
+        if (!currentSnapshot() || overlayFuture_.valid()) return;
+        
+        auto csr = graphSnapshot_;
+        overlaySource_ = csr;
+        overlayFuture_ = std::async(std::launch::async, [csr]() {
+            auto begin = std::chrono::steady_clock::now();
+            auto result = ParallelAlgorithms::louvain(*csr, std::max(1u, std::thread::hardware_concurrency()));
+            auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin);
+            
+            VertexOverlay overlay;
+            for (int v = 0; v < csr->size(); ++v) {
+                overlay.colors[csr->ids[v]] = GraphRenderer::categoricalColor(result.community[v]);
+                overlay.clusters[csr->ids[v]] = result.community[v];
+            }
+            std::cout << "Сообщества: " << result.count << ", модулярность " << result.modularity
+                      << ", уровней " << result.levels << " (" << elapsed.count() << " мс)" << std::endl;
+            return overlay;
+        });
+    }
+    
+    void computeStatistics() {
+        if (!currentSnapshot() || overlayFuture_.valid()) return;
+        
+        auto csr = graphSnapshot_;
+        overlaySource_ = csr;
+        overlayFuture_ = std::async(std::launch::async, [csr]() {
+            auto begin = std::chrono::steady_clock::now();
+            auto stats = graph::Statistics::compute(*csr, std::max(1u, std::thread::hardware_concurrency()));
+            auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin);
+            
+            // Цвет - локальный коэффициент кластеризации, обведены вершины наибольшего k-ядра
+            VertexOverlay overlay;
+            for (int v = 0; v < csr->size(); ++v) {
+                overlay.colors[csr->ids[v]] = GraphRenderer::gradientColor(static_cast<float>(1.0 - stats.clustering[v]));
+                if (stats.coreNumber[v] == stats.degeneracy) overlay.highlighted.push_back(csr->ids[v]);
+            }
+            std::cout << "Треугольников: " << stats.triangles
+                      << ", средний коэффициент кластеризации: " << stats.averageClustering
+                      << ", транзитивность: " << stats.transitivity
+                      << ", вырожденность: " << stats.degeneracy
+                      << " (" << elapsed.count() << " мс)" << std::endl;
+            return overlay;
+        });
+    }
+    
+    static void printRanking(const CSRGraph& csr, const std::vector<double>& score, const std::vector<int>& top) {
+        for (size_t i = 0; i < top.size(); ++i) {
+            std::cout << "  " << (i + 1) << ". вершина " << top[i]
+                      << ": " << score[csr.indexOf(top[i])] << std::endl;
+        }
+    }
+    
+    void toggleCoreFilter() {
+        if (!currentSnapshot()) return;
+        if (coreLevel_ > 0) {
+            setCoreLevel(0);
+            return;
+        }
+        
+        if (!coreNumbers_) {
+            // Параллельное снятие слоёв окупается только на больших графах
+            CSRGraph simple = graphSnapshot_->simplified();
+            auto core = simple.arcCount() > kParallelCoreArcs
+                ? graph::Statistics::coreNumbersParallel(simple, std::max(1u, std::thread::hardware_concurrency()))
+                : graph::Statistics::coreNumbers(simple);
+            degeneracy_ = core.empty() ? 0 : *std::max_element(core.begin(), core.end());
+            coreNumbers_ = std::make_shared<const std::vector<int>>(std::move(core));
+        }
+        setCoreLevel(std::max(1, (degeneracy_ + 1) / 2));
+    }
+    
+    void setCoreLevel(int k) {
+        if (!coreNumbers_ || !graphSnapshot_) return;
+        coreLevel_ = std::clamp(k, 0, degeneracy_);
+        egoHops_ = 0;
+        
+        if (coreLevel_ == 0) {
+            showSubgraph(nullptr);
+            return;
+        }
+        auto view = std::make_shared<const SubgraphView>(
+            SubgraphView::kCore(graphSnapshot_, *coreNumbers_, coreLevel_));
+        std::cout << "k-ядро, k = " << coreLevel_ << " из " << degeneracy_
+                  << ": " << view->size() << " вершин" << std::endl;
+        showSubgraph(view);
+    }
+    
+    void setEgoHops(int hops) {
+        if (!currentSnapshot()) return;
+        if (hops > 0 && selectedStartVertex_ == -1) {
+            std::cout << "Выберите вершину кликом" << std::endl;
+            return;
+        }
+        egoHops_ = std::max(0, hops);
+        coreLevel_ = 0;
+        
+        if (egoHops_ == 0) {
+            egoCenter_ = -1;
+            showSubgraph(nullptr);
+            return;
+        }
+        
+        // Граф остаётся в памяти целиком, обходится только окрестность
+        egoCenter_ = selectedStartVertex_;
+        auto begin = std::chrono::steady_clock::now();
+        auto view = std::make_shared<const SubgraphView>(SubgraphView::neighborhood(
+            graphSnapshot_, egoCenter_, egoHops_, kEgoVertexLimit, reverseSnapshot_.get()));
+        auto elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin);
+        std::cout << "Окрестность вершины " << egoCenter_ << " радиуса " << egoHops_ << ": "
+                  << view->size() << " вершин (" << elapsed.count() << " мкс)" << std::endl;
+        if (view->size() >= kEgoVertexLimit) {
+            std::cout << "Окрестность обрезана до " << kEgoVertexLimit << " вершин" << std::endl;
+        }
+        showSubgraph(view);
+    }
+    
+    void startTextInput(InputMode mode, char32_t opener) {
+        inputMode_ = mode;
+        skipInputChar_ = opener;
+        inputText_.clear();
+        updatePrompt();
+        if (mode == InputMode::Query) {
+            std::cout << "Запрос (Enter - выполнить, Esc - отмена), например: course -lecturer_of-> person" << std::endl;
+        } else {
+            std::cout << "Поиск по имени (Enter - перейти к вершине, Esc - отмена)" << std::endl;
+        }
+    }
+    
+    void updatePrompt() {
+        if (!renderer_) return;
+        if (inputMode_ == InputMode::Query) {
+            renderer_->setPromptText("Запрос: " + inputText_);
+        } else if (inputMode_ == InputMode::Search) {
+            renderer_->setPromptText("Поиск: " + inputText_ + "   [" + std::to_string(searchHits_.size()) + "]");
+        } else {
+            renderer_->clearPromptText();
+        }
+    }
+    
+    void handleInputText(char32_t code) {
+        if (skipInputChar_ != 0) {
+            char32_t skipped = skipInputChar_;
+            skipInputChar_ = 0;
+            if (code == skipped || (skipped == U'q' && code == U'Q')) return;
+        }
+        // Управляющие символы (Enter, Backspace, Tab) обрабатываются как клавиши
+        if (code < 0x20 || code == 0x7F) return;
+        
+        // UTF-8, чтобы можно было вводить кириллические имена и метки
+        if (code < 0x80) {
+            inputText_ += static_cast<char>(code);
+        } else if (code < 0x800) {
+            inputText_ += static_cast<char>(0xC0 | (code >> 6));
+            inputText_ += static_cast<char>(0x80 | (code & 0x3F));
+        } else if (code < 0x10000) {
+            inputText_ += static_cast<char>(0xE0 | (code >> 12));
+            inputText_ += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            inputText_ += static_cast<char>(0x80 | (code & 0x3F));
+        } else {
+            inputText_ += static_cast<char>(0xF0 | (code >> 18));
+            inputText_ += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+            inputText_ += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            inputText_ += static_cast<char>(0x80 | (code & 0x3F));
+        }
+        if (inputMode_ == InputMode::Search) searchVertices(inputText_);
+        updatePrompt();
+    }
+    
+    void handleInputKey(sf::Keyboard::Key key) {
+        InputMode mode = inputMode_;
+        switch (key) {
+            case sf::Keyboard::Key::Enter:
+                inputMode_ = InputMode::None;
+                updatePrompt();
+                if (mode == InputMode::Query) {
+                    runQuery(inputText_);
+                } else {
+                    searchCursor_ = 0;
+                    printSearchHits();
+                    focusSearchHit();
+                }
+                break;
+            case sf::Keyboard::Key::Backspace:
+                // Удалить последний символ UTF-8 целиком
+                while (!inputText_.empty() && (static_cast<unsigned char>(inputText_.back()) & 0xC0) == 0x80) {
+                    inputText_.pop_back();
+                }
+                if (!inputText_.empty()) inputText_.pop_back();
+                if (mode == InputMode::Search) searchVertices(inputText_);
+                updatePrompt();
+                break;
+            case sf::Keyboard::Key::Tab:
+                if (mode == InputMode::Search) focusNextSearchHit();
+                break;
+            case sf::Keyboard::Key::Escape:
+                inputMode_ = InputMode::None;
+                updatePrompt();
+                std::cout << (mode == InputMode::Query ? "Запрос отменён" : "Поиск отменён") << std::endl;
+                break;
+            default:
+                break;
+        }
+    }
+    
+    // Поиск выполняется на каждое нажатие: найденные вершины обводятся сразу
+    void searchVertices(const std::string& text) {
+        searchHits_.clear();
+        searchCursor_ = 0;
+        auto index = searchIndex();
+        if (index && !text.empty()) searchHits_ = index->search(text, kSearchLimit);
+        
+        std::vector<int> ids;
+        for (const auto& hit : searchHits_) ids.push_back(hit.id);
+        if (renderer_) renderer_->setHighlightedVertices(ids);
+    }
+    
+    void printSearchHits() const {
+        if (searchHits_.empty()) {
+            std::cout << "Ничего не найдено: " << inputText_ << std::endl;
+            return;
+        }
+        std::cout << "Найдено " << searchHits_.size() << " по запросу \"" << inputText_ << "\":" << std::endl;
+        // Только чтение: константный доступ не копирует куски графа
+        const Graph& view = *graph_;
+        for (size_t i = 0; i < searchHits_.size() && i < 5; ++i) {
+            const Vertex* vertex = view.getVertex(searchHits_[i].id);
+            std::cout << "  " << (i + 1) << ". вершина " << searchHits_[i].id;
+            if (vertex && !vertex->label.empty()) std::cout << " (" << vertex->label << ")";
+            if (searchHits_[i].score < 1.0) std::cout << ", сходство " << searchHits_[i].score;
+            std::cout << std::endl;
+        }
+    }
+    
+    // Приблизить текущий результат и сделать его начальной вершиной
+    void focusSearchHit() {
+        if (searchCursor_ >= searchHits_.size() || !graph_) return;
+        int id = searchHits_[searchCursor_].id;
+        const Graph& view = *graph_;
+        const Vertex* vertex = view.getVertex(id);
+        if (!vertex) return;
+        if (renderer_) {
+            renderer_->focusOn(sf::Vector2f(static_cast<float>(vertex->x), static_cast<float>(vertex->y)), kSearchZoom);
+        }
+        selectedStartVertex_ = id;
+        selectedEndVertex_ = -1;
+        std::cout << "Выбрана начальная вершина: " << id << std::endl;
+    }
+    
+    void focusNextSearchHit() {
+        if (searchHits_.empty()) return;
+        searchCursor_ = (searchCursor_ + 1) % searchHits_.size();
+        focusSearchHit();
+    }
+    
+    void runQuery(const std::string& text) {
+        std::cout << "Запрос: " << text << std::endl;
+        if (!queryEngine_) {
+            std::cout << "Индекс связей ещё строится" << std::endl;
+            return;
+        }
+        std::string error;
+        auto pattern = QueryEngine::parse(text, &error);
+        if (!pattern) {
+            std::cout << "Ошибка в запросе: " << error << std::endl;
+            return;
+        }
+        
+        auto begin = std::chrono::steady_clock::now();
+        QueryResult result = queryEngine_->evaluate(*pattern, kQueryPathLimit);
+        auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin);
+        
+        const auto& answers = result.bindings.back();
+        std::cout << "Ответов: " << answers.size() << ", путей: " << result.paths.size()
+                  << (result.truncated ? "+" : "") << " (" << elapsed.count() << " мс)" << std::endl;
+        const Graph& view = *graph_;
+        for (size_t i = 0; i < result.paths.size() && i < kQueryPrintedPaths; ++i) {
+            std::cout << "  ";
+            for (size_t j = 0; j < result.paths[i].size(); ++j) {
+                const Vertex* vertex = view.getVertex(result.paths[i][j]);
+                std::cout << (j > 0 ? " -> " : "") << result.paths[i][j];
+                if (vertex && !vertex->label.empty()) std::cout << " (" << vertex->label << ")";
+            }
+            std::cout << std::endl;
+        }
+        
+        // Цвет - позиция в шаблоне, ответы (последний узел) обведены,
+        // первый найденный путь подсвечен как путь алгоритма
+        algorithmState_.reset();
+        if (!result.paths.empty()) algorithmState_.path = result.paths.front();
+        if (renderer_) {
+            std::unordered_map<int, sf::Color> colors;
+            for (size_t i = 0; i < result.bindings.size(); ++i) {
+                for (int id : result.bindings[i]) colors[id] = GraphRenderer::categoricalColor(static_cast<int>(i));
+            }
+            renderer_->setVertexColors(std::move(colors));
+            renderer_->setHighlightedVertices(answers);
+        }
+    }
+    
+    // Ограничить отрисовку и макет подграфом (nullptr - весь граф)
+    void showSubgraph(std::shared_ptr<const SubgraphView> view) {
+        if (view) {
+            if (renderer_) renderer_->setSubgraph(view);
+            layout_.setSubgraph(view);
+        } else {
+            if (renderer_) renderer_->clearSubgraph();
+            layout_.clearSubgraph();
+            std::cout << "Показан весь граф" << std::endl;
+        }
+        applyLayout(currentLayout_);
+    }
+    
+    // Подписаться на изменения нового графа
+    void watchGraph() {
+        if (!graph_) return;
+        dynamics_ = IncrementalAnalysis::build(*graph_);
+        graph_->addChangeListener([this](const std::vector<GraphChange>& changes) { onGraphChanged(changes); });
+    }
+    
+    void applyDeltaFile() {
+        if (!graph_) return;
+        if (isAlgorithmRunning_) {
+            std::cout << "Дождитесь завершения алгоритма" << std::endl;
+            return;
+        }
+        std::string filename = (currentGraphFile_.empty() ? "graph" : currentGraphFile_) + ".delta";
+        auto delta = GraphLoader::loadDelta(filename);
+        if (!delta) return;
+        if (delta->empty()) {
+            std::cout << "Пакет изменений " << filename << " пуст" << std::endl;
+            return;
+        }
+        journal_.begin(*graph_);
+        graph_->applyDelta(*delta);
+        journal_.commit(*graph_);
+    }
+    
+    // Компоненты, степени и макет обновляются по изменениям; снимок графа
+    // и индексы над ним отбрасываются и строятся заново после серии правок
+    void onGraphChanged(const std::vector<GraphChange>& changes) {
+        if (restoringJournal_) return;
+        journal_.record(*graph_, changes);
+        
+        // При отмене и повторе координаты берутся из журнала
+        auto begin = std::chrono::steady_clock::now();
+        auto touched = dynamics_.apply(*graph_, changes);
+        if (!journal_.replaying()) layout_.relaxAround(*graph_, touched, 1200.0, 800.0);
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+        
+        std::cout << "Изменений: " << changes.size() << ", затронуто вершин: " << touched.size()
+                  << "; компонент: " << dynamics_.componentCount()
+                  << " (наибольшая " << dynamics_.largestComponentSize() << ")"
+                  << ", макс. степень: " << dynamics_.maxDegree()
+                  << " (" << ms << " мс)" << std::endl;
+        
+        bool verticesChanged = std::any_of(changes.begin(), changes.end(), [](const GraphChange& change) {
+            return change.kind == GraphChange::Kind::VertexAdded || change.kind == GraphChange::Kind::VertexRemoved;
+        });
+        if (verticesChanged) graph_->setSearchIndex(nullptr);
+        if (!graph_->hasVertex(selectedStartVertex_)) selectedStartVertex_ = -1;
+        if (!graph_->hasVertex(selectedEndVertex_)) selectedEndVertex_ = -1;
+        algorithmState_.reset();
+        discardPrecomputations();
+        snapshotPending_ = true;
+        indicesPending_ = true;
+        lastEdit_ = std::chrono::steady_clock::now();
+    }
+    
+    std::string journalFile() const {
+        return currentGraphFile_.empty() ? "" : currentGraphFile_ + ".journal";
+    }
+    
+    // Новый журнал для загруженного графа; сохранённый журнал того же графа
+    // применяется до прежней версии, и тогда макет не пересчитывается
+    void startJournal() {
+        uint64_t fingerprint = graphSnapshot_->fingerprint();
+        sessionResumed_ = false;
+        std::string filename = journalFile();
+        if (!filename.empty()) {
+            auto begin = std::chrono::steady_clock::now();
+            restoringJournal_ = true;
+            auto loaded = Journal::load(filename, *graph_, fingerprint);
+            restoringJournal_ = false;
+            if (loaded) {
+                journal_ = std::move(*loaded);
+                sessionResumed_ = true;
+                dynamics_ = IncrementalAnalysis::build(*graph_);
+                preparePrecomputations();
+                double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+                std::cout << "Сеанс восстановлен из " << filename << ": версия " << journal_.version()
+                          << " из " << journal_.size() << " (" << ms << " мс)" << std::endl;
+                return;
+            }
+        }
+        journal_ = Journal(*graph_, fingerprint);
+    }
+    
+    void saveJournal() {
+        std::string filename = journalFile();
+        if (filename.empty() || journal_.size() == 0) return;
+        if (journal_.save(filename)) {
+            std::cout << "Журнал операций сохранён в " << filename << " (" << journal_.size() << " записей, "
+                      << journal_.bytes() << " байт)" << std::endl;
+        } else {
+            std::cerr << "Не удалось сохранить журнал в " << filename << std::endl;
+        }
+    }
+    
+    void stepJournal(bool forward) {
+        if (!graph_) return;
+        if (isAlgorithmRunning_) {
+            std::cout << "Дождитесь завершения алгоритма" << std::endl;
+            return;
+        }
+        bool done = forward ? journal_.redo(*graph_) : journal_.undo(*graph_);
+        if (!done) {
+            std::cout << (forward ? "Нечего повторять" : "Нечего отменять") << std::endl;
+            return;
+        }
+        std::cout << (forward ? "Повтор" : "Отмена") << ": версия " << journal_.version()
+                  << " из " << journal_.size() << std::endl;
+    }
+    
+    // Снимок и индексы для нового графа - сразу
+    void preparePrecomputations() {
+        if (!graph_) return;
+        discardPrecomputations();
+        snapshotPending_ = true;
+        buildPrecomputations();
+    }
+    
+    // Результаты по прежней версии графа сбрасываются, её задачи прерываются
+    // (флаг проверяется между этапами) и доживают в retired_
+    void discardPrecomputations() {
+        oracle_.reset();
+        hierarchy_.reset();
+        queryEngine_.reset();
+        retire(oracleFuture_);
+        retire(hierarchyFuture_);
+        retire(queryEngineFuture_);
+        retire(overlayFuture_);
+        if (precomputeStale_) precomputeStale_->store(true);
+        precomputeStale_ = std::make_shared<std::atomic<bool>>(false);
+        oracleSource_.reset();
+        overlaySource_.reset();
+        searchHits_.clear();
+        coreNumbers_.reset();
+        coreLevel_ = 0;
+        egoHops_ = 0;
+        egoCenter_ = -1;
+        if (renderer_) renderer_->clearSubgraph();
+        layout_.clearSubgraph();
+    }
+    
+    // Снимок CSR текущей версии графа; после правок строится при первом
+    // обращении, а не на каждую правку
+    const std::shared_ptr<const CSRGraph>& currentSnapshot() {
+        if (graph_ && (snapshotPending_ || !graphSnapshot_)) {
+            graphSnapshot_ = std::make_shared<const CSRGraph>(CSRGraph::fromGraph(*graph_));
+            reverseSnapshot_ = graphSnapshot_->directed
+                ? std::make_shared<const CSRGraph>(graphSnapshot_->transposed()) : graphSnapshot_;
+            snapshotPending_ = false;
+        }
+        return graphSnapshot_;
+    }
+    
+    // Загрузчики строят поисковый индекс сами, тестовый граф и правки - здесь
+    std::shared_ptr<const SearchIndex> searchIndex() {
+        if (!graph_) return nullptr;
+        if (!graph_->getSearchIndex()) {
+            graph_->setSearchIndex(std::make_shared<const SearchIndex>(SearchIndex::build(*graph_)));
+        }
+        return graph_->getSearchIndex();
+    }
+    
+    // Фоновое построение индексов по текущему снимку
+    void buildPrecomputations() {
+        indicesPending_ = false;
+        auto csr = currentSnapshot();
+        searchIndex();
+        auto stale = precomputeStale_;
+        
+        hierarchyFuture_ = std::async(std::launch::async, [csr, stale]() {
+            return std::make_shared<const ContractionHierarchy>(ContractionHierarchy::build(*csr, stale.get()));
+        });
+        
+        queryEngineFuture_ = std::async(std::launch::async, [graph = graph_->snapshot(), stale]() {
+            return std::make_shared<const QueryEngine>(QueryEngine::build(*graph, stale.get()));
+        });
+        
+        std::string oracleFile = currentGraphFile_.empty() ? "" : currentGraphFile_ + ".oracle";
+        if (!oracleFile.empty()) {
+            if (auto loaded = DistanceOracle::load(oracleFile, *csr)) {
+                oracle_ = std::make_shared<const DistanceOracle>(std::move(*loaded));
+                std::cout << "Оракул расстояний загружен из " << oracleFile << std::endl;
+                return;
+            }
+        }
+        
+        oracleSource_ = csr;
+        oracleFuture_ = std::async(std::launch::async, [this, csr, oracleFile, stale]() {
+            auto oracle = std::make_shared<const DistanceOracle>(
+                DistanceOracle::build(*csr, 16, LandmarkStrategy::FarthestPoint, workers_, stale.get()));
+            // Оракул устаревшего снимка не сохраняется; под блокировкой задача,
+            // закончившая позже, не перезапишет файл более новой
+            std::lock_guard<std::mutex> lock(oracleFileMutex_);
+            if (!oracleFile.empty() && !stale->load() && !oracle->save(oracleFile)) {
+                std::cerr << "Не удалось сохранить оракул в " << oracleFile << std::endl;
+            }
+            return oracle;
+        });
+    }
+    
     void pauseResumeAlgorithm() {
         if (isAlgorithmRunning_) {
             algorithmState_.isPaused = !algorithmState_.isPaused;
@@ -346,10 +1296,22 @@ private:
         isAlgorithmRunning_ = false;
         selectedStartVertex_ = -1;
         selectedEndVertex_ = -1;
+        if (renderer_) {
+            renderer_->clearVertexColors();
+            renderer_->clearVertexScales();
+            renderer_->clearHighlightedVertices();
+        }
+        layout_.clearClusterHints();
         std::cout << "Алгоритм сброшен" << std::endl;
     }
     
     void update() {
+        std::erase_if(retired_, [](const auto& ready) { return ready(); });
+        
+        if (indicesPending_ && std::chrono::steady_clock::now() - lastEdit_ >= kRebuildDelay) {
+            buildPrecomputations();
+        }
+        
         // Проверить завершение алгоритма
         if (isAlgorithmRunning_ && algorithmFuture_.valid()) {
             auto status = algorithmFuture_.wait_for(std::chrono::milliseconds(0));
@@ -360,6 +1322,44 @@ private:
             }
         }
         
+        if (oracleFuture_.valid()
+            && oracleFuture_.wait_for(std::chrono::milliseconds(0)) == std::future_status::ready) {
+            auto oracle = oracleFuture_.get();
+            if (oracleSource_ == graphSnapshot_) {
+                oracle_ = std::move(oracle);
+                std::cout << "Оракул расстояний готов: " << oracle_->landmarks().size() << " ориентиров" << std::endl;
+            }
+        }
+        
+        if (overlayFuture_.valid()
+            && overlayFuture_.wait_for(std::chrono::milliseconds(0)) == std::future_status::ready) {
+            auto overlay = overlayFuture_.get();
+            // Раскраска по прежнему снимку отбрасывается: индексы вершин уже не те
+            if (overlaySource_ == graphSnapshot_) {
+                if (renderer_) {
+                    renderer_->setVertexColors(std::move(overlay.colors));
+                    renderer_->setVertexScales(std::move(overlay.scales));
+                    renderer_->setHighlightedVertices(overlay.highlighted);
+                }
+                if (!overlay.clusters.empty()) {
+                    layout_.setClusterHints(std::move(overlay.clusters));
+                    if (currentLayout_ == LayoutType::ForceDirected) applyLayout(currentLayout_);
+                }
+            }
+        }
+        
+        if (hierarchyFuture_.valid()
+            && hierarchyFuture_.wait_for(std::chrono::milliseconds(0)) == std::future_status::ready) {
+            hierarchy_ = hierarchyFuture_.get();
+            std::cout << "Иерархия сжатия готова: " << hierarchy_->shortcutCount() << " шорткатов" << std::endl;
+        }
+        
+        if (queryEngineFuture_.valid()
+            && queryEngineFuture_.wait_for(std::chrono::milliseconds(0)) == std::future_status::ready) {
+            queryEngine_ = queryEngineFuture_.get();
+            std::cout << "Индекс связей готов: " << queryEngine_->relationCounts().size() << " типов связей" << std::endl;
+        }
+        
         // Force directed layout обновляется только при изменении графа или при явном запросе
         // Убрано постоянное обновление для стабильности визуализации
         // Если нужна анимация, можно добавить флаг и обновлять с ограничением частоты
@@ -419,7 +1419,9 @@ private:
     void applyLayout(LayoutType type) {
         if (!graph_) return;
         currentLayout_ = type;
+        journal_.begin(*graph_);
         layout_.applyLayout(*graph_, type, 1200.0, 800.0);
+        journal_.commit(*graph_);
     }
     
     void loadGraph() {
@@ -430,22 +1432,15 @@ private:
     }
     
     void loadGraphFromFile(const std::string& filename) {
-        std::unique_ptr<Graph> newGraph;
-        if (filename.find(".csv") != std::string::npos) {
-            newGraph = GraphLoader::loadFromCSV(filename, false);
-        } else if (filename.find("kg.json") != std::string::npos || filename.find("knowledge") != std::string::npos) {
-            // Загрузка графа знаний
-            newGraph = GraphLoader::loadFromKnowledgeGraph(filename, true);
-        } else if (filename.find(".json") != std::string::npos) {
-            newGraph = GraphLoader::loadFromJSON(filename, false);
-        } else {
-            std::cout << "Неподдерживаемый формат файла: " << filename << std::endl;
-            return;
-        }
+        std::unique_ptr<Graph> newGraph = GraphLoader::loadFromFile(filename);
         
         if (newGraph) {
             graph_ = std::move(newGraph);
-            applyLayout(currentLayout_);
+            currentGraphFile_ = filename;
+            watchGraph();
+            preparePrecomputations();
+            startJournal();
+            if (!sessionResumed_) applyLayout(currentLayout_);
             std::cout << "Граф загружен из " << filename << std::endl;
             std::cout << "Вершин: " << graph_->getVertexCount() 
                      << ", Рёбер: " << graph_->getEdgeCount() << std::endl;
@@ -476,7 +1471,7 @@ private:
         std::cout.flush();
         
         try {
-            graph_ = std::make_unique<Graph>(false);
+            graph_ = std::make_shared<Graph>(false);
             std::cout << "[DEBUG] Graph создан" << std::endl;
             std::cout.flush();
             
@@ -515,6 +1510,33 @@ private:
 };
 
 int main(int argc, char* argv[]) {
+    // Headless-вывод характеристик графа: --stats <файл>
+    if (argc > 2 && std::string(argv[1]) == "--stats") {
+        return Benchmark::statisticsReport(argv[2], std::cout);
+    }
+    
+    // Headless-запрос по типам связей: --query <файл> "<шаблон>"
+    if (argc > 3 && std::string(argv[1]) == "--query") {
+        return Benchmark::queryReport(argv[2], argv[3], std::cout);
+    }
+    
+    // Headless-поиск вершин по имени: --search <файл> "<текст>"
+    if (argc > 3 && std::string(argv[1]) == "--search") {
+        return Benchmark::searchReport(argv[2], argv[3], std::cout);
+    }
+    
+    // Headless-запись графа: --export <файл> <выходной файл .csv/.json/.graphml/.dot>
+    if (argc > 3 && std::string(argv[1]) == "--export") {
+        return Benchmark::exportReport(argv[2], argv[3], std::cout);
+    }
+    
+    // Headless-режим замеров: --bench <файл> [число запросов] [раздел]
+    if (argc > 2 && std::string(argv[1]) == "--bench") {
+        size_t queries = argc > 3 ? std::stoul(argv[3]) : 100;
+        std::string section = argc > 4 ? argv[4] : "";
+        return Benchmark::run(argv[2], queries, std::cout, section);
+    }
+    
     std::string graphFile = "";
     if (argc > 1) {
         graphFile = argv[1];
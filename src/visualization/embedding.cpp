@@ -0,0 +1,484 @@
+#include "visualization/embedding.hpp"
+#include "core/parallel.hpp"
+#include <algorithm>
+#include <numeric>
+#include <optional>
+#include <random>
+#include <cmath>
+#include <cstdint>
+
+namespace graph {
+
+namespace {
+
+// Суммы считаются по блокам постоянного размера и складываются по порядку
+// блоков, поэтому результат не зависит от числа потоков
+constexpr size_t kBlock = 4096;
+
+size_t blockCount(size_t count) {
+    return (count + kBlock - 1) / kBlock;
+}
+
+// body(номер блока, begin, end) для блоков [0, count) на пуле или в текущем потоке
+template<typename F>
+void forBlocks(ThreadPool* pool, size_t count, F&& body) {
+    size_t blocks = blockCount(count);
+    auto run = [&](size_t, size_t begin, size_t end) {
+        for (size_t b = begin; b < end; ++b) {
+            body(b, b * kBlock, std::min(count, (b + 1) * kBlock));
+        }
+    };
+    if (pool && blocks > 1) {
+        pool->parallelFor(blocks, run);
+    } else {
+        run(0, 0, blocks);
+    }
+}
+
+double dot(ThreadPool* pool, const std::vector<double>& a, const std::vector<double>& b) {
+    std::vector<double> partial(blockCount(a.size()), 0.0);
+    forBlocks(pool, a.size(), [&](size_t block, size_t begin, size_t end) {
+        double sum = 0.0;
+        for (size_t i = begin; i < end; ++i) sum += a[i] * b[i];
+        partial[block] = sum;
+    });
+    return std::accumulate(partial.begin(), partial.end(), 0.0);
+}
+
+// Небольшой детерминированный сдвиг: вершины с одинаковыми расстояниями
+// до опорных не совпадают в начальном положении
+double jitter(int v, int axis) {
+    uint64_t h = (static_cast<uint64_t>(v) << 1 | static_cast<uint64_t>(axis)) * 0x9e3779b97f4a7c15ull;
+    h ^= h >> 29;
+    return static_cast<double>(h >> 11) / static_cast<double>(uint64_t{1} << 53) - 0.5;
+}
+
+// Собственные значения и векторы симметричной трёхдиагональной матрицы
+// (неявный QL): diagonal - диагональ, на выходе значения; offDiagonal[i] -
+// элемент (i, i + 1). Векторы - столбцы vectors
+void tridiagonalEigen(std::vector<double>& diagonal, std::vector<double> offDiagonal,
+                      std::vector<std::vector<double>>& vectors) {
+    int n = static_cast<int>(diagonal.size());
+    offDiagonal.resize(n, 0.0);
+    vectors.assign(n, std::vector<double>(n, 0.0));
+    for (int i = 0; i < n; ++i) vectors[i][i] = 1.0;
+
+    for (int l = 0; l < n; ++l) {
+        for (int iteration = 0; iteration < 60; ++iteration) {
+            int m = l;
+            for (; m < n - 1; ++m) {
+                double scale = std::abs(diagonal[m]) + std::abs(diagonal[m + 1]);
+                if (std::abs(offDiagonal[m]) <= 1e-15 * scale) break;
+            }
+            if (m == l) break;
+            double g = (diagonal[l + 1] - diagonal[l]) / (2.0 * offDiagonal[l]);
+            double r = std::hypot(g, 1.0);
+            g = diagonal[m] - diagonal[l] + offDiagonal[l] / (g + std::copysign(r, g));
+            double s = 1.0, c = 1.0, p = 0.0;
+            int i = m - 1;
+            for (; i >= l; --i) {
+                double f = s * offDiagonal[i];
+                double b = c * offDiagonal[i];
+                r = std::hypot(f, g);
+                offDiagonal[i + 1] = r;
+                if (r == 0.0) {
+                    diagonal[i + 1] -= p;
+                    offDiagonal[m] = 0.0;
+                    break;
+                }
+                s = f / r;
+                c = g / r;
+                g = diagonal[i + 1] - p;
+                r = (diagonal[i] - g) * s + 2.0 * c * b;
+                p = s * r;
+                diagonal[i + 1] = g + p;
+                g = c * r - b;
+                for (int k = 0; k < n; ++k) {
+                    f = vectors[k][i + 1];
+                    vectors[k][i + 1] = s * vectors[k][i] + c * f;
+                    vectors[k][i] = c * vectors[k][i] - s * f;
+                }
+            }
+            if (r == 0.0 && i >= l) continue;
+            diagonal[l] -= p;
+            offDiagonal[l] = g;
+            offDiagonal[m] = 0.0;
+        }
+    }
+}
+
+} // namespace
+
+StressModel StressModel::build(const CSRGraph& g, int pivots, size_t numThreads) {
+    StressModel model;
+    model.numThreads_ = std::max<size_t>(1, numThreads);
+    CSRGraph simple = g.simplified();
+    model.offsets_ = std::move(simple.offsets);
+    model.targets_ = std::move(simple.targets);
+    if (model.offsets_.empty()) model.offsets_.push_back(0);
+    int n = model.size();
+    int k = std::min(pivots, n);
+    for (int i = 0; i < k; ++i) {
+        model.pivots_.push_back(static_cast<int>((2 * static_cast<int64_t>(i) + 1) * n / (2 * k)));
+    }
+
+    std::optional<ThreadPool> pool;
+    if (model.numThreads_ > 1 && k > 1) pool.emplace(model.numThreads_);
+    auto forPivots = [&](auto&& body) {
+        if (pool) pool->parallelFor(k, body); else body(0, 0, static_cast<size_t>(k));
+    };
+
+    model.distance_.assign(static_cast<size_t>(k) * n, -1);
+    forPivots([&](size_t, size_t begin, size_t end) {
+        std::vector<int> queue;
+        for (size_t p = begin; p < end; ++p) {
+            int* row = model.distance_.data() + p * n;
+            row[model.pivots_[p]] = 0;
+            queue.assign(1, model.pivots_[p]);
+            for (size_t head = 0; head < queue.size(); ++head) {
+                int v = queue[head];
+                for (size_t i = model.offsets_[v]; i < model.offsets_[v + 1]; ++i) {
+                    int u = model.targets_[i];
+                    if (row[u] == -1) {
+                        row[u] = row[v] + 1;
+                        queue.push_back(u);
+                    }
+                }
+            }
+        }
+    });
+
+    // Область опорной - вершины, для которых она ближайшая; у каждой
+    // опорной - отсортированные расстояния до вершин её области
+    std::vector<std::vector<int>> region(k);
+    for (int v = 0; v < n; ++v) {
+        int nearest = -1;
+        for (int p = 0; p < k; ++p) {
+            int d = model.distance(p, v);
+            if (d >= 0 && (nearest < 0 || d < model.distance(nearest, v))) nearest = p;
+        }
+        if (nearest >= 0) region[nearest].push_back(model.distance(nearest, v));
+    }
+    model.weight_.assign(static_cast<size_t>(k) * n, 0.0);
+    forPivots([&](size_t, size_t begin, size_t end) {
+        for (size_t p = begin; p < end; ++p) {
+            std::sort(region[p].begin(), region[p].end());
+            for (int v = 0; v < n; ++v) {
+                int d = model.distance(p, v);
+                if (d <= 0) continue;
+                auto closer = std::upper_bound(region[p].begin(), region[p].end(), d / 2) - region[p].begin();
+                model.weight_[p * n + v] = static_cast<double>(closer) / (static_cast<double>(d) * d);
+            }
+        }
+    });
+    return model;
+}
+
+std::pair<double, double> StressModel::fit(const Coordinates& c) const {
+    int n = size();
+    size_t k = pivots_.size();
+    struct Sums {
+        double a = 0.0, b = 0.0, count = 0.0;
+    };
+    std::vector<Sums> partial(blockCount(n));
+    std::optional<ThreadPool> pool;
+    if (numThreads_ > 1 && partial.size() > 1) pool.emplace(numThreads_);
+    forBlocks(pool ? &*pool : nullptr, n, [&](size_t block, size_t begin, size_t end) {
+        Sums sums;
+        for (size_t v = begin; v < end; ++v) {
+            for (size_t p = 0; p < k; ++p) {
+                int d = distance(p, static_cast<int>(v));
+                if (d <= 0) continue;
+                int u = pivots_[p];
+                double ratio = std::hypot(c.x[v] - c.x[u], c.y[v] - c.y[u]) / d;
+                sums.a += ratio;
+                sums.b += ratio * ratio;
+                sums.count += 1.0;
+            }
+        }
+        partial[block] = sums;
+    });
+
+    // Сумма (s * e / d - 1)^2 по парам минимальна при s = a / b и равна count - a^2 / b
+    Sums total;
+    for (const auto& sums : partial) {
+        total.a += sums.a;
+        total.b += sums.b;
+        total.count += sums.count;
+    }
+    if (total.count == 0.0 || total.b == 0.0) return {1.0, total.count == 0.0 ? 0.0 : 1.0};
+    double scale = total.a / total.b;
+    return {scale, 1.0 - total.a * total.a / (total.b * total.count)};
+}
+
+double StressModel::stress(const Coordinates& c) const {
+    return fit(c).second;
+}
+
+Coordinates StressModel::pivotMDS() const {
+    int n = size();
+    int k = static_cast<int>(pivots_.size());
+    Coordinates c;
+    c.x.assign(n, 0.0);
+    c.y.assign(n, 0.0);
+    if (k < 3) {
+        for (int v = 0; v < n; ++v) c.x[v] = v;
+        return c;
+    }
+    std::optional<ThreadPool> pool;
+    if (numThreads_ > 1 && n > static_cast<int>(kBlock)) pool.emplace(numThreads_);
+    ThreadPool* workers = pool ? &*pool : nullptr;
+
+    // Квадраты расстояний n x k; недостижимые - на шаг дальше самой далёкой
+    int farthest = *std::max_element(distance_.begin(), distance_.end());
+    std::vector<double> matrix(static_cast<size_t>(n) * k);
+    std::vector<double> rowMean(n, 0.0), columnMean(k, 0.0);
+    for (int v = 0; v < n; ++v) {
+        for (int p = 0; p < k; ++p) {
+            int d = distance(p, v);
+            double value = d < 0 ? farthest + 1.0 : static_cast<double>(d);
+            value *= value;
+            matrix[static_cast<size_t>(v) * k + p] = value;
+            rowMean[v] += value / k;
+            columnMean[p] += value / n;
+        }
+    }
+    double grandMean = std::accumulate(columnMean.begin(), columnMean.end(), 0.0) / k;
+    for (int v = 0; v < n; ++v) {
+        for (int p = 0; p < k; ++p) {
+            double& value = matrix[static_cast<size_t>(v) * k + p];
+            value = -0.5 * (value - rowMean[v] - columnMean[p] + grandMean);
+        }
+    }
+
+    // B = C^T C (k x k) по блокам строк
+    std::vector<double> partial(blockCount(n) * k * k, 0.0);
+    forBlocks(workers, n, [&](size_t block, size_t begin, size_t end) {
+        double* out = partial.data() + block * k * k;
+        for (size_t v = begin; v < end; ++v) {
+            const double* row = matrix.data() + v * k;
+            for (int i = 0; i < k; ++i) {
+                for (int j = 0; j < k; ++j) out[i * k + j] += row[i] * row[j];
+            }
+        }
+    });
+    std::vector<double> b(k * k, 0.0);
+    for (size_t block = 0; block < blockCount(n); ++block) {
+        for (int i = 0; i < k * k; ++i) b[i] += partial[block * k * k + i];
+    }
+
+    // Две главные компоненты степенным методом, вторая ортогональна первой
+    std::vector<std::vector<double>> components;
+    for (int index = 0; index < 2; ++index) {
+        std::vector<double> vec(k), next(k);
+        for (int i = 0; i < k; ++i) vec[i] = index == 0 ? 1.0 + i : (i % 2 == 0 ? 1.0 : -1.0);
+        for (int iteration = 0; iteration < 500; ++iteration) {
+            for (int i = 0; i < k; ++i) {
+                next[i] = 0.0;
+                for (int j = 0; j < k; ++j) next[i] += b[i * k + j] * vec[j];
+            }
+            for (const auto& previous : components) {
+                double projection = 0.0;
+                for (int i = 0; i < k; ++i) projection += next[i] * previous[i];
+                for (int i = 0; i < k; ++i) next[i] -= projection * previous[i];
+            }
+            double norm = 0.0;
+            for (double value : next) norm += value * value;
+            norm = std::sqrt(norm);
+            if (norm == 0.0) break;
+            double change = 0.0;
+            for (int i = 0; i < k; ++i) {
+                next[i] /= norm;
+                change += std::abs(next[i] - vec[i]);
+            }
+            vec.swap(next);
+            if (change < 1e-10) break;
+        }
+        components.push_back(vec);
+    }
+
+    forBlocks(workers, n, [&](size_t, size_t begin, size_t end) {
+        for (size_t v = begin; v < end; ++v) {
+            const double* row = matrix.data() + v * k;
+            for (int p = 0; p < k; ++p) {
+                c.x[v] += row[p] * components[0][p];
+                c.y[v] += row[p] * components[1][p];
+            }
+        }
+    });
+
+    double scale = fit(c).first;
+    for (int v = 0; v < n; ++v) {
+        c.x[v] = c.x[v] * scale + 0.05 * jitter(v, 0);
+        c.y[v] = c.y[v] * scale + 0.05 * jitter(v, 1);
+    }
+    return c;
+}
+
+int StressModel::majorize(Coordinates& c, int maxIterations, double tolerance) const {
+    int n = size();
+    size_t k = pivots_.size();
+    if (n == 0) return 0;
+    std::optional<ThreadPool> pool;
+    if (numThreads_ > 1 && n > static_cast<int>(kBlock)) pool.emplace(numThreads_);
+    ThreadPool* workers = pool ? &*pool : nullptr;
+
+    Coordinates next = c;
+    std::vector<double> partial(blockCount(n), 0.0);
+    double previous = 0.0;
+    for (int iteration = 0; iteration < maxIterations; ++iteration) {
+        forBlocks(workers, n, [&](size_t block, size_t begin, size_t end) {
+            double local = 0.0;
+            for (size_t v = begin; v < end; ++v) {
+                double sx = 0.0, sy = 0.0, sw = 0.0;
+                auto term = [&](int u, double d, double w) {
+                    double dx = c.x[v] - c.x[u];
+                    double dy = c.y[v] - c.y[u];
+                    double e = std::max(std::hypot(dx, dy), 1e-9);
+                    sx += w * (c.x[u] + d * dx / e);
+                    sy += w * (c.y[u] + d * dy / e);
+                    sw += w;
+                    local += w * (e - d) * (e - d);
+                };
+                for (size_t i = offsets_[v]; i < offsets_[v + 1]; ++i) {
+                    term(targets_[i], 1.0, 1.0);
+                }
+                for (size_t p = 0; p < k; ++p) {
+                    int d = distance(p, static_cast<int>(v));
+                    if (d > 0) term(pivots_[p], d, weight_[p * n + v]);
+                }
+                next.x[v] = sw > 0.0 ? sx / sw : c.x[v];
+                next.y[v] = sw > 0.0 ? sy / sw : c.y[v];
+            }
+            partial[block] = local;
+        });
+        c.x.swap(next.x);
+        c.y.swap(next.y);
+        double current = std::accumulate(partial.begin(), partial.end(), 0.0);
+        if (iteration > 0 && previous - current < tolerance * previous) return iteration + 1;
+        previous = current;
+    }
+    return maxIterations;
+}
+
+Coordinates SpectralEmbedding::compute(const CSRGraph& g, int steps, size_t numThreads) {
+    CSRGraph simple = g.simplified();
+    int n = simple.size();
+    Coordinates result;
+    result.x.assign(n, 0.0);
+    result.y.assign(n, 0.0);
+    if (n < 3) {
+        for (int v = 0; v < n; ++v) result.x[v] = v;
+        return result;
+    }
+    numThreads = std::max<size_t>(1, numThreads);
+    std::optional<ThreadPool> pool;
+    if (numThreads > 1 && n > static_cast<int>(kBlock)) pool.emplace(numThreads);
+    ThreadPool* workers = pool ? &*pool : nullptr;
+
+    // Постоянные на компонентах векторы - собственные с нулевым значением
+    std::vector<int> component(n, -1), queue;
+    std::vector<double> componentSize;
+    for (int root = 0; root < n; ++root) {
+        if (component[root] != -1) continue;
+        int id = static_cast<int>(componentSize.size());
+        component[root] = id;
+        queue.assign(1, root);
+        for (size_t head = 0; head < queue.size(); ++head) {
+            for (int u : simple.neighbors(queue[head])) {
+                if (component[u] == -1) {
+                    component[u] = id;
+                    queue.push_back(u);
+                }
+            }
+        }
+        componentSize.push_back(static_cast<double>(queue.size()));
+    }
+    std::vector<double> componentSum(componentSize.size());
+    auto deflate = [&](std::vector<double>& w) {
+        std::fill(componentSum.begin(), componentSum.end(), 0.0);
+        for (int v = 0; v < n; ++v) componentSum[component[v]] += w[v];
+        for (int v = 0; v < n; ++v) w[v] -= componentSum[component[v]] / componentSize[component[v]];
+    };
+
+    int maxDegree = 0;
+    for (int v = 0; v < n; ++v) maxDegree = std::max(maxDegree, simple.degree(v));
+    double shift = 2.0 * maxDegree;  // спектр L лежит в [0, 2 * maxDeg]
+    auto multiply = [&](const std::vector<double>& q, std::vector<double>& w) {
+        forBlocks(workers, n, [&](size_t, size_t begin, size_t end) {
+            for (size_t v = begin; v < end; ++v) {
+                double sum = (shift - simple.degree(static_cast<int>(v))) * q[v];
+                for (int u : simple.neighbors(static_cast<int>(v))) sum += q[u];
+                w[v] = sum;
+            }
+        });
+    };
+
+    std::vector<double> q(n), w(n);
+    std::mt19937 gen(1);
+    std::uniform_real_distribution<double> unit(-1.0, 1.0);
+    for (double& value : q) value = unit(gen);
+    deflate(q);
+    double norm = std::sqrt(dot(workers, q, q));
+    if (norm == 0.0) return result;
+    for (double& value : q) value /= norm;
+
+    int limit = std::min(steps, n - 1);
+    std::vector<std::vector<double>> basis;
+    std::vector<double> alpha, beta;
+    for (int j = 0; j < limit; ++j) {
+        basis.push_back(q);
+        multiply(q, w);
+        alpha.push_back(dot(workers, w, q));
+        deflate(w);
+
+        // Полная переортогонализация (классический Грам-Шмидт дважды):
+        // все проекции за один проход по блокам, затем вычитание
+        size_t count = basis.size();
+        std::vector<double> partial(blockCount(n) * count);
+        std::vector<double> projection(count);
+        for (int pass = 0; pass < 2; ++pass) {
+            forBlocks(workers, n, [&](size_t block, size_t begin, size_t end) {
+                for (size_t i = 0; i < count; ++i) {
+                    double sum = 0.0;
+                    for (size_t v = begin; v < end; ++v) sum += w[v] * basis[i][v];
+                    partial[block * count + i] = sum;
+                }
+            });
+            std::fill(projection.begin(), projection.end(), 0.0);
+            for (size_t block = 0; block < blockCount(n); ++block) {
+                for (size_t i = 0; i < count; ++i) projection[i] += partial[block * count + i];
+            }
+            forBlocks(workers, n, [&](size_t, size_t begin, size_t end) {
+                for (size_t v = begin; v < end; ++v) {
+                    for (size_t i = 0; i < count; ++i) w[v] -= projection[i] * basis[i][v];
+                }
+            });
+        }
+
+        double b = std::sqrt(dot(workers, w, w));
+        if (b < 1e-9 * shift || j + 1 == limit) break;
+        beta.push_back(b);
+        for (int v = 0; v < n; ++v) q[v] = w[v] / b;
+    }
+
+    std::vector<std::vector<double>> ritz;
+    std::vector<double> values = alpha;
+    tridiagonalEigen(values, beta, ritz);
+    std::vector<int> order(values.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&values](int a, int b) { return values[a] > values[b]; });
+    if (order.size() < 2) return result;
+
+    forBlocks(workers, n, [&](size_t, size_t begin, size_t end) {
+        for (size_t v = begin; v < end; ++v) {
+            for (size_t j = 0; j < basis.size(); ++j) {
+                result.x[v] += ritz[j][order[0]] * basis[j][v];
+                result.y[v] += ritz[j][order[1]] * basis[j][v];
+            }
+        }
+    });
+    return result;
+}
+
+} // namespace graph
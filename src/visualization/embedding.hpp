@@ -0,0 +1,76 @@
+#pragma once
+
+#include "core/csr.hpp"
+#include <vector>
+#include <utility>
+#include <cstddef>
+
+namespace graph {
+
+// Координаты по плотным индексам CSR, масштаб - в рёбрах (ребро ~ 1)
+struct Coordinates {
+    std::vector<double> x, y;
+};
+
+// Разреженная модель стресса (Ортманн, Климента, Брандес): вместо всех
+// пар вершин - рёбра и расстояния до k опорных вершин. Вес пары (v, p) -
+// число вершин области опорной p (ближайших к ней), лежащих от неё не
+// дальше d(v, p) / 2, делённое на d(v, p)^2: опорная стоит за свою область.
+// Расстояния - число рёбер без учёта направления и весов. Память - k * n
+class StressModel {
+public:
+    static constexpr int kDefaultPivots = 50;
+    static constexpr int kDefaultIterations = 100;
+
+    // Опорные - равномерно по плотной нумерации: после перенумерации RCM
+    // соседние индексы - соседние уровни BFS, и опорные расходятся по
+    // графу. BFS от опорных выполняются на пуле потоков
+    static StressModel build(const CSRGraph& g, int pivots = kDefaultPivots, size_t numThreads = 4);
+
+    // Pivot MDS (Брандес, Пих): двойное центрирование квадратов расстояний
+    // до опорных, две главные компоненты степенным методом по матрице k x k,
+    // затем масштаб с наименьшим стрессом
+    Coordinates pivotMDS() const;
+
+    // Majorization: вершины сдвигаются одновременно (по положениям прошлого
+    // шага), поэтому шаг делится между потоками. Останавливается, когда
+    // разреженный стресс меняется меньше чем на tolerance от себя.
+    // Возвращает число выполненных шагов
+    int majorize(Coordinates& c, int maxIterations = kDefaultIterations, double tolerance = 1e-3) const;
+
+    // Нормированный стресс по парам (опорная, вершина) при лучшем масштабе:
+    // сравним для макетов с разным масштабом; 0 - расстояния совпадают
+    double stress(const Coordinates& c) const;
+
+    int size() const { return static_cast<int>(offsets_.size()) - 1; }
+    const std::vector<int>& pivots() const { return pivots_; }
+
+private:
+    size_t numThreads_ = 1;
+    std::vector<size_t> offsets_;   // рёбра простого неориентированного графа
+    std::vector<int> targets_;
+    std::vector<int> pivots_;
+    std::vector<int> distance_;     // k x n, -1 - недостижима
+    std::vector<double> weight_;    // k x n, вес пары (вершина, опорная)
+
+    int distance(size_t p, int v) const { return distance_[p * size() + v]; }
+    
+    // Лучший масштаб координат и нормированный стресс при нём
+    std::pair<double, double> fit(const Coordinates& c) const;
+};
+
+// Спектральный макет: собственные векторы лапласиана L = D - A с двумя
+// наименьшими ненулевыми собственными значениями. Ланцош с полной
+// переортогонализацией ищет наибольшие значения матрицы 2*maxDeg*I - L;
+// постоянные на компонентах связности векторы (нулевые значения)
+// исключаются на каждом шаге. У несвязного графа векторы описывают
+// компоненты с наименьшими значениями (обычно крупные), остальные
+// собираются в центре
+class SpectralEmbedding {
+public:
+    static constexpr int kDefaultSteps = 60;
+
+    static Coordinates compute(const CSRGraph& g, int steps = kDefaultSteps, size_t numThreads = 4);
+};
+
+} // namespace graph
@@ -1,7 +1,16 @@
 #include "visualization/layout.hpp"
+#include "visualization/sugiyama.hpp"
+#include "visualization/embedding.hpp"
+#include "visualization/packing.hpp"
+#include "core/parallel.hpp"
 #include <algorithm>
 #include <cmath>
 #include <unordered_map>
+#include <cstdint>
+#include <numeric>
+#include <atomic>
+#include <bit>
+#include <iostream>
 #define _USE_MATH_DEFINES
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
@@ -9,6 +18,307 @@
 
 namespace graph {
 
+namespace {
+
+// Сила притяжения вершины к центру кластера относительно притяжения по ребру
+constexpr double kClusterPull = 0.3;
+
+// Ячейка сетки для отталкивания при локальном обновлении
+int64_t gridKey(int64_t cx, int64_t cy) {
+    return (cx << 32) ^ (cy & 0xffffffff);
+}
+
+int64_t gridCell(double x, double y, double size) {
+    return gridKey(static_cast<int64_t>(std::floor(x / size)), static_cast<int64_t>(std::floor(y / size)));
+}
+
+// Соседи без учёта направления
+std::vector<int> adjacentVertices(const Graph& g, int v) {
+    auto neighbors = g.getNeighbors(v);
+    if (g.isDirected()) {
+        auto incoming = g.getIncoming(v);
+        neighbors.insert(neighbors.end(), incoming.begin(), incoming.end());
+    }
+    return neighbors;
+}
+
+// Видимая часть снимка как отдельный CSR с плотной нумерацией подграфа
+CSRGraph visiblePart(const SubgraphView& view) {
+    const CSRGraph& parent = view.parent();
+    CSRGraph local;
+    local.directed = parent.directed;
+    local.offsets.push_back(0);
+    for (int v = 0; v < parent.size(); ++v) {
+        if (!view.containsIndex(v)) continue;
+        local.index[parent.ids[v]] = local.size();
+        local.ids.push_back(parent.ids[v]);
+        auto neighbors = parent.neighbors(v);
+        auto weights = parent.neighborWeights(v);
+        for (size_t i = 0; i < neighbors.size(); ++i) {
+            if (!view.containsIndex(neighbors[i])) continue;
+            local.targets.push_back(view.localIndex(neighbors[i]));
+            local.weights.push_back(weights[i]);
+        }
+        local.offsets.push_back(local.targets.size());
+    }
+    return local;
+}
+
+// Компонента крупнее этого раскладывается на всех потоках, а не в очереди мелких
+constexpr size_t kLargeComponent = 10000;
+
+// Зазор между упакованными компонентами (в длинах рёбер)
+constexpr double kComponentGap = 2.0;
+
+// Вписать координаты в окно с сохранением пропорций
+void fitToWindow(Graph& g, const CSRGraph& csr, const Coordinates& c, double width, double height) {
+    auto [minX, maxX] = std::minmax_element(c.x.begin(), c.x.end());
+    auto [minY, maxY] = std::minmax_element(c.y.begin(), c.y.end());
+    const double margin = 50.0;
+    double spanX = *maxX - *minX, spanY = *maxY - *minY;
+    double scale = std::min(spanX > 0.0 ? (width - 2.0 * margin) / spanX : 1.0,
+                            spanY > 0.0 ? (height - 2.0 * margin) / spanY : 1.0);
+    double centerX = (*minX + *maxX) / 2.0, centerY = (*minY + *maxY) / 2.0;
+    for (int v = 0; v < csr.size(); ++v) {
+        g.setVertexPosition(csr.ids[v], width / 2.0 + (c.x[v] - centerX) * scale,
+                            height / 2.0 + (c.y[v] - centerY) * scale);
+    }
+}
+
+// Перемешивание splitmix64
+uint64_t mix(uint64_t z) {
+    z += 0x9e3779b97f4a7c15ull;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+// Зерно компоненты (splitmix64 от зерна макета и наименьшего ID): не
+// зависит от порядка компонент и от того, какой поток её раскладывает
+uint64_t componentSeed(uint64_t seed, int id) {
+    return mix(seed + 0x9e3779b97f4a7c15ull * static_cast<uint64_t>(static_cast<uint32_t>(id)));
+}
+
+// Компоненты связности без учёта направления, вершины - по возрастанию
+// плотного индекса
+std::vector<std::vector<int>> weakComponents(const CSRGraph& g) {
+    CSRGraph simple = g.simplified();
+    int n = simple.size();
+    std::vector<char> seen(n, 0);
+    std::vector<std::vector<int>> components;
+    for (int root = 0; root < n; ++root) {
+        if (seen[root]) continue;
+        seen[root] = 1;
+        std::vector<int> members(1, root);
+        for (size_t head = 0; head < members.size(); ++head) {
+            for (int u : simple.neighbors(members[head])) {
+                if (!seen[u]) {
+                    seen[u] = 1;
+                    members.push_back(u);
+                }
+            }
+        }
+        std::sort(members.begin(), members.end());
+        components.push_back(std::move(members));
+    }
+    return components;
+}
+
+// Компонента как отдельный CSR; local - номер вершины внутри её компоненты
+CSRGraph componentGraph(const CSRGraph& g, const std::vector<int>& members, const std::vector<int>& local) {
+    CSRGraph c;
+    c.directed = g.directed;
+    c.offsets.push_back(0);
+    for (int v : members) {
+        c.index[g.ids[v]] = c.size();
+        c.ids.push_back(g.ids[v]);
+        auto neighbors = g.neighbors(v);
+        auto weights = g.neighborWeights(v);
+        for (size_t i = 0; i < neighbors.size(); ++i) {
+            c.targets.push_back(local[neighbors[i]]);
+            c.weights.push_back(weights[i]);
+        }
+        c.offsets.push_back(c.targets.size());
+    }
+    return c;
+}
+
+// Все макеты компонент - в длинах рёбер: идеальное ребро force-directed,
+// ребро стресса и шаг слоя Сугиямы равны 1, окружность - шаг 1 между вершинами
+
+Coordinates circularComponent(int n) {
+    Coordinates p;
+    double radius = std::max(0.5, n / (2.0 * M_PI));
+    for (int i = 0; i < n; ++i) {
+        double angle = 2.0 * M_PI * i / n;
+        p.x.push_back(radius * std::cos(angle));
+        p.y.push_back(radius * std::sin(angle));
+    }
+    return p;
+}
+
+Coordinates randomComponent(int n, std::mt19937_64& gen) {
+    std::uniform_real_distribution<double> coordinate(0.0, std::sqrt(static_cast<double>(n)));
+    Coordinates p;
+    for (int i = 0; i < n; ++i) {
+        p.x.push_back(coordinate(gen));
+        p.y.push_back(coordinate(gen));
+    }
+    return p;
+}
+
+// Фрухтерман-Рейнгольд в квадрате площади n: идеальное расстояние k = 1.
+// cluster - номер кластера вершины или -1; кластеры стартуют вокруг своих
+// центров по кругу и стягиваются к ним
+Coordinates forceDirectedComponent(const CSRGraph& c, int iterations, const std::vector<int>& cluster,
+                                   std::mt19937_64& gen) {
+    int n = c.size();
+    double side = std::sqrt(static_cast<double>(n));
+    int clusters = 0;
+    for (int k : cluster) clusters = std::max(clusters, k + 1);
+    
+    Coordinates p;
+    p.x.resize(n);
+    p.y.resize(n);
+    if (clusters == 0) {
+        std::uniform_real_distribution<double> coordinate(0.0, side);
+        for (int v = 0; v < n; ++v) {
+            p.x[v] = coordinate(gen);
+            p.y[v] = coordinate(gen);
+        }
+    } else {
+        double radius = side * 0.3;
+        double spread = side / (2.0 + std::sqrt(static_cast<double>(clusters)) * 2.0);
+        std::normal_distribution<double> offset(0.0, spread / 2.0);
+        for (int v = 0; v < n; ++v) {
+            double angle = cluster[v] < 0 ? 0.0 : 2.0 * M_PI * cluster[v] / clusters;
+            double ring = cluster[v] < 0 || clusters == 1 ? 0.0 : radius;
+            p.x[v] = std::clamp(side / 2.0 + ring * std::cos(angle) + offset(gen), 0.0, side);
+            p.y[v] = std::clamp(side / 2.0 + ring * std::sin(angle) + offset(gen), 0.0, side);
+        }
+    }
+    if (n < 2) return p;
+    
+    std::vector<std::pair<int, int>> edges;
+    for (int u = 0; u < n; ++u) {
+        for (int v : c.neighbors(u)) {
+            if (u != v && (c.directed || u < v)) edges.emplace_back(u, v);
+        }
+    }
+    
+    double temperature = side / 10.0;
+    std::vector<double> fx(n), fy(n), centerX(clusters), centerY(clusters);
+    std::vector<int> members(clusters);
+    for (int iter = 0; iter < iterations; ++iter) {
+        std::fill(fx.begin(), fx.end(), 0.0);
+        std::fill(fy.begin(), fy.end(), 0.0);
+        
+        // Отталкивание k^2 / d между всеми парами
+        for (int i = 0; i < n; ++i) {
+            for (int j = i + 1; j < n; ++j) {
+                double dx = p.x[j] - p.x[i];
+                double dy = p.y[j] - p.y[i];
+                double dist = std::max(0.01, std::hypot(dx, dy));
+                double repulsion = 1.0 / dist;
+                fx[i] -= dx / dist * repulsion;
+                fy[i] -= dy / dist * repulsion;
+                fx[j] += dx / dist * repulsion;
+                fy[j] += dy / dist * repulsion;
+            }
+        }
+        
+        // Притяжение d^2 / k по рёбрам
+        for (const auto& [a, b] : edges) {
+            double dx = p.x[b] - p.x[a];
+            double dy = p.y[b] - p.y[a];
+            double dist = std::max(0.01, std::hypot(dx, dy));
+            fx[a] += dx * dist;
+            fy[a] += dy * dist;
+            fx[b] -= dx * dist;
+            fy[b] -= dy * dist;
+        }
+        
+        // Притяжение к центру своего кластера
+        if (clusters > 0) {
+            std::fill(centerX.begin(), centerX.end(), 0.0);
+            std::fill(centerY.begin(), centerY.end(), 0.0);
+            std::fill(members.begin(), members.end(), 0);
+            for (int v = 0; v < n; ++v) {
+                if (cluster[v] < 0) continue;
+                centerX[cluster[v]] += p.x[v];
+                centerY[cluster[v]] += p.y[v];
+                ++members[cluster[v]];
+            }
+            for (int v = 0; v < n; ++v) {
+                if (cluster[v] < 0) continue;
+                double dx = centerX[cluster[v]] / members[cluster[v]] - p.x[v];
+                double dy = centerY[cluster[v]] / members[cluster[v]] - p.y[v];
+                double dist = std::hypot(dx, dy);
+                if (dist < 0.01) continue;
+                fx[v] += dx * kClusterPull * dist;
+                fy[v] += dy * kClusterPull * dist;
+            }
+        }
+        
+        // Сдвиг не больше температуры, затем охлаждение
+        for (int v = 0; v < n; ++v) {
+            double magnitude = std::hypot(fx[v], fy[v]);
+            double limit = magnitude > temperature ? temperature / magnitude : 1.0;
+            p.x[v] = std::clamp(p.x[v] + fx[v] * limit, 0.0, side);
+            p.y[v] = std::clamp(p.y[v] + fy[v] * limit, 0.0, side);
+        }
+        temperature *= 0.95;
+    }
+    return p;
+}
+
+// Сугияма: x - координаты Брандеса-Кёпфа, шаг слоя подобран так, чтобы
+// компонента была примерно 3:2, как окно
+Coordinates layeredComponent(const CSRGraph& c, size_t numThreads) {
+    int n = c.size();
+    LayeredGraph lg = Sugiyama::build(c, Sugiyama::assignLayers(c));
+    Sugiyama::orderLayers(lg, numThreads);
+    std::vector<double> x = Sugiyama::assignCoordinates(lg);
+    
+    // Фиктивные вершины только держат место длинных дуг: ширина - по настоящим
+    auto [minX, maxX] = std::minmax_element(x.begin(), x.begin() + n);
+    double layerStep = lg.layers() > 1 ? std::max(1.0, (*maxX - *minX) * 2.0 / 3.0 / (lg.layers() - 1)) : 1.0;
+    Coordinates p;
+    for (int v = 0; v < n; ++v) {
+        p.x.push_back(x[v] - *minX);
+        p.y.push_back(lg.layer[v] * layerStep);
+    }
+    return p;
+}
+
+Coordinates stressComponent(const CSRGraph& c, size_t numThreads) {
+    StressModel model = StressModel::build(c, StressModel::kDefaultPivots, numThreads);
+    Coordinates p = model.pivotMDS();
+    model.majorize(p);
+    return p;
+}
+
+// Собственные векторы единичной длины: масштаб - средняя длина ребра 1
+Coordinates spectralComponent(const CSRGraph& c, size_t numThreads) {
+    Coordinates p = SpectralEmbedding::compute(c, SpectralEmbedding::kDefaultSteps, numThreads);
+    double total = 0.0;
+    size_t count = 0;
+    for (int u = 0; u < c.size(); ++u) {
+        for (int v : c.neighbors(u)) {
+            total += std::hypot(p.x[u] - p.x[v], p.y[u] - p.y[v]);
+            ++count;
+        }
+    }
+    if (total > 0.0) {
+        double scale = count / total;
+        for (double& value : p.x) value *= scale;
+        for (double& value : p.y) value *= scale;
+    }
+    return p;
+}
+
+} // namespace
+
 void Layout::applyLayout(Graph& g, LayoutType type, double width, double height) {
     switch (type) {
         case LayoutType::Circular:
@@ -20,148 +330,310 @@ void Layout::applyLayout(Graph& g, LayoutType type, double width, double height)
         case LayoutType::Random:
             random(g, width, height);
             break;
+        case LayoutType::Layered:
+            layered(g, width, height);
+            break;
+        case LayoutType::Stress:
+            stress(g, width, height);
+            break;
+        case LayoutType::Spectral:
+            spectral(g, width, height);
+            break;
     }
 }
 
-void Layout::circular(Graph& g, double width, double height) {
-    auto vertices = g.getVertices();
-    int n = static_cast<int>(vertices.size());
+CSRGraph Layout::layoutSnapshot(const Graph& g) const {
+    return subgraph_ ? visiblePart(*subgraph_) : CSRGraph::fromGraph(g);
+}
+
+uint64_t Layout::resultKey(const CSRGraph& snapshot, LayoutType type, double width, double height, int iterations) const {
+    auto combine = [](uint64_t key, uint64_t value) { return mix(key ^ mix(value)); };
+    uint64_t key = combine(snapshot.contentHash(), static_cast<uint64_t>(type));
+    key = combine(key, seed_);
+    key = combine(key, std::bit_cast<uint64_t>(width));
+    key = combine(key, std::bit_cast<uint64_t>(height));
+    if (type == LayoutType::ForceDirected) {
+        key = combine(key, static_cast<uint64_t>(iterations));
+        std::vector<std::pair<int, int>> clusters;
+        for (int id : snapshot.ids) {
+            if (auto it = clusterOf_.find(id); it != clusterOf_.end()) clusters.emplace_back(id, it->second);
+        }
+        std::sort(clusters.begin(), clusters.end());
+        for (const auto& [id, cluster] : clusters) {
+            key = combine(key, static_cast<uint64_t>(static_cast<uint32_t>(id)) << 32 | static_cast<uint32_t>(cluster));
+        }
+    }
+    return key;
+}
+
+void Layout::arrange(Graph& g, LayoutType type, double width, double height, int iterations) {
+    CSRGraph csr = layoutSnapshot(g);
+    int n = csr.size();
     if (n == 0) return;
+    uint64_t key = 0;
+    if (cache_) {
+        key = resultKey(csr, type, width, height, iterations);
+        if (cache_->load(key, csr, g)) return;
+    }
+    
+    // Крупные компоненты - первыми; при равном размере - по наименьшему ID
+    auto components = weakComponents(csr);
+    std::vector<int> local(n), minId(components.size());
+    for (size_t i = 0; i < components.size(); ++i) {
+        minId[i] = csr.ids[components[i][0]];
+        for (size_t k = 0; k < components[i].size(); ++k) {
+            local[components[i][k]] = static_cast<int>(k);
+            minId[i] = std::min(minId[i], csr.ids[components[i][k]]);
+        }
+    }
+    std::vector<size_t> order(components.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        if (components[a].size() != components[b].size()) return components[a].size() > components[b].size();
+        return minId[a] < minId[b];
+    });
     
-    double centerX = width / 2.0;
-    double centerY = height / 2.0;
-    double radius = std::min(width, height) * 0.4;
+    std::vector<Coordinates> placed(components.size());
+    auto arrangeComponent = [&](size_t index, size_t numThreads) {
+        CSRGraph c = componentGraph(csr, components[index], local);
+        std::mt19937_64 gen(componentSeed(seed_, minId[index]));
+        Coordinates& p = placed[index];
+        switch (type) {
+            case LayoutType::Circular:
+                p = circularComponent(c.size());
+                break;
+            case LayoutType::Random:
+                p = randomComponent(c.size(), gen);
+                break;
+            case LayoutType::ForceDirected: {
+                std::vector<int> cluster(c.size(), -1);
+                if (!clusterOf_.empty()) {
+                    for (int v = 0; v < c.size(); ++v) {
+                        auto it = clusterOf_.find(c.ids[v]);
+                        if (it != clusterOf_.end()) cluster[v] = it->second;
+                    }
+                }
+                p = forceDirectedComponent(c, iterations, cluster, gen);
+                break;
+            }
+            case LayoutType::Layered:
+                p = layeredComponent(c, numThreads);
+                break;
+            case LayoutType::Stress:
+                p = stressComponent(c, numThreads);
+                break;
+            case LayoutType::Spectral:
+                p = spectralComponent(c, numThreads);
+                break;
+        }
+    };
     
-    double angleStep = 2.0 * M_PI / n;
+    size_t split = 0;
+    while (split < order.size() && components[order[split]].size() >= kLargeComponent) {
+        arrangeComponent(order[split++], numThreads_);
+    }
+    std::atomic<size_t> next{split};
+    auto worker = [&](size_t, size_t, size_t) {
+        for (size_t i = next.fetch_add(1); i < order.size(); i = next.fetch_add(1)) {
+            arrangeComponent(order[i], 1);
+        }
+    };
+    if (numThreads_ > 1 && order.size() - split > 1) {
+        ThreadPool pool(numThreads_);
+        pool.parallelFor(numThreads_, worker);
+    } else {
+        worker(0, 0, 0);
+    }
     
-    for (int i = 0; i < n; ++i) {
-        double angle = i * angleStep;
-        double x = centerX + radius * std::cos(angle);
-        double y = centerY + radius * std::sin(angle);
-        g.setVertexPosition(vertices[i], x, y);
+    // Упаковка рамок компонент в полосу с пропорциями окна
+    std::vector<std::pair<double, double>> sizes(components.size()), low(components.size());
+    for (size_t i = 0; i < components.size(); ++i) {
+        auto [minX, maxX] = std::minmax_element(placed[i].x.begin(), placed[i].x.end());
+        auto [minY, maxY] = std::minmax_element(placed[i].y.begin(), placed[i].y.end());
+        low[i] = {*minX, *minY};
+        sizes[i] = {*maxX - *minX + kComponentGap, *maxY - *minY + kComponentGap};
+    }
+    auto corners = SkylinePacker::pack(sizes, width / height);
+    Coordinates all;
+    all.x.resize(n);
+    all.y.resize(n);
+    for (size_t i = 0; i < components.size(); ++i) {
+        for (size_t k = 0; k < components[i].size(); ++k) {
+            int v = components[i][k];
+            all.x[v] = placed[i].x[k] - low[i].first + corners[i].first;
+            all.y[v] = placed[i].y[k] - low[i].second + corners[i].second;
+        }
+    }
+    fitToWindow(g, csr, all, width, height);
+    if (cache_ && !cache_->store(key, csr, g)) {
+        std::cerr << "Не удалось сохранить макет в кеш " << cache_->path(key) << std::endl;
     }
 }
 
+void Layout::circular(Graph& g, double width, double height) {
+    arrange(g, LayoutType::Circular, width, height, 0);
+}
+
 void Layout::random(Graph& g, double width, double height) {
-    std::uniform_real_distribution<double> xDist(50.0, width - 50.0);
-    std::uniform_real_distribution<double> yDist(50.0, height - 50.0);
-    
-    auto vertices = g.getVertices();
-    for (int v : vertices) {
-        g.setVertexPosition(v, xDist(gen_), yDist(gen_));
-    }
+    arrange(g, LayoutType::Random, width, height, 0);
+}
+
+void Layout::layered(Graph& g, double width, double height) {
+    arrange(g, LayoutType::Layered, width, height, 0);
+}
+
+void Layout::stress(Graph& g, double width, double height) {
+    arrange(g, LayoutType::Stress, width, height, 0);
+}
+
+void Layout::spectral(Graph& g, double width, double height) {
+    arrange(g, LayoutType::Spectral, width, height, 0);
 }
 
 void Layout::forceDirected(Graph& g, double width, double height, int iterations) {
-    auto vertices = g.getVertices();
-    int n = static_cast<int>(vertices.size());
-    if (n == 0) return;
+    arrange(g, LayoutType::ForceDirected, width, height, iterations);
+}
+
+void Layout::relaxAround(Graph& g, const std::vector<int>& touched, double width, double height, int iterations) {
+    int n = g.getVertexCount();
+    if (touched.empty() || n == 0) return;
+    double k = std::sqrt((width * height) / n);
+    // Чтение координат - через константный доступ: он не копирует куски графа
+    const Graph& view = g;
+    
+    // Новые вершины (без координат) - в центр уже расположенных соседей
+    std::uniform_real_distribution<double> jitter(-k, k);
+    std::uniform_real_distribution<double> xDist(50.0, width - 50.0);
+    std::uniform_real_distribution<double> yDist(50.0, height - 50.0);
+    for (int v : touched) {
+        auto* vertex = view.getVertex(v);
+        if (!vertex || vertex->x != 0.0 || vertex->y != 0.0) continue;
+        double sx = 0.0, sy = 0.0;
+        int placed = 0;
+        for (int w : adjacentVertices(g, v)) {
+            auto* neighbor = view.getVertex(w);
+            if (!neighbor || (neighbor->x == 0.0 && neighbor->y == 0.0)) continue;
+            sx += neighbor->x;
+            sy += neighbor->y;
+            ++placed;
+        }
+        double x = placed ? sx / placed + jitter(gen_) : xDist(gen_);
+        double y = placed ? sy / placed + jitter(gen_) : yDist(gen_);
+        g.setVertexPosition(v, std::clamp(x, 50.0, width - 50.0), std::clamp(y, 50.0, height - 50.0));
+    }
     
-    // Инициализация случайными позициями
-    random(g, width, height);
+    // Подвижные вершины: затронутые и их соседи. Координаты в плотном массиве:
+    // сначала подвижные, затем неподвижные соседи (их позиции не меняются)
+    std::vector<int> moving;
+    std::unordered_map<int, size_t> index;
+    for (int v : touched) {
+        if (!g.hasVertex(v) || index.count(v)) continue;
+        index[v] = moving.size();
+        moving.push_back(v);
+    }
+    size_t touchedCount = moving.size();
+    for (size_t i = 0; i < touchedCount; ++i) {
+        for (int w : adjacentVertices(g, moving[i])) {
+            if (!index.count(w) && g.hasVertex(w)) {
+                index[w] = moving.size();
+                moving.push_back(w);
+            }
+        }
+    }
     
-    // Убедиться, что координаты установлены
-    for (int v : vertices) {
-        auto* vertex = g.getVertex(v);
-        if (vertex && (vertex->x == 0.0 && vertex->y == 0.0)) {
-            // Если координаты не установлены, установить случайные
-            std::uniform_real_distribution<double> xDist(50.0, width - 50.0);
-            std::uniform_real_distribution<double> yDist(50.0, height - 50.0);
-            g.setVertexPosition(v, xDist(gen_), yDist(gen_));
+    std::vector<std::pair<double, double>> position;
+    for (int v : moving) {
+        auto* vertex = view.getVertex(v);
+        position.emplace_back(vertex->x, vertex->y);
+    }
+    std::vector<std::vector<size_t>> links(moving.size());
+    for (size_t i = 0; i < moving.size(); ++i) {
+        for (int w : adjacentVertices(g, moving[i])) {
+            auto it = index.find(w);
+            if (it == index.end()) {
+                auto* neighbor = view.getVertex(w);
+                if (!neighbor) continue;
+                it = index.emplace(w, position.size()).first;
+                position.emplace_back(neighbor->x, neighbor->y);
+            }
+            links[i].push_back(it->second);
         }
     }
     
-    // Параметры алгоритма
-    double k = std::sqrt((width * height) / n);  // Идеальное расстояние
-    double temperature = std::min(width, height) / 10.0;
+    // Неподвижные вершины раскладываются по сетке один раз; отталкивание
+    // k^2 / d заметно только на расстояниях порядка k
+    double cell = 2.0 * k;
+    std::unordered_map<int64_t, std::vector<std::pair<double, double>>> fixed;
+    for (int v : g.getVertices()) {
+        auto it = index.find(v);
+        if (it != index.end() && it->second < moving.size()) continue;
+        if (auto* vertex = view.getVertex(v)) {
+            fixed[gridCell(vertex->x, vertex->y, cell)].emplace_back(vertex->x, vertex->y);
+        }
+    }
     
+    double temperature = std::min(width, height) / 40.0;
+    std::vector<std::pair<double, double>> forces(moving.size());
     for (int iter = 0; iter < iterations; ++iter) {
-        std::unordered_map<int, std::pair<double, double>> forces;
-        
-        // Инициализировать силы
-        for (int v : vertices) {
-            forces[v] = {0.0, 0.0};
+        std::unordered_map<int64_t, std::vector<size_t>> movingGrid;
+        for (size_t i = 0; i < moving.size(); ++i) {
+            movingGrid[gridCell(position[i].first, position[i].second, cell)].push_back(i);
         }
         
-        // Вычислить силы отталкивания между всеми парами вершин
-        for (size_t i = 0; i < vertices.size(); ++i) {
-            int v1 = vertices[i];
-            auto* vertex1 = g.getVertex(v1);
-            if (!vertex1) continue;
-            
-            for (size_t j = i + 1; j < vertices.size(); ++j) {
-                int v2 = vertices[j];
-                auto* vertex2 = g.getVertex(v2);
-                if (!vertex2) continue;
-                
-                double dx = vertex2->x - vertex1->x;
-                double dy = vertex2->y - vertex1->y;
-                double dist = distance(vertex1->x, vertex1->y, vertex2->x, vertex2->y);
-                
-                if (dist < 0.01) dist = 0.01;  // Избежать деления на ноль
-                
-                // Сила отталкивания
+        for (size_t i = 0; i < moving.size(); ++i) {
+            auto [x, y] = position[i];
+            double fx = 0.0, fy = 0.0;
+            auto repel = [&](double ox, double oy) {
+                double dx = x - ox;
+                double dy = y - oy;
+                double dist = std::max(0.01, distance(0.0, 0.0, dx, dy));
                 double repulsion = k * k / dist;
-                double fx = (dx / dist) * repulsion;
-                double fy = (dy / dist) * repulsion;
-                
-                forces[v1].first -= fx;
-                forces[v1].second -= fy;
-                forces[v2].first += fx;
-                forces[v2].second += fy;
-            }
-        }
-        
-        // Вычислить силы притяжения для рёбер
-        auto edges = g.getEdges();
-        for (const auto& edge : edges) {
-            auto* v1 = g.getVertex(edge.from);
-            auto* v2 = g.getVertex(edge.to);
-            if (!v1 || !v2) continue;
-            
-            double dx = v2->x - v1->x;
-            double dy = v2->y - v1->y;
-            double dist = distance(v1->x, v1->y, v2->x, v2->y);
-            
-            if (dist < 0.01) dist = 0.01;
+                fx += (dx / dist) * repulsion;
+                fy += (dy / dist) * repulsion;
+            };
             
-            // Сила притяжения
-            double attraction = dist * dist / k;
-            double fx = (dx / dist) * attraction;
-            double fy = (dy / dist) * attraction;
+            auto cx = static_cast<int64_t>(std::floor(x / cell));
+            auto cy = static_cast<int64_t>(std::floor(y / cell));
+            for (int64_t a = cx - 1; a <= cx + 1; ++a) {
+                for (int64_t b = cy - 1; b <= cy + 1; ++b) {
+                    int64_t key = gridKey(a, b);
+                    if (auto it = fixed.find(key); it != fixed.end()) {
+                        for (const auto& [ox, oy] : it->second) repel(ox, oy);
+                    }
+                    if (auto it = movingGrid.find(key); it != movingGrid.end()) {
+                        for (size_t j : it->second) {
+                            if (j != i) repel(position[j].first, position[j].second);
+                        }
+                    }
+                }
+            }
             
-            forces[edge.from].first += fx;
-            forces[edge.from].second += fy;
-            forces[edge.to].first -= fx;
-            forces[edge.to].second -= fy;
+            for (size_t j : links[i]) {
+                double dx = position[j].first - x;
+                double dy = position[j].second - y;
+                double dist = std::max(0.01, distance(0.0, 0.0, dx, dy));
+                double attraction = dist * dist / k;
+                fx += (dx / dist) * attraction;
+                fy += (dy / dist) * attraction;
+            }
+            forces[i] = {fx, fy};
         }
         
-        // Применить силы с ограничением температуры
-        for (int v : vertices) {
-            double fx = forces[v].first;
-            double fy = forces[v].second;
+        for (size_t i = 0; i < moving.size(); ++i) {
+            auto [fx, fy] = forces[i];
             double forceMag = std::sqrt(fx * fx + fy * fy);
-            
             if (forceMag > temperature) {
                 fx = (fx / forceMag) * temperature;
                 fy = (fy / forceMag) * temperature;
             }
-            
-            auto* vertex = g.getVertex(v);
-            if (vertex) {
-                double newX = vertex->x + fx;
-                double newY = vertex->y + fy;
-                
-                // Ограничить границами
-                newX = std::max(50.0, std::min(width - 50.0, newX));
-                newY = std::max(50.0, std::min(height - 50.0, newY));
-                
-                g.setVertexPosition(v, newX, newY);
-            }
+            position[i].first = std::clamp(position[i].first + fx, 50.0, width - 50.0);
+            position[i].second = std::clamp(position[i].second + fy, 50.0, height - 50.0);
         }
-        
-        // Охлаждение
-        temperature *= 0.95;
+        temperature *= 0.9;
+    }
+    
+    for (size_t i = 0; i < moving.size(); ++i) {
+        g.setVertexPosition(moving[i], position[i].first, position[i].second);
     }
 }
 
@@ -1,26 +1,61 @@
 #pragma once
 
 #include "core/graph.hpp"
+#include "core/subgraph.hpp"
+#include "visualization/layout_cache.hpp"
 #include <vector>
 #include <random>
 #include <cmath>
+#include <unordered_map>
+#include <memory>
+#include <utility>
+#include <algorithm>
+#include <thread>
+#include <cstdint>
 
 namespace graph {
 
 enum class LayoutType {
     Circular,
     ForceDirected,
-    Random
+    Random,
+    Layered,   // иерархия по направлению дуг (subtopic_of, part_of)
+    Stress,    // расстояния на экране пропорциональны расстояниям в графе
+    Spectral   // собственные векторы лапласиана
 };
 
+// Макеты детерминированы: компоненты связности (без учёта направления)
+// раскладываются независимо, каждая - своим генератором с зерном от зерна
+// макета и наименьшего ID компоненты, затем упаковываются по линии
+// горизонта и вписываются в окно. Один граф (в той же плотной нумерации)
+// с тем же зерном и параметрами даёт те же координаты при любом числе
+// потоков, поэтому результат можно кешировать
 class Layout {
 public:
-    Layout() : gen_(std::random_device{}()) {}
+    static constexpr uint64_t kDefaultSeed = 42;
+    
+    explicit Layout(uint64_t seed = kDefaultSeed) : seed_(seed), gen_(seed) {}
+    
+    void setSeed(uint64_t seed) { seed_ = seed; gen_.seed(seed); }
+    uint64_t seed() const { return seed_; }
+    
+    // Крупные компоненты раскладываются по очереди, каждая на всех потоках;
+    // мелкие - параллельно, по одной на поток
+    void setThreadCount(size_t numThreads) { numThreads_ = std::max<size_t>(1, numThreads); }
+    
+    // Кеш готовых макетов на диске: макет с тем же ключом не пересчитывается,
+    // а читается из файла
+    void setCache(std::shared_ptr<const LayoutCache> cache) { cache_ = std::move(cache); }
+    
+    // Ключ результата: содержимое видимой части графа (CSRGraph::contentHash,
+    // не зависит от порядка загрузки), тип, зерно, размер окна, число итераций
+    // и кластеры force-directed
+    uint64_t resultKey(const CSRGraph& snapshot, LayoutType type, double width, double height, int iterations) const;
     
     // Применить макет к графу
     void applyLayout(Graph& g, LayoutType type, double width = 800.0, double height = 600.0);
     
-    // Force directed layout Fruchterman Reingold
+    // Force directed layout Fruchterman Reingold (все пары вершин компоненты)
     void forceDirected(Graph& g, double width, double height, int iterations = 100);
     
     // Circular layout
@@ -29,11 +64,49 @@ public:
     // Random layout
     void random(Graph& g, double width, double height);
     
+    // Иерархический макет Сугиямы (visualization/sugiyama.hpp): слои по
+    // направлению дуг (у неориентированного графа - по глубине BFS), порядок
+    // в слоях с минимумом пересечений, координаты Брандеса-Кёпфа
+    void layered(Graph& g, double width, double height);
+    
+    // Макет по стрессу (visualization/embedding.hpp): pivot MDS, затем
+    // majorization разреженного стресса; без перебора всех пар вершин
+    void stress(Graph& g, double width, double height);
+    
+    // Спектральный макет: два собственных вектора лапласиана (Ланцош)
+    void spectral(Graph& g, double width, double height);
+    
     // Обновление force directed для анимации
     void updateForceDirected(Graph& g, double width, double height, int iterations = 1);
     
+    // Дорасположить изменённую часть графа: новые вершины ставятся рядом с
+    // соседями, затем force-directed двигает только затронутые вершины и их
+    // соседей, остальные неподвижны. Отталкивание считается от вершин в
+    // соседних ячейках сетки, а не от всех пар
+    void relaxAround(Graph& g, const std::vector<int>& touched, double width, double height, int iterations = 30);
+    
+    // Подсказки кластеров (вершина -> номер кластера, например сообщество):
+    // force-directed стартует с кластеров вокруг своих центров и стягивает их
+    void setClusterHints(std::unordered_map<int, int> clusterOf) { clusterOf_ = std::move(clusterOf); }
+    void clearClusterHints() { clusterOf_.clear(); }
+    
+    // Располагать только вершины подграфа (например, k-ядра), остальные не трогать
+    void setSubgraph(std::shared_ptr<const SubgraphView> subgraph) { subgraph_ = std::move(subgraph); }
+    void clearSubgraph() { subgraph_.reset(); }
+    
 private:
+    uint64_t seed_;
     std::mt19937 gen_;
+    size_t numThreads_ = std::max(1u, std::thread::hardware_concurrency());
+    std::unordered_map<int, int> clusterOf_;
+    std::shared_ptr<const SubgraphView> subgraph_;
+    std::shared_ptr<const LayoutCache> cache_;
+    
+    // Видимая часть графа, которая участвует в макете
+    CSRGraph layoutSnapshot(const Graph& g) const;
+    
+    // Разложить компоненты, упаковать и вписать в окно
+    void arrange(Graph& g, LayoutType type, double width, double height, int iterations);
     
     double distance(double x1, double y1, double x2, double y2) const {
         return std::sqrt((x2 - x1) * (x2 - x1) + (y2 - y1) * (y2 - y1));
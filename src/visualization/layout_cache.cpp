@@ -0,0 +1,167 @@
+#include "visualization/layout_cache.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+#include <fstream>
+#include <filesystem>
+#include <vector>
+#if defined(_WIN32)
+#include <iterator>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace graph {
+
+namespace {
+
+constexpr char kCacheMagic[4] = {'K', 'G', 'L', 'C'};
+constexpr uint32_t kCacheVersion = 1;
+
+struct Header {
+    char magic[4];
+    uint32_t version;
+    uint64_t key;
+    uint32_t count;
+    uint32_t reserved;
+};
+
+struct Record {
+    int32_t id;
+    float x, y;
+};
+
+static_assert(sizeof(Header) == 24 && sizeof(Record) == 12, "формат файла кеша макетов");
+
+// Содержимое файла только для чтения: отображение в память, на Windows - чтение
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& filename) {
+#if defined(_WIN32)
+        std::ifstream file(filename, std::ios::binary);
+        if (!file.is_open()) return;
+        buffer_.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        data_ = buffer_.data();
+        size_ = buffer_.size();
+#else
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0) return;
+        struct stat info;
+        if (::fstat(fd, &info) == 0 && info.st_size > 0) {
+            void* mapped = ::mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped != MAP_FAILED) {
+                data_ = static_cast<const char*>(mapped);
+                size_ = static_cast<size_t>(info.st_size);
+            }
+        }
+        ::close(fd);
+#endif
+    }
+
+    ~MappedFile() {
+#if !defined(_WIN32)
+        if (data_) ::munmap(const_cast<char*>(data_), size_);
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+#if defined(_WIN32)
+    std::vector<char> buffer_;
+#endif
+};
+
+} // namespace
+
+std::string LayoutCache::defaultDirectory() {
+    if (const char* cache = std::getenv("XDG_CACHE_HOME"); cache && *cache) {
+        return std::string(cache) + "/graph-visualizer";
+    }
+    if (const char* home = std::getenv("HOME"); home && *home) {
+        return std::string(home) + "/.cache/graph-visualizer";
+    }
+    return ".layout-cache";
+}
+
+std::string LayoutCache::path(uint64_t key) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.pos", static_cast<unsigned long long>(key));
+    return directory_ + "/" + name;
+}
+
+bool LayoutCache::load(uint64_t key, const CSRGraph& snapshot, Graph& g) const {
+    MappedFile file(path(key));
+    if (!file.data() || file.size() < sizeof(Header)) {
+        return false;
+    }
+    Header header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, kCacheMagic, sizeof(kCacheMagic)) != 0 || header.version != kCacheVersion
+        || header.key != key || header.count != static_cast<uint32_t>(snapshot.size())
+        || file.size() != sizeof(Header) + static_cast<size_t>(header.count) * sizeof(Record)) {
+        return false;
+    }
+
+    // Сначала проверить все ID, чтобы не расставить граф наполовину
+    const char* records = file.data() + sizeof(Header);
+    Record record;
+    for (uint32_t i = 0; i < header.count; ++i) {
+        std::memcpy(&record, records + i * sizeof(Record), sizeof(Record));
+        if (snapshot.index.find(record.id) == snapshot.index.end()) return false;
+    }
+    for (uint32_t i = 0; i < header.count; ++i) {
+        std::memcpy(&record, records + i * sizeof(Record), sizeof(Record));
+        g.setVertexPosition(record.id, record.x, record.y);
+    }
+    return true;
+}
+
+bool LayoutCache::store(uint64_t key, const CSRGraph& snapshot, const Graph& g) const {
+    std::error_code error;
+    std::filesystem::create_directories(directory_, error);
+    if (error) {
+        return false;
+    }
+
+    Header header{};
+    std::memcpy(header.magic, kCacheMagic, sizeof(kCacheMagic));
+    header.version = kCacheVersion;
+    header.key = key;
+    header.count = static_cast<uint32_t>(snapshot.size());
+    std::vector<Record> records;
+    records.reserve(snapshot.size());
+    for (int id : snapshot.ids) {
+        const Vertex* vertex = g.getVertex(id);
+        if (!vertex) return false;
+        records.push_back({id, static_cast<float>(vertex->x), static_cast<float>(vertex->y)});
+    }
+
+    std::string target = path(key);
+    std::string temporary = target + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary);
+        if (!file.is_open()) {
+            return false;
+        }
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(records.data()),
+                   static_cast<std::streamsize>(records.size() * sizeof(Record)));
+        if (!file) {
+            return false;
+        }
+    }
+    std::filesystem::rename(temporary, target, error);
+    return !error;
+}
+
+} // namespace graph
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "core/graph.hpp"
+#include "core/csr.hpp"
+#include <string>
+#include <cstdint>
+
+namespace graph {
+
+// Кеш готовых макетов на диске: файл <ключ>.pos на каждый ключ (содержимое
+// видимой части графа и параметры макета, см. Layout::resultKey). Файл -
+// заголовок и записи (ID int32, x float, y float) по 12 байт; читается
+// через отображение в память (mmap), без разбора и копирования.
+// Координаты во float: в окне это точность лучше 1/1000 пикселя
+class LayoutCache {
+public:
+    explicit LayoutCache(std::string directory) : directory_(std::move(directory)) {}
+
+    // $XDG_CACHE_HOME/graph-visualizer или ~/.cache/graph-visualizer,
+    // иначе .layout-cache в текущем каталоге
+    static std::string defaultDirectory();
+
+    // Расставить вершины снимка по сохранённому макету. false (граф не
+    // меняется), если файла нет, он повреждён или не подходит снимку
+    bool load(uint64_t key, const CSRGraph& snapshot, Graph& g) const;
+
+    // Сохранить положения вершин снимка: запись во временный файл и
+    // переименование, поэтому читатель не видит недописанный файл
+    bool store(uint64_t key, const CSRGraph& snapshot, const Graph& g) const;
+
+    std::string path(uint64_t key) const;
+    const std::string& directory() const { return directory_; }
+
+private:
+    std::string directory_;
+};
+
+} // namespace graph
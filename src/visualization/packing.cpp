@@ -0,0 +1,80 @@
+#include "visualization/packing.hpp"
+#include <algorithm>
+#include <numeric>
+#include <cmath>
+
+namespace graph {
+
+std::vector<std::pair<double, double>> SkylinePacker::pack(const std::vector<std::pair<double, double>>& sizes,
+                                                           double aspect) {
+    std::vector<std::pair<double, double>> corner(sizes.size(), {0.0, 0.0});
+    if (sizes.empty()) return corner;
+
+    double area = 0.0, widest = 0.0;
+    for (const auto& [w, h] : sizes) {
+        area += w * h;
+        widest = std::max(widest, w);
+    }
+    double strip = std::max(widest, std::sqrt(area * aspect));
+
+    std::vector<size_t> order(sizes.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&sizes](size_t a, size_t b) {
+        if (sizes[a].second != sizes[b].second) return sizes[a].second > sizes[b].second;
+        return sizes[a].first > sizes[b].first;
+    });
+
+    struct Step {
+        double x, y, width;
+    };
+    std::vector<Step> skyline = {{0.0, 0.0, strip}};
+    const double eps = 1e-9;
+    for (size_t i : order) {
+        auto [w, h] = sizes[i];
+
+        // Кандидаты - левые края ступеней; низ - самая высокая ступень под прямоугольником
+        size_t best = skyline.size();
+        double bestY = 0.0;
+        for (size_t s = 0; s < skyline.size(); ++s) {
+            double x = skyline[s].x;
+            if (x + w > strip + eps) break;
+            double y = 0.0;
+            for (size_t t = s; t < skyline.size() && skyline[t].x < x + w - eps; ++t) {
+                y = std::max(y, skyline[t].y);
+            }
+            if (best == skyline.size() || y < bestY - eps) {
+                best = s;
+                bestY = y;
+            }
+        }
+        double x = skyline[best].x;
+        corner[i] = {x, bestY};
+
+        // Ступени под прямоугольником заменяются одной на высоте его верха
+        std::vector<Step> next;
+        next.reserve(skyline.size() + 2);
+        for (const Step& step : skyline) {
+            double end = step.x + step.width;
+            if (end <= x + eps || step.x >= x + w - eps) {
+                next.push_back(step);
+                continue;
+            }
+            if (step.x < x) next.push_back({step.x, step.y, x - step.x});
+            if (next.empty() || next.back().x + next.back().width <= x + eps) {
+                next.push_back({x, bestY + h, w});
+            }
+            if (end > x + w) next.push_back({x + w, step.y, end - x - w});
+        }
+        skyline.clear();
+        for (const Step& step : next) {
+            if (!skyline.empty() && std::abs(skyline.back().y - step.y) < eps) {
+                skyline.back().width += step.width;
+            } else {
+                skyline.push_back(step);
+            }
+        }
+    }
+    return corner;
+}
+
+} // namespace graph
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <vector>
+#include <utility>
+
+namespace graph {
+
+// Упаковка прямоугольников в полосу по линии горизонта (skyline): горизонт -
+// ступени (x, высота, ширина), прямоугольник встаёт туда, где его низ
+// ниже всего (при равенстве - левее). Прямоугольники ставятся по убыванию
+// высоты; порядок при равных размерах - по индексу, поэтому упаковка
+// детерминирована
+class SkylinePacker {
+public:
+    // sizes[i] - ширина и высота; возвращает левый нижний угол каждого.
+    // Ширина полосы - не меньше самого широкого прямоугольника и близка к
+    // sqrt(площадь * aspect), чтобы упаковка была пропорциональна окну
+    static std::vector<std::pair<double, double>> pack(const std::vector<std::pair<double, double>>& sizes,
+                                                       double aspect = 1.5);
+};
+
+} // namespace graph
@@ -65,17 +65,22 @@ void GraphRenderer::render(const Graph& g, const AlgorithmState& state, sf::Rend
     sf::View originalView = target.getView();
     target.setView(view_);
     
-    // Отрисовать рёбра
-    auto edges = g.getEdges();
+    // Отрисовать рёбра (только видимого подграфа, если он задан)
+    std::vector<std::pair<int, int>> edges;
+    if (subgraph_) {
+        edges = subgraph_->edges();
+    } else {
+        for (const auto& edge : g.getEdges()) edges.emplace_back(edge.from, edge.to);
+    }
     for (const auto& edge : edges) {
-        bool isInPath = std::find(state.path.begin(), state.path.end(), edge.from) != state.path.end() &&
-                       std::find(state.path.begin(), state.path.end(), edge.to) != state.path.end();
+        bool isInPath = std::find(state.path.begin(), state.path.end(), edge.first) != state.path.end() &&
+                       std::find(state.path.begin(), state.path.end(), edge.second) != state.path.end();
         
         // Проверить, является ли ребро частью пути
         bool isPathEdge = false;
         if (isInPath) {
-            auto fromIt = std::find(state.path.begin(), state.path.end(), edge.from);
-            auto toIt = std::find(state.path.begin(), state.path.end(), edge.to);
+            auto fromIt = std::find(state.path.begin(), state.path.end(), edge.first);
+            auto toIt = std::find(state.path.begin(), state.path.end(), edge.second);
             if (fromIt != state.path.end() && toIt != state.path.end()) {
                 int fromIdx = std::distance(state.path.begin(), fromIt);
                 int toIdx = std::distance(state.path.begin(), toIt);
@@ -84,11 +89,11 @@ void GraphRenderer::render(const Graph& g, const AlgorithmState& state, sf::Rend
         }
         
         sf::Color edgeColor = isPathEdge ? pathColor_ : edgeColor_;
-        drawEdge(g, edge.from, edge.to, edgeColor, target);
+        drawEdge(g, edge.first, edge.second, edgeColor, target);
     }
     
     // Отрисовать вершины
-    auto vertices = g.getVertices();
+    auto vertices = subgraph_ ? subgraph_->vertices() : g.getVertices();
     for (int id : vertices) {
         bool isVisited = std::find(state.visited.begin(), state.visited.end(), id) != state.visited.end();
         bool isCurrent = (state.currentVertex == id);
@@ -101,6 +106,8 @@ void GraphRenderer::render(const Graph& g, const AlgorithmState& state, sf::Rend
             color = pathColor_;
         } else if (isVisited) {
             color = visitedColor_;
+        } else if (auto it = vertexColors_.find(id); it != vertexColors_.end()) {
+            color = it->second;
         }
         
         drawVertex(g, id, color, target);
@@ -109,6 +116,72 @@ void GraphRenderer::render(const Graph& g, const AlgorithmState& state, sf::Rend
     
     // Восстановить оригинальный view
     target.setView(originalView);
+    
+    if (!promptText_.empty()) {
+        drawPrompt(target);
+    }
+}
+
+void GraphRenderer::drawPrompt(sf::RenderTarget& target) {
+    // Строка ввода не масштабируется и не сдвигается вместе с графом
+    sf::View originalView = target.getView();
+    sf::Vector2f size(static_cast<float>(target.getSize().x), static_cast<float>(target.getSize().y));
+    target.setView(sf::View(sf::FloatRect({0.0f, 0.0f}, size)));
+    
+    float height = 28.0f;
+    sf::RectangleShape background(sf::Vector2f(size.x, height));
+    background.setPosition({0.0f, size.y - height});
+    background.setFillColor(sf::Color(30, 30, 30, 230));
+    target.draw(background);
+    
+    if (fontLoaded_ && font_.has_value()) {
+        sf::Text text(*font_, sf::String::fromUtf8(promptText_.begin(), promptText_.end()), 16);
+        text.setFillColor(sf::Color::White);
+        text.setPosition({8.0f, size.y - height + 4.0f});
+        target.draw(text);
+    }
+    target.setView(originalView);
+}
+
+float GraphRenderer::radiusOf(int id) const {
+    auto it = vertexScales_.find(id);
+    return it == vertexScales_.end() ? vertexRadius_ : vertexRadius_ * it->second;
+}
+
+sf::Color GraphRenderer::gradientColor(float t) {
+    t = std::clamp(t, 0.0f, 1.0f);
+    // Жёлтый -> оранжевый -> фиолетовый
+    auto mix = [](float a, float b, float k) {
+        return static_cast<std::uint8_t>(a + (b - a) * k);
+    };
+    if (t < 0.5f) {
+        float k = t * 2.0f;
+        return sf::Color(mix(255, 240, k), mix(235, 110, k), mix(80, 40, k));
+    }
+    float k = (t - 0.5f) * 2.0f;
+    return sf::Color(mix(240, 90, k), mix(110, 30, k), mix(40, 150, k));
+}
+
+sf::Color GraphRenderer::categoricalColor(int index) {
+    float hue = std::fmod(index * 137.508f, 360.0f) / 60.0f;
+    float saturation = 0.65f;
+    float value = index % 2 == 0 ? 0.95f : 0.8f;
+    
+    // HSV -> RGB
+    float chroma = value * saturation;
+    float x = chroma * (1.0f - std::abs(std::fmod(hue, 2.0f) - 1.0f));
+    float r = 0.0f, g = 0.0f, b = 0.0f;
+    switch (static_cast<int>(hue)) {
+        case 0: r = chroma; g = x; break;
+        case 1: r = x; g = chroma; break;
+        case 2: g = chroma; b = x; break;
+        case 3: g = x; b = chroma; break;
+        case 4: r = x; b = chroma; break;
+        default: r = chroma; b = x; break;
+    }
+    float m = value - chroma;
+    auto channel = [m](float c) { return static_cast<std::uint8_t>((c + m) * 255.0f); };
+    return sf::Color(channel(r), channel(g), channel(b));
 }
 
 void GraphRenderer::drawEdge(const Graph& g, int from, int to, const sf::Color& color, sf::RenderTarget& target) {
@@ -196,12 +269,14 @@ void GraphRenderer::drawVertex(const Graph& g, int id, const sf::Color& color, s
         debugCount++;
     }
     
-    sf::CircleShape circle(vertexRadius_);
-    circle.setPosition({static_cast<float>(v->x) - vertexRadius_, 
-                       static_cast<float>(v->y) - vertexRadius_});
+    float radius = radiusOf(id);
+    sf::CircleShape circle(radius);
+    circle.setPosition({static_cast<float>(v->x) - radius, 
+                       static_cast<float>(v->y) - radius});
     circle.setFillColor(color);
-    circle.setOutlineColor(sf::Color::Black);
-    circle.setOutlineThickness(2.0f);
+    bool highlighted = highlighted_.count(id) > 0;
+    circle.setOutlineColor(highlighted ? highlightColor_ : sf::Color::Black);
+    circle.setOutlineThickness(highlighted ? 5.0f : 2.0f);
     
     target.draw(circle);
 }
@@ -230,8 +305,16 @@ void GraphRenderer::resetView() {
     panOffset_ = sf::Vector2f(0.0f, 0.0f);
 }
 
+void GraphRenderer::focusOn(sf::Vector2f position, float zoom) {
+    sf::Vector2f windowSize(static_cast<float>(window_.getSize().x), static_cast<float>(window_.getSize().y));
+    view_.setSize(windowSize / zoom);
+    view_.setCenter(position);
+    zoom_ = zoom;
+    panOffset_ = windowSize / 2.0f - position;
+}
+
 int GraphRenderer::getVertexAt(sf::Vector2f position, const Graph& g) const {
-    auto vertices = g.getVertices();
+    auto vertices = subgraph_ ? subgraph_->vertices() : g.getVertices();
     for (int id : vertices) {
         const Vertex* v = g.getVertex(id);
         if (!v) continue;
@@ -240,7 +323,7 @@ int GraphRenderer::getVertexAt(sf::Vector2f position, const Graph& g) const {
         float dy = position.y - static_cast<float>(v->y);
         float dist = std::sqrt(dx * dx + dy * dy);
         
-        if (dist <= vertexRadius_) {
+        if (dist <= radiusOf(id)) {
             return id;
         }
     }
@@ -2,10 +2,14 @@
 
 #include "core/graph.hpp"
 #include "core/algorithms.hpp"
+#include "core/subgraph.hpp"
 #include <SFML/Graphics.hpp>
 #include <memory>
 #include <string>
 #include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 namespace graph {
 
@@ -21,6 +25,9 @@ public:
     void handleMouseDrag(sf::Vector2f delta);
     void resetView();
     
+    // Поставить точку графа в центр окна с заданным увеличением (например, найденную вершину)
+    void focusOn(sf::Vector2f position, float zoom = 2.0f);
+    
     // Получить выбранную вершину по координатам
     int getVertexAt(sf::Vector2f position, const Graph& g) const;
     
@@ -29,6 +36,32 @@ public:
     void setEdgeWidth(float width) { edgeWidth_ = width; }
     void setAnimationSpeed(float speed) { animationSpeed_ = speed; }
     
+    // Цвета вершин поверх стандартного (например, карта расстояний)
+    void setVertexColors(std::unordered_map<int, sf::Color> colors) { vertexColors_ = std::move(colors); }
+    void clearVertexColors() { vertexColors_.clear(); }
+    
+    // Множители радиуса вершин (например, по PageRank)
+    void setVertexScales(std::unordered_map<int, float> scales) { vertexScales_ = std::move(scales); }
+    void clearVertexScales() { vertexScales_.clear(); }
+    
+    // Выделенные вершины (например, топ-k по центральности) обводятся контуром
+    void setHighlightedVertices(const std::vector<int>& ids) { highlighted_ = {ids.begin(), ids.end()}; }
+    void clearHighlightedVertices() { highlighted_.clear(); }
+    
+    // Отрисовывать только подграф (например, k-ядро); граф не копируется
+    void setSubgraph(std::shared_ptr<const SubgraphView> subgraph) { subgraph_ = std::move(subgraph); }
+    void clearSubgraph() { subgraph_.reset(); }
+    
+    // Строка ввода внизу окна (например, текст запроса); пустая - не отображается
+    void setPromptText(std::string text) { promptText_ = std::move(text); }
+    void clearPromptText() { promptText_.clear(); }
+    
+    // Градиент от близкого (t = 0) к дальнему (t = 1)
+    static sf::Color gradientColor(float t);
+    
+    // Различимые цвета для категорий (сообществ): оттенки через золотой угол
+    static sf::Color categoricalColor(int index);
+    
 private:
     sf::RenderWindow& window_;
     sf::View view_;
@@ -49,11 +82,20 @@ private:
     sf::Color visitedColor_ = sf::Color::Green;
     sf::Color currentColor_ = sf::Color::Red;
     sf::Color pathColor_ = sf::Color::Blue;
+    std::unordered_map<int, sf::Color> vertexColors_;
+    std::unordered_map<int, float> vertexScales_;
+    std::unordered_set<int> highlighted_;
+    std::shared_ptr<const SubgraphView> subgraph_;
+    sf::Color highlightColor_ = sf::Color(255, 200, 0);
+    std::string promptText_;
+    
+    float radiusOf(int id) const;
     
     void drawEdge(const Graph& g, int from, int to, const sf::Color& color, sf::RenderTarget& target);
     void drawVertex(const Graph& g, int id, const sf::Color& color, sf::RenderTarget& target);
     void drawLabel(const Graph& g, int id, sf::RenderTarget& target);
     void drawEdgeLabel(const Graph& g, int from, int to, const std::string& label, sf::RenderTarget& target);
+    void drawPrompt(sf::RenderTarget& target);
     void loadFont();
 };
 
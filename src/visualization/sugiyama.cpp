@@ -0,0 +1,388 @@
+#include "visualization/sugiyama.hpp"
+#include "core/dag.hpp"
+#include "core/parallel.hpp"
+#include <algorithm>
+#include <numeric>
+#include <optional>
+#include <array>
+#include <climits>
+#include <cstdint>
+
+namespace graph {
+
+namespace {
+
+// Слой уже этого упорядочивается в текущем потоке
+constexpr size_t kParallelRow = 4096;
+
+// Слои по глубине BFS; корни - непосещённые вершины по убыванию степени
+std::vector<int> breadthLayers(const CSRGraph& g) {
+    int n = g.size();
+    std::vector<int> roots(n);
+    std::iota(roots.begin(), roots.end(), 0);
+    std::stable_sort(roots.begin(), roots.end(), [&g](int a, int b) { return g.degree(a) > g.degree(b); });
+    std::vector<int> layer(n, -1), queue;
+    for (int root : roots) {
+        if (layer[root] != -1) continue;
+        layer[root] = 0;
+        queue.assign(1, root);
+        for (size_t head = 0; head < queue.size(); ++head) {
+            int v = queue[head];
+            for (int u : g.neighbors(v)) {
+                if (layer[u] == -1) {
+                    layer[u] = layer[v] + 1;
+                    queue.push_back(u);
+                }
+            }
+        }
+    }
+    return layer;
+}
+
+// Пересечения сегментов между слоями l и l + 1: сегменты в порядке верхних
+// концов, для каждого - сколько уже вставленных нижних концов правее
+size_t crossingsBelow(const LayeredGraph& lg, int l, std::vector<int>& tree, std::vector<int>& ends) {
+    size_t m = lg.rows[l + 1].size();
+    tree.assign(m + 1, 0);
+    size_t inserted = 0, crossings = 0;
+    for (int v : lg.rows[l]) {
+        ends.clear();
+        for (int u : lg.lower(v)) ends.push_back(lg.position[u]);
+        std::sort(ends.begin(), ends.end());
+        for (int p : ends) {
+            size_t atMost = 0;
+            for (size_t i = p + 1; i > 0; i -= i & (~i + 1)) atMost += tree[i];
+            crossings += inserted - atMost;
+            for (size_t i = p + 1; i <= m; i += i & (~i + 1)) ++tree[i];
+            ++inserted;
+        }
+    }
+    return crossings;
+}
+
+size_t countAll(const LayeredGraph& lg, ThreadPool* pool) {
+    size_t pairs = lg.layers() > 1 ? lg.layers() - 1 : 0;
+    std::vector<size_t> partial(pool ? pool->size() : 1, 0);
+    auto count = [&](size_t part, size_t begin, size_t end) {
+        std::vector<int> tree, ends;
+        for (size_t l = begin; l < end; ++l) {
+            partial[part] += crossingsBelow(lg, static_cast<int>(l), tree, ends);
+        }
+    };
+    if (pool && pairs > 1) {
+        pool->parallelFor(pairs, count);
+    } else {
+        count(0, 0, pairs);
+    }
+    return std::accumulate(partial.begin(), partial.end(), size_t{0});
+}
+
+uint64_t segmentKey(int a, int b) {
+    if (a > b) std::swap(a, b);
+    return (static_cast<uint64_t>(a) << 32) | static_cast<uint32_t>(b);
+}
+
+// Конфликты первого типа: обычный сегмент пересекает внутренний (между
+// двумя фиктивными вершинами). Такой сегмент не выравнивается, поэтому
+// длинные дуги остаются вертикальными
+std::vector<uint64_t> typeOneConflicts(const LayeredGraph& lg) {
+    std::vector<uint64_t> marked;
+    for (int l = 1; l < lg.layers(); ++l) {
+        const auto& row = lg.rows[l];
+        int k0 = 0;
+        size_t scan = 0;
+        for (size_t l1 = 0; l1 < row.size(); ++l1) {
+            int v = row[l1];
+            int inner = -1;
+            if (lg.dummy(v)) {
+                for (int u : lg.upper(v)) {
+                    if (lg.dummy(u)) inner = u;
+                }
+            }
+            if (l1 + 1 != row.size() && inner < 0) continue;
+            int k1 = inner >= 0 ? lg.position[inner] : static_cast<int>(lg.rows[l - 1].size()) - 1;
+            for (; scan <= l1; ++scan) {
+                int w = row[scan];
+                for (int u : lg.upper(w)) {
+                    int k = lg.position[u];
+                    if ((k < k0 || k > k1) && !(lg.dummy(u) && lg.dummy(w))) {
+                        marked.push_back(segmentKey(u, w));
+                    }
+                }
+            }
+            k0 = k1;
+        }
+    }
+    std::sort(marked.begin(), marked.end());
+    return marked;
+}
+
+// Одно из четырёх выравниваний: вершина встаёт в блок с медианным соседом
+// слоем выше (upward - слоем ниже), блоки не пересекаются; затем блоки
+// сжимаются влево (rightward - вправо) самым длинным путём по графу
+// ограничений "левый сосед в слое - на 1 левее"
+std::vector<double> alignAndCompact(const LayeredGraph& lg, const std::vector<uint64_t>& conflicts,
+                                    bool upward, bool rightward) {
+    int size = lg.size();
+    int layers = lg.layers();
+    auto place = [&](int v) {
+        int p = lg.position[v];
+        return rightward ? static_cast<int>(lg.rows[lg.layer[v]].size()) - 1 - p : p;
+    };
+    auto at = [&](const std::vector<int>& row, size_t k) {
+        return row[rightward ? row.size() - 1 - k : k];
+    };
+
+    std::vector<int> root(size);
+    std::iota(root.begin(), root.end(), 0);
+    std::vector<int> neighbors;
+    for (int step = 1; step < layers; ++step) {
+        const auto& row = lg.rows[upward ? layers - 1 - step : step];
+        int r = -1;
+        for (size_t k = 0; k < row.size(); ++k) {
+            int v = at(row, k);
+            auto adjacent = upward ? lg.lower(v) : lg.upper(v);
+            if (adjacent.empty()) continue;
+            neighbors.assign(adjacent.begin(), adjacent.end());
+            std::sort(neighbors.begin(), neighbors.end(), [&](int a, int b) { return place(a) < place(b); });
+            int d = static_cast<int>(neighbors.size());
+            for (int m : {(d - 1) / 2, d / 2}) {
+                if (root[v] != v) break;
+                int u = neighbors[m];
+                if (r < place(u) && !std::binary_search(conflicts.begin(), conflicts.end(), segmentKey(u, v))) {
+                    root[v] = root[u];
+                    r = place(u);
+                }
+            }
+        }
+    }
+
+    // Ограничения между корнями блоков, как CSR по корню левого соседа
+    std::vector<size_t> offsets(size + 1, 0);
+    std::vector<int> indegree(size, 0);
+    for (const auto& row : lg.rows) {
+        for (size_t k = 1; k < row.size(); ++k) {
+            ++offsets[root[at(row, k - 1)] + 1];
+            ++indegree[root[at(row, k)]];
+        }
+    }
+    for (int v = 0; v < size; ++v) offsets[v + 1] += offsets[v];
+    std::vector<int> targets(offsets[size]);
+    std::vector<size_t> fill(offsets.begin(), offsets.end() - 1);
+    for (const auto& row : lg.rows) {
+        for (size_t k = 1; k < row.size(); ++k) {
+            targets[fill[root[at(row, k - 1)]]++] = root[at(row, k)];
+        }
+    }
+
+    std::vector<double> x(size, 0.0);
+    std::vector<int> queue;
+    for (int v = 0; v < size; ++v) {
+        if (root[v] == v && indegree[v] == 0) queue.push_back(v);
+    }
+    for (size_t head = 0; head < queue.size(); ++head) {
+        int b = queue[head];
+        for (size_t i = offsets[b]; i < offsets[b + 1]; ++i) {
+            int next = targets[i];
+            x[next] = std::max(x[next], x[b] + 1.0);
+            if (--indegree[next] == 0) queue.push_back(next);
+        }
+    }
+    for (int v = 0; v < size; ++v) {
+        x[v] = rightward ? -x[root[v]] : x[root[v]];
+    }
+    return x;
+}
+
+} // namespace
+
+std::vector<int> Sugiyama::assignLayers(const CSRGraph& g) {
+    int n = g.size();
+    std::vector<int> layer;
+    if (!g.directed) {
+        layer = breadthLayers(g);
+    } else {
+        Condensation cd = Dag::condense(g);
+        std::vector<int> componentLayer = Dag::longestPathLayers(cd);
+        std::vector<size_t> incoming(cd.count(), 0);
+        for (int d : cd.targets) ++incoming[d];
+        // Обратный топологический порядок: слои преемников уже окончательные,
+        // а предшественники выше старого слоя, значит и нового
+        for (int c = cd.count() - 1; c >= 0; --c) {
+            auto successors = cd.successors(c);
+            if (successors.size() <= incoming[c]) continue;
+            int lowest = INT_MAX;
+            for (int d : successors) lowest = std::min(lowest, componentLayer[d]);
+            componentLayer[c] = std::max(componentLayer[c], lowest - 1);
+        }
+        layer.resize(n);
+        for (int v = 0; v < n; ++v) layer[v] = componentLayer[cd.component[v]];
+    }
+
+    if (n == 0) return layer;
+    std::vector<int> renumber(*std::max_element(layer.begin(), layer.end()) + 1, 0);
+    for (int l : layer) renumber[l] = 1;
+    int used = 0;
+    for (int& l : renumber) {
+        int present = l;
+        l = used;
+        used += present;
+    }
+    for (int& l : layer) l = renumber[l];
+    return layer;
+}
+
+LayeredGraph Sugiyama::build(const CSRGraph& g, const std::vector<int>& layer) {
+    LayeredGraph lg;
+    int n = g.size();
+    lg.vertices = n;
+    lg.layer = layer;
+
+    // Неориентированное ребро есть в CSR дважды, нужное направление одно
+    std::vector<std::pair<int, int>> arcs;
+    for (int u = 0; u < n; ++u) {
+        for (int v : g.neighbors(u)) {
+            if (layer[u] < layer[v]) arcs.emplace_back(u, v);
+        }
+    }
+    std::sort(arcs.begin(), arcs.end());
+    arcs.erase(std::unique(arcs.begin(), arcs.end()), arcs.end());
+
+    std::vector<std::pair<int, int>> segments;
+    segments.reserve(arcs.size());
+    for (const auto& [u, v] : arcs) {
+        int previous = u;
+        for (int l = layer[u] + 1; l < layer[v]; ++l) {
+            int dummy = lg.size();
+            lg.layer.push_back(l);
+            segments.emplace_back(previous, dummy);
+            previous = dummy;
+        }
+        segments.emplace_back(previous, v);
+    }
+
+    int size = lg.size();
+    int layers = n == 0 ? 0 : *std::max_element(layer.begin(), layer.end()) + 1;
+    lg.rows.resize(layers);
+    lg.position.resize(size);
+    for (int v = 0; v < size; ++v) {
+        auto& row = lg.rows[lg.layer[v]];
+        lg.position[v] = static_cast<int>(row.size());
+        row.push_back(v);
+    }
+
+    lg.upOffsets.assign(size + 1, 0);
+    lg.downOffsets.assign(size + 1, 0);
+    for (const auto& [a, b] : segments) {
+        ++lg.downOffsets[a + 1];
+        ++lg.upOffsets[b + 1];
+    }
+    for (int v = 0; v < size; ++v) {
+        lg.downOffsets[v + 1] += lg.downOffsets[v];
+        lg.upOffsets[v + 1] += lg.upOffsets[v];
+    }
+    lg.down.resize(segments.size());
+    lg.up.resize(segments.size());
+    std::vector<size_t> downFill(lg.downOffsets.begin(), lg.downOffsets.end() - 1);
+    std::vector<size_t> upFill(lg.upOffsets.begin(), lg.upOffsets.end() - 1);
+    for (const auto& [a, b] : segments) {
+        lg.down[downFill[a]++] = b;
+        lg.up[upFill[b]++] = a;
+    }
+    return lg;
+}
+
+size_t Sugiyama::orderLayers(LayeredGraph& lg, size_t numThreads, int sweeps) {
+    numThreads = std::max<size_t>(1, numThreads);
+    std::optional<ThreadPool> pool;
+    if (numThreads > 1) pool.emplace(numThreads);
+    ThreadPool* workers = pool ? &*pool : nullptr;
+
+    // Ключ - среднее место соседей в закреплённом слое; вершина без таких
+    // соседей сохраняет своё место в масштабе закреплённого слоя
+    std::vector<double> key(lg.size(), 0.0);
+    auto sweep = [&](bool downward) {
+        int layers = lg.layers();
+        for (int step = 1; step < layers; ++step) {
+            int l = downward ? step : layers - 1 - step;
+            auto& row = lg.rows[l];
+            double scale = static_cast<double>(lg.rows[downward ? l - 1 : l + 1].size()) / row.size();
+            auto compute = [&](size_t, size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    int v = row[i];
+                    auto fixed = downward ? lg.upper(v) : lg.lower(v);
+                    if (fixed.empty()) {
+                        key[v] = lg.position[v] * scale;
+                        continue;
+                    }
+                    double sum = 0.0;
+                    for (int u : fixed) sum += lg.position[u];
+                    key[v] = sum / fixed.size();
+                }
+            };
+            if (workers && row.size() >= kParallelRow) {
+                workers->parallelFor(row.size(), compute);
+            } else {
+                compute(0, 0, row.size());
+            }
+            std::stable_sort(row.begin(), row.end(), [&key](int a, int b) { return key[a] < key[b]; });
+            for (size_t i = 0; i < row.size(); ++i) lg.position[row[i]] = static_cast<int>(i);
+        }
+    };
+
+    size_t best = countAll(lg, workers);
+    std::vector<std::vector<int>> bestRows = lg.rows;
+    for (int s = 0; s < sweeps && best > 0; ++s) {
+        sweep(true);
+        sweep(false);
+        size_t crossings = countAll(lg, workers);
+        if (crossings >= best) break;
+        best = crossings;
+        bestRows = lg.rows;
+    }
+    lg.rows = std::move(bestRows);
+    for (const auto& row : lg.rows) {
+        for (size_t i = 0; i < row.size(); ++i) lg.position[row[i]] = static_cast<int>(i);
+    }
+    return best;
+}
+
+size_t Sugiyama::countCrossings(const LayeredGraph& lg, size_t numThreads) {
+    numThreads = std::max<size_t>(1, numThreads);
+    if (numThreads == 1) return countAll(lg, nullptr);
+    ThreadPool pool(numThreads);
+    return countAll(lg, &pool);
+}
+
+std::vector<double> Sugiyama::assignCoordinates(const LayeredGraph& lg) {
+    int size = lg.size();
+    std::vector<double> x(size, 0.0);
+    if (size == 0) return x;
+    std::vector<uint64_t> conflicts = typeOneConflicts(lg);
+
+    std::array<std::vector<double>, 4> candidates;
+    std::array<double, 4> low, high;
+    int narrowest = 0;
+    for (int k = 0; k < 4; ++k) {
+        candidates[k] = alignAndCompact(lg, conflicts, k / 2 == 1, k % 2 == 1);
+        auto [minIt, maxIt] = std::minmax_element(candidates[k].begin(), candidates[k].end());
+        low[k] = *minIt;
+        high[k] = *maxIt;
+        if (high[k] - low[k] < high[narrowest] - low[narrowest]) narrowest = k;
+    }
+
+    // Левые выравнивания прижимаются к левому краю самого узкого, правые -
+    // к правому; координата - среднее двух средних из четырёх значений
+    for (int k = 0; k < 4; ++k) {
+        double shift = k % 2 == 1 ? high[narrowest] - high[k] : low[narrowest] - low[k];
+        for (double& value : candidates[k]) value += shift;
+    }
+    for (int v = 0; v < size; ++v) {
+        std::array<double, 4> values = {candidates[0][v], candidates[1][v], candidates[2][v], candidates[3][v]};
+        std::sort(values.begin(), values.end());
+        x[v] = (values[1] + values[2]) / 2.0;
+    }
+    return x;
+}
+
+} // namespace graph
@@ -0,0 +1,137 @@
+// Версии графа: удаление вершины не должно менять уже снятый снимок,
+// а перекладка части графа в новую арену - связи и плотные индексы
+#include "core/graph.hpp"
+#include <iostream>
+#include <vector>
+
+using namespace graph;
+
+namespace {
+
+int failures = 0;
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": не выполнено " #condition << std::endl; \
+            ++failures; \
+        } \
+    } while (0)
+
+// Плотные индексы, соседи и индексы концов дуг - всё, что видят алгоритмы
+struct Shape {
+    std::vector<int> vertices;
+    std::vector<int> indices;
+    std::vector<std::vector<int>> neighbors;
+    std::vector<std::vector<int>> targets;
+
+    static Shape of(const Graph& g) {
+        Shape shape;
+        shape.vertices = g.getVertices();
+        for (int id : shape.vertices) {
+            shape.indices.push_back(g.denseIndex(id));
+            shape.neighbors.push_back(g.getNeighbors(id));
+            std::vector<int> targets;
+            for (const Edge& edge : g.getEdges()) {
+                if (edge.from == id) targets.push_back(edge.toIndex);
+            }
+            shape.targets.push_back(std::move(targets));
+        }
+        return shape;
+    }
+
+    bool operator==(const Shape&) const = default;
+};
+
+// Удаляется вершина не в конце плотной нумерации и не смежная с последней:
+// место занимает последняя, а её часть графа больше ничем не затронута и
+// остаётся общей со снимком
+void removeKeepsSnapshot(bool directed) {
+    Graph g(directed);
+    for (int id = 1; id <= 6; ++id) g.addVertex(id, "v" + std::to_string(id));
+    g.addEdge(1, 2, 1.0);
+    g.addEdge(2, 6, 2.0);
+    g.addEdge(6, 3, 1.0);
+    g.addEdge(4, 6, 1.0);
+    g.addEdge(3, 5, 1.0);
+
+    auto snapshot = g.snapshot();
+    Shape before = Shape::of(*snapshot);
+    int removedIndex = g.denseIndex(1);
+
+    g.removeVertex(1);
+    CHECK(Shape::of(*snapshot) == before);
+    CHECK(snapshot->hasVertex(1));
+    CHECK(snapshot->denseIndex(6) == 5);
+    CHECK(snapshot->externalId(5) == 6);
+
+    // В текущем графе последняя вершина переехала на место удалённой
+    CHECK(!g.hasVertex(1));
+    CHECK(g.denseIndex(6) == removedIndex);
+    CHECK(g.externalId(removedIndex) == 6);
+    for (const Edge& edge : g.getEdges()) {
+        CHECK(g.externalId(edge.toIndex) == edge.to);
+    }
+    CHECK(g.hasEdge(2, 6) && g.hasEdge(6, 3) && g.hasEdge(4, 6));
+}
+
+// Все вершины в одной части графа (ID кратны числу частей): после удаления
+// большинства из них мёртвой памяти в арене больше живой, и часть
+// перекладывается в новую арену. Оставшиеся связи, обратный индекс и снимок,
+// снятый до удалений, не меняются
+void removeCompactsChunk(bool directed) {
+    const int stride = 1024;
+    const int count = 200;
+    Graph g(directed);
+    g.addVertex(1, "hub");
+    for (int i = 0; i < count; ++i) g.addVertex(i * stride, "v" + std::to_string(i));
+    for (int i = 0; i < count; ++i) {
+        g.addEdge(i * stride, ((i + 1) % count) * stride, 1.0, "next");
+        g.addEdge(i * stride, ((i + 7) % count) * stride, 2.0);
+        g.addEdge(1, i * stride, 0.5);
+    }
+
+    auto snapshot = g.snapshot();
+    Shape before = Shape::of(*snapshot);
+
+    // Остаются вершины с номерами, кратными 10
+    for (int i = 0; i < count; ++i) {
+        if (i % 10 != 0) g.removeVertex(i * stride);
+    }
+    CHECK(Shape::of(*snapshot) == before);
+
+    CHECK(g.getVertexCount() == count / 10 + 1);
+    CHECK(g.getEdgeCount() == count / 10);
+    for (const Edge& edge : g.getEdges()) {
+        CHECK(g.externalId(edge.toIndex) == edge.to);
+    }
+    for (int i = 0; i < count; i += 10) {
+        int id = i * stride;
+        CHECK(g.hasVertex(id));
+        CHECK(g.getVertex(id)->label == "v" + std::to_string(i));
+        CHECK(g.externalId(g.denseIndex(id)) == id);
+        CHECK(g.hasEdge(1, id));
+        // Соседи по цепочке удалены - осталась только дуга из центра
+        CHECK(g.getNeighbors(id) == (directed ? std::vector<int>{} : std::vector<int>{1}));
+        if (directed) CHECK(g.getIncoming(id) == std::vector<int>{1});
+    }
+
+    // В переложенную часть можно дописывать
+    g.addEdge(0, 10 * stride, 3.0, "late");
+    CHECK(g.getEdge(0, 10 * stride).label == "late");
+}
+
+} // namespace
+
+int main() {
+    removeKeepsSnapshot(false);
+    removeKeepsSnapshot(true);
+    removeCompactsChunk(false);
+    removeCompactsChunk(true);
+    if (failures > 0) {
+        std::cerr << "Ошибок: " << failures << std::endl;
+        return 1;
+    }
+    std::cout << "graph_test: OK" << std::endl;
+    return 0;
+}
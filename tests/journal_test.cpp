@@ -0,0 +1,135 @@
+// Отмена и повтор через журнал: обновление ребра, тип удалённой вершины,
+// запись в файл и переход по версиям после прореживания снимков
+#include "core/journal.hpp"
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+using namespace graph;
+
+namespace {
+
+int failures = 0;
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": не выполнено " #condition << std::endl; \
+            ++failures; \
+        } \
+    } while (0)
+
+// Граф с журналом: каждое изменение графа записывается отдельной операцией
+struct Recorded {
+    Graph graph;
+    Journal journal;
+
+    explicit Recorded(bool directed) : graph(directed), journal(graph, 1) {
+        graph.addChangeListener([this](const std::vector<GraphChange>& changes) { journal.record(graph, changes); });
+    }
+};
+
+void edgeUpdate(bool directed) {
+    Recorded r(directed);
+    r.graph.addEdge(1, 2, 1.5, "lecturer_of");
+    r.graph.addEdge(1, 2, 4.0, "subtopic_of");
+    CHECK(r.journal.size() == 2);
+    CHECK(r.graph.getEdge(1, 2).weight == 4.0);
+
+    // Тот же вес и метка - изменения нет, запись не появляется
+    r.graph.addEdge(1, 2, 4.0, "subtopic_of");
+    CHECK(r.journal.size() == 2);
+
+    CHECK(r.journal.undo(r.graph));
+    CHECK(r.graph.getEdge(1, 2).weight == 1.5);
+    CHECK(r.graph.getEdge(1, 2).label == "lecturer_of");
+    if (!directed) CHECK(r.graph.getEdge(2, 1).weight == 1.5);
+    CHECK(r.graph.getEdgeCount() == 1);
+
+    CHECK(r.journal.redo(r.graph));
+    CHECK(r.graph.getEdge(1, 2).weight == 4.0);
+    CHECK(r.graph.getEdge(1, 2).label == "subtopic_of");
+    if (!directed) CHECK(r.graph.getEdge(2, 1).label == "subtopic_of");
+
+    CHECK(r.journal.undo(r.graph));
+    CHECK(r.journal.undo(r.graph));
+    CHECK(!r.graph.hasEdge(1, 2));
+}
+
+void removedVertexType() {
+    Recorded r(true);
+    r.graph.addVertex(7, "Иванов");
+    r.graph.setVertexType(7, "person");
+    r.graph.addEdge(7, 8, 2.0, "lecturer_of");
+    r.graph.addEdge(9, 7, 1.0);
+    r.graph.removeVertex(7);
+    CHECK(!r.graph.hasVertex(7));
+
+    CHECK(r.journal.undo(r.graph));
+    const Vertex* vertex = static_cast<const Graph&>(r.graph).getVertex(7);
+    CHECK(vertex && vertex->label == "Иванов" && vertex->type == "person");
+    CHECK(r.graph.hasEdge(7, 8) && r.graph.getEdge(7, 8).label == "lecturer_of");
+    CHECK(r.graph.hasEdge(9, 7));
+
+    CHECK(r.journal.redo(r.graph));
+    CHECK(!r.graph.hasVertex(7));
+    CHECK(r.journal.undo(r.graph));
+    vertex = static_cast<const Graph&>(r.graph).getVertex(7);
+    CHECK(vertex && vertex->type == "person");
+}
+
+void saveAndLoad() {
+    Recorded r(false);
+    r.graph.addEdge(1, 2, 1.0, "a");
+    r.graph.addEdge(1, 2, 3.0, "b");
+    r.graph.setVertexType(2, "topic");
+    r.graph.removeVertex(2);
+
+    std::string file = "journal_test.journal";
+    CHECK(r.journal.save(file));
+
+    Graph copy(false);
+    auto loaded = Journal::load(file, copy, 1);
+    std::remove(file.c_str());
+    CHECK(loaded.has_value());
+    if (!loaded) return;
+    CHECK(loaded->version() == r.journal.version());
+    CHECK(!copy.hasVertex(2));
+
+    copy.addChangeListener([&](const std::vector<GraphChange>& changes) { loaded->record(copy, changes); });
+    CHECK(loaded->undo(copy));
+    const Vertex* vertex = static_cast<const Graph&>(copy).getVertex(2);
+    CHECK(vertex && vertex->type == "topic");
+    CHECK(copy.getEdge(1, 2).weight == 3.0);
+    CHECK(loaded->undo(copy));
+    CHECK(copy.getEdge(1, 2).weight == 1.0 && copy.getEdge(1, 2).label == "a");
+}
+
+void seekAfterThinning() {
+    Recorded r(true);
+    const int operations = static_cast<int>(Journal::kCheckpointInterval) * 100;
+    for (int i = 0; i < operations; ++i) r.graph.addEdge(i, i + 1, 1.0);
+    CHECK(r.journal.size() == static_cast<size_t>(operations));
+
+    for (size_t version : {size_t(0), size_t(1), size_t(777), size_t(2048), size_t(operations - 5), size_t(operations)}) {
+        r.journal.seek(r.graph, version);
+        CHECK(r.journal.version() == version);
+        CHECK(r.graph.getEdgeCount() == static_cast<int>(version));
+    }
+}
+
+} // namespace
+
+int main() {
+    edgeUpdate(false);
+    edgeUpdate(true);
+    removedVertexType();
+    saveAndLoad();
+    seekAfterThinning();
+    if (failures > 0) {
+        std::cerr << "Ошибок: " << failures << std::endl;
+        return 1;
+    }
+    std::cout << "journal_test: OK" << std::endl;
+    return 0;
+}